@@ -0,0 +1,368 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * End to end benchmark of the lidarDataManager executable.
+ *
+ * A synthetic las file is generated (see SyntheticPointCloud), then a set of representative pipelines is run
+ * by the actual executable for different numbers of threads (through OMP_NUM_THREADS).
+ * The wall time, throughput and peak memory of each run are reported as json.
+ */
+
+#include <StereoVision/io/pointcloud_io.h>
+#include <StereoVision/io/las_pointcloud_io.h>
+
+#include <tclap/CmdLine.h>
+
+#include "../processingBlocks/aliasheaderattributes.h"
+#include "../io/syntheticpointcloud.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef LDM_EXECUTABLE_PATH
+#define LDM_EXECUTABLE_PATH "lidarDataManager"
+#endif
+
+//the synthetic data is generated in the swiss LV95 projection.
+constexpr char syntheticCrs[] = "EPSG:2056";
+
+struct Pipeline {
+    std::string name;
+    std::string outExtension;
+    std::vector<std::string> arguments;
+};
+
+struct RunResult {
+    bool ok;
+    double seconds;
+    long peakRssKb;
+};
+
+bool generateInputFile(std::string const& path, SyntheticPointCloud::Parameters const& parameters) {
+
+    StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+    AliasHeaderAttributes::AliasMap headerAttributes;
+    headerAttributes["crs"] = std::string(syntheticCrs);
+
+    pointCloudStack.headerAccess = std::make_unique<AliasHeaderAttributes>(nullptr, headerAttributes);
+    pointCloudStack.pointAccess = SyntheticPointCloud::setupSyntheticPointCloud(parameters);
+
+    if (pointCloudStack.pointAccess == nullptr) {
+        return false;
+    }
+
+    return StereoVision::IO::writePointCloudLas(std::filesystem::path(path), pointCloudStack);
+}
+
+std::vector<Pipeline> representativePipelines(SyntheticPointCloud::Parameters const& parameters) {
+
+    int nPoints = parameters.nPoints;
+
+    //a rotated box around the middle of the first line.
+    std::ostringstream roi;
+    roi.precision(12);
+    roi << parameters.x0 + parameters.lineLength/2 << "," << parameters.y0 << ",0,"
+        << parameters.lineLength/4 << "," << parameters.flightHeight/4 << ",1000,0,0,0.3";
+
+    std::vector<Pipeline> ret;
+
+    ret.push_back({"las2las_roi", ".las", {"-f", "lasv14", "--roi", roi.str()}});
+    ret.push_back({"las2pcd_crs", ".pcd", {"-f", "pcd-bin", "--incrs", syntheticCrs, "--outcrs", "EPSG:4326"}});
+    ret.push_back({"line_selection", ".las", {"-f", "lasv14", "--line", "0", "--line_range", "2-3"}});
+    ret.push_back({"decimation", ".las", {"-f", "lasv14", "-n", std::to_string(std::max(1, nPoints/10))}});
+
+    return ret;
+}
+
+/*!
+ * \brief runExecutable run the executable in a child process and wait for it.
+ * \param executable the path to the executable
+ * \param arguments the arguments of the executable
+ * \param nThreads the number of OpenMP threads the child process should use
+ * \return the wall time and the peak resident set size of the child process.
+ */
+RunResult runExecutable(std::string const& executable, std::vector<std::string> const& arguments, int nThreads) {
+
+    RunResult ret{false, 0, 0};
+
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(executable.c_str()));
+
+    for (std::string const& arg : arguments) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+
+    argv.push_back(nullptr);
+
+    std::string threadsStr = std::to_string(nThreads);
+
+    auto start = std::chrono::steady_clock::now();
+
+    pid_t pid = fork();
+
+    if (pid < 0) {
+        return ret;
+    }
+
+    if (pid == 0) {
+        setenv("OMP_NUM_THREADS", threadsStr.c_str(), 1);
+
+        //the progress report is not part of what we want to measure, and would clutter the json output.
+        int devNull = open("/dev/null", O_WRONLY);
+        if (devNull >= 0) {
+            dup2(devNull, STDOUT_FILENO);
+            dup2(devNull, STDERR_FILENO);
+            close(devNull);
+        }
+
+        execv(executable.c_str(), argv.data());
+        _exit(127);
+    }
+
+    int status;
+    struct rusage usage;
+
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        return ret;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    ret.ok = WIFEXITED(status) and WEXITSTATUS(status) == 0;
+    ret.seconds = std::chrono::duration<double>(end - start).count();
+    ret.peakRssKb = usage.ru_maxrss;
+
+    return ret;
+}
+
+std::vector<int> defaultThreadCounts() {
+
+    int maxThreads = std::max<int>(1, std::thread::hardware_concurrency());
+
+    std::vector<int> ret;
+
+    for (int n = 1; n < maxThreads; n *= 2) {
+        ret.push_back(n);
+    }
+
+    ret.push_back(maxThreads);
+
+    return ret;
+}
+
+int main(int argc, char** argv) {
+
+    const char* message = "Benchmark the lidarDataManager executable on representative pipelines";
+    constexpr char delimiter = '=';
+    const char* version = "0.1";
+
+    std::string executable;
+    std::string workDir;
+    std::string outputFile;
+    int nPoints;
+    int nRepetitions;
+    std::vector<int> threadCounts;
+
+    try {
+
+        TCLAP::CmdLine cmd(message, delimiter, version);
+
+        TCLAP::ValueArg<std::string> executableArg("e", "executable", "Path to the lidarDataManager executable", false, LDM_EXECUTABLE_PATH, "path");
+        TCLAP::ValueArg<std::string> workDirArg("w", "workdir", "Directory where the generated files are written", false, "ldm_cli_benchmark", "path");
+        TCLAP::ValueArg<std::string> outputArg("o", "output", "Json file to write the results to, print on the standard output if not set", false, "", "path");
+        TCLAP::ValueArg<int> pointsArg("p", "points", "Number of points in the generated input file", false, 1000000, "An int");
+        TCLAP::ValueArg<int> repetitionsArg("r", "repetitions", "Number of runs per configuration, the fastest one is reported", false, 3, "An int");
+        TCLAP::MultiArg<int> threadsArg("t", "threads", "A number of threads to run the pipelines with, default to powers of two up to the number of cores", false, "An int");
+
+        cmd.add(executableArg);
+        cmd.add(workDirArg);
+        cmd.add(outputArg);
+        cmd.add(pointsArg);
+        cmd.add(repetitionsArg);
+        cmd.add(threadsArg);
+
+        cmd.parse(argc, argv);
+
+        executable = executableArg.getValue();
+        workDir = workDirArg.getValue();
+        outputFile = outputArg.getValue();
+        nPoints = std::max(1, pointsArg.getValue());
+        nRepetitions = std::max(1, repetitionsArg.getValue());
+        threadCounts = threadsArg.getValue();
+
+    } catch (TCLAP::ArgException &e) {
+
+        std::cerr << "Command line error: " << e.error() << " for argument " << e.argId() << std::endl;
+        return 1;
+
+    }
+
+    if (threadCounts.empty()) {
+        threadCounts = defaultThreadCounts();
+    }
+
+    std::sort(threadCounts.begin(), threadCounts.end());
+    threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+    threadCounts.erase(std::remove_if(threadCounts.begin(), threadCounts.end(), [] (int n) {return n <= 0;}), threadCounts.end());
+
+    if (threadCounts.empty()) {
+        std::cerr << "No valid number of threads given! Aborting!" << std::endl;
+        return 1;
+    }
+
+    std::filesystem::path workPath(workDir);
+    std::error_code ec;
+    std::filesystem::create_directories(workPath, ec);
+
+    if (ec) {
+        std::cerr << "Could not create work directory " << workPath << "! Aborting!" << std::endl;
+        return 1;
+    }
+
+    std::string inFile = (workPath / ("input_" + std::to_string(nPoints) + ".las")).string();
+
+    SyntheticPointCloud::Parameters parameters;
+    parameters.nPoints = nPoints;
+
+    //shorter lines than the default, so that small files still cover multiple lines.
+    parameters.lineLength = 500;
+
+    if (!std::filesystem::exists(inFile)) {
+        std::cerr << "Generating " << nPoints << " points in " << inFile << std::endl;
+
+        if (!generateInputFile(inFile, parameters)) {
+            std::cerr << "Could not generate input file " << inFile << "! Aborting!" << std::endl;
+            return 1;
+        }
+    }
+
+    double inputMb = std::filesystem::file_size(inFile)/1e6;
+
+    std::ostringstream json;
+
+    json << "{\"executable\":\"" << executable << "\""
+         << ",\"points\":" << nPoints
+         << ",\"input_mb\":" << inputMb
+         << ",\"repetitions\":" << nRepetitions
+         << ",\"pipelines\":[";
+
+    std::vector<Pipeline> pipelines = representativePipelines(parameters);
+
+    bool allOk = true;
+
+    for (int p = 0; p < pipelines.size(); p++) {
+
+        Pipeline const& pipeline = pipelines[p];
+
+        std::vector<std::string> arguments = {inFile, "-o", (workPath / ("output_" + pipeline.name + pipeline.outExtension)).string()};
+        arguments.insert(arguments.end(), pipeline.arguments.begin(), pipeline.arguments.end());
+
+        if (p > 0) {
+            json << ",";
+        }
+
+        json << "{\"name\":\"" << pipeline.name << "\",\"runs\":[";
+
+        double baseSeconds = -1;
+        int baseThreads = threadCounts.front();
+
+        for (int t = 0; t < threadCounts.size(); t++) {
+
+            int nThreads = threadCounts[t];
+
+            double bestSeconds = std::numeric_limits<double>::infinity();
+            long peakRssKb = 0;
+            bool ok = true;
+
+            for (int r = 0; r < nRepetitions; r++) {
+
+                RunResult result = runExecutable(executable, arguments, nThreads);
+
+                if (!result.ok) {
+                    ok = false;
+                    break;
+                }
+
+                bestSeconds = std::min(bestSeconds, result.seconds);
+                peakRssKb = std::max(peakRssKb, result.peakRssKb);
+            }
+
+            std::cerr << pipeline.name << " with " << nThreads << " threads: "
+                      << ((ok) ? std::to_string(bestSeconds) + "s" : std::string("failed")) << std::endl;
+
+            if (t > 0) {
+                json << ",";
+            }
+
+            json << "{\"threads\":" << nThreads;
+
+            if (!ok) {
+                allOk = false;
+                json << ",\"status\":\"error\"}";
+                continue;
+            }
+
+            if (t == 0) {
+                baseSeconds = bestSeconds;
+            }
+
+            //efficiency of the speedup relative to the smallest number of threads.
+            double efficiency = (baseSeconds > 0) ? (baseSeconds*baseThreads)/(bestSeconds*nThreads) : 0;
+
+            json << ",\"status\":\"ok\""
+                 << ",\"seconds\":" << bestSeconds
+                 << ",\"points_per_s\":" << nPoints/bestSeconds
+                 << ",\"mb_per_s\":" << inputMb/bestSeconds
+                 << ",\"peak_rss_kb\":" << peakRssKb
+                 << ",\"parallel_efficiency\":" << efficiency << "}";
+        }
+
+        json << "]}";
+    }
+
+    json << "]}";
+
+    if (outputFile.empty()) {
+        std::cout << json.str() << std::endl;
+    } else {
+        std::ofstream out(outputFile);
+
+        if (!out.is_open()) {
+            std::cerr << "Could not open output file " << outputFile << "!" << std::endl;
+            return 1;
+        }
+
+        out << json.str() << std::endl;
+    }
+
+    return (allOk) ? 0 : 1;
+}
@@ -23,9 +23,27 @@
 
 #include "../processingBlocks/identityprocessor.h"
 #include "../processingBlocks/attributebasedselector.h"
+#include "../processingBlocks/attributesetbasedselector.h"
 #include "../processingBlocks/crsconversion.h"
+#include "../processingBlocks/pointsattributesfilters.h"
+#include "../processingBlocks/pointsnumberlimit.h"
+#include "../processingBlocks/regionofinterestselector.h"
 
+#include "../io/asciipointcloudreader.h"
+#include "../io/asciipointcloudwriter.h"
+#include "../io/ldmcpointcloud.h"
+#include "../io/plypointcloud.h"
+
+#include "../densitycache.h"
+
+#include <algorithm>
+#include <filesystem>
 #include <random>
+#include <sstream>
+
+#ifndef LDM_BENCHMARK_MAX_POINTS
+#define LDM_BENCHMARK_MAX_POINTS 1000000
+#endif
 
 using GenericCloud = StereoVision::IO::GenericPointCloud<float, float>;
 using GenericCloudHeaderInterface = StereoVision::IO::GenericPointCloudHeaderInterface<float, float>;
@@ -66,72 +84,126 @@ GenericCloud getRandomPointCloud(int nPoints) {
 
 }
 
-static void PcdAsciiWritingBenchmark(benchmark::State& state) {
+constexpr int benchmarkMinPoints = 1000;
+constexpr int benchmarkMaxPoints = LDM_BENCHMARK_MAX_POINTS;
 
-    // setup
-    constexpr int nPoints = 1024;
+//the density estimator is quadratic in the number of points, larger sizes are not practical.
+constexpr int densityBenchmarkMaxPoints = std::min(10000, benchmarkMaxPoints);
 
-    GenericCloud ptCloud = getRandomPointCloud(nPoints);
+//size of the payload of a point for the processing blocks (xyz + rgba as floats).
+constexpr int64_t pointPayloadSize = 7*sizeof(float);
 
-    StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+const std::string numberAttributeName = "number";
+const std::array<int,2> numberAttributeOptions = {42, 69};
 
-    pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(ptCloud);
-    pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(ptCloud);
-
-    GenericCloudInterface* base = static_cast<GenericCloudInterface*>(pointCloudStack.pointAccess.get());
-
-    std::string outFile = "test_pcd_ascii.pcd";
-
-    //time loop
-    for (auto _ : state) {
-
-        bool hasMore = true;
-        base->reset();
+static void pointsRange(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(10)->Range(benchmarkMinPoints, benchmarkMaxPoints)->Unit(benchmark::kMillisecond);
+}
 
-        StereoVision::IO::PcdDataStorageType dataStorageType = StereoVision::IO::PcdDataStorageType::ascii;
+static void densityPointsRange(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(10)->Range(benchmarkMinPoints, densityBenchmarkMaxPoints)->Unit(benchmark::kMillisecond);
+}
 
-        bool ok = StereoVision::IO::writePointCloudPcd(std::filesystem::path(outFile), pointCloudStack, dataStorageType);
+void addNumberAttribute(GenericCloud & ptCloud, int nPoints) {
 
-        benchmark::DoNotOptimize(ok);
+    ptCloud.addAttribute(numberAttributeName);
 
+    for (int i = 0; i < nPoints; i++) {
+        ptCloud[i].attributes[numberAttributeName] = numberAttributeOptions[i%2];
     }
 }
 
-static void PcdBinaryWritingBenchmark(benchmark::State& state) {
-
-    // setup
-    constexpr int nPoints = 1024;
-
-    GenericCloud ptCloud = getRandomPointCloud(nPoints);
+/*!
+ * \brief setThroughputCounters report the number of points and bytes processed per second.
+ * \param state the benchmark state
+ * \param nPoints the number of points processed per iteration
+ * \param nBytes the number of bytes processed per iteration
+ */
+void setThroughputCounters(benchmark::State& state, int64_t nPoints, int64_t nBytes) {
+    state.counters["points/s"] = benchmark::Counter(double(state.iterations())*nPoints, benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(state.iterations()*nBytes);
+}
 
-    StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+int64_t fileSize(std::string const& path) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    return (ec) ? 0 : size;
+}
 
-    pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(ptCloud);
-    pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(ptCloud);
+enum class BenchmarkFileType {
+    PcdAscii,
+    PcdBinary,
+    Las,
+    Ply,
+    Ldmc
+};
+
+std::string benchmarkFileName(BenchmarkFileType type, int nPoints, std::string const& suffix = "") {
+
+    switch (type) {
+    case BenchmarkFileType::PcdAscii:
+        return "test_pcd_ascii_" + std::to_string(nPoints) + suffix + ".pcd";
+    case BenchmarkFileType::PcdBinary:
+        return "test_pcd_bin_" + std::to_string(nPoints) + suffix + ".pcd";
+    case BenchmarkFileType::Las:
+        return "test_las_" + std::to_string(nPoints) + suffix + ".las";
+    case BenchmarkFileType::Ply:
+        return "test_ply_" + std::to_string(nPoints) + suffix + ".ply";
+    case BenchmarkFileType::Ldmc:
+        return "test_ldmc_" + std::to_string(nPoints) + suffix + ".ldmc";
+    }
 
-    GenericCloudInterface* base = static_cast<GenericCloudInterface*>(pointCloudStack.pointAccess.get());
+    return "";
+}
 
-    std::string outFile = "test_pcd_bin.pcd";
+bool writeBenchmarkFile(BenchmarkFileType type, std::string const& path, StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack) {
+
+    switch (type) {
+    case BenchmarkFileType::PcdAscii:
+        return StereoVision::IO::writePointCloudPcd(std::filesystem::path(path), pointCloudStack, StereoVision::IO::PcdDataStorageType::ascii);
+    case BenchmarkFileType::PcdBinary:
+        return StereoVision::IO::writePointCloudPcd(std::filesystem::path(path), pointCloudStack, StereoVision::IO::PcdDataStorageType::binary);
+    case BenchmarkFileType::Las:
+        return StereoVision::IO::writePointCloudLas(std::filesystem::path(path), pointCloudStack);
+    case BenchmarkFileType::Ply:
+        return Ply::writePointCloudPly(std::filesystem::path(path), pointCloudStack);
+    case BenchmarkFileType::Ldmc:
+        return Ldmc::writePointCloudLdmc(std::filesystem::path(path), pointCloudStack);
+    }
 
-    //time loop
-    for (auto _ : state) {
+    return false;
+}
 
-        bool hasMore = true;
-        base->reset();
+std::optional<StereoVision::IO::FullPointCloudAccessInterface> openBenchmarkFile(BenchmarkFileType type, std::string const& path) {
 
-        StereoVision::IO::PcdDataStorageType dataStorageType = StereoVision::IO::PcdDataStorageType::binary;
+    if (type == BenchmarkFileType::Ply) {
+        return Ply::openPointCloudPly(path);
+    }
 
-        bool ok = StereoVision::IO::writePointCloudPcd(std::filesystem::path(outFile), pointCloudStack, dataStorageType);
+    if (type == BenchmarkFileType::Ldmc) {
+        return Ldmc::openPointCloudLdmc(path);
+    }
 
-        benchmark::DoNotOptimize(ok);
+    StatusOptional<StereoVision::IO::FullPointCloudAccessInterface> opened = StereoVision::IO::openPointCloud(path);
 
+    if (!opened.has_value()) {
+        return std::nullopt;
     }
+
+    return std::move(opened.value());
 }
 
-static void LasWritingBenchmark(benchmark::State& state) {
+/*!
+ * \brief ensureBenchmarkFile generate the input file of the reading benchmarks, if it does not exist yet.
+ * \return the path to the file, or an empty string in case of error.
+ */
+std::string ensureBenchmarkFile(BenchmarkFileType type, int nPoints) {
 
-    // setup
-    constexpr int nPoints = 1024;
+    std::string path = benchmarkFileName(type, nPoints);
+
+    if (std::filesystem::exists(path)) {
+        return path;
+    }
 
     GenericCloud ptCloud = getRandomPointCloud(nPoints);
 
@@ -140,79 +212,55 @@ static void LasWritingBenchmark(benchmark::State& state) {
     pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(ptCloud);
     pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(ptCloud);
 
-    GenericCloudInterface* base = static_cast<GenericCloudInterface*>(pointCloudStack.pointAccess.get());
-
-    std::string outFile = "test_las.las";
-
-    //time loop
-    for (auto _ : state) {
-
-        bool hasMore = true;
-        base->reset();
-
-        bool ok = StereoVision::IO::writePointCloudLas(std::filesystem::path(outFile), pointCloudStack);
-
-        benchmark::DoNotOptimize(ok);
-
+    if (!writeBenchmarkFile(type, path, pointCloudStack)) {
+        return "";
     }
+
+    return path;
 }
 
-static void PcdAsciiReadingBenchmark(benchmark::State& state) {
-    // setup
+static void writingBenchmark(benchmark::State& state, BenchmarkFileType type) {
 
-    std::string inFile = "test_pcd_ascii.pcd";
+    // setup
+    const int nPoints = state.range(0);
 
-    bool fileReadOk = true;
+    GenericCloud ptCloud = getRandomPointCloud(nPoints);
 
-    std::array<float,3> meanPoint = {0,0,0};
-    std::array<float,4> meanColor = {0,0,0,0};
+    std::string outFile = benchmarkFileName(type, nPoints);
 
     //time loop
     for (auto _ : state) {
 
-        StatusOptional<StereoVision::IO::FullPointCloudAccessInterface> pointCloudStack =
-                StereoVision::IO::openPointCloud(inFile);
-
-        if (!pointCloudStack.has_value()) {
-            state.SkipWithError("Failed to open file");
-            break;
-        }
+        StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
 
-        bool hasMore = true;
+        pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(ptCloud);
+        pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(ptCloud);
 
-        do {
-
-            auto point = pointCloudStack->pointAccess->castedPointGeometry<float>();
+        bool ok = writeBenchmarkFile(type, outFile, pointCloudStack);
 
-            meanPoint[0] += point.x;
-            meanPoint[1] += point.y;
-            meanPoint[2] += point.z;
-
-            auto color = pointCloudStack->pointAccess->castedPointColor<float>();
-
-            if (color.has_value()) {
-                meanColor[0] = color->r;
-                meanColor[1] = color->g;
-                meanColor[2] = color->b;
-                meanColor[3] = color->a;
-            }
-
-            hasMore = pointCloudStack->pointAccess->gotoNext();
+        if (!ok) {
+            state.SkipWithError("Failed to write file");
+            break;
+        }
 
-        } while (hasMore);
+        benchmark::DoNotOptimize(ok);
 
     }
 
-    benchmark::DoNotOptimize(meanPoint);
-    benchmark::DoNotOptimize(meanColor);
+    setThroughputCounters(state, nPoints, fileSize(outFile));
 }
 
-static void PcdBinaryReadingBenchmark(benchmark::State& state) {
+static void readingBenchmark(benchmark::State& state, BenchmarkFileType type, bool parallelAsciiReader = false) {
+
     // setup
+    const int nPoints = state.range(0);
 
-    std::string inFile = "test_pcd_bin.pcd";
+    std::string inFile = ensureBenchmarkFile(type, nPoints);
 
-    bool fileReadOk = true;
+    if (inFile.empty()) {
+        state.SkipWithError("Failed to generate input file");
+        return;
+    }
 
     std::array<float,3> meanPoint = {0,0,0};
     std::array<float,4> meanColor = {0,0,0,0};
@@ -220,8 +268,13 @@ static void PcdBinaryReadingBenchmark(benchmark::State& state) {
     //time loop
     for (auto _ : state) {
 
-        StatusOptional<StereoVision::IO::FullPointCloudAccessInterface> pointCloudStack =
-                StereoVision::IO::openPointCloud(inFile);
+        std::optional<StereoVision::IO::FullPointCloudAccessInterface> pointCloudStack;
+
+        if (parallelAsciiReader) {
+            pointCloudStack = AsciiPointCloud::openPointCloudAscii(inFile);
+        } else {
+            pointCloudStack = openBenchmarkFile(type, inFile);
+        }
 
         if (!pointCloudStack.has_value()) {
             state.SkipWithError("Failed to open file");
@@ -255,223 +308,289 @@ static void PcdBinaryReadingBenchmark(benchmark::State& state) {
 
     benchmark::DoNotOptimize(meanPoint);
     benchmark::DoNotOptimize(meanColor);
+
+    setThroughputCounters(state, nPoints, fileSize(inFile));
 }
 
-static void LasReadingBenchmark(benchmark::State& state) {
+static void fullReadWriteBenchmark(benchmark::State& state, BenchmarkFileType type) {
+
     // setup
+    const int nPoints = state.range(0);
 
-    std::string inFile = "test_las.las";
+    std::string inFile = ensureBenchmarkFile(type, nPoints);
 
-    bool fileReadOk = true;
+    if (inFile.empty()) {
+        state.SkipWithError("Failed to generate input file");
+        return;
+    }
 
-    std::array<float,3> meanPoint = {0,0,0};
-    std::array<float,4> meanColor = {0,0,0,0};
+    std::string outFile = benchmarkFileName(type, nPoints, "_copy");
 
     //time loop
     for (auto _ : state) {
 
-        StatusOptional<StereoVision::IO::FullPointCloudAccessInterface> pointCloudStack =
-                StereoVision::IO::openPointCloud(inFile);
+        std::optional<StereoVision::IO::FullPointCloudAccessInterface> pointCloudStack = openBenchmarkFile(type, inFile);
 
         if (!pointCloudStack.has_value()) {
             state.SkipWithError("Failed to open file");
             break;
         }
 
-        bool hasMore = true;
-
-        do {
-
-            auto point = pointCloudStack->pointAccess->castedPointGeometry<float>();
-
-            meanPoint[0] += point.x;
-            meanPoint[1] += point.y;
-            meanPoint[2] += point.z;
-
-            auto color = pointCloudStack->pointAccess->castedPointColor<float>();
-
-            if (color.has_value()) {
-                meanColor[0] = color->r;
-                meanColor[1] = color->g;
-                meanColor[2] = color->b;
-                meanColor[3] = color->a;
-            }
+        //ensure to disable the optimization where the data is just copied directly when writing to the same type of file.
+        pointCloudStack.value().pointAccess = std::make_unique<IdentityProcessor>(std::move(pointCloudStack.value().pointAccess));
 
-            hasMore = pointCloudStack->pointAccess->gotoNext();
+        bool ok = writeBenchmarkFile(type, outFile, pointCloudStack.value());
 
-        } while (hasMore);
+        benchmark::DoNotOptimize(ok);
 
     }
 
-    benchmark::DoNotOptimize(meanPoint);
-    benchmark::DoNotOptimize(meanColor);
+    setThroughputCounters(state, nPoints, fileSize(inFile) + fileSize(outFile));
 }
 
-static void PcdAsciiFullReadWriteBenchmark(benchmark::State& state) {
-
-
-    std::string inFile = "test_pcd_ascii.pcd";
-
-    bool fileReadOk = true;
+static void asciiWritingBenchmark(benchmark::State& state, AsciiPointCloud::Format format, std::string const& outFile) {
 
-    std::array<float,3> meanPoint = {0,0,0};
-    std::array<float,4> meanColor = {0,0,0,0};
+    // setup
+    const int nPoints = state.range(0);
 
-    std::string outFile = "test_pcd_ascii_copy.pcd";
+    GenericCloud ptCloud = getRandomPointCloud(nPoints);
 
     //time loop
     for (auto _ : state) {
 
-        StatusOptional<StereoVision::IO::FullPointCloudAccessInterface> pointCloudStack =
-                StereoVision::IO::openPointCloud(inFile);
+        StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
 
-        if (!pointCloudStack.has_value()) {
-            state.SkipWithError("Failed to open file");
-            break;
-        }
-
-        //ensure to disable the optimization where the data is just copied directly when writing to the same type of file.
-        pointCloudStack.value().pointAccess = std::make_unique<IdentityProcessor>(std::move(pointCloudStack.value().pointAccess));
+        pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(ptCloud);
+        pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(ptCloud);
 
-        StereoVision::IO::PcdDataStorageType dataStorageType = StereoVision::IO::PcdDataStorageType::ascii;
+        bool ok = AsciiPointCloud::writePointCloudAscii(outFile, pointCloudStack, format);
 
-        bool ok = StereoVision::IO::writePointCloudPcd(std::filesystem::path(outFile), pointCloudStack.value(), dataStorageType);
+        if (!ok) {
+            state.SkipWithError("Failed to write file");
+            break;
+        }
 
         benchmark::DoNotOptimize(ok);
 
     }
-}
-
-static void PcdBinaryFullReadWriteBenchmark(benchmark::State& state) {
 
+    setThroughputCounters(state, nPoints, fileSize(outFile));
+}
 
-    std::string inFile = "test_pcd_bin.pcd";
+static void PcdAsciiWritingBenchmark(benchmark::State& state) {
+    writingBenchmark(state, BenchmarkFileType::PcdAscii);
+}
 
-    bool fileReadOk = true;
+static void PcdAsciiParallelWritingBenchmark(benchmark::State& state) {
+    asciiWritingBenchmark(state, AsciiPointCloud::Format::PcdAscii, "test_pcd_ascii_parallel_" + std::to_string(state.range(0)) + ".pcd");
+}
 
-    std::array<float,3> meanPoint = {0,0,0};
-    std::array<float,4> meanColor = {0,0,0,0};
+static void CsvWritingBenchmark(benchmark::State& state) {
+    asciiWritingBenchmark(state, AsciiPointCloud::Format::Csv, "test_csv_" + std::to_string(state.range(0)) + ".csv");
+}
 
-    std::string outFile = "test_pcd_bin_copy.pcd";
+static void PcdBinaryWritingBenchmark(benchmark::State& state) {
+    writingBenchmark(state, BenchmarkFileType::PcdBinary);
+}
 
-    //time loop
-    for (auto _ : state) {
+static void LasWritingBenchmark(benchmark::State& state) {
+    writingBenchmark(state, BenchmarkFileType::Las);
+}
 
-        StatusOptional<StereoVision::IO::FullPointCloudAccessInterface> pointCloudStack =
-                StereoVision::IO::openPointCloud(inFile);
+static void PlyWritingBenchmark(benchmark::State& state) {
+    writingBenchmark(state, BenchmarkFileType::Ply);
+}
 
-        if (!pointCloudStack.has_value()) {
-            state.SkipWithError("Failed to open file");
-            break;
-        }
+static void LdmcWritingBenchmark(benchmark::State& state) {
+    writingBenchmark(state, BenchmarkFileType::Ldmc);
+}
 
-        //ensure to disable the optimization where the data is just copied directly when writing to the same type of file.
-        pointCloudStack.value().pointAccess = std::make_unique<IdentityProcessor>(std::move(pointCloudStack.value().pointAccess));
+static void PcdAsciiReadingBenchmark(benchmark::State& state) {
+    readingBenchmark(state, BenchmarkFileType::PcdAscii);
+}
 
-        StereoVision::IO::PcdDataStorageType dataStorageType = StereoVision::IO::PcdDataStorageType::binary;
+static void PcdAsciiParallelReadingBenchmark(benchmark::State& state) {
+    readingBenchmark(state, BenchmarkFileType::PcdAscii, true);
+}
 
-        bool ok = StereoVision::IO::writePointCloudPcd(std::filesystem::path(outFile), pointCloudStack.value(), dataStorageType);
+static void PcdBinaryReadingBenchmark(benchmark::State& state) {
+    readingBenchmark(state, BenchmarkFileType::PcdBinary);
+}
 
-        benchmark::DoNotOptimize(ok);
+static void LasReadingBenchmark(benchmark::State& state) {
+    readingBenchmark(state, BenchmarkFileType::Las);
+}
 
-    }
+static void PlyReadingBenchmark(benchmark::State& state) {
+    readingBenchmark(state, BenchmarkFileType::Ply);
 }
 
-static void LasFullReadWriteBenchmark(benchmark::State& state) {
+static void LdmcReadingBenchmark(benchmark::State& state) {
+    readingBenchmark(state, BenchmarkFileType::Ldmc);
+}
 
+static void PcdAsciiFullReadWriteBenchmark(benchmark::State& state) {
+    fullReadWriteBenchmark(state, BenchmarkFileType::PcdAscii);
+}
 
-    std::string inFile = "test_las.las";
+static void PcdBinaryFullReadWriteBenchmark(benchmark::State& state) {
+    fullReadWriteBenchmark(state, BenchmarkFileType::PcdBinary);
+}
 
-    bool fileReadOk = true;
+static void LasFullReadWriteBenchmark(benchmark::State& state) {
+    fullReadWriteBenchmark(state, BenchmarkFileType::Las);
+}
 
-    std::array<float,3> meanPoint = {0,0,0};
-    std::array<float,4> meanColor = {0,0,0,0};
+/*!
+ * \brief processingBlockBenchmark read a whole point cloud through a processing block.
+ * \param state the benchmark state
+ * \param ptCloud the point cloud to read from
+ * \param nPoints the number of points in the point cloud
+ * \param setup a function building the processing block on top of a source.
+ *
+ * The processing chain is built in each iteration, so that blocks holding a state are measured from scratch.
+ */
+template<typename SetupT>
+static void processingBlockBenchmark(benchmark::State& state, GenericCloud & ptCloud, int nPoints, SetupT const& setup) {
 
-    std::string outFile = "test_las_copy.las";
+    int64_t nRead = 0;
 
     //time loop
     for (auto _ : state) {
 
-        StatusOptional<StereoVision::IO::FullPointCloudAccessInterface> pointCloudStack =
-                StereoVision::IO::openPointCloud(inFile);
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> baseInterface =
+                std::make_unique<GenericCloudInterface>(ptCloud);
 
-        if (!pointCloudStack.has_value()) {
-            state.SkipWithError("Failed to open file");
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> block = setup(baseInterface);
+
+        if (block == nullptr) {
+            state.SkipWithError("Failed to setup processing block");
             break;
         }
 
-        //ensure to disable the optimization where the data is just copied directly when writing to the same type of file.
-        pointCloudStack.value().pointAccess = std::make_unique<IdentityProcessor>(std::move(pointCloudStack.value().pointAccess));
+        bool hasMore = block->hasData();
 
-        StereoVision::IO::PcdDataStorageType dataStorageType = StereoVision::IO::PcdDataStorageType::binary;
+        while (hasMore) {
 
-        bool ok = StereoVision::IO::writePointCloudPcd(std::filesystem::path(outFile), pointCloudStack.value(), dataStorageType);
+            auto point = block->castedPointGeometry<float>();
+            auto color = block->castedPointColor<float>();
 
-        benchmark::DoNotOptimize(ok);
+            benchmark::DoNotOptimize(point);
+            benchmark::DoNotOptimize(color);
 
+            nRead++;
+
+            hasMore = block->gotoNext();
+
+        }
     }
+
+    benchmark::DoNotOptimize(nRead);
+
+    setThroughputCounters(state, nPoints, nPoints*pointPayloadSize);
 }
 
 static void AttributeSelectorBenchmark(benchmark::State& state) {
     // setup
-    constexpr int nPoints = 1024;
+    const int nPoints = state.range(0);
 
     GenericCloud ptCloud = getRandomPointCloud(nPoints);
+    addNumberAttribute(ptCloud, nPoints);
 
-    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> baseInterface =
-            std::make_unique<GenericCloudInterface>(ptCloud);
+    StereoVision::IO::PointCloudGenericAttribute val = numberAttributeOptions[0];
 
-    GenericCloudInterface* base = static_cast<GenericCloudInterface*>(baseInterface.get());
+    processingBlockBenchmark(state, ptCloud, nPoints, [&val] (std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source) {
+        return AttributeBasedSelector::setupAttributeBasedSelector(source,
+                                                                   numberAttributeName,
+                                                                   AttributeBasedSelector::Equal,
+                                                                   val);
+    });
+}
 
-    std::array<int,2> options = {42, 69};
+static void AttributeSetSelectorBenchmark(benchmark::State& state) {
+    // setup
+    const int nPoints = state.range(0);
 
-    std::string name = "number";
-    AttributeBasedSelector::Comparator comparator = AttributeBasedSelector::Equal;
-    StereoVision::IO::PointCloudGenericAttribute val = options[0];
+    GenericCloud ptCloud = getRandomPointCloud(nPoints);
+    addNumberAttribute(ptCloud, nPoints);
 
-    ptCloud.addAttribute(name);
+    std::vector<int> selectedValues = {numberAttributeOptions[0], 1, 2, 3};
 
-    for (int i = 0; i < nPoints; i++) {
-        ptCloud[i].attributes[name] = options[i%2];
-    }
+    processingBlockBenchmark(state, ptCloud, nPoints, [&selectedValues] (std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source) {
+        return AttributeSetBasedSelector::setupAttributeSetBasedSelector(source,
+                                                                         numberAttributeName,
+                                                                         AttributeSetBasedSelector::InSet,
+                                                                         selectedValues);
+    });
+}
 
-    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> selector =
-            AttributeBasedSelector::setupAttributeBasedSelector(baseInterface,
-                                                                name,
-                                                                comparator,
-                                                                val);
+static void RegionOfInterestSelectorBenchmark(benchmark::State& state) {
+    // setup
+    const int nPoints = state.range(0);
 
-    int nRead = 0;
+    GenericCloud ptCloud = getRandomPointCloud(nPoints);
 
-    //time loop
-    for (auto _ : state) {
+    //rotated box covering part of the random point cloud.
+    std::string roi = "0,0,0,500,500,500,0.1,0.2,0.3";
 
-        bool hasMore = true;
-        base->reset();
+    processingBlockBenchmark(state, ptCloud, nPoints, [&roi] (std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source) {
+        return RegionOfInterestSelector::setupRoiSelection(source, roi);
+    });
+}
 
-        do {
+static void PointsNumberLimitBenchmark(benchmark::State& state) {
+    // setup
+    const int nPoints = state.range(0);
 
-            auto point = selector->castedPointGeometry<float>();
-            auto color = selector->castedPointColor<float>();
+    GenericCloud ptCloud = getRandomPointCloud(nPoints);
 
-            benchmark::DoNotOptimize(point);
-            benchmark::DoNotOptimize(color);
+    processingBlockBenchmark(state, ptCloud, nPoints, [nPoints] (std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source) {
+        return PointsNumberLimit::setupPointNumberLimit(source, nPoints, 2);
+    });
+}
 
-            nRead++;
+static void PointsAttributesFiltersBenchmark(benchmark::State& state) {
+    // setup
+    const int nPoints = state.range(0);
 
-            hasMore = selector->gotoNext();
+    GenericCloud ptCloud = getRandomPointCloud(nPoints);
+    addNumberAttribute(ptCloud, nPoints);
 
-        } while (hasMore);
+    std::vector<std::string> excluded = {numberAttributeName};
+
+    processingBlockBenchmark(state, ptCloud, nPoints, [&excluded] (std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source) {
+        return PointsAttributesFilters::setupPointAttributeFiltering(source, true, excluded, false);
+    });
+}
+
+/*!
+ * \brief The BufferedPassThrough class is a BufferedIdentityProcessor doing nothing, to measure the cost of the buffering.
+ */
+class BufferedPassThrough : public BufferedIdentityProcessor<float>
+{
+public:
+    BufferedPassThrough(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source) :
+        BufferedIdentityProcessor<float>(std::move(source))
+    {
+        loadNextChunk();
     }
+};
+
+static void BufferedIdentityProcessorBenchmark(benchmark::State& state) {
+    // setup
+    const int nPoints = state.range(0);
 
-    int rFinal = nRead;
+    GenericCloud ptCloud = getRandomPointCloud(nPoints);
+    addNumberAttribute(ptCloud, nPoints);
 
-    benchmark::DoNotOptimize(rFinal);
+    processingBlockBenchmark(state, ptCloud, nPoints, [] (std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source) {
+        return std::make_unique<BufferedPassThrough>(std::move(source));
+    });
 }
 
 static void ConversionEcef2Geo(benchmark::State& state) {
     // setup
-    constexpr int nPoints = 1024;
+    const int nPoints = state.range(0);
 
     constexpr double earthRadius = 6.3781e6;
 
@@ -505,7 +624,12 @@ static void ConversionEcef2Geo(benchmark::State& state) {
                                               inCrs,
                                               outCrs);
 
-    int nRead = 0;
+    if (selector == nullptr) {
+        state.SkipWithError("Failed to setup crs conversion");
+        return;
+    }
+
+    int64_t nRead = 0;
 
     //time loop
     for (auto _ : state) {
@@ -530,21 +654,62 @@ static void ConversionEcef2Geo(benchmark::State& state) {
         selector->gotoNext(); //then reset the buffered point cloud.
     }
 
-    int rFinal = nRead;
+    benchmark::DoNotOptimize(nRead);
+
+    setThroughputCounters(state, nPoints, nPoints*pointPayloadSize);
+}
+
+static void DensityCacheEstimatorBenchmark(benchmark::State& state) {
+    // setup
+    const int nPoints = state.range(0);
+
+    GenericCloud ptCloud = getRandomPointCloud(nPoints);
+
+    //time loop
+    for (auto _ : state) {
+
+        GenericCloudInterface gridPass(ptCloud);
+        std::optional<GridInfos> gridInfos = computeGridInfos(gridPass);
+
+        if (!gridInfos.has_value()) {
+            state.SkipWithError("Failed to compute grid infos");
+            break;
+        }
+
+        GenericCloudInterface densityPass(ptCloud);
+        std::ostringstream out;
+
+        estimateDensity(densityPass, gridInfos.value(), out);
+
+        benchmark::DoNotOptimize(out.str().size());
+    }
 
-    benchmark::DoNotOptimize(rFinal);
+    setThroughputCounters(state, nPoints, nPoints*pointPayloadSize);
 }
 
-BENCHMARK(PcdAsciiWritingBenchmark);
-BENCHMARK(PcdBinaryWritingBenchmark);
-BENCHMARK(LasWritingBenchmark);
-BENCHMARK(PcdAsciiReadingBenchmark);
-BENCHMARK(PcdBinaryReadingBenchmark);
-BENCHMARK(LasReadingBenchmark);
-BENCHMARK(PcdAsciiFullReadWriteBenchmark);
-BENCHMARK(PcdBinaryFullReadWriteBenchmark);
-BENCHMARK(LasFullReadWriteBenchmark);
-BENCHMARK(AttributeSelectorBenchmark);
-BENCHMARK(ConversionEcef2Geo);
+BENCHMARK(PcdAsciiWritingBenchmark)->Apply(pointsRange);
+BENCHMARK(PcdAsciiParallelWritingBenchmark)->Apply(pointsRange);
+BENCHMARK(CsvWritingBenchmark)->Apply(pointsRange);
+BENCHMARK(PcdBinaryWritingBenchmark)->Apply(pointsRange);
+BENCHMARK(LasWritingBenchmark)->Apply(pointsRange);
+BENCHMARK(PlyWritingBenchmark)->Apply(pointsRange);
+BENCHMARK(LdmcWritingBenchmark)->Apply(pointsRange);
+BENCHMARK(PcdAsciiReadingBenchmark)->Apply(pointsRange);
+BENCHMARK(PcdAsciiParallelReadingBenchmark)->Apply(pointsRange);
+BENCHMARK(PcdBinaryReadingBenchmark)->Apply(pointsRange);
+BENCHMARK(LasReadingBenchmark)->Apply(pointsRange);
+BENCHMARK(PlyReadingBenchmark)->Apply(pointsRange);
+BENCHMARK(LdmcReadingBenchmark)->Apply(pointsRange);
+BENCHMARK(PcdAsciiFullReadWriteBenchmark)->Apply(pointsRange);
+BENCHMARK(PcdBinaryFullReadWriteBenchmark)->Apply(pointsRange);
+BENCHMARK(LasFullReadWriteBenchmark)->Apply(pointsRange);
+BENCHMARK(AttributeSelectorBenchmark)->Apply(pointsRange);
+BENCHMARK(AttributeSetSelectorBenchmark)->Apply(pointsRange);
+BENCHMARK(RegionOfInterestSelectorBenchmark)->Apply(pointsRange);
+BENCHMARK(PointsNumberLimitBenchmark)->Apply(pointsRange);
+BENCHMARK(PointsAttributesFiltersBenchmark)->Apply(pointsRange);
+BENCHMARK(BufferedIdentityProcessorBenchmark)->Apply(pointsRange);
+BENCHMARK(ConversionEcef2Geo)->Apply(pointsRange);
+BENCHMARK(DensityCacheEstimatorBenchmark)->Apply(densityPointsRange);
 
 BENCHMARK_MAIN();
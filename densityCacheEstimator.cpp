@@ -23,20 +23,7 @@
 
 #include <StereoVision/io/pointcloud_io.h>
 
-#include <limits>
-#include <cmath>
-
-#include <MultidimArrays/MultidimArrays.h>
-
-constexpr int gridScale = 10;
-
-struct GridInfos {
-    double scale;
-    double x0;
-    double y0;
-    int width;
-    int height;
-};
+#include "densitycache.h"
 
 std::optional<GridInfos> computeGridInfos(std::string const& inFile) {
 
@@ -55,61 +42,7 @@ std::optional<GridInfos> computeGridInfos(std::string const& inFile) {
         return std::nullopt;
     }
 
-    bool ok = true;
-
-    auto currentPoints = pointCloudStack.pointAccess->castedPointGeometry<double>();
-
-    double minX = currentPoints.x;
-    double maxX = currentPoints.x;
-
-    double minY = currentPoints.y;
-    double maxY = currentPoints.y;
-
-    int nPoints = 0;
-
-    do {
-
-        currentPoints = pointCloudStack.pointAccess->castedPointGeometry<double>();
-
-        minX = std::min(minX,currentPoints.x);
-        maxX = std::max(maxX, currentPoints.x);
-
-        minY = std::min(minY,currentPoints.y);
-        maxY = std::max(maxY, currentPoints.y);
-
-        nPoints++;
-
-        ok = pointCloudStack.pointAccess->gotoNext();
-
-    } while (ok);
-
-    if (nPoints <= 1) {
-        std::cerr << "Error with file: " << inFile << ", not enough points! Aborting!" << std::endl;
-        return std::nullopt;
-    }
-
-    GridInfos ret;
-    ret.x0 = minX;
-    ret.y0 = minY;
-
-    double w = maxX - minX;
-    double h = maxY - minY;
-
-    ret.scale = std::sqrt(double(nPoints)/(gridScale*w*h));
-
-    if (!std::isfinite(ret.scale)) {
-        std::cerr << "Error with file: " << inFile << ", points cover surface invalid! Aborting!" << std::endl;
-        return std::nullopt;
-    }
-
-    ret.height = std::ceil(ret.scale*h);
-    ret.width = std::ceil(ret.scale*w);
-
-    return ret;
-}
-
-inline float densityKernel(float dsqr) {
-    return 1/std::max<float>(1,dsqr);
+    return computeGridInfos(*pointCloudStack.pointAccess);
 }
 
 int processData(std::string const& inFile, GridInfos const& gridInfos) {
@@ -129,55 +62,8 @@ int processData(std::string const& inFile, GridInfos const& gridInfos) {
         return 1;
     }
 
-    Multidim::Array<float,2> density(gridInfos.width, gridInfos.height);
-
-    #pragma omp parallel for
-    for (int i = 0; i < density.shape()[0]; i++) {
-        for (int j = 0; j < density.shape()[1]; j++) {
-            density.atUnchecked(i,j) = 0;
-        }
-    }
-
-    bool ok = true;
-
-    do {
-
-        auto currentPoints = pointCloudStack.pointAccess->castedPointGeometry<double>();
-
-        double x = gridInfos.scale*(currentPoints.x-gridInfos.x0);
-        double y = gridInfos.scale*(currentPoints.y-gridInfos.y0);
-
-        int x0 = std::max<int>(0,std::floor(x));
-        int x1 = std::min(density.shape()[0]-1,x0+1);
-
-        int y0 = std::max<int>(0,std::floor(y));
-        int y1 = std::min(density.shape()[0]-1,y0+1);
-
-        double densityLimit =
-                (x1-x)*(y1-y)*density.atUnchecked(x0,y0) +
-                (x-x0)*(y1-y)*density.atUnchecked(x1,y0) +
-                (x1-x)*(y-y0)*density.atUnchecked(x0,y1) +
-                (x-x0)*(y-y0)*density.atUnchecked(x1,y1);
-
-        densityLimit *= gridInfos.scale*gridInfos.scale;
-
-        std::cout << densityLimit << std::endl;
-
-        #pragma omp parallel for
-        for (int i = 0; i < density.shape()[0]; i++) {
-            for (int j = 0; j < density.shape()[1]; j++) {
-                float dx = i-x;
-                float dy = j-y;
-                float dsqr = dx*dx + dy*dy;
-                density.atUnchecked(i,j) += densityKernel(dsqr);
-            }
-        }
-
-        ok = pointCloudStack.pointAccess->gotoNext();
-
-    } while (ok);
+    estimateDensity(*pointCloudStack.pointAccess, gridInfos, std::cout);
 
-    std::cout.flush();
     return 0;
 
 }
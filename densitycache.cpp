@@ -0,0 +1,140 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "densitycache.h"
+
+#include <iostream>
+#include <limits>
+#include <cmath>
+
+#include <MultidimArrays/MultidimArrays.h>
+
+std::optional<GridInfos> computeGridInfos(StereoVision::IO::PointCloudPointAccessInterface & points) {
+
+    bool ok = true;
+
+    auto currentPoints = points.castedPointGeometry<double>();
+
+    double minX = currentPoints.x;
+    double maxX = currentPoints.x;
+
+    double minY = currentPoints.y;
+    double maxY = currentPoints.y;
+
+    int nPoints = 0;
+
+    do {
+
+        currentPoints = points.castedPointGeometry<double>();
+
+        minX = std::min(minX,currentPoints.x);
+        maxX = std::max(maxX, currentPoints.x);
+
+        minY = std::min(minY,currentPoints.y);
+        maxY = std::max(maxY, currentPoints.y);
+
+        nPoints++;
+
+        ok = points.gotoNext();
+
+    } while (ok);
+
+    if (nPoints <= 1) {
+        std::cerr << "Not enough points! Aborting!" << std::endl;
+        return std::nullopt;
+    }
+
+    GridInfos ret;
+    ret.x0 = minX;
+    ret.y0 = minY;
+
+    double w = maxX - minX;
+    double h = maxY - minY;
+
+    ret.scale = std::sqrt(double(nPoints)/(gridScale*w*h));
+
+    if (!std::isfinite(ret.scale)) {
+        std::cerr << "Points cover surface invalid! Aborting!" << std::endl;
+        return std::nullopt;
+    }
+
+    ret.height = std::ceil(ret.scale*h);
+    ret.width = std::ceil(ret.scale*w);
+
+    return ret;
+}
+
+inline float densityKernel(float dsqr) {
+    return 1/std::max<float>(1,dsqr);
+}
+
+void estimateDensity(StereoVision::IO::PointCloudPointAccessInterface & points,
+                     GridInfos const& gridInfos,
+                     std::ostream & out) {
+
+    Multidim::Array<float,2> density(gridInfos.width, gridInfos.height);
+
+    #pragma omp parallel for
+    for (int i = 0; i < density.shape()[0]; i++) {
+        for (int j = 0; j < density.shape()[1]; j++) {
+            density.atUnchecked(i,j) = 0;
+        }
+    }
+
+    bool ok = true;
+
+    do {
+
+        auto currentPoints = points.castedPointGeometry<double>();
+
+        double x = gridInfos.scale*(currentPoints.x-gridInfos.x0);
+        double y = gridInfos.scale*(currentPoints.y-gridInfos.y0);
+
+        int x0 = std::max<int>(0,std::floor(x));
+        int x1 = std::min(density.shape()[0]-1,x0+1);
+
+        int y0 = std::max<int>(0,std::floor(y));
+        int y1 = std::min(density.shape()[0]-1,y0+1);
+
+        double densityLimit =
+                (x1-x)*(y1-y)*density.atUnchecked(x0,y0) +
+                (x-x0)*(y1-y)*density.atUnchecked(x1,y0) +
+                (x1-x)*(y-y0)*density.atUnchecked(x0,y1) +
+                (x-x0)*(y-y0)*density.atUnchecked(x1,y1);
+
+        densityLimit *= gridInfos.scale*gridInfos.scale;
+
+        out << densityLimit << "\n";
+
+        #pragma omp parallel for
+        for (int i = 0; i < density.shape()[0]; i++) {
+            for (int j = 0; j < density.shape()[1]; j++) {
+                float dx = i-x;
+                float dy = j-y;
+                float dsqr = dx*dx + dy*dy;
+                density.atUnchecked(i,j) += densityKernel(dsqr);
+            }
+        }
+
+        ok = points.gotoNext();
+
+    } while (ok);
+
+    out.flush();
+
+}
+
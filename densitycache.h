@@ -0,0 +1,53 @@
+#ifndef DENSITYCACHE_H
+#define DENSITYCACHE_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <optional>
+#include <ostream>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+constexpr int gridScale = 10;
+
+struct GridInfos {
+    double scale;
+    double x0;
+    double y0;
+    int width;
+    int height;
+};
+
+/*!
+ * \brief computeGridInfos compute the density grid extent and resolution from a point cloud.
+ * \param points the points, read until the end.
+ * \return the grid infos, or std::nullopt in case of error.
+ */
+std::optional<GridInfos> computeGridInfos(StereoVision::IO::PointCloudPointAccessInterface & points);
+
+/*!
+ * \brief estimateDensity estimate the density at each point of a point cloud.
+ * \param points the points, read until the end.
+ * \param gridInfos the grid to accumulate the density on.
+ * \param out the stream to write the density limit of each point to.
+ */
+void estimateDensity(StereoVision::IO::PointCloudPointAccessInterface & points,
+                     GridInfos const& gridInfos,
+                     std::ostream & out);
+
+#endif // DENSITYCACHE_H
@@ -0,0 +1,285 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arrowwriter.h"
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+
+#include <algorithm>
+#include <type_traits>
+
+namespace {
+
+using GenericAttribute = StereoVision::IO::PointCloudGenericAttribute;
+
+template<typename T>
+struct ArrowTypeOf {
+    using type = void;
+};
+
+template<> struct ArrowTypeOf<bool> { using type = arrow::BooleanType; };
+template<> struct ArrowTypeOf<int8_t> { using type = arrow::Int8Type; };
+template<> struct ArrowTypeOf<uint8_t> { using type = arrow::UInt8Type; };
+template<> struct ArrowTypeOf<int16_t> { using type = arrow::Int16Type; };
+template<> struct ArrowTypeOf<uint16_t> { using type = arrow::UInt16Type; };
+template<> struct ArrowTypeOf<int32_t> { using type = arrow::Int32Type; };
+template<> struct ArrowTypeOf<uint32_t> { using type = arrow::UInt32Type; };
+template<> struct ArrowTypeOf<int64_t> { using type = arrow::Int64Type; };
+template<> struct ArrowTypeOf<uint64_t> { using type = arrow::UInt64Type; };
+template<> struct ArrowTypeOf<float> { using type = arrow::FloatType; };
+template<> struct ArrowTypeOf<double> { using type = arrow::DoubleType; };
+template<> struct ArrowTypeOf<std::string> { using type = arrow::StringType; };
+
+class ColumnBuilder {
+public:
+    virtual ~ColumnBuilder() {}
+
+    virtual arrow::Status append(std::optional<GenericAttribute> const& value) = 0;
+    virtual arrow::Result<std::shared_ptr<arrow::Array>> finish() = 0;
+};
+
+template<typename T>
+class TypedColumnBuilder : public ColumnBuilder {
+public:
+
+    using BuilderT = typename arrow::TypeTraits<typename ArrowTypeOf<T>::type>::BuilderType;
+
+    arrow::Status append(std::optional<GenericAttribute> const& value) override {
+
+        if (!value.has_value()) {
+            return _builder.AppendNull();
+        }
+
+        return _builder.Append(StereoVision::IO::castedPointCloudAttribute<T>(value.value()));
+    }
+
+    arrow::Result<std::shared_ptr<arrow::Array>> finish() override {
+        return _builder.Finish();
+    }
+
+protected:
+    BuilderT _builder;
+};
+
+struct Column {
+    std::shared_ptr<arrow::Field> field;
+    std::unique_ptr<ColumnBuilder> builder;
+};
+
+std::optional<Column> columnFromValue(std::string const& name, GenericAttribute const& value) {
+
+    return std::visit([&name] (auto const& val) -> std::optional<Column> {
+
+        using T = std::decay_t<decltype(val)>;
+        using ArrowT = typename ArrowTypeOf<T>::type;
+
+        if constexpr (std::is_void_v<ArrowT>) {
+            return std::nullopt;
+        } else {
+            Column ret;
+            ret.field = arrow::field(name, arrow::TypeTraits<ArrowT>::type_singleton());
+            ret.builder = std::make_unique<TypedColumnBuilder<T>>();
+            return ret;
+        }
+
+    }, value);
+}
+
+}
+
+namespace ArrowIpc {
+
+bool writePointCloudArrow(std::filesystem::path const& outFile,
+                          StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack,
+                          int batchSize) {
+
+    if (pointCloudStack.pointAccess == nullptr) {
+        return false;
+    }
+
+    StereoVision::IO::PointCloudPointAccessInterface & points = *pointCloudStack.pointAccess;
+
+    //columns, deduced from the first point.
+    std::vector<Column> columns;
+    std::vector<std::string> attributes;
+    bool withColor = false;
+
+    auto addColumn = [&columns] (std::string const& name, std::optional<GenericAttribute> const& value) {
+
+        std::optional<Column> column = (value.has_value()) ? columnFromValue(name, value.value()) : std::nullopt;
+
+        if (!column.has_value()) {
+            column = columnFromValue(name, GenericAttribute(double(0)));
+        }
+
+        columns.push_back(std::move(column.value()));
+    };
+
+    if (points.hasData()) {
+
+        StereoVision::IO::PtGeometry<GenericAttribute> pos = points.getPointPosition();
+
+        addColumn("x", pos.x);
+        addColumn("y", pos.y);
+        addColumn("z", pos.z);
+
+        auto color = points.getPointColor();
+
+        if (color.has_value()) {
+            withColor = true;
+            addColumn("red", color->r);
+            addColumn("green", color->g);
+            addColumn("blue", color->b);
+            addColumn("alpha", color->a);
+        }
+
+        for (std::string const& attribute : points.attributeList()) {
+
+            std::optional<GenericAttribute> value = points.getAttributeByName(attribute.c_str());
+
+            if (!value.has_value()) {
+                continue;
+            }
+
+            std::optional<Column> column = columnFromValue(attribute, value.value());
+
+            if (column.has_value()) {
+                columns.push_back(std::move(column.value()));
+                attributes.push_back(attribute);
+            }
+        }
+
+    } else {
+        addColumn("x", std::nullopt);
+        addColumn("y", std::nullopt);
+        addColumn("z", std::nullopt);
+    }
+
+    arrow::FieldVector fields;
+
+    for (Column const& column : columns) {
+        fields.push_back(column.field);
+    }
+
+    std::vector<std::string> metadataKeys;
+    std::vector<std::string> metadataValues;
+
+    if (pointCloudStack.headerAccess != nullptr) {
+        for (std::string const& name : pointCloudStack.headerAccess->attributeList()) {
+
+            std::optional<GenericAttribute> value = pointCloudStack.headerAccess->getAttributeByName(name.c_str());
+
+            if (!value.has_value()) {
+                continue;
+            }
+
+            std::string strValue = StereoVision::IO::castedPointCloudAttribute<std::string>(value.value());
+
+            if (!strValue.empty()) {
+                metadataKeys.push_back(name);
+                metadataValues.push_back(strValue);
+            }
+        }
+    }
+
+    std::shared_ptr<arrow::Schema> schema = arrow::schema(fields, arrow::key_value_metadata(metadataKeys, metadataValues));
+
+    arrow::Result<std::shared_ptr<arrow::io::FileOutputStream>> outStream = arrow::io::FileOutputStream::Open(outFile.string());
+
+    if (!outStream.ok()) {
+        return false;
+    }
+
+    arrow::Result<std::shared_ptr<arrow::ipc::RecordBatchWriter>> writer = arrow::ipc::MakeFileWriter(outStream.ValueUnsafe(), schema);
+
+    if (!writer.ok()) {
+        return false;
+    }
+
+    batchSize = std::max(1, batchSize);
+
+    int nColorColumns = (withColor) ? 4 : 0;
+    int64_t nRows = 0;
+
+    auto flushBatch = [&] () -> bool {
+
+        arrow::ArrayVector arrays;
+
+        for (Column & column : columns) {
+
+            arrow::Result<std::shared_ptr<arrow::Array>> array = column.builder->finish();
+
+            if (!array.ok()) {
+                return false;
+            }
+
+            arrays.push_back(array.ValueUnsafe());
+        }
+
+        std::shared_ptr<arrow::RecordBatch> batch = arrow::RecordBatch::Make(schema, nRows, arrays);
+        nRows = 0;
+
+        return writer.ValueUnsafe()->WriteRecordBatch(*batch).ok();
+    };
+
+    bool hasMore = points.hasData();
+
+    while (hasMore) {
+
+        StereoVision::IO::PtGeometry<GenericAttribute> pos = points.getPointPosition();
+
+        bool ok = columns[0].builder->append(pos.x).ok() and
+                columns[1].builder->append(pos.y).ok() and
+                columns[2].builder->append(pos.z).ok();
+
+        if (withColor) {
+            auto color = points.getPointColor();
+
+            ok = ok and columns[3].builder->append((color.has_value()) ? std::optional<GenericAttribute>(color->r) : std::nullopt).ok();
+            ok = ok and columns[4].builder->append((color.has_value()) ? std::optional<GenericAttribute>(color->g) : std::nullopt).ok();
+            ok = ok and columns[5].builder->append((color.has_value()) ? std::optional<GenericAttribute>(color->b) : std::nullopt).ok();
+            ok = ok and columns[6].builder->append((color.has_value()) ? std::optional<GenericAttribute>(color->a) : std::nullopt).ok();
+        }
+
+        for (int i = 0; ok and i < attributes.size(); i++) {
+            ok = columns[3 + nColorColumns + i].builder->append(points.getAttributeByName(attributes[i].c_str())).ok();
+        }
+
+        if (!ok) {
+            return false;
+        }
+
+        nRows++;
+        hasMore = points.gotoNext();
+
+        if (nRows >= batchSize or (!hasMore and nRows > 0)) {
+            if (!flushBatch()) {
+                return false;
+            }
+        }
+    }
+
+    if (!writer.ValueUnsafe()->Close().ok()) {
+        return false;
+    }
+
+    return outStream.ValueUnsafe()->Close().ok();
+}
+
+}
@@ -0,0 +1,48 @@
+#ifndef ARROWWRITER_H
+#define ARROWWRITER_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <filesystem>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+/*!
+ * Apache Arrow IPC output, only available when the tool is built with Arrow (LDM_WITH_ARROW is defined).
+ */
+namespace ArrowIpc {
+
+/*!
+ * \brief writePointCloudArrow write a point cloud as an Arrow IPC file.
+ *
+ * The file contains one typed column per coordinate, per color channel and per attribute, the types of the
+ * columns are deduced from the first point. Missing values are written as nulls, and the header attributes
+ * which can be represented as strings (e.g. the crs) are stored in the schema metadata.
+ *
+ * \param outFile the file to write to.
+ * \param pointCloudStack the point cloud to write.
+ * \param batchSize the number of points per record batch.
+ * \return true on success, false otherwise.
+ */
+bool writePointCloudArrow(std::filesystem::path const& outFile,
+                          StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack,
+                          int batchSize = 1 << 16);
+
+}
+
+#endif // ARROWWRITER_H
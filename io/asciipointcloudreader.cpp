@@ -0,0 +1,785 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "asciipointcloudreader.h"
+
+#include "../processingBlocks/aliasheaderattributes.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+using ColumnType = AsciiPointCloudReader::ColumnType;
+
+struct AsciiHeader {
+    std::vector<std::string> columns;
+    std::vector<ColumnType> types;
+    size_t dataStart;
+    char separator; //!< the column separator, ' ' meaning any run of spaces or tabs.
+};
+
+inline bool isBlank(char c) {
+    return c == ' ' or c == '\t' or c == '\r';
+}
+
+std::string toLower(std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), [] (unsigned char c) {return std::tolower(c);});
+    return str;
+}
+
+/*!
+ * \brief nextLine get the line starting at a given offset, without the end of line.
+ * \param pos the offset of the line, updated to the start of the next line.
+ */
+std::string_view nextLine(char const* data, size_t size, size_t & pos) {
+
+    char const* begin = data + pos;
+    char const* end = static_cast<char const*>(std::memchr(begin, '\n', size - pos));
+
+    if (end == nullptr) {
+        end = data + size;
+        pos = size;
+    } else {
+        pos = end - data + 1;
+    }
+
+    std::string_view line(begin, end - begin);
+
+    while (!line.empty() and line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+
+    return line;
+}
+
+std::vector<std::string> splitLine(std::string_view line, char separator) {
+
+    std::vector<std::string> ret;
+
+    if (separator == ' ') {
+        size_t pos = 0;
+
+        while (pos < line.size()) {
+            while (pos < line.size() and isBlank(line[pos])) {
+                pos++;
+            }
+
+            size_t start = pos;
+
+            while (pos < line.size() and !isBlank(line[pos])) {
+                pos++;
+            }
+
+            if (pos > start) {
+                ret.emplace_back(line.substr(start, pos - start));
+            }
+        }
+
+        return ret;
+    }
+
+    size_t start = 0;
+
+    while (true) {
+        size_t end = line.find(separator, start);
+        std::string_view token = line.substr(start, (end == std::string_view::npos) ? std::string_view::npos : end - start);
+
+        //trim blanks and quotes
+        while (!token.empty() and (isBlank(token.front()) or token.front() == '"')) {
+            token.remove_prefix(1);
+        }
+        while (!token.empty() and (isBlank(token.back()) or token.back() == '"')) {
+            token.remove_suffix(1);
+        }
+
+        ret.emplace_back(token);
+
+        if (end == std::string_view::npos) {
+            break;
+        }
+
+        start = end + 1;
+    }
+
+    return ret;
+}
+
+bool isNumber(std::string const& token) {
+
+    char const* begin = token.data();
+    char const* end = begin + token.size();
+
+    if (begin < end and *begin == '+') {
+        begin++;
+    }
+
+    double val;
+    std::from_chars_result result = std::from_chars(begin, end, val);
+
+    return result.ec == std::errc() and result.ptr == end;
+}
+
+/*!
+ * \brief csvSeparator get the separator of a csv line, ',' unless the line only contains ';'.
+ */
+char csvSeparator(std::string_view line) {
+    return (line.find(',') == std::string_view::npos and line.find(';') != std::string_view::npos) ? ';' : ',';
+}
+
+/*!
+ * \brief numbersSeparator get the separator splitting a line in at least three numbers.
+ * \return ' ' (blanks), ',' or ';', or std::nullopt if the line is not a line of numbers.
+ */
+std::optional<char> numbersSeparator(std::string_view line) {
+
+    for (char separator : {' ', ',', ';'}) {
+
+        std::vector<std::string> tokens = splitLine(line, separator);
+
+        if (tokens.size() >= 3 and std::all_of(tokens.begin(), tokens.end(), isNumber)) {
+            return separator;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::vector<std::string> genericColumnNames(int nColumns) {
+
+    std::vector<std::string> ret = {"x", "y", "z"};
+
+    for (int i = 3; i < nColumns; i++) {
+        ret.push_back("field" + std::to_string(i));
+    }
+
+    return ret;
+}
+
+std::optional<AsciiHeader> parsePcdHeader(char const* data, size_t size) {
+
+    AsciiHeader ret;
+    ret.separator = ' ';
+
+    std::vector<std::string> sizes;
+    std::vector<std::string> types;
+
+    bool dataFound = false;
+    size_t pos = 0;
+
+    while (pos < size) {
+
+        std::vector<std::string> tokens = splitLine(nextLine(data, size, pos), ' ');
+
+        if (tokens.empty() or tokens[0].front() == '#') {
+            continue;
+        }
+
+        std::string key = tokens[0];
+        tokens.erase(tokens.begin());
+
+        if (key == "FIELDS") {
+            ret.columns = tokens;
+        } else if (key == "SIZE") {
+            sizes = tokens;
+        } else if (key == "TYPE") {
+            types = tokens;
+        } else if (key == "COUNT") {
+            //multi valued fields are not supported.
+            for (std::string const& count : tokens) {
+                if (count != "1") {
+                    return std::nullopt;
+                }
+            }
+        } else if (key == "DATA") {
+
+            if (tokens.empty() or tokens[0] != "ascii") {
+                return std::nullopt;
+            }
+
+            ret.dataStart = pos;
+            dataFound = true;
+            break;
+        }
+    }
+
+    if (!dataFound or ret.columns.empty() or sizes.size() != ret.columns.size() or types.size() != ret.columns.size()) {
+        return std::nullopt;
+    }
+
+    for (int i = 0; i < ret.columns.size(); i++) {
+        ret.types.push_back(ColumnType{types[i].front(), std::atoi(sizes[i].c_str())});
+    }
+
+    return ret;
+}
+
+std::optional<AsciiHeader> parseTextHeader(char const* data, size_t size, AsciiPointCloud::Format format) {
+
+    AsciiHeader ret;
+
+    size_t pos = 0;
+    size_t lineStart = 0;
+    std::string_view firstLine;
+
+    //skip the empty lines and the comments before the first line.
+    while (pos < size) {
+        lineStart = pos;
+        firstLine = nextLine(data, size, pos);
+
+        size_t firstChar = firstLine.find_first_not_of(" \t");
+
+        if (firstChar != std::string_view::npos and firstLine[firstChar] != '#') {
+            break;
+        }
+
+        firstLine = std::string_view();
+    }
+
+    if (firstLine.empty()) {
+        return std::nullopt;
+    }
+
+    if (format == AsciiPointCloud::Format::Csv) {
+        ret.separator = csvSeparator(firstLine);
+    } else {
+        ret.separator = ' ';
+    }
+
+    std::vector<std::string> tokens = splitLine(firstLine, ret.separator);
+
+    bool hasHeader = format == AsciiPointCloud::Format::Csv and
+            std::any_of(tokens.begin(), tokens.end(), [] (std::string const& token) {
+                return !token.empty() and !isNumber(token);
+            });
+
+    if (hasHeader) {
+        ret.columns = tokens;
+        ret.dataStart = pos;
+    } else {
+        ret.columns = genericColumnNames(tokens.size());
+        ret.dataStart = lineStart;
+    }
+
+    if (ret.columns.size() < 3) {
+        return std::nullopt;
+    }
+
+    ret.types = std::vector<ColumnType>(ret.columns.size(), ColumnType{'F', 8});
+
+    return ret;
+}
+
+int findColumn(std::vector<std::string> const& columns, std::initializer_list<const char*> names) {
+
+    for (int i = 0; i < columns.size(); i++) {
+
+        std::string name = toLower(columns[i]);
+
+        for (const char* candidate : names) {
+            if (name == candidate) {
+                return i;
+            }
+        }
+    }
+
+    return -1;
+}
+
+template<typename T>
+inline StereoVision::IO::PointCloudGenericAttribute castedValue(double val) {
+    if constexpr (std::is_integral_v<T>) {
+        if (!std::isfinite(val)) {
+            return T(0);
+        }
+    }
+    return static_cast<T>(val);
+}
+
+}
+
+std::unique_ptr<AsciiPointCloudReader> AsciiPointCloudReader::setupAsciiPointCloudReader(std::filesystem::path const& path,
+                                                                                         AsciiPointCloud::Format format,
+                                                                                         size_t blockSize) {
+
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat fileStats;
+
+    if (fstat(fd, &fileStats) != 0 or fileStats.st_size <= 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    size_t size = fileStats.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    //the mapping stays valid after the file descriptor is closed.
+    close(fd);
+
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+
+    madvise(mapped, size, MADV_SEQUENTIAL);
+
+    char const* data = static_cast<char const*>(mapped);
+
+    std::optional<AsciiHeader> header = (format == AsciiPointCloud::Format::PcdAscii) ?
+                parsePcdHeader(data, size) :
+                parseTextHeader(data, size, format);
+
+    if (!header.has_value() or findColumn(header->columns, {"x"}) < 0
+            or findColumn(header->columns, {"y"}) < 0 or findColumn(header->columns, {"z"}) < 0) {
+        munmap(mapped, size);
+        return nullptr;
+    }
+
+    std::unique_ptr<AsciiPointCloudReader> ret(new AsciiPointCloudReader(data,
+                                                                         size,
+                                                                         header->dataStart,
+                                                                         header->separator,
+                                                                         header->columns,
+                                                                         header->types,
+                                                                         blockSize));
+
+    return ret;
+}
+
+AsciiPointCloudReader::AsciiPointCloudReader(char const* data,
+                                             size_t mappedSize,
+                                             size_t dataStart,
+                                             char separator,
+                                             std::vector<std::string> const& columns,
+                                             std::vector<ColumnType> const& columnTypes,
+                                             size_t blockSize) :
+    _data(data),
+    _mappedSize(mappedSize),
+    _cursor(dataStart),
+    _blockSize(std::max<size_t>(blockSize, 1)),
+    _separator(separator),
+    _columns(columns),
+    _columnTypes(columnTypes),
+    _currentPoint(0),
+    _hasData(false)
+{
+
+    _positionColumns = {findColumn(_columns, {"x"}), findColumn(_columns, {"y"}), findColumn(_columns, {"z"})};
+
+    _colorColumns = {findColumn(_columns, {"r", "red"}),
+                     findColumn(_columns, {"g", "green"}),
+                     findColumn(_columns, {"b", "blue"}),
+                     findColumn(_columns, {"a", "alpha"})};
+
+    if (_colorColumns[0] < 0 or _colorColumns[1] < 0 or _colorColumns[2] < 0) {
+        _colorColumns = {-1, -1, -1, -1};
+    }
+
+    for (int i = 0; i < _columns.size(); i++) {
+
+        if (std::find(_positionColumns.begin(), _positionColumns.end(), i) != _positionColumns.end() or
+                std::find(_colorColumns.begin(), _colorColumns.end(), i) != _colorColumns.end()) {
+            continue;
+        }
+
+        _attributeIdxs[_columns[i]] = _attributeColumns.size();
+        _attributeColumns.push_back(i);
+        _attributeNames.push_back(_columns[i]);
+    }
+
+    _nextBatch = launchNextBatch();
+    _hasData = loadNextBlock();
+}
+
+AsciiPointCloudReader::~AsciiPointCloudReader() {
+
+    //the batch being parsed still access the mapped file.
+    if (_nextBatch.valid()) {
+        _nextBatch.wait();
+    }
+
+    munmap(const_cast<char*>(_data), _mappedSize);
+}
+
+AsciiPointCloudReader::Block AsciiPointCloudReader::parseBlock(char const* begin, char const* end, int nColumns, char separator) {
+
+    constexpr double missing = std::numeric_limits<double>::quiet_NaN();
+
+    Block ret;
+    ret.nPoints = 0;
+    //rough guess of the number of values, assuming short numbers.
+    ret.values.reserve((end - begin)/8);
+
+    char const* line = begin;
+
+    while (line < end) {
+
+        //memchr is vectorized by the standard library, so the lines are found with simd instructions.
+        char const* lineEnd = static_cast<char const*>(std::memchr(line, '\n', end - line));
+
+        if (lineEnd == nullptr) {
+            lineEnd = end;
+        }
+
+        char const* p = line;
+        line = lineEnd + 1;
+
+        while (p < lineEnd and isBlank(*p)) {
+            p++;
+        }
+
+        if (p == lineEnd or *p == '#') {
+            continue;
+        }
+
+        size_t base = ret.values.size();
+        ret.values.resize(base + nColumns, missing);
+
+        for (int c = 0; c < nColumns and p < lineEnd; c++) {
+
+            if (separator == ' ') {
+                while (p < lineEnd and isBlank(*p)) {
+                    p++;
+                }
+            } else {
+                while (p < lineEnd and (*p == ' ' or *p == '"')) {
+                    p++;
+                }
+            }
+
+            if (p < lineEnd and *p == '+') {
+                p++;
+            }
+
+            double val;
+            std::from_chars_result result = std::from_chars(p, lineEnd, val);
+
+            if (result.ec == std::errc()) {
+                ret.values[base + c] = val;
+                p = result.ptr;
+            }
+
+            //move to the start of the next value.
+            if (separator == ' ') {
+                while (p < lineEnd and !isBlank(*p)) {
+                    p++;
+                }
+            } else {
+                char const* next = static_cast<char const*>(std::memchr(p, separator, lineEnd - p));
+                p = (next == nullptr) ? lineEnd : next + 1;
+            }
+        }
+
+        ret.nPoints++;
+    }
+
+    return ret;
+}
+
+std::future<AsciiPointCloudReader::Batch> AsciiPointCloudReader::launchNextBatch() {
+
+    int nBlocks = 1;
+
+    #ifdef _OPENMP
+    nBlocks = omp_get_max_threads();
+    #endif
+
+    std::vector<std::pair<size_t, size_t>> ranges;
+
+    while (ranges.size() < nBlocks and _cursor < _mappedSize) {
+
+        size_t end = std::min(_cursor + _blockSize, _mappedSize);
+
+        //extend the block to the end of its last line.
+        if (end < _mappedSize) {
+            char const* newLine = static_cast<char const*>(std::memchr(_data + end, '\n', _mappedSize - end));
+            end = (newLine == nullptr) ? _mappedSize : newLine - _data + 1;
+        }
+
+        ranges.emplace_back(_cursor, end);
+        _cursor = end;
+    }
+
+    if (ranges.empty()) {
+        return std::future<Batch>();
+    }
+
+    return std::async(std::launch::async, [data = _data, ranges, nColumns = int(_columns.size()), separator = _separator] () {
+
+        Batch batch(ranges.size());
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < ranges.size(); i++) {
+            batch[i] = parseBlock(data + ranges[i].first, data + ranges[i].second, nColumns, separator);
+        }
+
+        return batch;
+    });
+}
+
+bool AsciiPointCloudReader::loadNextBlock() {
+
+    while (_blocks.empty()) {
+
+        if (!_nextBatch.valid()) {
+            return false;
+        }
+
+        Batch batch = _nextBatch.get();
+        _nextBatch = launchNextBatch();
+
+        for (Block & block : batch) {
+            if (block.nPoints > 0) {
+                _blocks.push_back(std::move(block));
+            }
+        }
+    }
+
+    return true;
+}
+
+StereoVision::IO::PointCloudGenericAttribute AsciiPointCloudReader::columnValue(int column) const {
+
+    double val = _blocks.front().values[_currentPoint*_columns.size() + column];
+    ColumnType const& type = _columnTypes[column];
+
+    switch (type.type) {
+    case 'F':
+        return (type.size == 4) ? castedValue<float>(val) : castedValue<double>(val);
+    case 'I':
+        switch (type.size) {
+        case 1:
+            return castedValue<int8_t>(val);
+        case 2:
+            return castedValue<int16_t>(val);
+        case 4:
+            return castedValue<int32_t>(val);
+        default:
+            return castedValue<int64_t>(val);
+        }
+    case 'U':
+        switch (type.size) {
+        case 1:
+            return castedValue<uint8_t>(val);
+        case 2:
+            return castedValue<uint16_t>(val);
+        case 4:
+            return castedValue<uint32_t>(val);
+        default:
+            return castedValue<uint64_t>(val);
+        }
+    }
+
+    return val;
+}
+
+StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> AsciiPointCloudReader::getPointPosition() const {
+    return StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute>{columnValue(_positionColumns[0]),
+                                                                                     columnValue(_positionColumns[1]),
+                                                                                     columnValue(_positionColumns[2])};
+}
+
+std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> AsciiPointCloudReader::getPointColor() const {
+
+    if (_colorColumns[0] < 0) {
+        return std::nullopt;
+    }
+
+    StereoVision::IO::PointCloudGenericAttribute alpha = uint8_t(255);
+
+    if (_colorColumns[3] >= 0) {
+        alpha = columnValue(_colorColumns[3]);
+    } else if (_columnTypes[_colorColumns[0]].type == 'F') {
+        alpha = 1.f;
+    } else if (_columnTypes[_colorColumns[0]].size == 2) {
+        alpha = uint16_t(65535);
+    }
+
+    return StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>{columnValue(_colorColumns[0]),
+                                                                                  columnValue(_colorColumns[1]),
+                                                                                  columnValue(_colorColumns[2]),
+                                                                                  alpha};
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> AsciiPointCloudReader::getAttributeById(int id) const {
+
+    if (id < 0 or id >= _attributeColumns.size()) {
+        return std::nullopt;
+    }
+
+    int column = _attributeColumns[id];
+
+    //missing values (e.g. empty csv fields) have no integer representation.
+    if (_columnTypes[column].type != 'F' and std::isnan(_blocks.front().values[_currentPoint*_columns.size() + column])) {
+        return std::nullopt;
+    }
+
+    return columnValue(column);
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> AsciiPointCloudReader::getAttributeByName(const char* attributeName) const {
+
+    auto it = _attributeIdxs.find(attributeName);
+
+    if (it == _attributeIdxs.end()) {
+        return std::nullopt;
+    }
+
+    return getAttributeById(it->second);
+}
+
+std::vector<std::string> AsciiPointCloudReader::attributeList() const {
+    return _attributeNames;
+}
+
+bool AsciiPointCloudReader::gotoNext() {
+
+    if (!_hasData) {
+        return false;
+    }
+
+    _currentPoint++;
+
+    if (_currentPoint < _blocks.front().nPoints) {
+        return true;
+    }
+
+    _blocks.pop_front();
+    _currentPoint = 0;
+
+    _hasData = loadNextBlock();
+
+    return _hasData;
+}
+
+bool AsciiPointCloudReader::hasData() const {
+    return _hasData;
+}
+
+namespace AsciiPointCloud {
+
+std::optional<Format> formatFromPath(std::filesystem::path const& path) {
+
+    std::string extension = toLower(path.extension().string());
+
+    if (extension == ".xyz" or extension == ".txt") {
+        return Format::Xyz;
+    } else if (extension == ".csv") {
+        return Format::Csv;
+    }
+
+    std::ifstream file(path, std::ios_base::binary);
+
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+
+    //pcd files have their format in the header, other files (e.g. spooled standard input) are checked for a line of numbers,
+    //separated by blanks (xyz) or by commas or semicolons (csv), possibly after a line of column names (csv).
+    std::string line;
+    bool isPcd = false;
+    std::optional<char> headerSeparator;
+    size_t nHeaderColumns = 0;
+
+    while (std::getline(file, line)) {
+
+        std::vector<std::string> tokens = splitLine(line, ' ');
+
+        if (tokens.empty() or tokens[0].front() == '#') {
+            continue;
+        }
+
+        if (!headerSeparator.has_value() and (tokens[0] == "VERSION" or tokens[0] == "FIELDS")) {
+            isPcd = true;
+        }
+
+        if (isPcd) {
+            if (tokens[0] == "DATA") {
+                return (tokens.size() > 1 and tokens[1] == "ascii") ? std::optional<Format>(Format::PcdAscii) : std::nullopt;
+            }
+            continue;
+        }
+
+        std::optional<char> separator = numbersSeparator(line);
+
+        //the column names have to be followed by as many numbers.
+        if (headerSeparator.has_value()) {
+
+            if (separator != headerSeparator or splitLine(line, separator.value()).size() != nHeaderColumns) {
+                return std::nullopt;
+            }
+
+            return Format::Csv;
+        }
+
+        if (separator.has_value()) {
+            return (separator.value() == ' ') ? Format::Xyz : Format::Csv;
+        }
+
+        //the separator of the column names is selected as by the csv reader.
+        headerSeparator = csvSeparator(line);
+        nHeaderColumns = splitLine(line, headerSeparator.value()).size();
+
+        if (nHeaderColumns < 3) {
+            return std::nullopt;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<StereoVision::IO::FullPointCloudAccessInterface> openPointCloudAscii(std::filesystem::path const& path) {
+
+    std::optional<Format> format = formatFromPath(path);
+
+    if (!format.has_value()) {
+        return std::nullopt;
+    }
+
+    std::unique_ptr<AsciiPointCloudReader> reader = AsciiPointCloudReader::setupAsciiPointCloudReader(path, format.value());
+
+    if (reader == nullptr) {
+        return std::nullopt;
+    }
+
+    StereoVision::IO::FullPointCloudAccessInterface ret;
+    ret.headerAccess = std::make_unique<AliasHeaderAttributes>(nullptr, AliasHeaderAttributes::AliasMap());
+    ret.pointAccess = std::move(reader);
+
+    return ret;
+}
+
+}
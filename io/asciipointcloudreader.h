@@ -0,0 +1,152 @@
+#ifndef ASCIIPOINTCLOUDREADER_H
+#define ASCIIPOINTCLOUDREADER_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+#include "asciipointcloudwriter.h"
+
+/*!
+ * \brief The AsciiPointCloudReader class read ascii point clouds (ascii pcd, xyz and csv).
+ *
+ * The file is memory mapped and split in blocks at line boundaries. Batches of blocks are parsed
+ * in parallel with std::from_chars, the next batch being parsed in the background while the points
+ * of the current one are consumed by the processing chain, in file order.
+ *
+ * The columns named x, y and z give the position, the columns named r, g, b (and a) give the color,
+ * the other columns are exposed as attributes. Xyz files have no header, the first three columns are
+ * the position and the next ones are named "field3", "field4", etc.
+ */
+class AsciiPointCloudReader : public StereoVision::IO::PointCloudPointAccessInterface
+{
+public:
+
+    /*!
+     * \brief ColumnType give the type of the values of a column, as declared in the pcd header.
+     */
+    struct ColumnType {
+        char type; //!< 'F', 'I' or 'U'
+        int size; //!< size in bytes
+    };
+
+    /*!
+     * \brief setupAsciiPointCloudReader open an ascii point cloud.
+     * \param path the path to the file.
+     * \param format the format of the file.
+     * \param blockSize the approximate number of bytes parsed at once by a thread.
+     * \return the reader, or nullptr in case of error (e.g. the file cannot be mapped or the header is invalid).
+     */
+    static std::unique_ptr<AsciiPointCloudReader> setupAsciiPointCloudReader(std::filesystem::path const& path,
+                                                                             AsciiPointCloud::Format format,
+                                                                             size_t blockSize = 1 << 22);
+
+    ~AsciiPointCloudReader();
+
+    virtual StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> getPointPosition() const override;
+    virtual std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> getPointColor() const override;
+
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeById(int id) const override;
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeByName(const char* attributeName) const override;
+
+    virtual std::vector<std::string> attributeList() const override;
+
+    virtual bool gotoNext() override;
+    virtual bool hasData() const override;
+
+protected:
+
+    /*!
+     * \brief The Block struct hold the parsed values of a block of lines, column by column for each point.
+     */
+    struct Block {
+        std::vector<double> values;
+        int nPoints;
+    };
+
+    using Batch = std::vector<Block>;
+
+    AsciiPointCloudReader(char const* data,
+                          size_t mappedSize,
+                          size_t dataStart,
+                          char separator,
+                          std::vector<std::string> const& columns,
+                          std::vector<ColumnType> const& columnTypes,
+                          size_t blockSize);
+
+    /*!
+     * \brief parseBlock parse the lines between two offsets of the mapped file.
+     */
+    static Block parseBlock(char const* begin, char const* end, int nColumns, char separator);
+
+    std::future<Batch> launchNextBatch();
+    bool loadNextBlock();
+
+    StereoVision::IO::PointCloudGenericAttribute columnValue(int column) const;
+
+    char const* _data;
+    size_t _mappedSize;
+    size_t _cursor;
+    size_t _blockSize;
+    char _separator;
+
+    std::vector<std::string> _columns;
+    std::vector<ColumnType> _columnTypes;
+
+    std::array<int, 3> _positionColumns;
+    std::array<int, 4> _colorColumns;
+    std::vector<int> _attributeColumns;
+    std::vector<std::string> _attributeNames;
+    std::map<std::string, int> _attributeIdxs;
+
+    std::future<Batch> _nextBatch;
+    std::deque<Block> _blocks;
+    int _currentPoint;
+    bool _hasData;
+};
+
+namespace AsciiPointCloud {
+
+/*!
+ * \brief formatFromPath detect the ascii format of a file, from its extension and its header.
+ *
+ * Files without a known extension (e.g. the spooled standard input) are detected from their content: a pcd header,
+ * or lines of at least three numbers separated by blanks (xyz) or by commas or semicolons (csv), possibly after a line of column names (csv).
+ * \return the format, or nothing if the file is not an ascii point cloud.
+ */
+std::optional<Format> formatFromPath(std::filesystem::path const& path);
+
+/*!
+ * \brief openPointCloudAscii open an ascii point cloud.
+ * \param path the path to the file.
+ * \return the point cloud access interfaces, or nothing in case of error.
+ */
+std::optional<StereoVision::IO::FullPointCloudAccessInterface> openPointCloudAscii(std::filesystem::path const& path);
+
+}
+
+#endif // ASCIIPOINTCLOUDREADER_H
@@ -0,0 +1,461 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "asciipointcloudwriter.h"
+
+#include "partitionspool.h"
+
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <future>
+#include <type_traits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace AsciiPointCloud {
+
+namespace {
+
+using GenericAttribute = StereoVision::IO::PointCloudGenericAttribute;
+
+constexpr size_t copyBufferSize = 1 << 20;
+
+/*!
+ * \brief The Chunk struct hold the values of consecutive points, column by column for each point.
+ */
+struct Chunk {
+    std::vector<std::optional<GenericAttribute>> values;
+    int nPoints;
+};
+
+std::optional<Column> numericColumn(std::string const& name, GenericAttribute const& value) {
+
+    return std::visit([&name] (auto const& val) -> std::optional<Column> {
+
+        using T = std::decay_t<decltype(val)>;
+
+        if constexpr (std::is_same_v<T, bool>) {
+            return Column{name, 'U', 1};
+        } else if constexpr (std::is_floating_point_v<T>) {
+            return Column{name, 'F', sizeof(T)};
+        } else if constexpr (std::is_integral_v<T>) {
+            return Column{name, (std::is_signed_v<T>) ? 'I' : 'U', sizeof(T)};
+        }
+
+        return std::nullopt;
+
+    }, value);
+}
+
+/*!
+ * \brief readChunk read the next points of a point cloud in a chunk.
+ * \return true if the point cloud has more points after the chunk, false otherwise.
+ */
+bool readChunk(StereoVision::IO::PointCloudPointAccessInterface & points,
+               std::vector<std::string> const& attributes,
+               bool withColor,
+               int chunkSize,
+               Chunk & chunk) {
+
+    int nColumns = 3 + ((withColor) ? 3 : 0) + attributes.size();
+
+    chunk.values.clear();
+    chunk.values.reserve(chunkSize*nColumns);
+    chunk.nPoints = 0;
+
+    bool hasMore = true;
+
+    while (chunk.nPoints < chunkSize and hasMore) {
+
+        StereoVision::IO::PtGeometry<GenericAttribute> pos = points.getPointPosition();
+
+        chunk.values.push_back(pos.x);
+        chunk.values.push_back(pos.y);
+        chunk.values.push_back(pos.z);
+
+        if (withColor) {
+            auto color = points.getPointColor();
+
+            if (color.has_value()) {
+                chunk.values.push_back(color->r);
+                chunk.values.push_back(color->g);
+                chunk.values.push_back(color->b);
+            } else {
+                chunk.values.insert(chunk.values.end(), 3, std::nullopt);
+            }
+        }
+
+        for (std::string const& attribute : attributes) {
+            chunk.values.push_back(points.getAttributeByName(attribute.c_str()));
+        }
+
+        chunk.nPoints++;
+        hasMore = points.gotoNext();
+    }
+
+    return hasMore;
+}
+
+std::string formatChunk(Chunk const& chunk,
+                        std::vector<std::string> const& missingValues,
+                        char separator) {
+
+    int nColumns = missingValues.size();
+
+    std::string ret;
+    ret.reserve(chunk.values.size()*12);
+
+    for (int p = 0; p < chunk.nPoints; p++) {
+        for (int c = 0; c < nColumns; c++) {
+
+            if (c > 0) {
+                ret.push_back(separator);
+            }
+
+            std::optional<GenericAttribute> const& value = chunk.values[p*nColumns + c];
+
+            if (!value.has_value() or !appendValue(ret, value.value())) {
+                ret.append(missingValues[c]);
+            }
+        }
+
+        ret.push_back('\n');
+    }
+
+    return ret;
+}
+
+std::string pcdHeader(std::vector<Column> const& columns, int64_t nPoints) {
+
+    std::string ret = "# .PCD v0.7 - Point Cloud Data file format\nVERSION 0.7\nFIELDS";
+
+    for (Column const& column : columns) {
+        ret += " " + column.name;
+    }
+
+    ret += "\nSIZE";
+
+    for (Column const& column : columns) {
+        ret += " " + std::to_string(column.pcdSize);
+    }
+
+    ret += "\nTYPE";
+
+    for (Column const& column : columns) {
+        ret += std::string(" ") + column.pcdType;
+    }
+
+    ret += "\nCOUNT";
+
+    for (int i = 0; i < columns.size(); i++) {
+        ret += " 1";
+    }
+
+    ret += "\nWIDTH " + std::to_string(nPoints);
+    ret += "\nHEIGHT 1\nVIEWPOINT 0 0 0 1 0 0 0\nPOINTS " + std::to_string(nPoints);
+    ret += "\nDATA ascii\n";
+
+    return ret;
+}
+
+/*!
+ * \brief The BodySpool struct hold the temporary file the points of a pcd are formatted to, before its header can be written.
+ */
+struct BodySpool {
+
+    BodySpool() :
+        dir(PartitionSpool::temporarySpoolDir("pcd"))
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+
+        if (ec) {
+            std::cerr << "Could not create spool directory " << dir << "!" << std::endl;
+            return;
+        }
+
+        file.open(dir / "body.txt", std::ios_base::in | std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    }
+
+    ~BodySpool() {
+        file.close();
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+
+    bool copyTo(std::ostream & out) {
+
+        file.flush();
+        file.seekg(0);
+
+        std::vector<char> buffer(copyBufferSize);
+
+        while (file) {
+            file.read(buffer.data(), buffer.size());
+            out.write(buffer.data(), file.gcount());
+        }
+
+        return file.eof() and bool(out);
+    }
+
+    std::filesystem::path dir;
+    std::fstream file;
+};
+
+}
+
+std::optional<Format> formatFromName(std::string const& name) {
+
+    if (name == "pcd-ascii") {
+        return Format::PcdAscii;
+    } else if (name == "xyz") {
+        return Format::Xyz;
+    } else if (name == "csv") {
+        return Format::Csv;
+    }
+
+    return std::nullopt;
+}
+
+std::vector<Column> columnsFromAttributes(StereoVision::IO::PointCloudPointAccessInterface const& points, Format format) {
+
+    std::vector<Column> ret;
+
+    bool hasPoint = points.hasData();
+
+    if (hasPoint) {
+        StereoVision::IO::PtGeometry<GenericAttribute> pos = points.getPointPosition();
+
+        ret.push_back(numericColumn("x", pos.x).value_or(Column{"x", 'F', 8}));
+        ret.push_back(numericColumn("y", pos.y).value_or(Column{"y", 'F', 8}));
+        ret.push_back(numericColumn("z", pos.z).value_or(Column{"z", 'F', 8}));
+    } else {
+        ret = {Column{"x", 'F', 8}, Column{"y", 'F', 8}, Column{"z", 'F', 8}};
+    }
+
+    if (format == Format::Xyz) {
+        return ret;
+    }
+
+    auto color = (hasPoint) ? points.getPointColor() : std::nullopt;
+
+    if (color.has_value()) {
+        ret.push_back(numericColumn("r", color->r).value_or(Column{"r", 'U', 1}));
+        ret.push_back(numericColumn("g", color->g).value_or(Column{"g", 'U', 1}));
+        ret.push_back(numericColumn("b", color->b).value_or(Column{"b", 'U', 1}));
+    }
+
+    for (std::string const& attribute : points.attributeList()) {
+
+        std::optional<GenericAttribute> value = (hasPoint) ? points.getAttributeByName(attribute.c_str()) : std::nullopt;
+
+        //the attributes the current point does not have are still written, as doubles.
+        if (!value.has_value()) {
+            ret.push_back(Column{attribute, 'F', 8});
+            continue;
+        }
+
+        std::optional<Column> column = numericColumn(attribute, value.value());
+
+        if (column.has_value()) {
+            ret.push_back(column.value());
+        }
+    }
+
+    return ret;
+}
+
+bool appendValue(std::string & out, StereoVision::IO::PointCloudGenericAttribute const& value) {
+
+    return std::visit([&out] (auto const& val) -> bool {
+
+        using T = std::decay_t<decltype(val)>;
+
+        if constexpr (std::is_same_v<T, bool>) {
+            out.push_back((val) ? '1' : '0');
+            return true;
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            //enough for the shortest round trip representation of any double.
+            char buffer[32];
+            std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), val);
+
+            if (result.ec != std::errc()) {
+                return false;
+            }
+
+            out.append(buffer, result.ptr);
+            return true;
+        }
+
+        return false;
+
+    }, value);
+}
+
+bool writePointCloudAscii(std::filesystem::path const& outFile,
+                          StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack,
+                          Format format,
+                          int chunkSize) {
+
+    if (pointCloudStack.pointAccess == nullptr) {
+        return false;
+    }
+
+    std::ofstream out(outFile, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+
+    if (!out.is_open()) {
+        return false;
+    }
+
+    if (!writePointCloudAscii(out, pointCloudStack, format, chunkSize)) {
+        return false;
+    }
+
+    out.close();
+
+    return !out.fail();
+}
+
+bool writePointCloudAscii(std::ostream & out,
+                          StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack,
+                          Format format,
+                          int chunkSize) {
+
+    if (pointCloudStack.pointAccess == nullptr) {
+        return false;
+    }
+
+    StereoVision::IO::PointCloudPointAccessInterface & points = *pointCloudStack.pointAccess;
+
+    std::vector<Column> columns = columnsFromAttributes(points, format);
+
+    bool withColor = columns.size() > 3 and columns[3].name == "r";
+
+    std::vector<std::string> attributes;
+
+    for (int i = (withColor) ? 6 : 3; i < columns.size(); i++) {
+        attributes.push_back(columns[i].name);
+    }
+
+    char separator = (format == Format::Csv) ? ',' : ' ';
+
+    std::vector<std::string> missingValues(columns.size());
+
+    if (format == Format::PcdAscii) {
+        for (int i = 0; i < columns.size(); i++) {
+            missingValues[i] = (columns[i].pcdType == 'F') ? "nan" : "0";
+        }
+    }
+
+    //the number of points of a pcd is only known at the end, so the points are formatted to a temporary file, copied after the header.
+    std::optional<BodySpool> bodySpool;
+
+    if (format == Format::PcdAscii) {
+
+        bodySpool.emplace();
+
+        if (!bodySpool->file.is_open()) {
+            return false;
+        }
+
+    } else if (format == Format::Csv) {
+        std::string header;
+
+        for (int i = 0; i < columns.size(); i++) {
+            if (i > 0) {
+                header.push_back(',');
+            }
+            header += columns[i].name;
+        }
+
+        header.push_back('\n');
+        out.write(header.data(), header.size());
+    }
+
+    std::ostream & body = (bodySpool.has_value()) ? static_cast<std::ostream &>(bodySpool->file) : out;
+
+    int nChunksPerBatch = 1;
+
+    #ifdef _OPENMP
+    nChunksPerBatch = omp_get_max_threads();
+    #endif
+
+    chunkSize = std::max(1, chunkSize);
+
+    int64_t nPoints = 0;
+
+    //formatting and writing a batch of chunks runs in the background while the next batch is read from the processing chain.
+    std::future<bool> pendingBatch;
+
+    bool hasMore = points.hasData();
+
+    while (hasMore) {
+
+        std::vector<Chunk> batch(nChunksPerBatch);
+        int nChunks = 0;
+
+        for (; nChunks < nChunksPerBatch and hasMore; nChunks++) {
+            hasMore = readChunk(points, attributes, withColor, chunkSize, batch[nChunks]);
+            nPoints += batch[nChunks].nPoints;
+        }
+
+        batch.resize(nChunks);
+
+        if (pendingBatch.valid() and !pendingBatch.get()) {
+            return false;
+        }
+
+        pendingBatch = std::async(std::launch::async, [&body, &missingValues, separator, batch = std::move(batch)] () {
+
+            std::vector<std::string> texts(batch.size());
+
+            #pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < batch.size(); i++) {
+                texts[i] = formatChunk(batch[i], missingValues, separator);
+            }
+
+            for (std::string const& text : texts) {
+                body.write(text.data(), text.size());
+            }
+
+            return bool(body);
+        });
+    }
+
+    if (pendingBatch.valid() and !pendingBatch.get()) {
+        return false;
+    }
+
+    if (bodySpool.has_value()) {
+
+        std::string header = pcdHeader(columns, nPoints);
+        out.write(header.data(), header.size());
+
+        if (!bodySpool->copyTo(out)) {
+            return false;
+        }
+    }
+
+    out.flush();
+
+    return !out.fail();
+}
+
+}
@@ -0,0 +1,107 @@
+#ifndef ASCIIPOINTCLOUDWRITER_H
+#define ASCIIPOINTCLOUDWRITER_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+/*!
+ * The ascii writers format the points with std::to_chars, using the shortest representation
+ * which read back to the same value.
+ *
+ * The points are read in chunks from the processing chain, the chunks are formatted in parallel
+ * while the next chunks are read, and are then written to the file in order.
+ */
+namespace AsciiPointCloud {
+
+enum class Format {
+    PcdAscii, //!< ascii pcd, with one field per color channel and per numeric attribute.
+    Xyz, //!< space separated coordinates, without header.
+    Csv //!< comma separated values, with a header line, including the color and the numeric attributes.
+};
+
+/*!
+ * \brief formatFromName get the ascii format corresponding to an output format name.
+ * \param name the format name, one of "pcd-ascii", "xyz" or "csv".
+ * \return the format, or nothing if the name is not an ascii format.
+ */
+std::optional<Format> formatFromName(std::string const& name);
+
+/*!
+ * \brief Column describe a column of the ascii output.
+ */
+struct Column {
+    std::string name;
+    char pcdType; //!< the pcd type of the column, 'F', 'I' or 'U'.
+    int pcdSize; //!< the size in bytes of the column in pcd.
+};
+
+/*!
+ * \brief columnsFromAttributes get the columns of the output from the attributes of a point cloud.
+ *
+ * The columns are the position, the color (if the current point has one) and the attributes listed by the point cloud.
+ * The types of the columns are those of the values of the current point, the attributes it does not have being written as doubles.
+ * Non numeric attributes (e.g. strings) cannot be represented in a single column and are skipped.
+ */
+std::vector<Column> columnsFromAttributes(StereoVision::IO::PointCloudPointAccessInterface const& points, Format format);
+
+/*!
+ * \brief appendValue format a value and append it to a string.
+ * \param out the string to append to.
+ * \param value the value to format.
+ * \return false if the value cannot be formatted as a single number.
+ */
+bool appendValue(std::string & out, StereoVision::IO::PointCloudGenericAttribute const& value);
+
+/*!
+ * \brief writePointCloudAscii write a point cloud to an ascii file.
+ * \param outFile the file to write to.
+ * \param pointCloudStack the point cloud to write.
+ * \param format the ascii format.
+ * \param chunkSize the number of points formatted at once by a thread.
+ * \return true on success, false otherwise.
+ */
+bool writePointCloudAscii(std::filesystem::path const& outFile,
+                          StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack,
+                          Format format,
+                          int chunkSize = 1 << 14);
+
+/*!
+ * \brief writePointCloudAscii write a point cloud to an output stream in an ascii format.
+ * \param out the stream to write to, written sequentially, so it can be a pipe (e.g. the standard output).
+ * The xyz and csv formats are streamed as the points are read, the points of the pcd format are formatted to a temporary file,
+ * and written once the header can be written with the number of points.
+ * \param pointCloudStack the point cloud to write.
+ * \param format the ascii format.
+ * \param chunkSize the number of points formatted at once by a thread.
+ * \return true on success, false otherwise.
+ */
+bool writePointCloudAscii(std::ostream & out,
+                          StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack,
+                          Format format,
+                          int chunkSize = 1 << 14);
+
+}
+
+#endif // ASCIIPOINTCLOUDWRITER_H
@@ -0,0 +1,1116 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ldmcpointcloud.h"
+
+#include "../processingBlocks/aliasheaderattributes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef LDM_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+using GenericAttribute = StereoVision::IO::PointCloudGenericAttribute;
+
+/*
+ * Layout of a ldmc file (all numbers are little endian):
+ *
+ * header: "LDMC", uint32 version,
+ *         uint32 nColumns, then per column: char type, uint8 size, uint16 name length, name,
+ *         uint32 nAttributes, then per header attribute: uint32 key length, key, uint32 value length, value.
+ * chunks: per column a segment (validity bytes if the column has missing values, then the values, optionally compressed),
+ *         then a footer: uint64 nPoints, then per column: uint64 offset, uint64 stored size, uint8 compressed, uint8 hasNulls,
+ *         6 padding bytes, double min, double max, int64 count.
+ * index:  uint64 offset of each chunk footer.
+ * trailer: uint64 index offset, uint64 nChunks, "LDMCTAIL".
+ *
+ * Segments and footers are aligned on 8 bytes.
+ */
+constexpr char headerMagic[] = "LDMC";
+constexpr char trailerMagic[] = "LDMCTAIL";
+constexpr uint32_t formatVersion = 1;
+
+constexpr size_t trailerSize = 3*sizeof(uint64_t);
+constexpr size_t columnFooterSize = 6*sizeof(uint64_t);
+
+constexpr int compressionLevel = 3;
+
+constexpr bool hostIsLittleEndian = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+template<typename T>
+inline T readRaw(char const* src) {
+    T val;
+    std::memcpy(&val, src, sizeof(T));
+    return val;
+}
+
+template<typename T>
+inline void appendRaw(std::vector<char> & dst, T val) {
+    size_t pos = dst.size();
+    dst.resize(pos + sizeof(T));
+    std::memcpy(dst.data() + pos, &val, sizeof(T));
+}
+
+inline void appendString(std::vector<char> & dst, std::string const& str) {
+    dst.insert(dst.end(), str.begin(), str.end());
+}
+
+inline size_t paddingTo8(size_t size) {
+    return (8 - size%8)%8;
+}
+
+/*!
+ * \brief The Cursor class read the fields of the header, checking the bounds of the file.
+ */
+class Cursor {
+public:
+    Cursor(char const* data, size_t size, size_t pos) :
+        _data(data),
+        _size(size),
+        _pos(pos),
+        _ok(true)
+    {
+
+    }
+
+    template<typename T>
+    T read() {
+        if (!_ok or _pos + sizeof(T) > _size) {
+            _ok = false;
+            return T();
+        }
+
+        T val = readRaw<T>(_data + _pos);
+        _pos += sizeof(T);
+        return val;
+    }
+
+    std::string readString(size_t length) {
+        if (!_ok or _pos + length > _size) {
+            _ok = false;
+            return "";
+        }
+
+        std::string val(_data + _pos, length);
+        _pos += length;
+        return val;
+    }
+
+    inline bool ok() const {
+        return _ok;
+    }
+
+protected:
+    char const* _data;
+    size_t _size;
+    size_t _pos;
+    bool _ok;
+};
+
+std::optional<Ldmc::Column> columnFromValue(std::string const& name, GenericAttribute const& value) {
+
+    return std::visit([&name] (auto const& val) -> std::optional<Ldmc::Column> {
+
+        using T = std::decay_t<decltype(val)>;
+
+        if constexpr (std::is_same_v<T, bool>) {
+            return Ldmc::Column{name, 'U', 1};
+        } else if constexpr (std::is_floating_point_v<T>) {
+            return Ldmc::Column{name, 'F', sizeof(T)};
+        } else if constexpr (std::is_integral_v<T>) {
+            return Ldmc::Column{name, (std::is_signed_v<T>) ? 'I' : 'U', sizeof(T)};
+        }
+
+        return std::nullopt;
+
+    }, value);
+}
+
+int findColumn(std::vector<Ldmc::Column> const& columns, std::initializer_list<const char*> names) {
+
+    for (int i = 0; i < columns.size(); i++) {
+        for (const char* name : names) {
+            if (columns[i].name == name) {
+                return i;
+            }
+        }
+    }
+
+    return -1;
+}
+
+bool validColumnType(char type, int size) {
+
+    switch (type) {
+    case 'F':
+        return size == 4 or size == 8;
+    case 'I':
+    case 'U':
+        return size == 1 or size == 2 or size == 4 or size == 8;
+    }
+
+    return false;
+}
+
+template<typename T>
+inline void encodeRaw(char* dst, GenericAttribute const& value) {
+    T val = StereoVision::IO::castedPointCloudAttribute<T>(value);
+    std::memcpy(dst, &val, sizeof(T));
+}
+
+void encodeValue(char* dst, Ldmc::Column const& column, GenericAttribute const& value) {
+
+    switch (column.type) {
+    case 'F':
+        if (column.size == 4) {
+            encodeRaw<float>(dst, value);
+        } else {
+            encodeRaw<double>(dst, value);
+        }
+        return;
+    case 'I':
+        switch (column.size) {
+        case 1:
+            encodeRaw<int8_t>(dst, value);
+            return;
+        case 2:
+            encodeRaw<int16_t>(dst, value);
+            return;
+        case 4:
+            encodeRaw<int32_t>(dst, value);
+            return;
+        default:
+            encodeRaw<int64_t>(dst, value);
+            return;
+        }
+    case 'U':
+        switch (column.size) {
+        case 1:
+            encodeRaw<uint8_t>(dst, value);
+            return;
+        case 2:
+            encodeRaw<uint16_t>(dst, value);
+            return;
+        case 4:
+            encodeRaw<uint32_t>(dst, value);
+            return;
+        default:
+            encodeRaw<uint64_t>(dst, value);
+            return;
+        }
+    }
+}
+
+GenericAttribute decodeValue(char const* src, Ldmc::Column const& column) {
+
+    switch (column.type) {
+    case 'F':
+        return (column.size == 4) ? GenericAttribute(readRaw<float>(src)) : GenericAttribute(readRaw<double>(src));
+    case 'I':
+        switch (column.size) {
+        case 1:
+            return readRaw<int8_t>(src);
+        case 2:
+            return readRaw<int16_t>(src);
+        case 4:
+            return readRaw<int32_t>(src);
+        default:
+            return readRaw<int64_t>(src);
+        }
+    default:
+        switch (column.size) {
+        case 1:
+            return readRaw<uint8_t>(src);
+        case 2:
+            return readRaw<uint16_t>(src);
+        case 4:
+            return readRaw<uint32_t>(src);
+        default:
+            return readRaw<uint64_t>(src);
+        }
+    }
+}
+
+/*!
+ * \brief The ColumnBuffer struct accumulate the values of a column for the chunk being written.
+ */
+struct ColumnBuffer {
+
+    Ldmc::Column column;
+
+    std::vector<char> values;
+    std::vector<uint8_t> validity;
+    bool hasNulls = false;
+
+    Ldmc::ColumnStatistics statistics = {std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), 0};
+
+    void append(std::optional<GenericAttribute> const& value) {
+
+        size_t pos = values.size();
+        values.resize(pos + column.size, 0);
+
+        if (!value.has_value()) {
+            validity.push_back(0);
+            hasNulls = true;
+            return;
+        }
+
+        validity.push_back(1);
+        encodeValue(values.data() + pos, column, value.value());
+
+        //the statistics are computed on the stored value, nan values are counted but do not change the bounds.
+        double val = StereoVision::IO::castedPointCloudAttribute<double>(decodeValue(values.data() + pos, column));
+
+        statistics.count++;
+
+        if (!std::isnan(val)) {
+            statistics.min = std::min(statistics.min, val);
+            statistics.max = std::max(statistics.max, val);
+        }
+    }
+
+    void clear() {
+        values.clear();
+        validity.clear();
+        hasNulls = false;
+        statistics = {std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), 0};
+    }
+
+    /*!
+     * \brief segment build the (uncompressed) segment of the column.
+     */
+    std::vector<char> segment() const {
+
+        std::vector<char> ret;
+        ret.reserve(((hasNulls) ? validity.size() : 0) + values.size());
+
+        if (hasNulls) {
+            ret.insert(ret.end(), validity.begin(), validity.end());
+        }
+
+        ret.insert(ret.end(), values.begin(), values.end());
+
+        return ret;
+    }
+};
+
+/*!
+ * \brief encodeChunk encode the segments and the footer of a chunk.
+ * \param columns the column buffers of the chunk.
+ * \param nPoints the number of points in the chunk.
+ * \param chunkOffset the offset of the chunk in the file.
+ * \param compress compress the segments.
+ * \param footerOffset output, the offset of the footer in the file.
+ * \return the encoded chunk, or nothing in case of error.
+ */
+std::optional<std::vector<char>> encodeChunk(std::vector<ColumnBuffer> const& columns,
+                                             int64_t nPoints,
+                                             size_t chunkOffset,
+                                             bool compress,
+                                             size_t & footerOffset) {
+
+    std::vector<std::vector<char>> segments(columns.size());
+    bool ok = true;
+
+    //the columns are independent, so they are encoded (and compressed) in parallel.
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < columns.size(); i++) {
+
+        std::vector<char> raw = columns[i].segment();
+
+        if (!compress) {
+            segments[i] = std::move(raw);
+            continue;
+        }
+
+        #ifdef LDM_WITH_ZSTD
+        std::vector<char> compressed(ZSTD_compressBound(raw.size()));
+        size_t compressedSize = ZSTD_compress(compressed.data(), compressed.size(), raw.data(), raw.size(), compressionLevel);
+
+        if (ZSTD_isError(compressedSize)) {
+            #pragma omp atomic write
+            ok = false;
+            continue;
+        }
+
+        compressed.resize(compressedSize);
+        segments[i] = std::move(compressed);
+        #else
+        #pragma omp atomic write
+        ok = false;
+        #endif
+    }
+
+    if (!ok) {
+        return std::nullopt;
+    }
+
+    std::vector<char> ret;
+    std::vector<size_t> offsets(columns.size());
+
+    for (int i = 0; i < columns.size(); i++) {
+        offsets[i] = chunkOffset + ret.size();
+        ret.insert(ret.end(), segments[i].begin(), segments[i].end());
+        ret.resize(ret.size() + paddingTo8(ret.size()), 0);
+    }
+
+    footerOffset = chunkOffset + ret.size();
+
+    appendRaw<uint64_t>(ret, nPoints);
+
+    for (int i = 0; i < columns.size(); i++) {
+        appendRaw<uint64_t>(ret, offsets[i]);
+        appendRaw<uint64_t>(ret, segments[i].size());
+        appendRaw<uint8_t>(ret, compress);
+        appendRaw<uint8_t>(ret, columns[i].hasNulls);
+        ret.resize(ret.size() + 6, 0);
+        appendRaw<double>(ret, columns[i].statistics.min);
+        appendRaw<double>(ret, columns[i].statistics.max);
+        appendRaw<int64_t>(ret, columns[i].statistics.count);
+    }
+
+    return ret;
+}
+
+}
+
+namespace Ldmc {
+
+bool compressionAvailable() {
+    #ifdef LDM_WITH_ZSTD
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+}
+
+std::unique_ptr<LdmcPointCloudReader> LdmcPointCloudReader::setupLdmcPointCloudReader(std::filesystem::path const& path) {
+
+    if (!hostIsLittleEndian) {
+        return nullptr;
+    }
+
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat fileStats;
+
+    if (fstat(fd, &fileStats) != 0 or fileStats.st_size <= 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    size_t size = fileStats.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+
+    char const* data = static_cast<char const*>(mapped);
+
+    auto fail = [mapped, size] () -> std::unique_ptr<LdmcPointCloudReader> {
+        munmap(mapped, size);
+        return nullptr;
+    };
+
+    if (size < 8 + trailerSize or std::memcmp(data, headerMagic, 4) != 0 or
+            std::memcmp(data + size - 8, trailerMagic, 8) != 0) {
+        return fail();
+    }
+
+    Cursor header(data, size, 4);
+
+    if (header.read<uint32_t>() != formatVersion) {
+        return fail();
+    }
+
+    uint32_t nColumns = header.read<uint32_t>();
+    std::vector<Ldmc::Column> columns;
+
+    for (uint32_t i = 0; header.ok() and i < nColumns; i++) {
+
+        Ldmc::Column column;
+        column.type = header.read<char>();
+        column.size = header.read<uint8_t>();
+        column.name = header.readString(header.read<uint16_t>());
+
+        if (!validColumnType(column.type, column.size)) {
+            return fail();
+        }
+
+        columns.push_back(column);
+    }
+
+    uint32_t nAttributes = header.read<uint32_t>();
+    std::map<std::string, std::string> headerAttributes;
+
+    for (uint32_t i = 0; header.ok() and i < nAttributes; i++) {
+        std::string key = header.readString(header.read<uint32_t>());
+        headerAttributes[key] = header.readString(header.read<uint32_t>());
+    }
+
+    if (!header.ok() or findColumn(columns, {"x"}) < 0 or findColumn(columns, {"y"}) < 0 or findColumn(columns, {"z"}) < 0) {
+        return fail();
+    }
+
+    Cursor trailer(data, size, size - trailerSize);
+    uint64_t indexOffset = trailer.read<uint64_t>();
+    uint64_t nChunks = trailer.read<uint64_t>();
+
+    if (indexOffset > size - trailerSize or nChunks > (size - trailerSize - indexOffset)/sizeof(uint64_t)) {
+        return fail();
+    }
+
+    std::vector<std::vector<Segment>> segments(nChunks);
+    std::vector<Ldmc::ChunkStatistics> chunkStatistics(nChunks);
+
+    Cursor index(data, size, indexOffset);
+
+    for (uint64_t c = 0; c < nChunks; c++) {
+
+        Cursor footer(data, size, index.read<uint64_t>());
+
+        int64_t nPoints = footer.read<uint64_t>();
+        chunkStatistics[c].nPoints = nPoints;
+
+        for (Ldmc::Column const& column : columns) {
+
+            Segment segment;
+            segment.offset = footer.read<uint64_t>();
+            segment.storedSize = footer.read<uint64_t>();
+            segment.compressed = footer.read<uint8_t>() != 0;
+            segment.hasNulls = footer.read<uint8_t>() != 0;
+            footer.readString(6);
+
+            Ldmc::ColumnStatistics statistics;
+            statistics.min = footer.read<double>();
+            statistics.max = footer.read<double>();
+            statistics.count = footer.read<int64_t>();
+
+            size_t expectedSize = nPoints*column.size + ((segment.hasNulls) ? nPoints : 0);
+
+            if (segment.offset > size or segment.storedSize > size - segment.offset or
+                    (!segment.compressed and segment.storedSize != expectedSize) or
+                    (segment.compressed and !Ldmc::compressionAvailable())) {
+                return fail();
+            }
+
+            segments[c].push_back(segment);
+            chunkStatistics[c].columns[column.name] = statistics;
+        }
+
+        if (!footer.ok()) {
+            return fail();
+        }
+    }
+
+    if (!index.ok()) {
+        return fail();
+    }
+
+    return std::unique_ptr<LdmcPointCloudReader>(new LdmcPointCloudReader(data, size, columns, segments, chunkStatistics, headerAttributes));
+}
+
+LdmcPointCloudReader::LdmcPointCloudReader(char const* mapped,
+                                           size_t mappedSize,
+                                           std::vector<Ldmc::Column> const& columns,
+                                           std::vector<std::vector<Segment>> const& segments,
+                                           std::vector<Ldmc::ChunkStatistics> const& chunkStatistics,
+                                           std::map<std::string, std::string> const& headerAttributes) :
+    _mapped(mapped),
+    _mappedSize(mappedSize),
+    _columns(columns),
+    _segments(segments),
+    _chunkStatistics(chunkStatistics),
+    _headerAttributes(headerAttributes),
+    _nSkippedChunks(0),
+    _failed(false),
+    _currentChunk(0),
+    _currentIdx(0),
+    _values(columns.size(), nullptr),
+    _validity(columns.size(), nullptr),
+    _buffers(columns.size())
+{
+    _positionColumns = {findColumn(_columns, {"x"}), findColumn(_columns, {"y"}), findColumn(_columns, {"z"})};
+
+    _colorColumns = {findColumn(_columns, {"red"}),
+                     findColumn(_columns, {"green"}),
+                     findColumn(_columns, {"blue"}),
+                     findColumn(_columns, {"alpha"})};
+
+    if (_colorColumns[0] < 0 or _colorColumns[1] < 0 or _colorColumns[2] < 0) {
+        _colorColumns = {-1, -1, -1, -1};
+    }
+
+    for (int i = 0; i < _columns.size(); i++) {
+
+        if (std::find(_positionColumns.begin(), _positionColumns.end(), i) != _positionColumns.end() or
+                std::find(_colorColumns.begin(), _colorColumns.end(), i) != _colorColumns.end()) {
+            continue;
+        }
+
+        _attributeIdxs[_columns[i].name] = _attributeColumns.size();
+        _attributeColumns.push_back(i);
+        _attributeNames.push_back(_columns[i].name);
+    }
+
+    gotoAcceptedChunk(0);
+}
+
+LdmcPointCloudReader::~LdmcPointCloudReader() {
+    munmap(const_cast<char*>(_mapped), _mappedSize);
+}
+
+bool LdmcPointCloudReader::loadChunk(int64_t chunk) {
+
+    std::vector<Segment> const& segments = _segments[chunk];
+    int64_t nPoints = _chunkStatistics[chunk].nPoints;
+
+    bool ok = true;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < _columns.size(); i++) {
+
+        Segment const& segment = segments[i];
+        char const* segmentData = _mapped + segment.offset;
+
+        if (segment.compressed) {
+            #ifdef LDM_WITH_ZSTD
+            size_t expectedSize = nPoints*_columns[i].size + ((segment.hasNulls) ? nPoints : 0);
+            _buffers[i].resize(expectedSize);
+
+            size_t decompressedSize = ZSTD_decompress(_buffers[i].data(), expectedSize, segmentData, segment.storedSize);
+
+            if (ZSTD_isError(decompressedSize) or decompressedSize != expectedSize) {
+                #pragma omp atomic write
+                ok = false;
+            }
+
+            segmentData = _buffers[i].data();
+            #else
+            #pragma omp atomic write
+            ok = false;
+            #endif
+        }
+
+        _validity[i] = (segment.hasNulls) ? reinterpret_cast<uint8_t const*>(segmentData) : nullptr;
+        _values[i] = segmentData + ((segment.hasNulls) ? nPoints : 0);
+    }
+
+    return ok;
+}
+
+bool LdmcPointCloudReader::gotoAcceptedChunk(int64_t chunk) {
+
+    int64_t nChunks = _chunkStatistics.size();
+
+    for (; chunk < nChunks; chunk++) {
+
+        Ldmc::ChunkStatistics const& statistics = _chunkStatistics[chunk];
+
+        if (statistics.nPoints <= 0) {
+            continue;
+        }
+
+        bool accepted = std::all_of(_predicates.begin(), _predicates.end(), [&statistics] (Ldmc::ChunkPredicate const& predicate) {
+            return predicate(statistics);
+        });
+
+        if (!accepted) {
+            _nSkippedChunks++;
+            continue;
+        }
+
+        if (!loadChunk(chunk)) {
+            std::cerr << "Could not decode the chunk " << chunk << " of the ldmc file!" << std::endl;
+            _failed = true;
+            break;
+        }
+
+        _currentChunk = chunk;
+        _currentIdx = 0;
+        return true;
+    }
+
+    _currentChunk = nChunks;
+    _currentIdx = 0;
+    return false;
+}
+
+void LdmcPointCloudReader::addChunkPredicate(Ldmc::ChunkPredicate const& predicate) {
+
+    _predicates.push_back(predicate);
+
+    if (!hasData() or _currentIdx != 0 or predicate(_chunkStatistics[_currentChunk])) {
+        return;
+    }
+
+    _nSkippedChunks++;
+    gotoAcceptedChunk(_currentChunk+1);
+}
+
+int64_t LdmcPointCloudReader::numberOfPoints() const {
+
+    int64_t ret = 0;
+
+    for (Ldmc::ChunkStatistics const& statistics : _chunkStatistics) {
+        ret += statistics.nPoints;
+    }
+
+    return ret;
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> LdmcPointCloudReader::columnValue(int column) const {
+
+    if (_validity[column] != nullptr and _validity[column][_currentIdx] == 0) {
+        return std::nullopt;
+    }
+
+    return decodeValue(_values[column] + _currentIdx*_columns[column].size, _columns[column]);
+}
+
+StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> LdmcPointCloudReader::getPointPosition() const {
+
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+    return StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute>{columnValue(_positionColumns[0]).value_or(nan),
+                                                                                     columnValue(_positionColumns[1]).value_or(nan),
+                                                                                     columnValue(_positionColumns[2]).value_or(nan)};
+}
+
+std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> LdmcPointCloudReader::getPointColor() const {
+
+    if (_colorColumns[0] < 0) {
+        return std::nullopt;
+    }
+
+    std::optional<GenericAttribute> red = columnValue(_colorColumns[0]);
+    std::optional<GenericAttribute> green = columnValue(_colorColumns[1]);
+    std::optional<GenericAttribute> blue = columnValue(_colorColumns[2]);
+
+    if (!red.has_value() or !green.has_value() or !blue.has_value()) {
+        return std::nullopt;
+    }
+
+    std::optional<GenericAttribute> alpha = (_colorColumns[3] >= 0) ? columnValue(_colorColumns[3]) : std::nullopt;
+
+    if (!alpha.has_value()) {
+        if (_columns[_colorColumns[0]].type == 'F') {
+            alpha = 1.f;
+        } else if (_columns[_colorColumns[0]].size == 2) {
+            alpha = uint16_t(65535);
+        } else {
+            alpha = uint8_t(255);
+        }
+    }
+
+    return StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>{red.value(),
+                                                                                  green.value(),
+                                                                                  blue.value(),
+                                                                                  alpha.value()};
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> LdmcPointCloudReader::getAttributeById(int id) const {
+
+    if (id < 0 or id >= _attributeColumns.size()) {
+        return std::nullopt;
+    }
+
+    return columnValue(_attributeColumns[id]);
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> LdmcPointCloudReader::getAttributeByName(const char* attributeName) const {
+
+    auto it = _attributeIdxs.find(attributeName);
+
+    if (it == _attributeIdxs.end()) {
+        return std::nullopt;
+    }
+
+    return getAttributeById(it->second);
+}
+
+std::vector<std::string> LdmcPointCloudReader::attributeList() const {
+    return _attributeNames;
+}
+
+bool LdmcPointCloudReader::gotoNext() {
+
+    if (!hasData()) {
+        return false;
+    }
+
+    _currentIdx++;
+
+    if (_currentIdx < _chunkStatistics[_currentChunk].nPoints) {
+        return true;
+    }
+
+    return gotoAcceptedChunk(_currentChunk+1);
+}
+
+bool LdmcPointCloudReader::hasData() const {
+    return _currentChunk < _chunkStatistics.size();
+}
+
+namespace Ldmc {
+
+std::optional<StereoVision::IO::FullPointCloudAccessInterface> openPointCloudLdmc(std::filesystem::path const& path) {
+
+    std::unique_ptr<LdmcPointCloudReader> reader = LdmcPointCloudReader::setupLdmcPointCloudReader(path);
+
+    if (reader == nullptr) {
+        return std::nullopt;
+    }
+
+    AliasHeaderAttributes::AliasMap headerAttributes;
+
+    for (auto const& [key, value] : reader->headerAttributes()) {
+        headerAttributes[key] = value;
+    }
+
+    StereoVision::IO::FullPointCloudAccessInterface ret;
+    ret.headerAccess = std::make_unique<AliasHeaderAttributes>(nullptr, headerAttributes);
+    ret.pointAccess = std::move(reader);
+
+    return ret;
+}
+
+bool writePointCloudLdmc(std::filesystem::path const& outFile,
+                         StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack,
+                         bool compress,
+                         int chunkSize) {
+
+    if (!hostIsLittleEndian or pointCloudStack.pointAccess == nullptr or (compress and !compressionAvailable())) {
+        return false;
+    }
+
+    StereoVision::IO::PointCloudPointAccessInterface & points = *pointCloudStack.pointAccess;
+
+    std::ofstream out(outFile, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+
+    if (!out.is_open()) {
+        return false;
+    }
+
+    //columns, deduced from the first point.
+    std::vector<ColumnBuffer> columns;
+    std::vector<std::string> attributes;
+    bool withColor = false;
+
+    auto addColumn = [&columns] (std::string const& name, std::optional<GenericAttribute> const& value, Column const& fallback) {
+        ColumnBuffer buffer;
+        buffer.column = (value.has_value()) ? columnFromValue(name, value.value()).value_or(fallback) : fallback;
+        columns.push_back(std::move(buffer));
+    };
+
+    if (points.hasData()) {
+
+        StereoVision::IO::PtGeometry<GenericAttribute> pos = points.getPointPosition();
+
+        addColumn("x", pos.x, Column{"x", 'F', 8});
+        addColumn("y", pos.y, Column{"y", 'F', 8});
+        addColumn("z", pos.z, Column{"z", 'F', 8});
+
+        auto color = points.getPointColor();
+
+        if (color.has_value()) {
+            withColor = true;
+            addColumn("red", color->r, Column{"red", 'U', 1});
+            addColumn("green", color->g, Column{"green", 'U', 1});
+            addColumn("blue", color->b, Column{"blue", 'U', 1});
+            addColumn("alpha", color->a, Column{"alpha", 'U', 1});
+        }
+
+        for (std::string const& attribute : points.attributeList()) {
+
+            std::optional<GenericAttribute> value = points.getAttributeByName(attribute.c_str());
+
+            if (!value.has_value() or attribute.size() > std::numeric_limits<uint16_t>::max()) {
+                continue;
+            }
+
+            std::optional<Column> column = columnFromValue(attribute, value.value());
+
+            if (column.has_value()) {
+                addColumn(attribute, value, column.value());
+                attributes.push_back(attribute);
+            }
+        }
+
+    } else {
+        addColumn("x", std::nullopt, Column{"x", 'F', 8});
+        addColumn("y", std::nullopt, Column{"y", 'F', 8});
+        addColumn("z", std::nullopt, Column{"z", 'F', 8});
+    }
+
+    std::vector<char> header;
+    appendString(header, headerMagic);
+    appendRaw<uint32_t>(header, formatVersion);
+    appendRaw<uint32_t>(header, columns.size());
+
+    for (ColumnBuffer const& buffer : columns) {
+        appendRaw<char>(header, buffer.column.type);
+        appendRaw<uint8_t>(header, buffer.column.size);
+        appendRaw<uint16_t>(header, buffer.column.name.size());
+        appendString(header, buffer.column.name);
+    }
+
+    std::map<std::string, std::string> headerAttributes;
+
+    if (pointCloudStack.headerAccess != nullptr) {
+        for (std::string const& name : pointCloudStack.headerAccess->attributeList()) {
+
+            std::optional<GenericAttribute> value = pointCloudStack.headerAccess->getAttributeByName(name.c_str());
+
+            if (!value.has_value()) {
+                continue;
+            }
+
+            std::string strValue = StereoVision::IO::castedPointCloudAttribute<std::string>(value.value());
+
+            if (!strValue.empty()) {
+                headerAttributes[name] = strValue;
+            }
+        }
+    }
+
+    appendRaw<uint32_t>(header, headerAttributes.size());
+
+    for (auto const& [key, value] : headerAttributes) {
+        appendRaw<uint32_t>(header, key.size());
+        appendString(header, key);
+        appendRaw<uint32_t>(header, value.size());
+        appendString(header, value);
+    }
+
+    header.resize(header.size() + paddingTo8(header.size()), 0);
+    out.write(header.data(), header.size());
+
+    size_t fileOffset = header.size();
+    std::vector<uint64_t> footerOffsets;
+
+    chunkSize = std::max(1, chunkSize);
+
+    auto resetColumns = [&columns, chunkSize] () {
+        for (ColumnBuffer & buffer : columns) {
+            buffer.clear();
+            buffer.values.reserve(chunkSize*buffer.column.size);
+            buffer.validity.reserve(chunkSize);
+        }
+    };
+
+    resetColumns();
+
+    //the chunks are encoded and written in a background task, while the next chunk is read.
+    std::future<bool> pendingChunk;
+
+    auto flushChunk = [&] (int64_t nPoints) -> bool {
+
+        if (pendingChunk.valid() and !pendingChunk.get()) {
+            return false;
+        }
+
+        std::vector<ColumnBuffer> chunkColumns(columns.size());
+        std::swap(chunkColumns, columns);
+
+        for (int i = 0; i < columns.size(); i++) {
+            columns[i].column = chunkColumns[i].column;
+        }
+
+        resetColumns();
+
+        pendingChunk = std::async(std::launch::async, [&out, &fileOffset, &footerOffsets, compress, nPoints] (std::vector<ColumnBuffer> chunkColumns) -> bool {
+
+            size_t footerOffset;
+            std::optional<std::vector<char>> encoded = encodeChunk(chunkColumns, nPoints, fileOffset, compress, footerOffset);
+
+            if (!encoded.has_value()) {
+                return false;
+            }
+
+            out.write(encoded->data(), encoded->size());
+            fileOffset += encoded->size();
+            footerOffsets.push_back(footerOffset);
+
+            return !out.fail();
+        }, std::move(chunkColumns));
+
+        return true;
+    };
+
+    int nColorColumns = (withColor) ? 4 : 0;
+    int64_t nPoints = 0;
+    bool hasMore = points.hasData();
+
+    while (hasMore) {
+
+        StereoVision::IO::PtGeometry<GenericAttribute> pos = points.getPointPosition();
+
+        columns[0].append(pos.x);
+        columns[1].append(pos.y);
+        columns[2].append(pos.z);
+
+        if (withColor) {
+            auto color = points.getPointColor();
+
+            columns[3].append((color.has_value()) ? std::optional<GenericAttribute>(color->r) : std::nullopt);
+            columns[4].append((color.has_value()) ? std::optional<GenericAttribute>(color->g) : std::nullopt);
+            columns[5].append((color.has_value()) ? std::optional<GenericAttribute>(color->b) : std::nullopt);
+            columns[6].append((color.has_value()) ? std::optional<GenericAttribute>(color->a) : std::nullopt);
+        }
+
+        for (int i = 0; i < attributes.size(); i++) {
+            columns[3 + nColorColumns + i].append(points.getAttributeByName(attributes[i].c_str()));
+        }
+
+        nPoints++;
+        hasMore = points.gotoNext();
+
+        if (nPoints >= chunkSize or (!hasMore and nPoints > 0)) {
+            if (!flushChunk(nPoints)) {
+                return false;
+            }
+            nPoints = 0;
+        }
+    }
+
+    if (pendingChunk.valid() and !pendingChunk.get()) {
+        return false;
+    }
+
+    std::vector<char> trailer;
+
+    for (uint64_t footerOffset : footerOffsets) {
+        appendRaw<uint64_t>(trailer, footerOffset);
+    }
+
+    appendRaw<uint64_t>(trailer, fileOffset);
+    appendRaw<uint64_t>(trailer, footerOffsets.size());
+    appendString(trailer, trailerMagic);
+
+    out.write(trailer.data(), trailer.size());
+    out.close();
+
+    return !out.fail();
+}
+
+ChunkPredicate boxPredicate(StereoVision::Geometry::AffineTransform<double> const& world2rect,
+                            std::array<double, 3> const& extents) {
+
+    return [world2rect, extents] (ChunkStatistics const& statistics) -> bool {
+
+        std::array<ColumnStatistics, 3> bounds;
+        std::array<const char*, 3> names = {"x", "y", "z"};
+
+        for (int i = 0; i < 3; i++) {
+
+            auto it = statistics.columns.find(names[i]);
+
+            if (it == statistics.columns.end() or it->second.count < statistics.nPoints) {
+                return true;
+            }
+
+            bounds[i] = it->second;
+
+            //only nan values, rejected by the region of interest.
+            if (bounds[i].min > bounds[i].max) {
+                return false;
+            }
+        }
+
+        //the chunk is rejected if the bounding box, in the frame of the region of interest, of its corners do not intersect the region.
+        Eigen::Vector3d min = Eigen::Vector3d::Constant(std::numeric_limits<double>::infinity());
+        Eigen::Vector3d max = -min;
+
+        for (int corner = 0; corner < 8; corner++) {
+
+            Eigen::Vector3d pos;
+            pos << ((corner & 1) ? bounds[0].max : bounds[0].min),
+                    ((corner & 2) ? bounds[1].max : bounds[1].min),
+                    ((corner & 4) ? bounds[2].max : bounds[2].min);
+
+            Eigen::Vector3d transformed = world2rect*pos;
+
+            min = min.cwiseMin(transformed);
+            max = max.cwiseMax(transformed);
+        }
+
+        for (int i = 0; i < 3; i++) {
+            if (min[i] > extents[i] or max[i] < -extents[i]) {
+                return false;
+            }
+        }
+
+        return true;
+    };
+}
+
+ChunkPredicate valueSetPredicate(std::string const& attributeName, std::vector<double> const& values) {
+
+    return [attributeName, values] (ChunkStatistics const& statistics) -> bool {
+
+        auto it = statistics.columns.find(attributeName);
+
+        if (it == statistics.columns.end() or it->second.count < statistics.nPoints) {
+            return true;
+        }
+
+        auto first = std::lower_bound(values.begin(), values.end(), it->second.min);
+
+        return first != values.end() and *first <= it->second.max;
+    };
+}
+
+ChunkPredicate maxValuePredicate(std::string const& attributeName, double cap) {
+
+    return [attributeName, cap] (ChunkStatistics const& statistics) -> bool {
+
+        auto it = statistics.columns.find(attributeName);
+
+        if (it == statistics.columns.end() or it->second.count == 0) {
+            return false;
+        }
+
+        return it->second.min <= cap;
+    };
+}
+
+}
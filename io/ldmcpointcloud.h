@@ -0,0 +1,244 @@
+#ifndef LDMCPOINTCLOUD_H
+#define LDMCPOINTCLOUD_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <StereoVision/geometry/rotations.h>
+#include <StereoVision/io/pointcloud_io.h>
+
+/*!
+ * The ldmc format is the native columnar cache format of the tool.
+ *
+ * A file is made of a header (the columns and the header attributes), followed by chunks of points.
+ * Each chunk store one segment per column (optionally compressed with zstd) and end with a footer giving,
+ * for each column, the location of its segment and the min, max and count of its non missing values.
+ * An index of the chunk footers is written at the end of the file, so that the statistics of all the chunks
+ * can be read without touching the points, and chunks which cannot contain points of interest skipped.
+ *
+ * The columns x, y and z give the position, red, green, blue and alpha give the color and any other column is an attribute.
+ * Uncompressed segments are read directly from the mapped file.
+ */
+namespace Ldmc {
+
+/*!
+ * \brief The Column struct describe a column of a ldmc file.
+ */
+struct Column {
+    std::string name;
+    char type; //!< 'F', 'I' or 'U'
+    int size; //!< size in bytes
+};
+
+/*!
+ * \brief The ColumnStatistics struct hold the statistics of a column in a chunk.
+ */
+struct ColumnStatistics {
+    double min;
+    double max;
+    int64_t count; //!< number of non missing values
+};
+
+/*!
+ * \brief The ChunkStatistics struct hold the statistics of a chunk.
+ */
+struct ChunkStatistics {
+    int64_t nPoints;
+    std::map<std::string, ColumnStatistics> columns;
+};
+
+/*!
+ * \brief A ChunkPredicate return false if a chunk can be proven to contain no point of interest, true otherwise.
+ */
+using ChunkPredicate = std::function<bool(ChunkStatistics const&)>;
+
+/*!
+ * \brief compressionAvailable indicate if the tool is built with zstd (LDM_WITH_ZSTD is defined).
+ */
+bool compressionAvailable();
+
+}
+
+/*!
+ * \brief The LdmcPointCloudReader class read the points of a ldmc file, chunk by chunk.
+ */
+class LdmcPointCloudReader : public StereoVision::IO::PointCloudPointAccessInterface
+{
+public:
+
+    /*!
+     * \brief setupLdmcPointCloudReader open a ldmc file.
+     * \param path the path to the file.
+     * \return the reader, or nullptr in case of error (e.g. truncated file, or compressed file without zstd support).
+     */
+    static std::unique_ptr<LdmcPointCloudReader> setupLdmcPointCloudReader(std::filesystem::path const& path);
+
+    ~LdmcPointCloudReader();
+
+    virtual StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> getPointPosition() const override;
+    virtual std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> getPointColor() const override;
+
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeById(int id) const override;
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeByName(const char* attributeName) const override;
+
+    virtual std::vector<std::string> attributeList() const override;
+
+    virtual bool gotoNext() override;
+    virtual bool hasData() const override;
+
+    /*!
+     * \brief addChunkPredicate skip the chunks rejected by a predicate.
+     *
+     * The predicates have to be added before the points are read, the reader is then moved to the first accepted point.
+     */
+    void addChunkPredicate(Ldmc::ChunkPredicate const& predicate);
+
+    inline std::vector<Ldmc::ChunkStatistics> const& chunkStatistics() const {
+        return _chunkStatistics;
+    }
+
+    inline std::map<std::string, std::string> const& headerAttributes() const {
+        return _headerAttributes;
+    }
+
+    int64_t numberOfPoints() const;
+
+    inline int64_t numberOfSkippedChunks() const {
+        return _nSkippedChunks;
+    }
+
+    /*!
+     * \brief ok indicate if all the chunks read so far could be decoded (the points end at the first corrupt chunk otherwise).
+     */
+    inline bool ok() const {
+        return !_failed;
+    }
+
+protected:
+
+    struct Segment {
+        size_t offset;
+        size_t storedSize;
+        bool compressed;
+        bool hasNulls;
+    };
+
+    LdmcPointCloudReader(char const* mapped,
+                         size_t mappedSize,
+                         std::vector<Ldmc::Column> const& columns,
+                         std::vector<std::vector<Segment>> const& segments,
+                         std::vector<Ldmc::ChunkStatistics> const& chunkStatistics,
+                         std::map<std::string, std::string> const& headerAttributes);
+
+    bool loadChunk(int64_t chunk);
+    bool gotoAcceptedChunk(int64_t chunk);
+
+    std::optional<StereoVision::IO::PointCloudGenericAttribute> columnValue(int column) const;
+
+    char const* _mapped;
+    size_t _mappedSize;
+
+    std::vector<Ldmc::Column> _columns;
+    std::vector<std::vector<Segment>> _segments; //!< segments per chunk, then per column
+    std::vector<Ldmc::ChunkStatistics> _chunkStatistics;
+    std::map<std::string, std::string> _headerAttributes;
+
+    std::vector<Ldmc::ChunkPredicate> _predicates;
+    int64_t _nSkippedChunks;
+
+    bool _failed;
+
+    int64_t _currentChunk;
+    int64_t _currentIdx; //!< index in the current chunk
+
+    //values and validity of each column for the current chunk, pointing to the mapped file or to the decompressed buffers.
+    std::vector<char const*> _values;
+    std::vector<uint8_t const*> _validity;
+    std::vector<std::vector<char>> _buffers;
+
+    std::array<int, 3> _positionColumns;
+    std::array<int, 4> _colorColumns;
+    std::vector<int> _attributeColumns;
+    std::vector<std::string> _attributeNames;
+    std::map<std::string, int> _attributeIdxs;
+};
+
+namespace Ldmc {
+
+/*!
+ * \brief openPointCloudLdmc open a ldmc file.
+ * \param path the path to the file.
+ * \return the point cloud access interfaces, or nothing in case of error.
+ */
+std::optional<StereoVision::IO::FullPointCloudAccessInterface> openPointCloudLdmc(std::filesystem::path const& path);
+
+/*!
+ * \brief writePointCloudLdmc write a point cloud as a ldmc file.
+ *
+ * The columns are deduced from the first point, attributes which are not scalar numbers are skipped.
+ * The header attributes which can be represented as strings (e.g. the crs) are stored in the file header.
+ *
+ * \param outFile the file to write to.
+ * \param pointCloudStack the point cloud to write.
+ * \param compress compress the segments with zstd, fail if zstd is not available.
+ * \param chunkSize the number of points per chunk.
+ * \return true on success, false otherwise.
+ */
+bool writePointCloudLdmc(std::filesystem::path const& outFile,
+                         StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack,
+                         bool compress = false,
+                         int chunkSize = 1 << 16);
+
+/*!
+ * \brief boxPredicate build a predicate rejecting the chunks whose bounding box do not intersect a region of interest.
+ * \param world2rect the transform from the world frame to the frame of the region of interest.
+ * \param extents the half extents of the region of interest.
+ */
+ChunkPredicate boxPredicate(StereoVision::Geometry::AffineTransform<double> const& world2rect,
+                            std::array<double, 3> const& extents);
+
+/*!
+ * \brief valueSetPredicate build a predicate rejecting the chunks where an attribute cannot take any value of a set.
+ *
+ * Chunks without the attribute, or with missing values, are accepted, same as the line selection.
+ *
+ * \param attributeName the name of the attribute.
+ * \param values the sorted values of the set.
+ */
+ChunkPredicate valueSetPredicate(std::string const& attributeName, std::vector<double> const& values);
+
+/*!
+ * \brief maxValuePredicate build a predicate rejecting the chunks where an attribute is always larger than a cap.
+ *
+ * Points without the attribute are rejected, same as the return number cap.
+ *
+ * \param attributeName the name of the attribute.
+ * \param cap the maximal value.
+ */
+ChunkPredicate maxValuePredicate(std::string const& attributeName, double cap);
+
+}
+
+#endif // LDMCPOINTCLOUD_H
@@ -0,0 +1,217 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "partitionedwriter.h"
+
+#include "pointspool.h"
+#include "../processingBlocks/aliasheaderattributes.h"
+
+#include <cctype>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+std::string attributeKey(std::optional<StereoVision::IO::PointCloudGenericAttribute> const& attribute) {
+
+    if (!attribute.has_value()) {
+        return "none";
+    }
+
+    return std::visit([] (auto const& val) -> std::string {
+        using T = std::decay_t<decltype (val)>;
+
+        if constexpr (std::is_integral_v<T>) {
+            return std::to_string(val);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            std::ostringstream strm;
+            strm << val;
+            return strm.str();
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            std::string ret = val;
+            for (char & c : ret) {
+                if (c == '/' or c == '\\' or std::isspace(static_cast<unsigned char>(c))) {
+                    c = '_';
+                }
+            }
+            return ret;
+        }
+
+        return "none";
+    }, attribute.value());
+}
+
+}
+
+std::optional<PartitionedWriter::PartitionFunction> PartitionedWriter::parsePartitionDefinition(std::string const& definition) {
+
+    if (definition.empty()) {
+        return std::nullopt;
+    }
+
+    const std::string tilePrefix = "tile:";
+
+    if (definition.rfind(tilePrefix, 0) == 0) {
+
+        double tileSize;
+
+        try {
+            tileSize = std::stod(definition.substr(tilePrefix.size()));
+        } catch (std::exception const& e) {
+            return std::nullopt;
+        }
+
+        if (!std::isfinite(tileSize) or tileSize <= 0) {
+            return std::nullopt;
+        }
+
+        return [tileSize] (StereoVision::IO::PointCloudPointAccessInterface const& src, std::vector<std::string> & keys) {
+            StereoVision::IO::PtGeometry<double> pos = src.castedPointGeometry<double>();
+            long long tx = std::floor(pos.x/tileSize);
+            long long ty = std::floor(pos.y/tileSize);
+            keys.push_back("tile_" + std::to_string(tx) + "_" + std::to_string(ty));
+        };
+    }
+
+    std::string attributeName = definition;
+
+    return [attributeName] (StereoVision::IO::PointCloudPointAccessInterface const& src, std::vector<std::string> & keys) {
+        keys.push_back(attributeName + "_" + attributeKey(src.getAttributeByName(attributeName.c_str())));
+    };
+}
+
+std::filesystem::path PartitionedWriter::partitionPath(std::filesystem::path const& pattern, std::string const& key) {
+
+    std::string patternStr = pattern.filename().string();
+    size_t placeholderPos = patternStr.find("{}");
+
+    std::string filename;
+
+    if (placeholderPos != std::string::npos) {
+        filename = patternStr.substr(0, placeholderPos) + key + patternStr.substr(placeholderPos+2);
+    } else {
+        filename = pattern.stem().string() + "_" + key + pattern.extension().string();
+    }
+
+    return pattern.parent_path() / filename;
+}
+
+PartitionedWriter::PartitionedWriter(std::filesystem::path const& outPattern,
+                                     PartitionFunction const& partitionFunction,
+                                     int maxOpenFiles,
+                                     size_t bufferSize) :
+    _outPattern(outPattern),
+    _partitionFunction(partitionFunction),
+    _spool(spoolDirFor(outPattern), maxOpenFiles, bufferSize)
+{
+
+}
+
+PartitionedWriter::~PartitionedWriter() {
+    _spool.clear();
+}
+
+bool PartitionedWriter::write(StereoVision::IO::FullPointCloudAccessInterface & pointCloud, WritingFunction const& writer) {
+
+    if (pointCloud.pointAccess == nullptr) {
+        return false;
+    }
+
+    StereoVision::IO::PointCloudPointAccessInterface& src = *pointCloud.pointAccess;
+
+    std::vector<std::string> schema = src.attributeList();
+
+    std::vector<std::string> keys;
+    std::string record;
+
+    if (src.hasData()) {
+
+        bool hasMore = true;
+
+        do {
+
+            keys.clear();
+            _partitionFunction(src, keys);
+
+            if (!keys.empty()) {
+
+                record.clear();
+                PointSpool::appendRecord(record, src, schema);
+
+                for (std::string const& key : keys) {
+                    if (!_spool.append(key, record)) {
+                        return false;
+                    }
+                }
+            }
+
+            hasMore = src.gotoNext();
+
+        } while (hasMore);
+    }
+
+    if (!_spool.flush()) {
+        return false;
+    }
+
+    _partitionsSizes = _spool.partitionsSizes();
+
+    //snapshot the header, so that it can be shared by all the partitions.
+    AliasHeaderAttributes::AliasMap headerAttributes;
+
+    if (pointCloud.headerAccess != nullptr) {
+        for (std::string const& name : pointCloud.headerAccess->attributeList()) {
+            auto attr = pointCloud.headerAccess->getAttributeByName(name.c_str());
+            if (attr.has_value()) {
+                headerAttributes[name] = attr.value();
+            }
+        }
+    }
+
+    bool ok = true;
+
+    for (std::string const& key : _spool.keys()) {
+
+        StereoVision::IO::FullPointCloudAccessInterface partitionCloud;
+        partitionCloud.headerAccess = std::make_unique<AliasHeaderAttributes>(nullptr, headerAttributes);
+        partitionCloud.pointAccess = _spool.openPartition(key, schema, true);
+
+        std::filesystem::path outPath = partitionPath(_outPattern, key);
+
+        if (!writer(outPath, partitionCloud)) {
+            std::cerr << "Error writing partition " << key << " to " << outPath << "!" << std::endl;
+            ok = false;
+        }
+    }
+
+    _spool.clear();
+
+    return ok;
+}
+
+std::filesystem::path PartitionedWriter::spoolDirFor(std::filesystem::path const& outPattern) {
+
+    std::filesystem::path parent = outPattern.parent_path();
+
+    if (parent.empty()) {
+        parent = ".";
+    }
+
+    //next to the outputs, as the spool holds all the points, but unique, so that concurrent runs writing to the same pattern do not share it.
+    return PartitionSpool::uniqueSpoolDir(parent, outPattern.filename().string());
+}
@@ -0,0 +1,101 @@
+#ifndef PARTITIONEDWRITER_H
+#define PARTITIONEDWRITER_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+#include "partitionspool.h"
+
+/*!
+ * \brief The PartitionedWriter class write a point cloud to multiple outputs in a single pass.
+ *
+ * Each point is dispatched to zero, one or more partitions, identified by a key.
+ * The points of each partition are buffered in memory and then appended to a spool file,
+ * the number of spool files open at the same time is capped, the least recently used ones being closed first.
+ *
+ * Once all the points have been read, each partition is written to its final output,
+ * so that the headers can be finalized with the actual number of points and bounds.
+ */
+class PartitionedWriter
+{
+public:
+
+    /*!
+     * \brief PartitionFunction fill the keys of the partitions the current point of the point cloud belongs to.
+     */
+    using PartitionFunction = std::function<void(StereoVision::IO::PointCloudPointAccessInterface const&, std::vector<std::string> &)>;
+
+    /*!
+     * \brief WritingFunction write a point cloud to a path, return true on success.
+     */
+    using WritingFunction = std::function<bool(std::filesystem::path const&, StereoVision::IO::FullPointCloudAccessInterface &)>;
+
+    /*!
+     * \brief parsePartitionDefinition parse a partition definition
+     * \param definition either "tile:<size>" to split the points in square tiles of size <size> in x and y, or the name of an attribute.
+     * \return the partition function, or std::nullopt in case of error.
+     */
+    static std::optional<PartitionFunction> parsePartitionDefinition(std::string const& definition);
+
+    /*!
+     * \brief partitionPath get the output path of a partition.
+     * \param pattern the output path pattern, if it contains "{}", it is replaced by the key, else the key is appended to the file stem.
+     * \param key the partition key
+     * \return the path of the partition
+     */
+    static std::filesystem::path partitionPath(std::filesystem::path const& pattern, std::string const& key);
+
+    PartitionedWriter(std::filesystem::path const& outPattern,
+                      PartitionFunction const& partitionFunction,
+                      int maxOpenFiles = 64,
+                      size_t bufferSize = 1 << 18);
+    ~PartitionedWriter();
+
+    /*!
+     * \brief write read all the points in the point cloud and write them to the partitions.
+     * \param pointCloud the point cloud to write.
+     * \param writer the function used to write each partition.
+     * \return true on success, false otherwise.
+     */
+    bool write(StereoVision::IO::FullPointCloudAccessInterface & pointCloud, WritingFunction const& writer);
+
+    inline std::map<std::string, size_t> const& partitionsSizes() const {
+        return _partitionsSizes;
+    }
+
+protected:
+
+    static std::filesystem::path spoolDirFor(std::filesystem::path const& outPattern);
+
+    std::filesystem::path _outPattern;
+
+    PartitionFunction _partitionFunction;
+
+    PartitionSpool _spool;
+
+    std::map<std::string, size_t> _partitionsSizes;
+};
+
+#endif // PARTITIONEDWRITER_H
@@ -0,0 +1,241 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "partitionspool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+#include <unistd.h>
+
+std::filesystem::path PartitionSpool::temporarySpoolDir(std::string const& name) {
+
+    std::error_code ec;
+    std::filesystem::path tmpDir = std::filesystem::temp_directory_path(ec);
+
+    if (ec) {
+        tmpDir = ".";
+    }
+
+    return uniqueSpoolDir(tmpDir, name);
+}
+
+std::filesystem::path PartitionSpool::uniqueSpoolDir(std::filesystem::path const& dir, std::string const& name) {
+
+    static std::atomic<int> counter(0);
+
+    return dir / ("." + name + "_" + std::to_string(getpid()) + "_" + std::to_string(counter++) + ".spool");
+}
+
+PartitionSpool::PartitionSpool(std::filesystem::path const& spoolDir,
+                               int maxOpenFiles,
+                               size_t bufferSize,
+                               size_t maxBufferedBytes) :
+    _spoolDir(spoolDir),
+    _maxOpenFiles(std::max(1, maxOpenFiles)),
+    _bufferSize(bufferSize),
+    _maxBufferedBytes(maxBufferedBytes),
+    _bufferedBytes(0)
+{
+
+}
+
+PartitionSpool::~PartitionSpool() {
+    clear();
+}
+
+bool PartitionSpool::append(std::string const& key, std::string const& record) {
+
+    Partition& partition = getPartition(key);
+
+    size_t previousCapacity = partition.buffer.capacity();
+    partition.buffer.append(record);
+    _bufferedBytes += partition.buffer.capacity() - previousCapacity;
+
+    _partitionsSizes[key]++;
+
+    if (partition.buffer.size() >= _bufferSize) {
+        if (!flushPartition(key, partition)) {
+            return false;
+        }
+    }
+
+    if (_bufferedBytes > _maxBufferedBytes) {
+        return flushLargestBuffers();
+    }
+
+    return true;
+}
+
+bool PartitionSpool::flush() {
+
+    for (auto & [key, partition] : _partitions) {
+        if (!flushPartition(key, partition)) {
+            return false;
+        }
+    }
+
+    for (auto & [key, partition] : _partitions) {
+        partition.file.reset();
+        partition.lruPos = _openFilesLru.end();
+    }
+
+    _openFilesLru.clear();
+
+    return true;
+}
+
+std::unique_ptr<PointSpoolReader> PartitionSpool::openPartition(std::string const& key,
+                                                                std::vector<std::string> const& schema,
+                                                                bool removeWhenDone) const {
+
+    auto it = _partitions.find(key);
+
+    if (it == _partitions.end()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<PointSpoolReader> reader = std::make_unique<PointSpoolReader>(it->second.spoolPath, schema, removeWhenDone);
+
+    if (!reader->isOpen()) {
+        std::cerr << "Could not open spool file " << it->second.spoolPath << "!" << std::endl;
+        return nullptr;
+    }
+
+    return reader;
+}
+
+std::vector<std::string> PartitionSpool::keys() const {
+
+    std::vector<std::string> ret;
+    ret.reserve(_partitions.size());
+
+    for (auto const& [key, partition] : _partitions) {
+        ret.push_back(key);
+    }
+
+    return ret;
+}
+
+void PartitionSpool::clear() {
+
+    _partitions.clear();
+    _partitionsSizes.clear();
+    _openFilesLru.clear();
+    _bufferedBytes = 0;
+
+    std::error_code ec;
+    std::filesystem::remove_all(_spoolDir, ec);
+}
+
+PartitionSpool::Partition& PartitionSpool::getPartition(std::string const& key) {
+
+    auto it = _partitions.find(key);
+
+    if (it != _partitions.end()) {
+        return it->second;
+    }
+
+    Partition& partition = _partitions[key];
+    partition.spoolPath = _spoolDir / (std::to_string(_partitions.size()) + ".spool");
+    partition.lruPos = _openFilesLru.end();
+
+    //the buffer is not reserved, most partitions (e.g. the halos of tiles) never fill it.
+    return partition;
+}
+
+bool PartitionSpool::flushPartition(std::string const& key, Partition & partition) {
+
+    if (partition.buffer.empty() and partition.file != nullptr) {
+        return true;
+    }
+
+    if (partition.file == nullptr) {
+
+        std::error_code ec;
+        std::filesystem::create_directories(_spoolDir, ec);
+
+        if (ec) {
+            std::cerr << "Could not create spool directory " << _spoolDir << "!" << std::endl;
+            return false;
+        }
+
+        if (_openFilesLru.size() >= _maxOpenFiles) {
+            Partition& lru = _partitions[_openFilesLru.back()];
+            lru.file.reset();
+            lru.lruPos = _openFilesLru.end();
+            _openFilesLru.pop_back();
+        }
+
+        //the spool file is created on the first flush, appended to afterward.
+        std::ios_base::openmode mode = std::ios_base::binary | std::ios_base::out | std::ios_base::app;
+        partition.file = std::make_unique<std::ofstream>(partition.spoolPath, mode);
+
+        if (!partition.file->is_open()) {
+            std::cerr << "Could not open spool file " << partition.spoolPath << "!" << std::endl;
+            return false;
+        }
+
+        _openFilesLru.push_front(key);
+        partition.lruPos = _openFilesLru.begin();
+
+    } else if (partition.lruPos != _openFilesLru.begin()) {
+        _openFilesLru.splice(_openFilesLru.begin(), _openFilesLru, partition.lruPos);
+    }
+
+    partition.file->write(partition.buffer.data(), partition.buffer.size());
+
+    //the buffer is released, so that the memory of the partitions which are not written to anymore is given back.
+    size_t previousCapacity = partition.buffer.capacity();
+    std::string().swap(partition.buffer);
+    _bufferedBytes -= previousCapacity - partition.buffer.capacity();
+
+    return bool(*partition.file);
+}
+
+bool PartitionSpool::flushLargestBuffers() {
+
+    std::vector<std::pair<size_t, std::string const*>> buffers;
+    buffers.reserve(_partitions.size());
+
+    for (auto const& [key, partition] : _partitions) {
+        if (!partition.buffer.empty()) {
+            buffers.emplace_back(partition.buffer.capacity(), &key);
+        }
+    }
+
+    std::sort(buffers.begin(), buffers.end(), [] (auto const& b1, auto const& b2) {
+        return b1.first > b2.first;
+    });
+
+    //flushing down to half the cap amortize the sort over many appends.
+    for (auto const& buffer : buffers) {
+
+        if (_bufferedBytes <= _maxBufferedBytes/2) {
+            break;
+        }
+
+        std::string const& key = *buffer.second;
+
+        if (!flushPartition(key, _partitions[key])) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,144 @@
+#ifndef PARTITIONSPOOL_H
+#define PARTITIONSPOOL_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "pointspool.h"
+
+/*!
+ * \brief The PartitionSpool class store points in multiple spool files, one per partition key.
+ *
+ * The records of each partition are buffered in memory and then appended to the spool file of the partition,
+ * the number of spool files open at the same time is capped, the least recently used ones being closed first.
+ * The memory used by the buffers of all the partitions together is capped too: when it is exceeded, the largest
+ * buffers are flushed (and released) first, so that the memory does not grow with the number of partitions.
+ *
+ * This allows to dispatch the points of a stream to partitions (e.g. spatial tiles) using a bounded amount of memory,
+ * and then to read back each partition independently.
+ */
+class PartitionSpool
+{
+public:
+
+    /*!
+     * \brief temporarySpoolDir get a new spool directory in the temporary directory of the system.
+     * \param name a name to identify the user of the spool.
+     */
+    static std::filesystem::path temporarySpoolDir(std::string const& name);
+
+    /*!
+     * \brief uniqueSpoolDir get a new spool directory in a given directory, unique to the process and to the call.
+     * \param dir the directory to create the spool directory in.
+     * \param name a name to identify the user of the spool.
+     */
+    static std::filesystem::path uniqueSpoolDir(std::filesystem::path const& dir, std::string const& name);
+
+    /*!
+     * \brief PartitionSpool create a partition spool
+     * \param spoolDir the directory to store the spool files in, created on the first flush and removed with the spool.
+     * \param maxOpenFiles the maximal number of spool files open at the same time.
+     * \param bufferSize the size of the memory buffer of each partition, in bytes.
+     * \param maxBufferedBytes the maximal memory used by the buffers of all the partitions, in bytes.
+     */
+    PartitionSpool(std::filesystem::path const& spoolDir,
+                   int maxOpenFiles = 64,
+                   size_t bufferSize = 1 << 18,
+                   size_t maxBufferedBytes = 1 << 26);
+    ~PartitionSpool();
+
+    PartitionSpool(PartitionSpool const& other) = delete;
+
+    /*!
+     * \brief append append a serialized record (see PointSpool::appendRecord) to a partition.
+     * \return true on success, false otherwise.
+     */
+    bool append(std::string const& key, std::string const& record);
+
+    /*!
+     * \brief flush write all the buffered records to the spool files and close them, needs to be called before reading the partitions.
+     * \return true on success, false otherwise.
+     */
+    bool flush();
+
+    /*!
+     * \brief openPartition read back the points of a partition.
+     * \param key the key of the partition.
+     * \param schema the schema the records were written with.
+     * \param removeWhenDone remove the spool file of the partition when the reader is destroyed.
+     * \return a reader, or nullptr if the partition does not exist or its spool file cannot be opened.
+     */
+    std::unique_ptr<PointSpoolReader> openPartition(std::string const& key,
+                                                    std::vector<std::string> const& schema,
+                                                    bool removeWhenDone = true) const;
+
+    std::vector<std::string> keys() const;
+
+    inline std::map<std::string, size_t> const& partitionsSizes() const {
+        return _partitionsSizes;
+    }
+
+    /*!
+     * \brief bufferedBytes the memory currently allocated for the buffers of the partitions, in bytes.
+     */
+    inline size_t bufferedBytes() const {
+        return _bufferedBytes;
+    }
+
+    /*!
+     * \brief clear remove all the partitions and the spool directory.
+     */
+    void clear();
+
+protected:
+
+    struct Partition {
+        std::string buffer;
+        std::filesystem::path spoolPath;
+        std::unique_ptr<std::ofstream> file;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    Partition& getPartition(std::string const& key);
+    bool flushPartition(std::string const& key, Partition & partition);
+
+    /*!
+     * \brief flushLargestBuffers flush the largest buffers until the buffered memory is at most half the cap.
+     */
+    bool flushLargestBuffers();
+
+    std::filesystem::path _spoolDir;
+
+    int _maxOpenFiles;
+    size_t _bufferSize;
+    size_t _maxBufferedBytes;
+    size_t _bufferedBytes;
+
+    std::map<std::string, Partition> _partitions;
+    std::map<std::string, size_t> _partitionsSizes;
+    std::list<std::string> _openFilesLru;
+};
+
+#endif // PARTITIONSPOOL_H
@@ -0,0 +1,609 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "plypointcloud.h"
+
+#include "../processingBlocks/aliasheaderattributes.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+using GenericAttribute = StereoVision::IO::PointCloudGenericAttribute;
+
+//the number of vertices is not known before the end, so it is written with a fixed width in the header, patched at the end.
+constexpr int vertexCountWidth = 19;
+
+constexpr bool hostIsLittleEndian = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+template<typename T>
+inline T readRaw(char const* src) {
+    T val;
+    std::memcpy(&val, src, sizeof(T));
+    return val;
+}
+
+template<typename T>
+inline void writeRaw(char* dst, GenericAttribute const& value) {
+    T val = StereoVision::IO::castedPointCloudAttribute<T>(value);
+    std::memcpy(dst, &val, sizeof(T));
+}
+
+std::optional<Ply::Property> propertyFromValue(std::string const& name, GenericAttribute const& value) {
+
+    return std::visit([&name] (auto const& val) -> std::optional<Ply::Property> {
+
+        using T = std::decay_t<decltype(val)>;
+
+        if constexpr (std::is_same_v<T, bool>) {
+            return Ply::Property{name, 'U', 1, 0};
+        } else if constexpr (std::is_floating_point_v<T>) {
+            return Ply::Property{name, 'F', sizeof(T), 0};
+        } else if constexpr (std::is_integral_v<T>) {
+            //ply has no 64 bits integers.
+            if constexpr (sizeof(T) > 4) {
+                return Ply::Property{name, 'F', 8, 0};
+            }
+            return Ply::Property{name, (std::is_signed_v<T>) ? 'I' : 'U', sizeof(T), 0};
+        }
+
+        return std::nullopt;
+
+    }, value);
+}
+
+int findProperty(std::vector<Ply::Property> const& properties, std::initializer_list<const char*> names) {
+
+    for (int i = 0; i < properties.size(); i++) {
+        for (const char* name : names) {
+            if (properties[i].name == name) {
+                return i;
+            }
+        }
+    }
+
+    return -1;
+}
+
+void encodeValue(char* dst, Ply::Property const& property, std::optional<GenericAttribute> const& value) {
+
+    if (!value.has_value()) {
+        if (property.type == 'F') {
+            GenericAttribute nan = std::numeric_limits<double>::quiet_NaN();
+            encodeValue(dst, property, nan);
+        } else {
+            std::memset(dst, 0, property.size);
+        }
+        return;
+    }
+
+    switch (property.type) {
+    case 'F':
+        if (property.size == 4) {
+            writeRaw<float>(dst, value.value());
+        } else {
+            writeRaw<double>(dst, value.value());
+        }
+        return;
+    case 'I':
+        switch (property.size) {
+        case 1:
+            writeRaw<int8_t>(dst, value.value());
+            return;
+        case 2:
+            writeRaw<int16_t>(dst, value.value());
+            return;
+        default:
+            writeRaw<int32_t>(dst, value.value());
+            return;
+        }
+    case 'U':
+        switch (property.size) {
+        case 1:
+            writeRaw<uint8_t>(dst, value.value());
+            return;
+        case 2:
+            writeRaw<uint16_t>(dst, value.value());
+            return;
+        default:
+            writeRaw<uint32_t>(dst, value.value());
+            return;
+        }
+    }
+}
+
+}
+
+namespace Ply {
+
+std::string typeName(char type, int size) {
+
+    switch (type) {
+    case 'F':
+        return (size == 4) ? "float" : "double";
+    case 'I':
+        return (size == 1) ? "char" : ((size == 2) ? "short" : "int");
+    case 'U':
+        return (size == 1) ? "uchar" : ((size == 2) ? "ushort" : "uint");
+    }
+
+    return "";
+}
+
+std::optional<std::pair<char, int>> parseTypeName(std::string const& name) {
+
+    static const std::map<std::string, std::pair<char, int>> types = {
+        {"char", {'I', 1}}, {"int8", {'I', 1}},
+        {"uchar", {'U', 1}}, {"uint8", {'U', 1}},
+        {"short", {'I', 2}}, {"int16", {'I', 2}},
+        {"ushort", {'U', 2}}, {"uint16", {'U', 2}},
+        {"int", {'I', 4}}, {"int32", {'I', 4}},
+        {"uint", {'U', 4}}, {"uint32", {'U', 4}},
+        {"float", {'F', 4}}, {"float32", {'F', 4}},
+        {"double", {'F', 8}}, {"float64", {'F', 8}}
+    };
+
+    auto it = types.find(name);
+
+    if (it == types.end()) {
+        return std::nullopt;
+    }
+
+    return it->second;
+}
+
+}
+
+std::unique_ptr<PlyPointCloudReader> PlyPointCloudReader::setupPlyPointCloudReader(std::filesystem::path const& path) {
+
+    if (!hostIsLittleEndian) {
+        return nullptr;
+    }
+
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat fileStats;
+
+    if (fstat(fd, &fileStats) != 0 or fileStats.st_size <= 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    size_t size = fileStats.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+
+    madvise(mapped, size, MADV_SEQUENTIAL);
+
+    char const* data = static_cast<char const*>(mapped);
+
+    auto fail = [mapped, size] () -> std::unique_ptr<PlyPointCloudReader> {
+        munmap(mapped, size);
+        return nullptr;
+    };
+
+    constexpr char endHeader[] = "end_header\n";
+    char const* headerEnd = static_cast<char const*>(memmem(data, size, endHeader, sizeof(endHeader)-1));
+
+    if (std::memcmp(data, "ply", std::min<size_t>(size, 3)) != 0 or headerEnd == nullptr) {
+        return fail();
+    }
+
+    headerEnd += sizeof(endHeader)-1;
+
+    std::istringstream header(std::string(data, headerEnd));
+    std::string line;
+
+    //size in bytes of the elements preceding the vertices, and properties of the vertices.
+    int64_t skippedBytes = 0;
+    int64_t nVertices = -1;
+    int stride = 0;
+    std::vector<Ply::Property> properties;
+
+    std::string currentElement;
+    int64_t currentCount = 0;
+    int currentStride = 0;
+    bool formatOk = false;
+
+    auto closeElement = [&] () {
+        if (!currentElement.empty() and currentElement != "vertex" and nVertices < 0) {
+            skippedBytes += currentCount*currentStride;
+        }
+    };
+
+    while (std::getline(header, line)) {
+
+        if (!line.empty() and line.back() == '\r') {
+            line.pop_back();
+        }
+
+        std::istringstream lineStream(line);
+        std::string keyword;
+        lineStream >> keyword;
+
+        if (keyword == "format") {
+            std::string format;
+            lineStream >> format;
+            formatOk = format == "binary_little_endian";
+        } else if (keyword == "element") {
+
+            closeElement();
+
+            lineStream >> currentElement >> currentCount;
+            currentStride = 0;
+
+            if (currentElement == "vertex") {
+                nVertices = currentCount;
+            }
+
+        } else if (keyword == "property") {
+
+            std::string type;
+            std::string name;
+            lineStream >> type >> name;
+
+            if (type == "list") {
+                //lists have a variable size, only supported in elements after the vertices, which are not read.
+                if (currentElement == "vertex" or nVertices < 0) {
+                    return fail();
+                }
+                continue;
+            }
+
+            std::optional<std::pair<char, int>> parsedType = Ply::parseTypeName(type);
+
+            if (!parsedType.has_value()) {
+                return fail();
+            }
+
+            if (currentElement == "vertex") {
+                properties.push_back(Ply::Property{name, parsedType->first, parsedType->second, stride});
+                stride += parsedType->second;
+            } else {
+                currentStride += parsedType->second;
+            }
+        }
+    }
+
+    closeElement();
+
+    if (!formatOk or nVertices < 0 or stride <= 0 or
+            findProperty(properties, {"x"}) < 0 or findProperty(properties, {"y"}) < 0 or findProperty(properties, {"z"}) < 0) {
+        return fail();
+    }
+
+    size_t dataStart = (headerEnd - data) + skippedBytes;
+
+    if (dataStart + nVertices*stride > size) {
+        return fail();
+    }
+
+    return std::unique_ptr<PlyPointCloudReader>(new PlyPointCloudReader(data, size, data + dataStart, nVertices, stride, properties));
+}
+
+PlyPointCloudReader::PlyPointCloudReader(char const* mapped,
+                                         size_t mappedSize,
+                                         char const* vertices,
+                                         int64_t nVertices,
+                                         int stride,
+                                         std::vector<Ply::Property> const& properties) :
+    _mapped(mapped),
+    _mappedSize(mappedSize),
+    _current(vertices),
+    _currentIdx(0),
+    _nVertices(nVertices),
+    _stride(stride),
+    _properties(properties)
+{
+    _positionProperties = {findProperty(_properties, {"x"}), findProperty(_properties, {"y"}), findProperty(_properties, {"z"})};
+
+    _colorProperties = {findProperty(_properties, {"red", "r"}),
+                        findProperty(_properties, {"green", "g"}),
+                        findProperty(_properties, {"blue", "b"}),
+                        findProperty(_properties, {"alpha", "a"})};
+
+    if (_colorProperties[0] < 0 or _colorProperties[1] < 0 or _colorProperties[2] < 0) {
+        _colorProperties = {-1, -1, -1, -1};
+    }
+
+    for (int i = 0; i < _properties.size(); i++) {
+
+        if (std::find(_positionProperties.begin(), _positionProperties.end(), i) != _positionProperties.end() or
+                std::find(_colorProperties.begin(), _colorProperties.end(), i) != _colorProperties.end()) {
+            continue;
+        }
+
+        _attributeIdxs[_properties[i].name] = _attributeProperties.size();
+        _attributeProperties.push_back(i);
+        _attributeNames.push_back(_properties[i].name);
+    }
+}
+
+PlyPointCloudReader::~PlyPointCloudReader() {
+    munmap(const_cast<char*>(_mapped), _mappedSize);
+}
+
+StereoVision::IO::PointCloudGenericAttribute PlyPointCloudReader::propertyValue(int property) const {
+
+    Ply::Property const& prop = _properties[property];
+    char const* src = _current + prop.offset;
+
+    switch (prop.type) {
+    case 'F':
+        return (prop.size == 4) ? GenericAttribute(readRaw<float>(src)) : GenericAttribute(readRaw<double>(src));
+    case 'I':
+        switch (prop.size) {
+        case 1:
+            return readRaw<int8_t>(src);
+        case 2:
+            return readRaw<int16_t>(src);
+        default:
+            return readRaw<int32_t>(src);
+        }
+    default:
+        switch (prop.size) {
+        case 1:
+            return readRaw<uint8_t>(src);
+        case 2:
+            return readRaw<uint16_t>(src);
+        default:
+            return readRaw<uint32_t>(src);
+        }
+    }
+}
+
+StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> PlyPointCloudReader::getPointPosition() const {
+    return StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute>{propertyValue(_positionProperties[0]),
+                                                                                     propertyValue(_positionProperties[1]),
+                                                                                     propertyValue(_positionProperties[2])};
+}
+
+std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> PlyPointCloudReader::getPointColor() const {
+
+    if (_colorProperties[0] < 0) {
+        return std::nullopt;
+    }
+
+    StereoVision::IO::PointCloudGenericAttribute alpha = uint8_t(255);
+
+    if (_colorProperties[3] >= 0) {
+        alpha = propertyValue(_colorProperties[3]);
+    } else if (_properties[_colorProperties[0]].type == 'F') {
+        alpha = 1.f;
+    } else if (_properties[_colorProperties[0]].size == 2) {
+        alpha = uint16_t(65535);
+    }
+
+    return StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>{propertyValue(_colorProperties[0]),
+                                                                                  propertyValue(_colorProperties[1]),
+                                                                                  propertyValue(_colorProperties[2]),
+                                                                                  alpha};
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> PlyPointCloudReader::getAttributeById(int id) const {
+
+    if (id < 0 or id >= _attributeProperties.size()) {
+        return std::nullopt;
+    }
+
+    return propertyValue(_attributeProperties[id]);
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> PlyPointCloudReader::getAttributeByName(const char* attributeName) const {
+
+    auto it = _attributeIdxs.find(attributeName);
+
+    if (it == _attributeIdxs.end()) {
+        return std::nullopt;
+    }
+
+    return getAttributeById(it->second);
+}
+
+std::vector<std::string> PlyPointCloudReader::attributeList() const {
+    return _attributeNames;
+}
+
+bool PlyPointCloudReader::gotoNext() {
+
+    if (_currentIdx >= _nVertices) {
+        return false;
+    }
+
+    _currentIdx++;
+    _current += _stride;
+
+    return _currentIdx < _nVertices;
+}
+
+bool PlyPointCloudReader::hasData() const {
+    return _currentIdx < _nVertices;
+}
+
+namespace Ply {
+
+std::optional<StereoVision::IO::FullPointCloudAccessInterface> openPointCloudPly(std::filesystem::path const& path) {
+
+    std::unique_ptr<PlyPointCloudReader> reader = PlyPointCloudReader::setupPlyPointCloudReader(path);
+
+    if (reader == nullptr) {
+        return std::nullopt;
+    }
+
+    StereoVision::IO::FullPointCloudAccessInterface ret;
+    ret.headerAccess = std::make_unique<AliasHeaderAttributes>(nullptr, AliasHeaderAttributes::AliasMap());
+    ret.pointAccess = std::move(reader);
+
+    return ret;
+}
+
+bool writePointCloudPly(std::filesystem::path const& outFile,
+                        StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack) {
+
+    if (!hostIsLittleEndian or pointCloudStack.pointAccess == nullptr) {
+        return false;
+    }
+
+    StereoVision::IO::PointCloudPointAccessInterface & points = *pointCloudStack.pointAccess;
+
+    std::ofstream out(outFile, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+
+    if (!out.is_open()) {
+        return false;
+    }
+
+    //properties of the vertices, deduced from the first point.
+    std::vector<Property> properties;
+    std::vector<std::string> attributes;
+    bool withColor = false;
+
+    if (points.hasData()) {
+
+        StereoVision::IO::PtGeometry<GenericAttribute> pos = points.getPointPosition();
+
+        properties.push_back(propertyFromValue("x", pos.x).value_or(Property{"x", 'F', 8, 0}));
+        properties.push_back(propertyFromValue("y", pos.y).value_or(Property{"y", 'F', 8, 0}));
+        properties.push_back(propertyFromValue("z", pos.z).value_or(Property{"z", 'F', 8, 0}));
+
+        auto color = points.getPointColor();
+
+        if (color.has_value()) {
+            withColor = true;
+            properties.push_back(propertyFromValue("red", color->r).value_or(Property{"red", 'U', 1, 0}));
+            properties.push_back(propertyFromValue("green", color->g).value_or(Property{"green", 'U', 1, 0}));
+            properties.push_back(propertyFromValue("blue", color->b).value_or(Property{"blue", 'U', 1, 0}));
+            properties.push_back(propertyFromValue("alpha", color->a).value_or(Property{"alpha", 'U', 1, 0}));
+        }
+
+        for (std::string const& attribute : points.attributeList()) {
+
+            std::optional<GenericAttribute> value = points.getAttributeByName(attribute.c_str());
+
+            //names with spaces cannot be represented in the header.
+            if (!value.has_value() or attribute.find_first_of(" \t\r\n") != std::string::npos) {
+                continue;
+            }
+
+            std::optional<Property> property = propertyFromValue(attribute, value.value());
+
+            if (property.has_value()) {
+                properties.push_back(property.value());
+                attributes.push_back(attribute);
+            }
+        }
+
+    } else {
+        properties = {Property{"x", 'F', 8, 0}, Property{"y", 'F', 8, 0}, Property{"z", 'F', 8, 0}};
+    }
+
+    int stride = 0;
+
+    for (Property & property : properties) {
+        property.offset = stride;
+        stride += property.size;
+    }
+
+    std::string header = "ply\nformat binary_little_endian 1.0\ncomment written by LidarDataManager\nelement vertex ";
+    std::streamoff countPos = header.size();
+    header += std::string(vertexCountWidth, '0') + "\n";
+
+    for (Property const& property : properties) {
+        header += "property " + typeName(property.type, property.size) + " " + property.name + "\n";
+    }
+
+    header += "end_header\n";
+
+    out.write(header.data(), header.size());
+
+    constexpr int bufferedVertices = 1 << 14;
+
+    std::vector<char> buffer;
+    buffer.reserve(bufferedVertices*stride);
+
+    int64_t nVertices = 0;
+    int nColorProperties = (withColor) ? 4 : 0;
+    bool hasMore = points.hasData();
+
+    while (hasMore) {
+
+        size_t recordStart = buffer.size();
+        buffer.resize(recordStart + stride);
+        char* record = buffer.data() + recordStart;
+
+        StereoVision::IO::PtGeometry<GenericAttribute> pos = points.getPointPosition();
+
+        encodeValue(record + properties[0].offset, properties[0], pos.x);
+        encodeValue(record + properties[1].offset, properties[1], pos.y);
+        encodeValue(record + properties[2].offset, properties[2], pos.z);
+
+        if (withColor) {
+            auto color = points.getPointColor();
+
+            encodeValue(record + properties[3].offset, properties[3], (color.has_value()) ? std::optional<GenericAttribute>(color->r) : std::nullopt);
+            encodeValue(record + properties[4].offset, properties[4], (color.has_value()) ? std::optional<GenericAttribute>(color->g) : std::nullopt);
+            encodeValue(record + properties[5].offset, properties[5], (color.has_value()) ? std::optional<GenericAttribute>(color->b) : std::nullopt);
+            encodeValue(record + properties[6].offset, properties[6], (color.has_value()) ? std::optional<GenericAttribute>(color->a) : std::nullopt);
+        }
+
+        for (int i = 0; i < attributes.size(); i++) {
+            Property const& property = properties[3 + nColorProperties + i];
+            encodeValue(record + property.offset, property, points.getAttributeByName(attributes[i].c_str()));
+        }
+
+        nVertices++;
+
+        if (buffer.size() >= bufferedVertices*stride) {
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+
+        hasMore = points.gotoNext();
+    }
+
+    out.write(buffer.data(), buffer.size());
+
+    std::string countStr = std::to_string(nVertices);
+    countStr.insert(0, vertexCountWidth - countStr.size(), '0');
+
+    out.seekp(countPos);
+    out.write(countStr.data(), countStr.size());
+
+    out.close();
+
+    return !out.fail();
+}
+
+}
@@ -0,0 +1,144 @@
+#ifndef PLYPOINTCLOUD_H
+#define PLYPOINTCLOUD_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+/*!
+ * Support for binary little endian ply files.
+ *
+ * Only the vertex element is read or written, the properties x, y and z give the position,
+ * red, green, blue and alpha give the color and any other scalar property is an attribute.
+ * The vertices have a fixed size, so they are decoded directly at fixed offsets of each record.
+ */
+namespace Ply {
+
+/*!
+ * \brief The Property struct describe a scalar property of the vertex element.
+ */
+struct Property {
+    std::string name;
+    char type; //!< 'F', 'I' or 'U'
+    int size; //!< size in bytes
+    int offset; //!< offset in the vertex record
+};
+
+/*!
+ * \brief typeName give the ply name of a property type (e.g. "float", "uchar").
+ */
+std::string typeName(char type, int size);
+
+/*!
+ * \brief parseTypeName parse a ply property type name.
+ * \return the type and size of the property, or nothing if the name is not a valid scalar type.
+ */
+std::optional<std::pair<char, int>> parseTypeName(std::string const& name);
+
+}
+
+/*!
+ * \brief The PlyPointCloudReader class read the vertices of a binary little endian ply file.
+ */
+class PlyPointCloudReader : public StereoVision::IO::PointCloudPointAccessInterface
+{
+public:
+
+    /*!
+     * \brief setupPlyPointCloudReader open a ply file.
+     * \param path the path to the file.
+     * \return the reader, or nullptr in case of error (e.g. unsupported ply variant or truncated file).
+     */
+    static std::unique_ptr<PlyPointCloudReader> setupPlyPointCloudReader(std::filesystem::path const& path);
+
+    ~PlyPointCloudReader();
+
+    virtual StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> getPointPosition() const override;
+    virtual std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> getPointColor() const override;
+
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeById(int id) const override;
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeByName(const char* attributeName) const override;
+
+    virtual std::vector<std::string> attributeList() const override;
+
+    virtual bool gotoNext() override;
+    virtual bool hasData() const override;
+
+    inline int64_t numberOfVertices() const {
+        return _nVertices;
+    }
+
+protected:
+
+    PlyPointCloudReader(char const* mapped,
+                        size_t mappedSize,
+                        char const* vertices,
+                        int64_t nVertices,
+                        int stride,
+                        std::vector<Ply::Property> const& properties);
+
+    StereoVision::IO::PointCloudGenericAttribute propertyValue(int property) const;
+
+    char const* _mapped;
+    size_t _mappedSize;
+
+    char const* _current;
+    int64_t _currentIdx;
+    int64_t _nVertices;
+    int _stride;
+
+    std::vector<Ply::Property> _properties;
+
+    std::array<int, 3> _positionProperties;
+    std::array<int, 4> _colorProperties;
+    std::vector<int> _attributeProperties;
+    std::vector<std::string> _attributeNames;
+    std::map<std::string, int> _attributeIdxs;
+};
+
+namespace Ply {
+
+/*!
+ * \brief openPointCloudPly open a binary little endian ply file.
+ * \param path the path to the file.
+ * \return the point cloud access interfaces, or nothing in case of error.
+ */
+std::optional<StereoVision::IO::FullPointCloudAccessInterface> openPointCloudPly(std::filesystem::path const& path);
+
+/*!
+ * \brief writePointCloudPly write a point cloud as a binary little endian ply file.
+ *
+ * The properties are deduced from the first point, attributes which are not scalar numbers are skipped.
+ *
+ * \param outFile the file to write to.
+ * \param pointCloudStack the point cloud to write.
+ * \return true on success, false otherwise.
+ */
+bool writePointCloudPly(std::filesystem::path const& outFile,
+                        StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack);
+
+}
+
+#endif // PLYPOINTCLOUD_H
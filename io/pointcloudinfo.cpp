@@ -0,0 +1,583 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pointcloudinfo.h"
+
+#include "streamio.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+using GenericAttribute = StereoVision::IO::PointCloudGenericAttribute;
+
+constexpr size_t batchSize = 1 << 16;
+
+constexpr int sidecarVersion = 1;
+
+//the attributes the points are counted per value of.
+constexpr char const* returnAttribute = "returnNumber";
+constexpr char const* classAttribute = "classification";
+constexpr char const* lineAttribute = "lineNumber";
+
+double numericValue(std::optional<GenericAttribute> const& value) {
+
+    if (!value.has_value()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    return std::visit([] (auto const& val) -> double {
+
+        using T = std::decay_t<decltype(val)>;
+
+        if constexpr (std::is_arithmetic_v<T>) {
+            return static_cast<double>(val);
+        } else {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+    }, value.value());
+}
+
+/*!
+ * \brief The PointBatch struct hold the numeric values of a batch of points, missing values are nan.
+ */
+struct PointBatch {
+    std::vector<double> positions; //!< 3 per point
+    std::vector<double> attributes; //!< one per attribute per point
+
+    inline size_t size() const {
+        return positions.size()/3;
+    }
+};
+
+/*!
+ * \brief The PartialInfo struct hold the statistics of a subset of the points, in flat arrays indexed by attribute.
+ */
+struct PartialInfo {
+
+    PartialInfo(int nAttributes) :
+        nPoints(0),
+        nPositions(0),
+        min({std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()}),
+        max({-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()}),
+        counts(nAttributes, 0),
+        mins(nAttributes, std::numeric_limits<double>::infinity()),
+        maxs(nAttributes, -std::numeric_limits<double>::infinity())
+    {
+
+    }
+
+    void merge(PartialInfo const& other) {
+
+        nPoints += other.nPoints;
+        nPositions += other.nPositions;
+
+        for (int i = 0; i < 3; i++) {
+            min[i] = std::min(min[i], other.min[i]);
+            max[i] = std::max(max[i], other.max[i]);
+        }
+
+        for (int i = 0; i < counts.size(); i++) {
+            counts[i] += other.counts[i];
+            mins[i] = std::min(mins[i], other.mins[i]);
+            maxs[i] = std::max(maxs[i], other.maxs[i]);
+        }
+
+        for (int c = 0; c < 3; c++) {
+            for (auto const& [value, count] : other.valuesCounts[c]) {
+                valuesCounts[c][value] += count;
+            }
+        }
+    }
+
+    int64_t nPoints;
+    int64_t nPositions; //!< number of points with a finite position
+
+    std::array<double, 3> min;
+    std::array<double, 3> max;
+
+    std::vector<int64_t> counts;
+    std::vector<double> mins;
+    std::vector<double> maxs;
+
+    std::array<std::map<int64_t, int64_t>, 3> valuesCounts; //!< returns, classes and lines
+};
+
+}
+
+PointCloudInfo PointCloudInfo::compute(StereoVision::IO::PointCloudPointAccessInterface & points) {
+
+    PointCloudInfo ret;
+    ret.attributes = points.attributeList();
+
+    int nAttributes = ret.attributes.size();
+
+    //index of the counted attributes, -1 if not present.
+    std::array<int, 3> countedIdxs = {-1, -1, -1};
+    std::array<char const*, 3> countedNames = {returnAttribute, classAttribute, lineAttribute};
+
+    for (int c = 0; c < 3; c++) {
+        auto it = std::find(ret.attributes.begin(), ret.attributes.end(), countedNames[c]);
+        countedIdxs[c] = (it != ret.attributes.end()) ? it - ret.attributes.begin() : -1;
+    }
+
+    auto readBatch = [&points, &ret, nAttributes] (PointBatch & batch) -> bool {
+
+        batch.positions.clear();
+        batch.attributes.clear();
+
+        bool hasMore = points.hasData();
+
+        while (hasMore and batch.size() < batchSize) {
+
+            StereoVision::IO::PtGeometry<double> pos = points.castedPointGeometry<double>();
+            batch.positions.insert(batch.positions.end(), {pos.x, pos.y, pos.z});
+
+            for (int i = 0; i < nAttributes; i++) {
+                batch.attributes.push_back(numericValue(points.getAttributeByName(ret.attributes[i].c_str())));
+            }
+
+            hasMore = points.gotoNext();
+        }
+
+        return hasMore;
+    };
+
+    int nThreads = 1;
+
+    #ifdef _OPENMP
+    nThreads = omp_get_max_threads();
+    #endif
+
+    std::vector<PartialInfo> partials(nThreads, PartialInfo(nAttributes));
+
+    auto reduce = [&partials, &countedIdxs, nAttributes, nThreads] (PointBatch const& batch) {
+
+        int64_t nPoints = batch.size();
+
+        #pragma omp parallel num_threads(nThreads)
+        {
+            int thread = 0;
+
+            #ifdef _OPENMP
+            thread = omp_get_thread_num();
+            #endif
+
+            PartialInfo & partial = partials[thread];
+
+            #pragma omp for schedule(static)
+            for (int64_t p = 0; p < nPoints; p++) {
+
+                partial.nPoints++;
+
+                double const* position = &batch.positions[3*p];
+
+                if (std::isfinite(position[0]) and std::isfinite(position[1]) and std::isfinite(position[2])) {
+
+                    partial.nPositions++;
+
+                    for (int i = 0; i < 3; i++) {
+                        partial.min[i] = std::min(partial.min[i], position[i]);
+                        partial.max[i] = std::max(partial.max[i], position[i]);
+                    }
+                }
+
+                double const* values = batch.attributes.data() + nAttributes*p;
+
+                for (int i = 0; i < nAttributes; i++) {
+
+                    if (std::isnan(values[i])) {
+                        continue;
+                    }
+
+                    partial.counts[i]++;
+                    partial.mins[i] = std::min(partial.mins[i], values[i]);
+                    partial.maxs[i] = std::max(partial.maxs[i], values[i]);
+                }
+
+                for (int c = 0; c < 3; c++) {
+                    if (countedIdxs[c] >= 0 and !std::isnan(values[countedIdxs[c]])) {
+                        partial.valuesCounts[c][static_cast<int64_t>(values[countedIdxs[c]])]++;
+                    }
+                }
+            }
+        }
+    };
+
+    //the next batch is read while the current one is reduced.
+    PointBatch current;
+    PointBatch next;
+
+    bool hasMore = readBatch(current);
+
+    while (current.size() > 0) {
+
+        std::future<void> reducing = std::async(std::launch::async, reduce, std::cref(current));
+
+        next.positions.clear();
+
+        if (hasMore) {
+            hasMore = readBatch(next);
+        }
+
+        reducing.get();
+        std::swap(current, next);
+    }
+
+    for (int t = 1; t < nThreads; t++) {
+        partials[0].merge(partials[t]);
+    }
+
+    PartialInfo const& total = partials[0];
+
+    ret.nPoints = total.nPoints;
+
+    if (total.nPositions > 0) {
+        ret.min = total.min;
+        ret.max = total.max;
+    }
+
+    for (int i = 0; i < nAttributes; i++) {
+        if (total.counts[i] > 0) {
+            ret.ranges[ret.attributes[i]] = AttributeRange{total.counts[i], total.mins[i], total.maxs[i]};
+        }
+    }
+
+    ret.returnsCounts = total.valuesCounts[0];
+    ret.classesCounts = total.valuesCounts[1];
+    ret.linesCounts = total.valuesCounts[2];
+
+    return ret;
+}
+
+std::optional<PointCloudInfo> PointCloudInfo::forFile(std::filesystem::path const& path, bool* fromSidecar) {
+
+    if (fromSidecar != nullptr) {
+        *fromSidecar = false;
+    }
+
+    std::optional<PointCloudInfo> cached = PointCloudInfo::fromSidecar(path);
+
+    if (cached.has_value()) {
+
+        if (fromSidecar != nullptr) {
+            *fromSidecar = true;
+        }
+
+        return cached;
+    }
+
+    uintmax_t size;
+    int64_t time;
+
+    if (!fileKey(path, size, time)) {
+        return std::nullopt;
+    }
+
+    auto pointCloud = openPointCloudByContent(path);
+
+    if (!pointCloud.has_value() or pointCloud.value().pointAccess == nullptr) {
+        return std::nullopt;
+    }
+
+    PointCloudInfo ret = compute(*pointCloud.value().pointAccess);
+    ret.fileSize = size;
+    ret.fileTime = time;
+
+    //the sidecar is only a cache, the statistics are still valid if it cannot be written (e.g. in a read only directory).
+    ret.writeSidecar(path);
+
+    return ret;
+}
+
+std::filesystem::path PointCloudInfo::sidecarPath(std::filesystem::path const& path) {
+    std::filesystem::path ret = path;
+    ret += ".ldminfo";
+    return ret;
+}
+
+bool PointCloudInfo::fileKey(std::filesystem::path const& path, uintmax_t & size, int64_t & time) {
+
+    std::error_code ec;
+
+    if (!std::filesystem::is_regular_file(path, ec)) {
+        return false;
+    }
+
+    size = std::filesystem::file_size(path, ec);
+
+    if (ec) {
+        return false;
+    }
+
+    std::filesystem::file_time_type fileTime = std::filesystem::last_write_time(path, ec);
+
+    if (ec) {
+        return false;
+    }
+
+    time = fileTime.time_since_epoch().count();
+
+    return true;
+}
+
+std::optional<PointCloudInfo> PointCloudInfo::fromSidecar(std::filesystem::path const& path) {
+
+    uintmax_t size;
+    int64_t time;
+
+    if (!fileKey(path, size, time)) {
+        return std::nullopt;
+    }
+
+    std::ifstream in(sidecarPath(path));
+
+    if (!in.is_open()) {
+        return std::nullopt;
+    }
+
+    std::optional<PointCloudInfo> ret = read(in);
+
+    if (!ret.has_value() or ret->fileSize != size or ret->fileTime != time) {
+        return std::nullopt;
+    }
+
+    return ret;
+}
+
+bool PointCloudInfo::writeSidecar(std::filesystem::path const& path) const {
+
+    std::filesystem::path sidecar = sidecarPath(path);
+    std::filesystem::path tmp = sidecar;
+    tmp += ".tmp";
+
+    //written to a temporary file first, so that concurrent readers never see a partial sidecar.
+    {
+        std::ofstream out(tmp);
+
+        if (!out.is_open() or !write(out)) {
+            std::error_code ec;
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, sidecar, ec);
+
+    return !ec;
+}
+
+bool PointCloudInfo::write(std::ostream & out) const {
+
+    //one record per line, the attribute names are assumed not to contain spaces.
+    out << std::setprecision(17);
+
+    out << "ldminfo " << sidecarVersion << "\n";
+    out << "file " << fileSize << " " << fileTime << "\n";
+    out << "points " << nPoints << "\n";
+    out << "bounds " << min[0] << " " << min[1] << " " << min[2] << " " << max[0] << " " << max[1] << " " << max[2] << "\n";
+
+    for (std::string const& name : attributes) {
+        out << "attribute " << name << "\n";
+    }
+
+    for (auto const& [name, range] : ranges) {
+        out << "range " << name << " " << range.count << " " << range.min << " " << range.max << "\n";
+    }
+
+    for (auto const& [value, count] : returnsCounts) {
+        out << "return " << value << " " << count << "\n";
+    }
+
+    for (auto const& [value, count] : classesCounts) {
+        out << "class " << value << " " << count << "\n";
+    }
+
+    for (auto const& [value, count] : linesCounts) {
+        out << "line " << value << " " << count << "\n";
+    }
+
+    out << "end\n";
+
+    return bool(out);
+}
+
+std::optional<PointCloudInfo> PointCloudInfo::read(std::istream & in) {
+
+    PointCloudInfo ret;
+
+    std::string line;
+
+    if (!std::getline(in, line)) {
+        return std::nullopt;
+    }
+
+    std::istringstream header(line);
+    std::string magic;
+    int version;
+
+    if (!(header >> magic >> version) or magic != "ldminfo" or version != sidecarVersion) {
+        return std::nullopt;
+    }
+
+    while (std::getline(in, line)) {
+
+        std::istringstream record(line);
+        std::string type;
+
+        record >> type;
+
+        bool ok = true;
+
+        if (type == "end") {
+            return ret;
+        } else if (type == "file") {
+            ok = bool(record >> ret.fileSize >> ret.fileTime);
+        } else if (type == "points") {
+            ok = bool(record >> ret.nPoints);
+        } else if (type == "bounds") {
+            ok = bool(record >> ret.min[0] >> ret.min[1] >> ret.min[2] >> ret.max[0] >> ret.max[1] >> ret.max[2]);
+        } else if (type == "attribute") {
+            std::string name;
+            ok = bool(record >> name);
+            ret.attributes.push_back(name);
+        } else if (type == "range") {
+            std::string name;
+            AttributeRange range;
+            ok = bool(record >> name >> range.count >> range.min >> range.max);
+            ret.ranges[name] = range;
+        } else if (type == "return" or type == "class" or type == "line") {
+
+            int64_t value;
+            int64_t count;
+            ok = bool(record >> value >> count);
+
+            std::map<int64_t, int64_t> & counts = (type == "return") ? ret.returnsCounts : (type == "class") ? ret.classesCounts : ret.linesCounts;
+            counts[value] = count;
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            return std::nullopt;
+        }
+    }
+
+    //a sidecar without end record is truncated.
+    return std::nullopt;
+}
+
+std::string PointCloudInfo::jsonEscape(std::string const& str) {
+
+    std::string ret;
+    ret.reserve(str.size());
+
+    for (char c : str) {
+
+        switch (c) {
+        case '"':
+            ret += "\\\"";
+            break;
+        case '\\':
+            ret += "\\\\";
+            break;
+        case '\n':
+            ret += "\\n";
+            break;
+        case '\r':
+            ret += "\\r";
+            break;
+        case '\t':
+            ret += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned char>(c));
+                ret += buffer;
+            } else {
+                ret.push_back(c);
+            }
+        }
+    }
+
+    return ret;
+}
+
+void PointCloudInfo::writeJson(std::ostream & out) const {
+
+    auto writeCounts = [&out] (std::map<int64_t, int64_t> const& counts) {
+
+        out << "{";
+
+        bool first = true;
+
+        for (auto const& [value, count] : counts) {
+            out << ((first) ? "" : ",") << "\"" << value << "\":" << count;
+            first = false;
+        }
+
+        out << "}";
+    };
+
+    out << std::setprecision(17);
+
+    out << "{\"points\":" << nPoints;
+    out << ",\"bounds\":{\"min\":[" << min[0] << "," << min[1] << "," << min[2] << "]"
+        << ",\"max\":[" << max[0] << "," << max[1] << "," << max[2] << "]}";
+
+    out << ",\"attributes\":{";
+
+    for (int i = 0; i < attributes.size(); i++) {
+
+        out << ((i > 0) ? "," : "") << "\"" << jsonEscape(attributes[i]) << "\":";
+
+        auto it = ranges.find(attributes[i]);
+
+        if (it == ranges.end()) {
+            out << "{\"count\":0}";
+            continue;
+        }
+
+        out << "{\"count\":" << it->second.count << ",\"min\":" << it->second.min << ",\"max\":" << it->second.max << "}";
+    }
+
+    out << "}";
+
+    out << ",\"returns\":";
+    writeCounts(returnsCounts);
+    out << ",\"classes\":";
+    writeCounts(classesCounts);
+    out << ",\"lines\":";
+    writeCounts(linesCounts);
+
+    out << "}";
+}
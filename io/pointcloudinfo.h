@@ -0,0 +1,115 @@
+#ifndef POINTCLOUDINFO_H
+#define POINTCLOUDINFO_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+/*!
+ * \brief The PointCloudInfo class hold the statistics of a point cloud.
+ *
+ * The statistics are the number of points, the bounds, the range of each numeric attribute,
+ * and the number of points per return number, per class and per line.
+ *
+ * They are computed in a single pass, the points being read in batches and each batch being reduced in parallel.
+ * The statistics of a file can be cached in a small sidecar file (the path of the file with the ".ldminfo" extension appended),
+ * which is valid as long as the size and the modification time of the file do not change.
+ */
+class PointCloudInfo
+{
+public:
+
+    struct AttributeRange {
+        int64_t count = 0; //!< the number of points with a numeric value for the attribute.
+        double min = 0;
+        double max = 0;
+    };
+
+    /*!
+     * \brief compute compute the statistics of a point cloud.
+     * \param points the points, read until the end.
+     */
+    static PointCloudInfo compute(StereoVision::IO::PointCloudPointAccessInterface & points);
+
+    /*!
+     * \brief forFile get the statistics of a file, from its sidecar if it is up to date, else by reading the file (the sidecar is then updated).
+     * \param path the path to the file.
+     * \param fromSidecar if not nullptr, set to true if the statistics were read from the sidecar.
+     * \return the statistics, or std::nullopt if the file could not be read.
+     */
+    static std::optional<PointCloudInfo> forFile(std::filesystem::path const& path, bool* fromSidecar = nullptr);
+
+    /*!
+     * \brief fromSidecar read the statistics of a file from its sidecar.
+     * \return the statistics, or std::nullopt if there is no sidecar or it is outdated.
+     */
+    static std::optional<PointCloudInfo> fromSidecar(std::filesystem::path const& path);
+
+    /*!
+     * \brief writeSidecar write the statistics of a file to its sidecar.
+     * \return true on success, false otherwise.
+     */
+    bool writeSidecar(std::filesystem::path const& path) const;
+
+    static std::filesystem::path sidecarPath(std::filesystem::path const& path);
+
+    /*!
+     * \brief writeJson write the statistics as a json object.
+     */
+    void writeJson(std::ostream & out) const;
+
+    /*!
+     * \brief jsonEscape escape a string to be written in a json string (quotes, backslashes and control characters).
+     */
+    static std::string jsonEscape(std::string const& str);
+
+    bool write(std::ostream & out) const;
+    static std::optional<PointCloudInfo> read(std::istream & in);
+
+    int64_t nPoints = 0;
+
+    std::array<double, 3> min = {0, 0, 0};
+    std::array<double, 3> max = {0, 0, 0};
+
+    std::vector<std::string> attributes;
+    std::map<std::string, AttributeRange> ranges;
+
+    std::map<int64_t, int64_t> returnsCounts;
+    std::map<int64_t, int64_t> classesCounts;
+    std::map<int64_t, int64_t> linesCounts;
+
+    //key of the file the statistics were computed from.
+    uintmax_t fileSize = 0;
+    int64_t fileTime = 0;
+
+protected:
+
+    static bool fileKey(std::filesystem::path const& path, uintmax_t & size, int64_t & time);
+};
+
+#endif // POINTCLOUDINFO_H
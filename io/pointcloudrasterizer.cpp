@@ -0,0 +1,603 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pointcloudrasterizer.h"
+
+#include "../processingBlocks/spatialkeys.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+#include <unordered_map>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+using GenericAttribute = StereoVision::IO::PointCloudGenericAttribute;
+
+constexpr size_t batchSize = 1 << 16;
+
+//the cells are accumulated in square blocks of blockSize x blockSize cells.
+constexpr int64_t blockSize = 64;
+constexpr int64_t blockCells = blockSize*blockSize;
+
+inline int64_t floorDiv(int64_t a, int64_t b) {
+    int64_t q = a/b;
+    return (a%b != 0 and (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+struct BlockIndex {
+    int64_t x;
+    int64_t y;
+
+    inline bool operator==(BlockIndex const& other) const {
+        return x == other.x and y == other.y;
+    }
+};
+
+struct BlockIndexHash {
+    inline size_t operator()(BlockIndex const& idx) const {
+        return SpatialKeys::mix(uint64_t(idx.x)*0x9e3779b97f4a7c15 ^ uint64_t(idx.y));
+    }
+};
+
+double numericValue(std::optional<GenericAttribute> const& value) {
+
+    if (!value.has_value()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    return std::visit([] (auto const& val) -> double {
+
+        using T = std::decay_t<decltype(val)>;
+
+        if constexpr (std::is_arithmetic_v<T>) {
+            return static_cast<double>(val);
+        } else {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+    }, value.value());
+}
+
+/*!
+ * \brief The PointBatch struct hold the cells and values of a batch of points, missing values are nan.
+ */
+struct PointBatch {
+    std::vector<int64_t> cells; //!< 2 per point
+    std::vector<double> values; //!< one per product per point
+
+    inline size_t size() const {
+        return cells.size()/2;
+    }
+};
+
+}
+
+/*!
+ * \brief The BlockGrid class accumulate the statistics of the cells, in sparse blocks.
+ */
+class PointCloudRasterizer::BlockGrid {
+public:
+
+    struct Block {
+        std::vector<double> values; //!< one per product per cell
+        std::vector<uint32_t> counts; //!< one per product per cell
+    };
+
+    BlockGrid(std::vector<Statistic> const& statistics) :
+        xMin(std::numeric_limits<int64_t>::max()),
+        xMax(std::numeric_limits<int64_t>::min()),
+        yMin(std::numeric_limits<int64_t>::max()),
+        yMax(std::numeric_limits<int64_t>::min()),
+        _statistics(statistics)
+    {
+
+    }
+
+    inline int nProducts() const {
+        return _statistics.size();
+    }
+
+    inline bool empty() const {
+        return blocks.empty();
+    }
+
+    Block& block(BlockIndex const& idx) {
+
+        auto it = blocks.find(idx);
+
+        if (it != blocks.end()) {
+            return it->second;
+        }
+
+        Block & block = blocks[idx];
+        block.values.resize(nProducts()*blockCells);
+        block.counts.resize(nProducts()*blockCells, 0);
+
+        for (int p = 0; p < nProducts(); p++) {
+
+            double init = 0;
+
+            if (_statistics[p] == Min) {
+                init = std::numeric_limits<double>::infinity();
+            } else if (_statistics[p] == Max) {
+                init = -std::numeric_limits<double>::infinity();
+            }
+
+            std::fill(block.values.begin() + p*blockCells, block.values.begin() + (p+1)*blockCells, init);
+        }
+
+        return block;
+    }
+
+    inline void accumulate(int p, double & acc, double value) const {
+
+        switch (_statistics[p]) {
+        case Min:
+            acc = std::min(acc, value);
+            break;
+        case Max:
+            acc = std::max(acc, value);
+            break;
+        case Mean:
+        case Count:
+            acc += value;
+            break;
+        }
+    }
+
+    void add(int64_t cx, int64_t cy, double const* values) {
+
+        BlockIndex idx{floorDiv(cx, blockSize), floorDiv(cy, blockSize)};
+        Block & b = block(idx);
+
+        int64_t cell = (cy - idx.y*blockSize)*blockSize + (cx - idx.x*blockSize);
+
+        for (int p = 0; p < nProducts(); p++) {
+
+            if (std::isnan(values[p])) {
+                continue;
+            }
+
+            accumulate(p, b.values[p*blockCells + cell], values[p]);
+            b.counts[p*blockCells + cell]++;
+        }
+
+        xMin = std::min(xMin, cx);
+        xMax = std::max(xMax, cx);
+        yMin = std::min(yMin, cy);
+        yMax = std::max(yMax, cy);
+    }
+
+    void merge(BlockGrid const& other) {
+
+        for (auto const& [idx, otherBlock] : other.blocks) {
+
+            Block & b = block(idx);
+
+            for (int p = 0; p < nProducts(); p++) {
+                for (int64_t c = p*blockCells; c < (p+1)*blockCells; c++) {
+
+                    if (otherBlock.counts[c] == 0) {
+                        continue;
+                    }
+
+                    accumulate(p, b.values[c], otherBlock.values[c]);
+                    b.counts[c] += otherBlock.counts[c];
+                }
+            }
+        }
+
+        xMin = std::min(xMin, other.xMin);
+        xMax = std::max(xMax, other.xMax);
+        yMin = std::min(yMin, other.yMin);
+        yMax = std::max(yMax, other.yMax);
+    }
+
+    std::unordered_map<BlockIndex, Block, BlockIndexHash> blocks;
+
+    //extent of the cells containing points.
+    int64_t xMin;
+    int64_t xMax;
+    int64_t yMin;
+    int64_t yMax;
+
+protected:
+    std::vector<Statistic> _statistics;
+};
+
+std::optional<PointCloudRasterizer::Product> PointCloudRasterizer::parseProduct(std::string const& definition) {
+
+    if (definition == "zmin") {
+        return Product{definition, Min, ""};
+    } else if (definition == "zmax") {
+        return Product{definition, Max, ""};
+    } else if (definition == "zmean") {
+        return Product{definition, Mean, ""};
+    } else if (definition == "intensity") {
+        return Product{definition, Mean, "intensity"};
+    } else if (definition == "count") {
+        return Product{definition, Count, ""};
+    }
+
+    size_t sep = definition.find(':');
+
+    if (sep == std::string::npos or sep + 1 >= definition.size()) {
+        return std::nullopt;
+    }
+
+    std::string statistic = definition.substr(0, sep);
+    std::string attribute = definition.substr(sep+1);
+    std::string name = statistic + "_" + attribute;
+
+    if (statistic == "min") {
+        return Product{name, Min, attribute};
+    } else if (statistic == "max") {
+        return Product{name, Max, attribute};
+    } else if (statistic == "mean") {
+        return Product{name, Mean, attribute};
+    }
+
+    return std::nullopt;
+}
+
+std::optional<std::vector<PointCloudRasterizer::Product>> PointCloudRasterizer::parseProducts(std::string const& definitions) {
+
+    std::vector<Product> ret;
+
+    std::stringstream stream(definitions);
+    std::string definition;
+
+    while (std::getline(stream, definition, ',')) {
+
+        std::optional<Product> product = parseProduct(definition);
+
+        if (!product.has_value()) {
+            return std::nullopt;
+        }
+
+        ret.push_back(product.value());
+    }
+
+    if (ret.empty()) {
+        return std::nullopt;
+    }
+
+    return ret;
+}
+
+namespace {
+
+std::vector<PointCloudRasterizer::Statistic> statistics(std::vector<PointCloudRasterizer::Product> const& products) {
+
+    std::vector<PointCloudRasterizer::Statistic> ret;
+    ret.reserve(products.size());
+
+    for (PointCloudRasterizer::Product const& product : products) {
+        ret.push_back(product.statistic);
+    }
+
+    return ret;
+}
+
+}
+
+PointCloudRasterizer::PointCloudRasterizer(double cellSize, std::vector<Product> const& products) :
+    _cellSize(cellSize),
+    _products(products),
+    _grid(std::make_unique<BlockGrid>(statistics(products)))
+{
+
+}
+
+PointCloudRasterizer::~PointCloudRasterizer() {
+
+}
+
+void PointCloudRasterizer::addPoints(StereoVision::IO::PointCloudPointAccessInterface & points) {
+
+    int nProducts = _products.size();
+    double cellSize = _cellSize;
+
+    auto readBatch = [this, &points, nProducts, cellSize] (PointBatch & batch) -> bool {
+
+        constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+        constexpr double limit = 9e18;
+
+        batch.cells.clear();
+        batch.values.clear();
+
+        bool hasMore = points.hasData();
+
+        while (hasMore and batch.size() < batchSize) {
+
+            StereoVision::IO::PtGeometry<double> pos = points.castedPointGeometry<double>();
+
+            double cx = std::floor(pos.x/cellSize);
+            double cy = std::floor(pos.y/cellSize);
+
+            if (!(std::abs(cx) < limit and std::abs(cy) < limit)) {
+                hasMore = points.gotoNext();
+                continue;
+            }
+
+            batch.cells.insert(batch.cells.end(), {int64_t(cx), int64_t(cy)});
+
+            for (Product const& product : _products) {
+
+                //all the points are counted, the value of the count is ignored.
+                if (product.statistic == Count) {
+                    batch.values.push_back(0);
+                    continue;
+                }
+
+                if (product.attribute.empty()) {
+                    batch.values.push_back((std::isfinite(pos.z)) ? pos.z : nan);
+                    continue;
+                }
+
+                batch.values.push_back(numericValue(points.getAttributeByName(product.attribute.c_str())));
+            }
+
+            hasMore = points.gotoNext();
+        }
+
+        return hasMore;
+    };
+
+    int nThreads = 1;
+
+    #ifdef _OPENMP
+    nThreads = omp_get_max_threads();
+    #endif
+
+    //partial grids, one per thread.
+    std::vector<BlockGrid> grids(nThreads, BlockGrid(statistics(_products)));
+
+    auto accumulate = [&grids, nProducts, nThreads] (PointBatch const& batch) {
+
+        int64_t nPoints = batch.size();
+
+        #pragma omp parallel num_threads(nThreads)
+        {
+            int thread = 0;
+
+            #ifdef _OPENMP
+            thread = omp_get_thread_num();
+            #endif
+
+            BlockGrid & grid = grids[thread];
+
+            #pragma omp for schedule(static)
+            for (int64_t i = 0; i < nPoints; i++) {
+                grid.add(batch.cells[2*i], batch.cells[2*i+1], batch.values.data() + nProducts*i);
+            }
+        }
+    };
+
+    //the next batch is read while the current one is binned.
+    PointBatch current;
+    PointBatch next;
+
+    bool hasMore = readBatch(current);
+
+    while (current.size() > 0) {
+
+        std::future<void> accumulating = std::async(std::launch::async, accumulate, std::cref(current));
+
+        next.cells.clear();
+        next.values.clear();
+
+        if (hasMore) {
+            hasMore = readBatch(next);
+        }
+
+        accumulating.get();
+        std::swap(current, next);
+    }
+
+    //merge the partial grids pairwise.
+    for (int stride = 1; stride < nThreads; stride *= 2) {
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < nThreads - stride; i += 2*stride) {
+            grids[i].merge(grids[i+stride]);
+            grids[i+stride] = BlockGrid(statistics(_products));
+        }
+    }
+
+    _grid->merge(grids[0]);
+}
+
+bool PointCloudRasterizer::empty() const {
+    return _grid->empty();
+}
+
+int64_t PointCloudRasterizer::width() const {
+    return (empty()) ? 0 : _grid->xMax - _grid->xMin + 1;
+}
+
+int64_t PointCloudRasterizer::height() const {
+    return (empty()) ? 0 : _grid->yMax - _grid->yMin + 1;
+}
+
+double PointCloudRasterizer::xMin() const {
+    return _grid->xMin*_cellSize;
+}
+
+double PointCloudRasterizer::yMin() const {
+    return _grid->yMin*_cellSize;
+}
+
+bool PointCloudRasterizer::fitsInMemory() const {
+    //compared by division, the product of the extents can overflow.
+    return height() == 0 or width() <= MaxGridCells/height();
+}
+
+Multidim::Array<float, 2> PointCloudRasterizer::grid(int productIdx) const {
+
+    int64_t w = width();
+    int64_t h = height();
+
+    Multidim::Array<float, 2> ret(w, h);
+
+    Statistic statistic = _products[productIdx].statistic;
+    float empty = (statistic == Count) ? 0 : NoData;
+
+    #pragma omp parallel for
+    for (int64_t i = 0; i < w; i++) {
+        for (int64_t j = 0; j < h; j++) {
+            ret.atUnchecked(i, j) = empty;
+        }
+    }
+
+    std::vector<BlockIndex> blocks;
+    blocks.reserve(_grid->blocks.size());
+
+    for (auto const& [idx, block] : _grid->blocks) {
+        blocks.push_back(idx);
+    }
+
+    //each block cover distinct cells, so they can be written in parallel.
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < blocks.size(); b++) {
+
+        BlockIndex const& idx = blocks[b];
+        BlockGrid::Block const& block = _grid->blocks.at(idx);
+
+        for (int64_t c = 0; c < blockCells; c++) {
+
+            int64_t cell = productIdx*blockCells + c;
+            uint32_t count = block.counts[cell];
+
+            if (count == 0) {
+                continue;
+            }
+
+            int64_t cx = idx.x*blockSize + c%blockSize;
+            int64_t cy = idx.y*blockSize + c/blockSize;
+
+            double value = block.values[cell];
+
+            if (statistic == Mean) {
+                value /= count;
+            } else if (statistic == Count) {
+                value = count;
+            }
+
+            //the rows are ordered north to south.
+            ret.atUnchecked(cx - _grid->xMin, _grid->yMax - cy) = value;
+        }
+    }
+
+    return ret;
+}
+
+bool PointCloudRasterizer::writeEsriGrids(std::filesystem::path const& basePath) const {
+
+    if (empty()) {
+        std::cerr << "No points to rasterize!" << std::endl;
+        return false;
+    }
+
+    if (!fitsInMemory()) {
+        std::cerr << "The grids would have " << width() << "x" << height() << " cells, more than the limit of " << MaxGridCells
+                  << ", use a larger --raster-cell or restrict the extent of the points (e.g. with --roi)!" << std::endl;
+        return false;
+    }
+
+    std::filesystem::path base = basePath;
+
+    if (base.extension() == ".flt") {
+        base.replace_extension();
+    }
+
+    for (int p = 0; p < _products.size(); p++) {
+
+        std::filesystem::path fltPath = base;
+        fltPath += "_" + _products[p].name + ".flt";
+
+        if (!writeEsriGrid(fltPath, grid(p), xMin(), yMin(), _cellSize)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool PointCloudRasterizer::writeEsriGrid(std::filesystem::path const& fltPath,
+                                         Multidim::Array<float, 2> const& grid,
+                                         double xll,
+                                         double yll,
+                                         double cellSize) {
+
+    int64_t w = grid.shape()[0];
+    int64_t h = grid.shape()[1];
+
+    std::filesystem::path hdrPath = fltPath;
+    hdrPath.replace_extension(".hdr");
+
+    std::ofstream hdr(hdrPath);
+
+    if (!hdr.is_open()) {
+        std::cerr << "Could not open " << hdrPath << "!" << std::endl;
+        return false;
+    }
+
+    hdr << std::setprecision(15);
+    hdr << "ncols " << w << "\n";
+    hdr << "nrows " << h << "\n";
+    hdr << "xllcorner " << xll << "\n";
+    hdr << "yllcorner " << yll << "\n";
+    hdr << "cellsize " << cellSize << "\n";
+    hdr << "NODATA_value " << NoData << "\n";
+    hdr << "byteorder LSBFIRST\n";
+
+    if (!hdr) {
+        return false;
+    }
+
+    std::ofstream flt(fltPath, std::ios_base::binary);
+
+    if (!flt.is_open()) {
+        std::cerr << "Could not open " << fltPath << "!" << std::endl;
+        return false;
+    }
+
+    std::vector<float> row(w);
+
+    for (int64_t j = 0; j < h; j++) {
+
+        for (int64_t i = 0; i < w; i++) {
+            row[i] = grid.atUnchecked(i, j);
+        }
+
+        flt.write(reinterpret_cast<const char*>(row.data()), w*sizeof(float));
+    }
+
+    return bool(flt);
+}
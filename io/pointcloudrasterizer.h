@@ -0,0 +1,155 @@
+#ifndef POINTCLOUDRASTERIZER_H
+#define POINTCLOUDRASTERIZER_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <MultidimArrays/MultidimArrays.h>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+/*!
+ * \brief The PointCloudRasterizer class bin the points of a point cloud in one or more grids at once.
+ *
+ * Each grid (product) is a statistic (min, max, mean or count) of the height or of an attribute of the points in each cell.
+ * The cells are aligned on multiples of the cell size. The extent of the grids does not need to be known in advance,
+ * the cells are accumulated in sparse blocks, which are assembled in dense grids at the end.
+ *
+ * The points are read in batches, each batch is binned in parallel in partial grids (one per thread), merged at the end.
+ */
+class PointCloudRasterizer
+{
+public:
+
+    enum Statistic {
+        Min = 0,
+        Max = 1,
+        Mean = 2,
+        Count = 3
+    };
+
+    struct Product {
+        std::string name;
+        Statistic statistic;
+        std::string attribute; //!< the attribute the statistic is computed on, empty for the height of the points.
+    };
+
+    static constexpr float NoData = -9999;
+
+    //the grids are assembled densely over the extent of the points, larger grids (4 GiB per product) are rejected.
+    static constexpr int64_t MaxGridCells = int64_t(1) << 30;
+
+    /*!
+     * \brief parseProduct parse a product definition
+     * \param definition either "zmin", "zmax", "zmean", "intensity" (mean intensity), "count",
+     * or "<statistic>:<attribute>" with statistic being "min", "max" or "mean".
+     * \return the product, or std::nullopt if the definition is invalid.
+     */
+    static std::optional<Product> parseProduct(std::string const& definition);
+
+    /*!
+     * \brief parseProducts parse a comma separated list of product definitions.
+     */
+    static std::optional<std::vector<Product>> parseProducts(std::string const& definitions);
+
+    PointCloudRasterizer(double cellSize, std::vector<Product> const& products);
+    ~PointCloudRasterizer();
+
+    /*!
+     * \brief addPoints bin the points of a point cloud.
+     * \param points the points, read until the end.
+     */
+    void addPoints(StereoVision::IO::PointCloudPointAccessInterface & points);
+
+    inline std::vector<Product> const& products() const {
+        return _products;
+    }
+
+    inline double cellSize() const {
+        return _cellSize;
+    }
+
+    /*!
+     * \brief empty indicate if no point has been binned.
+     */
+    bool empty() const;
+
+    int64_t width() const;
+    int64_t height() const;
+
+    /*!
+     * \brief xMin the x coordinate of the left border of the grids.
+     */
+    double xMin() const;
+    /*!
+     * \brief yMin the y coordinate of the bottom border of the grids.
+     */
+    double yMin() const;
+
+    /*!
+     * \brief grid assemble the grid of a product.
+     * \param productIdx the index of the product.
+     * \return the grid, indexed by column then row, the first row being the northernmost one.
+     * The cells without points are NoData, except for the count product, where they are 0.
+     * The grid is allocated densely, see fitsInMemory.
+     */
+    Multidim::Array<float, 2> grid(int productIdx) const;
+
+    /*!
+     * \brief fitsInMemory indicate if the extent of the points has at most MaxGridCells cells.
+     */
+    bool fitsInMemory() const;
+
+    /*!
+     * \brief writeEsriGrids write each product as an ESRI float grid.
+     * \param basePath the base path, the name of each product is appended to it, e.g. "dem" gives "dem_zmin.flt" and "dem_zmin.hdr".
+     * \return true on success, false otherwise (including when the grids would have more than MaxGridCells cells).
+     */
+    bool writeEsriGrids(std::filesystem::path const& basePath) const;
+
+    /*!
+     * \brief writeEsriGrid write a grid as an ESRI float grid, a raw little endian float32 file (.flt) with a text georeferencing header (.hdr).
+     * \param fltPath the path to the .flt file, the .hdr file is written next to it.
+     * \param grid the grid, indexed by column then row, the first row being the northernmost one.
+     * \param xll the x coordinate of the lower left corner of the grid.
+     * \param yll the y coordinate of the lower left corner of the grid.
+     * \param cellSize the size of the cells.
+     * \return true on success, false otherwise.
+     */
+    static bool writeEsriGrid(std::filesystem::path const& fltPath,
+                              Multidim::Array<float, 2> const& grid,
+                              double xll,
+                              double yll,
+                              double cellSize);
+
+protected:
+
+    class BlockGrid;
+
+    double _cellSize;
+    std::vector<Product> _products;
+
+    std::unique_ptr<BlockGrid> _grid;
+};
+
+#endif // POINTCLOUDRASTERIZER_H
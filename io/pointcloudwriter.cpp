@@ -0,0 +1,82 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pointcloudwriter.h"
+
+#include "asciipointcloudwriter.h"
+#include "ldmcpointcloud.h"
+#include "plypointcloud.h"
+
+#ifdef LDM_WITH_ARROW
+#include "arrowwriter.h"
+#endif
+
+#include <StereoVision/io/las_pointcloud_io.h>
+#include <StereoVision/io/pcd_pointcloud_io.h>
+
+bool writePointCloud(std::filesystem::path const& outFile,
+                     StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack,
+                     std::string const& outFormat) {
+
+    std::optional<AsciiPointCloud::Format> asciiFormat = AsciiPointCloud::formatFromName(outFormat);
+
+    if (asciiFormat.has_value()) {
+        return AsciiPointCloud::writePointCloudAscii(outFile, pointCloudStack, asciiFormat.value());
+    } else if (outFormat == "lasv14") {
+        return StereoVision::IO::writePointCloudLas(outFile, pointCloudStack);
+    } else if (outFormat == "ply") {
+        return Ply::writePointCloudPly(outFile, pointCloudStack);
+    } else if (outFormat == "ldmc") {
+        return Ldmc::writePointCloudLdmc(outFile, pointCloudStack);
+    }
+    #ifdef LDM_WITH_ZSTD
+    else if (outFormat == "ldmc-zstd") {
+        return Ldmc::writePointCloudLdmc(outFile, pointCloudStack, true);
+    }
+    #endif
+    #ifdef LDM_WITH_ARROW
+    else if (outFormat == "arrow") {
+        return ArrowIpc::writePointCloudArrow(outFile, pointCloudStack);
+    }
+    #endif
+    else if (outFormat == "pcd-bin") {
+        return StereoVision::IO::writePointCloudPcd(outFile, pointCloudStack, StereoVision::IO::PcdDataStorageType::binary);
+    }
+
+    return false;
+}
+
+bool isStreamableFormat(std::string const& outFormat) {
+    return outFormat == "xyz" or outFormat == "csv" or outFormat == "pcd-ascii";
+}
+
+bool writePointCloud(std::ostream & out,
+                     StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack,
+                     std::string const& outFormat) {
+
+    if (!isStreamableFormat(outFormat)) {
+        return false;
+    }
+
+    std::optional<AsciiPointCloud::Format> asciiFormat = AsciiPointCloud::formatFromName(outFormat);
+
+    if (!asciiFormat.has_value()) {
+        return false;
+    }
+
+    return AsciiPointCloud::writePointCloudAscii(out, pointCloudStack, asciiFormat.value());
+}
@@ -0,0 +1,57 @@
+#ifndef POINTCLOUDWRITER_H
+#define POINTCLOUDWRITER_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <filesystem>
+#include <ostream>
+#include <string>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+/*!
+ * \brief writePointCloud write a point cloud to a file in a given format.
+ * \param outFile the file to write to
+ * \param pointCloudStack the point cloud to write
+ * \param outFormat the output format, one of "lasv14", "pcd-ascii", "pcd-bin", "ply", "xyz", "csv" or "arrow" (if built with Arrow).
+ * \return true on success, false otherwise.
+ */
+bool writePointCloud(std::filesystem::path const& outFile,
+                     StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack,
+                     std::string const& outFormat);
+
+/*!
+ * \brief isStreamableFormat indicate if a format is written sequentially, and can be written to a stream which is not seekable (e.g. a pipe).
+ *
+ * The ascii pcd format is written sequentially too, its points being formatted to a temporary file until its header can be written.
+ * The other formats patch their header (e.g. the number of points) once all the points are written.
+ */
+bool isStreamableFormat(std::string const& outFormat);
+
+/*!
+ * \brief writePointCloud write a point cloud to an output stream in a streamable format.
+ * \param out the stream to write to
+ * \param pointCloudStack the point cloud to write
+ * \param outFormat the output format, see isStreamableFormat.
+ * \return true on success, false otherwise (including if the format is not streamable).
+ */
+bool writePointCloud(std::ostream & out,
+                     StereoVision::IO::FullPointCloudAccessInterface & pointCloudStack,
+                     std::string const& outFormat);
+
+#endif // POINTCLOUDWRITER_H
@@ -0,0 +1,368 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pointspool.h"
+
+#include <cstdint>
+#include <type_traits>
+
+namespace {
+
+constexpr uint8_t missingTypeIdx = 0xFF;
+
+template<typename T>
+struct IsVector : std::false_type {};
+
+template<typename T>
+struct IsVector<std::vector<T>> : std::true_type {};
+
+template<typename T>
+inline void writeRaw(std::string & out, T const& val) {
+    out.append(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+template<typename T>
+inline bool readRaw(std::istream & in, T & val) {
+    in.read(reinterpret_cast<char*>(&val), sizeof(T));
+    return bool(in);
+}
+
+template<typename T>
+constexpr bool isSerializable() {
+    if constexpr (std::is_arithmetic_v<T> or std::is_same_v<T, std::string>) {
+        return true;
+    } else if constexpr (IsVector<T>::value) {
+        return std::is_arithmetic_v<typename T::value_type> and !std::is_same_v<typename T::value_type, bool>;
+    }
+    return false;
+}
+
+template<typename T>
+void writeValue(std::string & out, T const& val) {
+
+    if constexpr (std::is_arithmetic_v<T>) {
+        writeRaw(out, val);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        writeRaw(out, static_cast<uint32_t>(val.size()));
+        out.append(val);
+    } else if constexpr (isSerializable<T>()) {
+        writeRaw(out, static_cast<uint32_t>(val.size()));
+        out.append(reinterpret_cast<const char*>(val.data()), val.size()*sizeof(typename T::value_type));
+    }
+}
+
+template<typename T>
+bool readValue(std::istream & in, T & val) {
+
+    if constexpr (std::is_arithmetic_v<T>) {
+        return readRaw(in, val);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        uint32_t size;
+        if (!readRaw(in, size)) {
+            return false;
+        }
+        val.resize(size);
+        in.read(val.data(), size);
+        return bool(in);
+    } else if constexpr (isSerializable<T>()) {
+        uint32_t size;
+        if (!readRaw(in, size)) {
+            return false;
+        }
+        val.resize(size);
+        in.read(reinterpret_cast<char*>(val.data()), size*sizeof(typename T::value_type));
+        return bool(in);
+    }
+    return false;
+}
+
+template<size_t I = 0>
+bool readAlternative(std::istream & in, size_t idx, StereoVision::IO::PointCloudGenericAttribute & out) {
+
+    using VariantT = StereoVision::IO::PointCloudGenericAttribute;
+
+    if constexpr (I < std::variant_size_v<VariantT>) {
+
+        if (idx == I) {
+            std::variant_alternative_t<I, VariantT> val;
+            if (!readValue(in, val)) {
+                return false;
+            }
+            out.template emplace<I>(std::move(val));
+            return true;
+        }
+
+        return readAlternative<I+1>(in, idx, out);
+    }
+
+    return false;
+}
+
+}
+
+SpooledPoint SpooledPoint::fromInterface(StereoVision::IO::PointCloudPointAccessInterface const& src,
+                                         std::vector<std::string> const& schema) {
+
+    SpooledPoint ret;
+
+    ret.xyz = src.castedPointGeometry<double>();
+    ret.rgba = src.getPointColor();
+
+    ret.attributes.resize(schema.size());
+
+    for (int i = 0; i < schema.size(); i++) {
+        ret.attributes[i] = src.getAttributeByName(schema[i].c_str());
+    }
+
+    return ret;
+}
+
+size_t SpooledPoint::approximateSize() const {
+
+    size_t ret = sizeof(SpooledPoint) + attributes.size()*sizeof(std::optional<StereoVision::IO::PointCloudGenericAttribute>);
+
+    for (auto const& attr : attributes) {
+        if (attr.has_value() and std::holds_alternative<std::string>(attr.value())) {
+            ret += std::get<std::string>(attr.value()).capacity();
+        }
+    }
+
+    return ret;
+}
+
+namespace PointSpool {
+
+void writeAttribute(std::string & out, std::optional<StereoVision::IO::PointCloudGenericAttribute> const& attribute) {
+
+    if (!attribute.has_value()) {
+        writeRaw(out, missingTypeIdx);
+        return;
+    }
+
+    std::visit([&out, &attribute] (auto const& val) {
+        using T = std::decay_t<decltype (val)>;
+
+        if constexpr (isSerializable<T>()) {
+            writeRaw(out, static_cast<uint8_t>(attribute->index()));
+            writeValue(out, val);
+        } else {
+            writeRaw(out, missingTypeIdx);
+        }
+    }, attribute.value());
+}
+
+bool readAttribute(std::istream & in, std::optional<StereoVision::IO::PointCloudGenericAttribute> & attribute) {
+
+    uint8_t typeIdx;
+
+    if (!readRaw(in, typeIdx)) {
+        return false;
+    }
+
+    if (typeIdx == missingTypeIdx) {
+        attribute = std::nullopt;
+        return true;
+    }
+
+    StereoVision::IO::PointCloudGenericAttribute val;
+
+    if (!readAlternative(in, typeIdx, val)) {
+        return false;
+    }
+
+    attribute = std::move(val);
+    return true;
+}
+
+void appendRecord(std::string & out, SpooledPoint const& point) {
+
+    writeRaw(out, point.xyz.x);
+    writeRaw(out, point.xyz.y);
+    writeRaw(out, point.xyz.z);
+
+    writeRaw(out, static_cast<uint8_t>(point.rgba.has_value()));
+
+    if (point.rgba.has_value()) {
+        writeAttribute(out, point.rgba->r);
+        writeAttribute(out, point.rgba->g);
+        writeAttribute(out, point.rgba->b);
+        writeAttribute(out, point.rgba->a);
+    }
+
+    for (auto const& attr : point.attributes) {
+        writeAttribute(out, attr);
+    }
+}
+
+void appendRecord(std::string & out,
+                  StereoVision::IO::PointCloudPointAccessInterface const& src,
+                  std::vector<std::string> const& schema) {
+
+    StereoVision::IO::PtGeometry<double> xyz = src.castedPointGeometry<double>();
+
+    writeRaw(out, xyz.x);
+    writeRaw(out, xyz.y);
+    writeRaw(out, xyz.z);
+
+    std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> rgba = src.getPointColor();
+
+    writeRaw(out, static_cast<uint8_t>(rgba.has_value()));
+
+    if (rgba.has_value()) {
+        writeAttribute(out, rgba->r);
+        writeAttribute(out, rgba->g);
+        writeAttribute(out, rgba->b);
+        writeAttribute(out, rgba->a);
+    }
+
+    for (std::string const& name : schema) {
+        writeAttribute(out, src.getAttributeByName(name.c_str()));
+    }
+}
+
+bool readRecord(std::istream & in, SpooledPoint & point, int nAttributes) {
+
+    if (!readRaw(in, point.xyz.x)) {
+        return false;
+    }
+
+    bool ok = readRaw(in, point.xyz.y);
+    ok = ok and readRaw(in, point.xyz.z);
+
+    uint8_t hasColor = 0;
+    ok = ok and readRaw(in, hasColor);
+
+    if (!ok) {
+        return false;
+    }
+
+    if (hasColor) {
+
+        std::optional<StereoVision::IO::PointCloudGenericAttribute> r;
+        std::optional<StereoVision::IO::PointCloudGenericAttribute> g;
+        std::optional<StereoVision::IO::PointCloudGenericAttribute> b;
+        std::optional<StereoVision::IO::PointCloudGenericAttribute> a;
+
+        ok = readAttribute(in, r) and readAttribute(in, g) and readAttribute(in, b) and readAttribute(in, a);
+
+        if (!ok or !r.has_value() or !g.has_value() or !b.has_value() or !a.has_value()) {
+            return false;
+        }
+
+        point.rgba = StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>{r.value(), g.value(), b.value(), a.value()};
+    } else {
+        point.rgba = std::nullopt;
+    }
+
+    point.attributes.resize(nAttributes);
+
+    for (int i = 0; i < nAttributes; i++) {
+        if (!readAttribute(in, point.attributes[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+PointSpoolReader::PointSpoolReader(std::filesystem::path const& path,
+                                   std::vector<std::string> const& schema,
+                                   bool removeWhenDone) :
+    _path(path),
+    _removeWhenDone(removeWhenDone),
+    _readBuffer(ReadBufferSize),
+    _schema(schema),
+    _hasData(false)
+{
+
+    for (int i = 0; i < _schema.size(); i++) {
+        _schemaIdxs[_schema[i]] = i;
+    }
+
+    _file.rdbuf()->pubsetbuf(_readBuffer.data(), _readBuffer.size());
+    _file.open(_path, std::ios_base::binary);
+
+    if (_file.is_open()) {
+        _hasData = PointSpool::readRecord(_file, _current, _schema.size());
+    }
+}
+
+PointSpoolReader::~PointSpoolReader() {
+
+    _file.close();
+
+    if (_removeWhenDone) {
+        std::error_code ec;
+        std::filesystem::remove(_path, ec);
+    }
+}
+
+StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> PointSpoolReader::getPointPosition() const {
+    StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> ret;
+    ret.x = _current.xyz.x;
+    ret.y = _current.xyz.y;
+    ret.z = _current.xyz.z;
+    return ret;
+}
+
+std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> PointSpoolReader::getPointColor() const {
+    return _current.rgba;
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> PointSpoolReader::getAttributeById(int id) const {
+
+    if (id < 0 or id >= _current.attributes.size()) {
+        return std::nullopt;
+    }
+
+    return _current.attributes[id];
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> PointSpoolReader::getAttributeByName(const char* attributeName) const {
+
+    auto it = _schemaIdxs.find(attributeName);
+
+    if (it == _schemaIdxs.end()) {
+        return std::nullopt;
+    }
+
+    return getAttributeById(it->second);
+}
+
+std::vector<std::string> PointSpoolReader::attributeList() const {
+    return _schema;
+}
+
+bool PointSpoolReader::gotoNext() {
+
+    if (!_hasData) {
+        return false;
+    }
+
+    if (!PointSpool::readRecord(_file, _next, _schema.size())) {
+        return false;
+    }
+
+    std::swap(_current, _next);
+    return true;
+}
+
+bool PointSpoolReader::hasData() const {
+    return _hasData;
+}
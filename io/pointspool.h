@@ -0,0 +1,141 @@
+#ifndef POINTSPOOL_H
+#define POINTSPOOL_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+/*!
+ * The spool format is a minimal binary format used to store points temporarily,
+ * e.g. when points need to be dispatched to multiple outputs or sorted out of core.
+ *
+ * A spool file is a sequence of records, the attribute names are not stored in the file,
+ * but are given by the schema the records are written with. Each record contains:
+ * - the position as three doubles.
+ * - a flag indicating if the point has a color, followed by the four color channels if it has.
+ * - each attribute of the schema, as a type index followed by the value (type index 0xFF for missing values).
+ */
+
+/*!
+ * \brief The SpooledPoint struct hold a point in memory, with attributes ordered according to a schema.
+ */
+struct SpooledPoint {
+    StereoVision::IO::PtGeometry<double> xyz;
+    std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> rgba;
+    std::vector<std::optional<StereoVision::IO::PointCloudGenericAttribute>> attributes;
+
+    /*!
+     * \brief fromInterface read the current point of a point cloud.
+     * \param src the point cloud to read from.
+     * \param schema the attributes to read.
+     */
+    static SpooledPoint fromInterface(StereoVision::IO::PointCloudPointAccessInterface const& src,
+                                      std::vector<std::string> const& schema);
+
+    /*!
+     * \brief approximateSize give an approximation of the memory used by the point, in bytes.
+     */
+    size_t approximateSize() const;
+};
+
+namespace PointSpool {
+
+void writeAttribute(std::string & out, std::optional<StereoVision::IO::PointCloudGenericAttribute> const& attribute);
+bool readAttribute(std::istream & in, std::optional<StereoVision::IO::PointCloudGenericAttribute> & attribute);
+
+/*!
+ * \brief appendRecord serialize a point and append it to a buffer.
+ */
+void appendRecord(std::string & out, SpooledPoint const& point);
+
+/*!
+ * \brief appendRecord serialize the current point of a point cloud and append it to a buffer.
+ */
+void appendRecord(std::string & out,
+                  StereoVision::IO::PointCloudPointAccessInterface const& src,
+                  std::vector<std::string> const& schema);
+
+/*!
+ * \brief readRecord read a record from a stream
+ * \return true in case of success, false otherwise (e.g. at the end of the stream).
+ */
+bool readRecord(std::istream & in, SpooledPoint & point, int nAttributes);
+
+}
+
+/*!
+ * \brief The PointSpoolReader class give access to the points stored in a spool file.
+ */
+class PointSpoolReader : public StereoVision::IO::PointCloudPointAccessInterface
+{
+public:
+
+    /*!
+     * \brief PointSpoolReader open a spool file.
+     * \param path the path to the spool file.
+     * \param schema the schema the file was written with.
+     * \param removeWhenDone if true, the file is removed when the reader is destroyed.
+     */
+    PointSpoolReader(std::filesystem::path const& path,
+                     std::vector<std::string> const& schema,
+                     bool removeWhenDone = false);
+    ~PointSpoolReader();
+
+    virtual StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> getPointPosition() const override;
+    virtual std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> getPointColor() const override;
+
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeById(int id) const override;
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeByName(const char* attributeName) const override;
+
+    virtual std::vector<std::string> attributeList() const override;
+
+    virtual bool gotoNext() override;
+    virtual bool hasData() const override;
+
+    inline SpooledPoint const& currentPoint() const {
+        return _current;
+    }
+
+    inline bool isOpen() const {
+        return _file.is_open();
+    }
+
+protected:
+
+    static constexpr int ReadBufferSize = 1 << 20;
+
+    std::filesystem::path _path;
+    bool _removeWhenDone;
+
+    std::vector<char> _readBuffer;
+    std::ifstream _file;
+
+    std::vector<std::string> _schema;
+    std::map<std::string, int> _schemaIdxs;
+    SpooledPoint _current;
+    SpooledPoint _next;
+    bool _hasData;
+};
+
+#endif // POINTSPOOL_H
@@ -0,0 +1,237 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "streamio.h"
+
+#include "asciipointcloudreader.h"
+#include "ldmcpointcloud.h"
+#include "plypointcloud.h"
+
+#include <StereoVision/io/las_pointcloud_io.h>
+#include <StereoVision/io/pcd_pointcloud_io.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+bool writeAll(int fd, char const* data, size_t size) {
+
+    size_t written = 0;
+
+    while (written < size) {
+        ssize_t n = ::write(fd, data + written, size - written);
+
+        if (n < 0 and errno == EINTR) {
+            continue;
+        }
+
+        if (n <= 0) {
+            return false;
+        }
+
+        written += n;
+    }
+
+    return true;
+}
+
+}
+
+std::optional<MemorySpool> MemorySpool::create(std::string const& name) {
+
+    int fd = memfd_create(name.c_str(), MFD_CLOEXEC);
+
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    return MemorySpool(fd);
+}
+
+MemorySpool::MemorySpool(int fd) :
+    _fd(fd)
+{
+
+}
+
+MemorySpool::MemorySpool(MemorySpool && other) :
+    _fd(std::exchange(other._fd, -1))
+{
+
+}
+
+MemorySpool::~MemorySpool() {
+    if (_fd >= 0) {
+        close(_fd);
+    }
+}
+
+MemorySpool& MemorySpool::operator=(MemorySpool && other) {
+    std::swap(_fd, other._fd);
+    return *this;
+}
+
+std::filesystem::path MemorySpool::path() const {
+    return std::filesystem::path("/proc/self/fd") / std::to_string(_fd);
+}
+
+bool MemorySpool::fillFrom(int srcFd) {
+
+    std::vector<char> buffer(CopyBufferSize);
+
+    while (true) {
+
+        ssize_t n = ::read(srcFd, buffer.data(), buffer.size());
+
+        if (n < 0 and errno == EINTR) {
+            continue;
+        }
+
+        if (n < 0) {
+            return false;
+        }
+
+        if (n == 0) {
+            break;
+        }
+
+        if (!writeAll(_fd, buffer.data(), n)) {
+            return false;
+        }
+    }
+
+    return lseek(_fd, 0, SEEK_SET) == 0;
+}
+
+bool MemorySpool::copyTo(int dstFd) const {
+
+    struct stat stats;
+
+    if (fstat(_fd, &stats) != 0) {
+        return false;
+    }
+
+    off_t offset = 0;
+
+    //sendfile avoids copying the data to user space, it works for pipes too on recent kernels.
+    while (offset < stats.st_size) {
+
+        ssize_t n = sendfile(dstFd, _fd, &offset, stats.st_size - offset);
+
+        if (n < 0 and errno == EINTR) {
+            continue;
+        }
+
+        if (n <= 0) {
+            break;
+        }
+    }
+
+    if (offset >= stats.st_size) {
+        return true;
+    }
+
+    //fallback to a buffered copy.
+    std::vector<char> buffer(CopyBufferSize);
+
+    while (offset < stats.st_size) {
+
+        ssize_t n = pread(_fd, buffer.data(), buffer.size(), offset);
+
+        if (n < 0 and errno == EINTR) {
+            continue;
+        }
+
+        if (n <= 0) {
+            return false;
+        }
+
+        if (!writeAll(dstFd, buffer.data(), n)) {
+            return false;
+        }
+
+        offset += n;
+    }
+
+    return true;
+}
+
+StatusOptional<StereoVision::IO::FullPointCloudAccessInterface> openPointCloudByContent(std::filesystem::path const& path) {
+
+    std::array<char, 16> magic;
+    magic.fill(0);
+
+    {
+        std::ifstream file(path, std::ios_base::binary);
+
+        if (file.is_open()) {
+            file.read(magic.data(), magic.size());
+        }
+    }
+
+    if (std::memcmp(magic.data(), "LASF", 4) == 0) {
+        return StereoVision::IO::openPointCloudLas(path);
+    }
+
+    if (std::memcmp(magic.data(), "LDMC", 4) == 0) {
+
+        std::optional<StereoVision::IO::FullPointCloudAccessInterface> ldmcPointCloud = Ldmc::openPointCloudLdmc(path);
+
+        if (ldmcPointCloud.has_value()) {
+            return std::move(ldmcPointCloud.value());
+        }
+    }
+
+    if (std::memcmp(magic.data(), "ply", 3) == 0) {
+
+        std::optional<StereoVision::IO::FullPointCloudAccessInterface> plyPointCloud = Ply::openPointCloudPly(path);
+
+        if (plyPointCloud.has_value()) {
+            return std::move(plyPointCloud.value());
+        }
+    }
+
+    //ascii files (ascii pcd, xyz and csv) are read by the parallel ascii reader.
+    if (AsciiPointCloud::formatFromPath(path).has_value()) {
+
+        std::optional<StereoVision::IO::FullPointCloudAccessInterface> asciiPointCloud = AsciiPointCloud::openPointCloudAscii(path);
+
+        if (asciiPointCloud.has_value()) {
+            return std::move(asciiPointCloud.value());
+        }
+    }
+
+    //a pcd file start with its header, possibly preceded by comments.
+    std::string start(magic.data(), magic.size());
+
+    if (start.rfind("#", 0) == 0 or start.rfind("VERSION", 0) == 0 or start.rfind("FIELDS", 0) == 0) {
+        return StereoVision::IO::openPointCloudPcd(path);
+    }
+
+    return StereoVision::IO::openPointCloud(path);
+}
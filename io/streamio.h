@@ -0,0 +1,105 @@
+#ifndef STREAMIO_H
+#define STREAMIO_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+/*!
+ * The point cloud readers and most writers work on seekable files (e.g. to read or patch the number of points in the header),
+ * so pipes cannot be used directly. To read from stdin or write to stdout without temporary files on disk,
+ * the data is spooled in an anonymous memory file, which can be accessed via a path in /proc/self/fd.
+ * The spool holds the whole stream, so it costs as much memory as the size of the input or of the output
+ * (the sequential formats, see isStreamableFormat, are written to stdout directly instead).
+ */
+
+/*!
+ * \brief The MemorySpool class manage an anonymous, seekable, in memory file.
+ */
+class MemorySpool
+{
+public:
+
+    /*!
+     * \brief create create a new memory spool
+     * \param name the name of the spool, for debugging purposes only.
+     * \return the spool, or std::nullopt in case of error.
+     */
+    static std::optional<MemorySpool> create(std::string const& name);
+
+    MemorySpool(MemorySpool const& other) = delete;
+    MemorySpool(MemorySpool && other);
+    ~MemorySpool();
+
+    MemorySpool& operator=(MemorySpool const& other) = delete;
+    MemorySpool& operator=(MemorySpool && other);
+
+    inline int fd() const {
+        return _fd;
+    }
+
+    /*!
+     * \brief path give a path that can be used to open the spool as a regular file.
+     */
+    std::filesystem::path path() const;
+
+    /*!
+     * \brief fillFrom copy all the data from a file descriptor (e.g. stdin) to the spool, until the end of the stream.
+     * \return true on success, false otherwise.
+     */
+    bool fillFrom(int srcFd);
+
+    /*!
+     * \brief copyTo copy the whole content of the spool to a file descriptor (e.g. stdout).
+     * \return true on success, false otherwise.
+     */
+    bool copyTo(int dstFd) const;
+
+protected:
+
+    MemorySpool(int fd);
+
+    static constexpr size_t CopyBufferSize = 1 << 22;
+
+    int _fd;
+};
+
+/*!
+ * \brief isStandardStreamPath check if a path designate the standard input or output ("-").
+ */
+inline bool isStandardStreamPath(std::string const& path) {
+    return path == "-";
+}
+
+/*!
+ * \brief openPointCloudByContent open a point cloud, detecting the format from the content of the file rather than its extension.
+ *
+ * This allows to open files without a meaningful extension, e.g. spooled standard input.
+ * Ascii files (ascii pcd, xyz and csv) are opened with the AsciiPointCloudReader, binary ply files with the PlyPointCloudReader.
+ * If the format cannot be detected, the file is opened based on its extension.
+ *
+ * \param path the path to the file
+ * \return the point cloud access interfaces, or an error.
+ */
+StatusOptional<StereoVision::IO::FullPointCloudAccessInterface> openPointCloudByContent(std::filesystem::path const& path);
+
+#endif // STREAMIO_H
@@ -0,0 +1,304 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "syntheticpointcloud.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+}
+
+std::unique_ptr<SyntheticPointCloud> SyntheticPointCloud::setupSyntheticPointCloud(Parameters const& parameters) {
+
+    bool ok = parameters.nPoints >= 0;
+    ok = ok and parameters.lineLength > 0 and parameters.lineSpacing >= 0;
+    ok = ok and parameters.flightHeight > 0 and parameters.speed > 0 and parameters.turnTime >= 0;
+    ok = ok and parameters.pulseRate > 0 and parameters.scanRate > 0;
+    ok = ok and parameters.scanAngle >= 0 and parameters.scanAngle < 80;
+    ok = ok and parameters.maxReturns >= 1 and parameters.maxReturns <= maxReturnsLimit;
+
+    if (!ok) {
+        return nullptr;
+    }
+
+    return std::unique_ptr<SyntheticPointCloud>(new SyntheticPointCloud(parameters));
+}
+
+std::vector<std::string> const& SyntheticPointCloud::attributesNames() {
+    static const std::vector<std::string> names = {"gpsTime",
+                                                   "classification",
+                                                   "lineNumber",
+                                                   "returnNumber",
+                                                   "numberOfReturns",
+                                                   "intensity",
+                                                   "scanAngle"};
+    return names;
+}
+
+SyntheticPointCloud::SyntheticPointCloud(Parameters const& parameters) :
+    _parameters(parameters),
+    _nGenerated(0),
+    _pulseIdx(0),
+    _line(0),
+    _lineStartTime(parameters.gpsTimeStart),
+    _gpsTime(parameters.gpsTimeStart),
+    _scanAngle(0),
+    _nReturns(0),
+    _currentReturn(0),
+    _rng(splitmix64(parameters.seed)),
+    _uniform(0, 1),
+    _rangeNoise(0, 0.03)
+{
+    _pulsesPerLine = std::max<int64_t>(1, std::llround(_parameters.lineLength/_parameters.speed*_parameters.pulseRate));
+
+    if (_parameters.nPoints > 0) {
+        generatePulse();
+    }
+}
+
+StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> SyntheticPointCloud::getPointPosition() const {
+    StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> ret;
+    ret.x = _returns[_currentReturn].xyz.x;
+    ret.y = _returns[_currentReturn].xyz.y;
+    ret.z = _returns[_currentReturn].xyz.z;
+    return ret;
+}
+
+std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> SyntheticPointCloud::getPointColor() const {
+    return std::nullopt;
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> SyntheticPointCloud::getAttributeById(int id) const {
+
+    Return const& current = _returns[_currentReturn];
+
+    switch (id) {
+    case 0:
+        return _gpsTime;
+    case 1:
+        return current.classification;
+    case 2:
+        return _line;
+    case 3:
+        return static_cast<uint8_t>(_currentReturn+1);
+    case 4:
+        return static_cast<uint8_t>(_nReturns);
+    case 5:
+        return current.intensity;
+    case 6:
+        return _scanAngle;
+    default:
+        break;
+    }
+
+    return std::nullopt;
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> SyntheticPointCloud::getAttributeByName(const char* attributeName) const {
+
+    std::vector<std::string> const& names = attributesNames();
+
+    for (int i = 0; i < names.size(); i++) {
+        if (std::strcmp(names[i].c_str(), attributeName) == 0) {
+            return getAttributeById(i);
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::vector<std::string> SyntheticPointCloud::attributeList() const {
+    return attributesNames();
+}
+
+bool SyntheticPointCloud::gotoNext() {
+
+    if (_nGenerated >= _parameters.nPoints) {
+        return false;
+    }
+
+    _nGenerated++;
+
+    if (_nGenerated >= _parameters.nPoints) {
+        return false;
+    }
+
+    _currentReturn++;
+
+    if (_currentReturn >= _nReturns) {
+        generatePulse();
+    }
+
+    return true;
+}
+
+bool SyntheticPointCloud::hasData() const {
+    return _nGenerated < _parameters.nPoints;
+}
+
+void SyntheticPointCloud::generatePulse() {
+
+    if (_pulseIdx >= _pulsesPerLine) {
+        _lineStartTime += _parameters.lineLength/_parameters.speed + _parameters.turnTime;
+        _pulseIdx = 0;
+        _line++;
+    }
+
+    double t = _pulseIdx/_parameters.pulseRate;
+    _pulseIdx++;
+
+    _gpsTime = _lineStartTime + t;
+
+    //the lines are flown in alternating directions.
+    bool forward = (_line % 2) == 0;
+    double along = _parameters.speed*t;
+
+    double px = _parameters.x0 + ((forward) ? along : _parameters.lineLength - along);
+    double py = _parameters.y0 + _line*_parameters.lineSpacing;
+
+    //oscillating mirror, the scan angle follows a triangular wave.
+    double phase = t*_parameters.scanRate;
+    phase -= std::floor(phase);
+
+    _scanAngle = _parameters.scanAngle*(4*std::abs(phase - 0.5) - 1);
+
+    double tanTheta = std::tan(_scanAngle*pi/180);
+    double side = (forward) ? -1 : 1;
+
+    double gx = px;
+    double gy = py + side*_parameters.flightHeight*tanTheta;
+    double ground = terrainHeight(gx, gy);
+
+    //the points above ground are hit earlier along the beam, so they are slightly shifted toward the flight line.
+    auto setReturn = [&] (int i, double heightAboveGround, uint8_t classification, double intensity) {
+        _returns[i].xyz.x = gx;
+        _returns[i].xyz.y = gy - side*heightAboveGround*tanTheta;
+        _returns[i].xyz.z = ground + heightAboveGround + _rangeNoise(_rng);
+        _returns[i].classification = classification;
+        _returns[i].intensity = static_cast<uint16_t>(std::clamp(intensity, 0., 65535.));
+    };
+
+    _currentReturn = 0;
+
+    double building = buildingHeight(gx, gy);
+
+    if (building > 0) {
+        _nReturns = 1;
+        setReturn(0, building, Building, 1500 + 1500*_uniform(_rng));
+        return;
+    }
+
+    double vegetation = vegetationDensity(gx, gy);
+
+    if (_parameters.maxReturns > 1 and _uniform(_rng) < vegetation) {
+
+        _nReturns = std::min(_parameters.maxReturns, 2 + static_cast<int>(_uniform(_rng)*(_parameters.maxReturns-1)));
+
+        double canopyHeight = 3 + 22*vegetation;
+
+        std::array<double, maxReturnsLimit> heights;
+
+        for (int i = 0; i < _nReturns-1; i++) {
+            heights[i] = 0.3 + (canopyHeight-0.3)*_uniform(_rng);
+        }
+
+        std::sort(heights.begin(), heights.begin() + _nReturns-1, std::greater<double>());
+
+        for (int i = 0; i < _nReturns-1; i++) {
+
+            uint8_t classification = HighVegetation;
+
+            if (heights[i] < 2) {
+                classification = LowVegetation;
+            } else if (heights[i] < 5) {
+                classification = MediumVegetation;
+            }
+
+            setReturn(i, heights[i], classification, (100 + 600*_uniform(_rng))/(1 + 0.5*i));
+        }
+
+        setReturn(_nReturns-1, 0, Ground, (600 + 900*_uniform(_rng))/(1 + 0.5*(_nReturns-1)));
+        return;
+    }
+
+    _nReturns = 1;
+
+    //a few isolated outliers, e.g. birds or multipath.
+    if (_uniform(_rng) < 1e-4) {
+        setReturn(0, -40 + 190*_uniform(_rng), Noise, 50*_uniform(_rng));
+        return;
+    }
+
+    setReturn(0, 0, Ground, 600 + 900*_uniform(_rng));
+}
+
+double SyntheticPointCloud::terrainHeight(double x, double y) const {
+
+    double lx = x - _parameters.x0;
+    double ly = y - _parameters.y0;
+
+    return 450 + 30*std::sin(lx/310)*std::cos(ly/270) + 8*std::sin(lx/47 + ly/63);
+}
+
+double SyntheticPointCloud::vegetationDensity(double x, double y) const {
+
+    double lx = x - _parameters.x0;
+    double ly = y - _parameters.y0;
+
+    double v = 0.5 + 0.5*std::sin(lx/130 + 1.3)*std::sin(ly/170);
+
+    return v*v;
+}
+
+double SyntheticPointCloud::buildingHeight(double x, double y) const {
+
+    constexpr double cellSize = 100;
+
+    double lx = x - _parameters.x0;
+    double ly = y - _parameters.y0;
+
+    int64_t cx = std::floor(lx/cellSize);
+    int64_t cy = std::floor(ly/cellSize);
+
+    uint64_t hash = splitmix64(_parameters.seed ^ splitmix64(uint64_t(cx)*0x100000001b3ULL ^ uint64_t(cy)));
+
+    if (hash % 8 != 0) {
+        return 0;
+    }
+
+    double ix = lx - cx*cellSize;
+    double iy = ly - cy*cellSize;
+
+    if (ix < 20 or ix > 70 or iy < 25 or iy > 75) {
+        return 0;
+    }
+
+    return 8 + (hash >> 8) % 20;
+}
@@ -0,0 +1,135 @@
+#ifndef SYNTHETICPOINTCLOUD_H
+#define SYNTHETICPOINTCLOUD_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+/*!
+ * \brief The SyntheticPointCloud class generate a realistic airborne lidar point cloud on the fly.
+ *
+ * The points are generated in acquisition order, as they would be by a lidar with an oscillating mirror
+ * flying parallel lines in alternating directions over a synthetic scene (smooth terrain, vegetation patches and buildings).
+ * Each pulse can produce multiple returns, and each point gets the usual las attributes:
+ * gpsTime, classification, lineNumber, returnNumber, numberOfReturns, intensity and scanAngle.
+ *
+ * The generation is deterministic for a given set of parameters, and does not need memory proportional to the number of points,
+ * so arbitrarily large point clouds can be streamed to a writer.
+ */
+class SyntheticPointCloud : public StereoVision::IO::PointCloudPointAccessInterface
+{
+public:
+
+    struct Parameters {
+        int64_t nPoints = 1000000;
+
+        double x0 = 2600000; //!< origin of the first line (the default is in the swiss LV95 projection).
+        double y0 = 1200000;
+
+        double lineLength = 2000; //!< length of a flight line, in meters.
+        double lineSpacing = 400; //!< distance between two flight lines, in meters.
+        double flightHeight = 800; //!< flight height above the mean terrain, in meters.
+        double speed = 60; //!< speed of the aircraft, in meters per seconds.
+        double turnTime = 120; //!< time between two lines, in seconds.
+
+        double pulseRate = 300000; //!< number of pulses per seconds.
+        double scanRate = 80; //!< number of scan lines per seconds.
+        double scanAngle = 30; //!< half field of view, in degrees.
+        int maxReturns = 5;
+
+        double gpsTimeStart = 3.5e8;
+        uint64_t seed = 0;
+    };
+
+    static constexpr int maxReturnsLimit = 15;
+
+    /*!
+     * \brief setupSyntheticPointCloud create a synthetic point cloud
+     * \param parameters the acquisition parameters.
+     * \return the point cloud, or nullptr if the parameters are invalid.
+     */
+    static std::unique_ptr<SyntheticPointCloud> setupSyntheticPointCloud(Parameters const& parameters);
+
+    static std::vector<std::string> const& attributesNames();
+
+    virtual StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> getPointPosition() const override;
+    virtual std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> getPointColor() const override;
+
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeById(int id) const override;
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeByName(const char* attributeName) const override;
+
+    virtual std::vector<std::string> attributeList() const override;
+
+    virtual bool gotoNext() override;
+    virtual bool hasData() const override;
+
+protected:
+
+    SyntheticPointCloud(Parameters const& parameters);
+
+    enum Classification {
+        Unclassified = 1,
+        Ground = 2,
+        LowVegetation = 3,
+        MediumVegetation = 4,
+        HighVegetation = 5,
+        Building = 6,
+        Noise = 7
+    };
+
+    struct Return {
+        StereoVision::IO::PtGeometry<double> xyz;
+        uint8_t classification;
+        uint16_t intensity;
+    };
+
+    void generatePulse();
+
+    double terrainHeight(double x, double y) const;
+    double vegetationDensity(double x, double y) const;
+    double buildingHeight(double x, double y) const;
+
+    Parameters _parameters;
+
+    int64_t _nGenerated;
+    int64_t _pulsesPerLine;
+    int64_t _pulseIdx;
+
+    int32_t _line;
+    double _lineStartTime;
+
+    double _gpsTime;
+    float _scanAngle;
+
+    std::array<Return, maxReturnsLimit> _returns;
+    int _nReturns;
+    int _currentReturn;
+
+    std::mt19937_64 _rng;
+    std::uniform_real_distribution<double> _uniform;
+    std::normal_distribution<double> _rangeNoise;
+};
+
+#endif // SYNTHETICPOINTCLOUD_H
@@ -0,0 +1,117 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tilespool.h"
+
+#include <algorithm>
+#include <cmath>
+
+TileSpool::TileSpool(std::string const& name, double tileSize, double haloSize) :
+    _tileSize(tileSize),
+    _haloSize(std::max(haloSize, 0.0)),
+    _spool(PartitionSpool::temporarySpoolDir(name)),
+    _nSkipped(0)
+{
+
+}
+
+std::string TileSpool::tileKey(int64_t tx, int64_t ty) {
+    return std::to_string(tx) + "_" + std::to_string(ty);
+}
+
+bool TileSpool::append(StereoVision::IO::PointCloudPointAccessInterface const& src, std::vector<std::string> const& schema) {
+
+    StereoVision::IO::PtGeometry<double> pos = src.castedPointGeometry<double>();
+
+    constexpr double limit = 9e18;
+
+    double fx = std::floor(pos.x/_tileSize);
+    double fy = std::floor(pos.y/_tileSize);
+
+    if (!std::isfinite(pos.z) or !(std::abs(fx) < limit and std::abs(fy) < limit)) {
+        _nSkipped++;
+        return true;
+    }
+
+    int64_t tx = fx;
+    int64_t ty = fy;
+
+    _record.clear();
+    PointSpool::appendRecord(_record, src, schema);
+
+    //the core points of a tile and the points in its halo are stored in separate partitions.
+    if (!_spool.append("c" + tileKey(tx, ty), _record)) {
+        return false;
+    }
+
+    //position of the point in its tile, to find the halos it belongs to.
+    double lx = pos.x - tx*_tileSize;
+    double ly = pos.y - ty*_tileSize;
+
+    int dxMin = (lx < _haloSize) ? -1 : 0;
+    int dxMax = (lx >= _tileSize - _haloSize) ? 1 : 0;
+    int dyMin = (ly < _haloSize) ? -1 : 0;
+    int dyMax = (ly >= _tileSize - _haloSize) ? 1 : 0;
+
+    for (int dx = dxMin; dx <= dxMax; dx++) {
+        for (int dy = dyMin; dy <= dyMax; dy++) {
+
+            if (dx == 0 and dy == 0) {
+                continue;
+            }
+
+            if (!_spool.append("h" + tileKey(tx+dx, ty+dy), _record)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool TileSpool::flush() {
+
+    if (!_spool.flush()) {
+        return false;
+    }
+
+    _tiles.clear();
+
+    for (std::string const& key : _spool.keys()) {
+
+        if (key.front() != 'c') {
+            continue;
+        }
+
+        size_t sep = key.find('_');
+        _tiles.push_back(Tile{std::stoll(key.substr(1, sep-1)), std::stoll(key.substr(sep+1))});
+    }
+
+    return true;
+}
+
+std::unique_ptr<PointSpoolReader> TileSpool::openCore(Tile const& tile, std::vector<std::string> const& schema) const {
+    return _spool.openPartition("c" + tileKey(tile.x, tile.y), schema, true);
+}
+
+std::unique_ptr<PointSpoolReader> TileSpool::openHalo(Tile const& tile, std::vector<std::string> const& schema) const {
+    return _spool.openPartition("h" + tileKey(tile.x, tile.y), schema, true);
+}
+
+bool TileSpool::hasHalo(Tile const& tile) const {
+    return _spool.partitionsSizes().count("h" + tileKey(tile.x, tile.y)) > 0;
+}
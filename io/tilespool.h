@@ -0,0 +1,113 @@
+#ifndef TILESPOOL_H
+#define TILESPOOL_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "partitionspool.h"
+
+/*!
+ * \brief The TileSpool class spool points to disk in square tiles, with a halo around each tile.
+ *
+ * Each point is stored in the tile it belongs to (the core of the tile), and copied in the halo of the neighboring tiles
+ * it is closer than the halo size to, so that a tile can be processed with the complete neighborhood of its points.
+ * The halo size is capped to the tile size.
+ */
+class TileSpool
+{
+public:
+
+    struct Tile {
+        int64_t x;
+        int64_t y;
+    };
+
+    /*!
+     * \brief TileSpool create a tile spool in the temporary directory.
+     * \param name a name to identify the user of the spool.
+     * \param tileSize the size of the tiles.
+     * \param haloSize the size of the halo of the tiles, at most the size of the tiles (the halo of a tile only covers its direct neighbors).
+     */
+    TileSpool(std::string const& name, double tileSize, double haloSize);
+
+    /*!
+     * \brief append spool the current point of a point cloud, points with a non finite position are skipped.
+     * \return true on success, false otherwise.
+     */
+    bool append(StereoVision::IO::PointCloudPointAccessInterface const& src, std::vector<std::string> const& schema);
+
+    /*!
+     * \brief flush write all the buffered points, needs to be called before reading the tiles.
+     * \return true on success, false otherwise.
+     */
+    bool flush();
+
+    /*!
+     * \brief tiles the tiles containing at least a point (in their core), available after a flush.
+     */
+    inline std::vector<Tile> const& tiles() const {
+        return _tiles;
+    }
+
+    /*!
+     * \brief openCore read the points of a tile, the spool file is removed when the reader is destroyed.
+     */
+    std::unique_ptr<PointSpoolReader> openCore(Tile const& tile, std::vector<std::string> const& schema) const;
+
+    /*!
+     * \brief openHalo read the points in the halo of a tile, the spool file is removed when the reader is destroyed.
+     * \return a reader, or nullptr if the halo is empty.
+     */
+    std::unique_ptr<PointSpoolReader> openHalo(Tile const& tile, std::vector<std::string> const& schema) const;
+
+    /*!
+     * \brief hasHalo check if points have been spooled in the halo of a tile.
+     */
+    bool hasHalo(Tile const& tile) const;
+
+    inline double tileSize() const {
+        return _tileSize;
+    }
+
+    inline double haloSize() const {
+        return _haloSize;
+    }
+
+    inline int64_t numberOfSkippedPoints() const {
+        return _nSkipped;
+    }
+
+protected:
+
+    static std::string tileKey(int64_t tx, int64_t ty);
+
+    double _tileSize;
+    double _haloSize;
+
+    PartitionSpool _spool;
+    std::vector<Tile> _tiles;
+
+    std::string _record;
+    int64_t _nSkipped;
+};
+
+#endif // TILESPOOL_H
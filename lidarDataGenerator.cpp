@@ -0,0 +1,157 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <string>
+#include <filesystem>
+
+#include <tclap/CmdLine.h>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+#include "processingBlocks/aliasheaderattributes.h"
+#include "processingBlocks/progresscounter.h"
+
+#include "io/pointcloudwriter.h"
+#include "io/syntheticpointcloud.h"
+
+int main(int argc, char** argv) {
+
+    const char* message = "Generate synthetic airborne lidar data";
+    constexpr char delimiter = '=';
+    const char* version = "0.1";
+
+    std::string outFile;
+    std::string outFormat;
+    std::string crs;
+
+    SyntheticPointCloud::Parameters parameters;
+
+    try {
+
+        TCLAP::CmdLine cmd(message, delimiter, version);
+
+        TCLAP::ValueArg<std::string> outputFileArg("o", "output_file_path", "Output file",true,"","path to a point cloud file");
+
+        TCLAP::ValueArg<int64_t> numberArg("n", "number", "The number of points to generate", false, parameters.nPoints, "An int");
+        TCLAP::ValueArg<uint64_t> seedArg("s", "seed", "The seed of the random generator, the same seed give the same point cloud", false, parameters.seed, "An int");
+
+        TCLAP::ValueArg<std::string> crsArg("", "crs", "The crs of the generated data, should be a projected crs with meters as units", false, "EPSG:2056",
+                                            "any string that can be parsed by PROJ, e.g. WTK string or \"EPSG:####\" codes");
+        TCLAP::ValueArg<double> x0Arg("", "x0", "The x coordinate of the start of the first line", false, parameters.x0, "A double");
+        TCLAP::ValueArg<double> y0Arg("", "y0", "The y coordinate of the start of the first line", false, parameters.y0, "A double");
+
+        TCLAP::ValueArg<double> lineLengthArg("", "line_length", "The length of the flight lines, in meters", false, parameters.lineLength, "A double");
+        TCLAP::ValueArg<double> lineSpacingArg("", "line_spacing", "The distance between the flight lines, in meters", false, parameters.lineSpacing, "A double");
+        TCLAP::ValueArg<double> heightArg("", "height", "The flight height, in meters", false, parameters.flightHeight, "A double");
+        TCLAP::ValueArg<double> speedArg("", "speed", "The speed of the aircraft, in meters per seconds", false, parameters.speed, "A double");
+
+        TCLAP::ValueArg<double> pulseRateArg("", "pulse_rate", "The number of pulses per seconds", false, parameters.pulseRate, "A double");
+        TCLAP::ValueArg<double> scanRateArg("", "scan_rate", "The number of scan lines per seconds", false, parameters.scanRate, "A double");
+        TCLAP::ValueArg<double> scanAngleArg("", "scan_angle", "The half field of view of the scanner, in degrees", false, parameters.scanAngle, "A double");
+        TCLAP::ValueArg<int> maxReturnsArg("", "max_returns", "The maximal number of returns per pulse", false, parameters.maxReturns, "An int");
+
+        std::vector<std::string> allowedOutFormats;
+                allowedOutFormats.push_back("pcd-ascii");
+                allowedOutFormats.push_back("pcd-bin");
+                allowedOutFormats.push_back("ply");
+                allowedOutFormats.push_back("ldmc");
+                #ifdef LDM_WITH_ZSTD
+                allowedOutFormats.push_back("ldmc-zstd");
+                #endif
+                allowedOutFormats.push_back("xyz");
+                allowedOutFormats.push_back("csv");
+                #ifdef LDM_WITH_ARROW
+                allowedOutFormats.push_back("arrow");
+                #endif
+                allowedOutFormats.push_back("lasv14");
+                TCLAP::ValuesConstraint<std::string> allowedOutFormatsConstraint( allowedOutFormats );
+        TCLAP::ValueArg<std::string> formatArg("f", "format", "Output format", false, "lasv14", &allowedOutFormatsConstraint);
+
+        cmd.add(outputFileArg);
+        cmd.add(numberArg);
+        cmd.add(seedArg);
+        cmd.add(crsArg);
+        cmd.add(x0Arg);
+        cmd.add(y0Arg);
+        cmd.add(lineLengthArg);
+        cmd.add(lineSpacingArg);
+        cmd.add(heightArg);
+        cmd.add(speedArg);
+        cmd.add(pulseRateArg);
+        cmd.add(scanRateArg);
+        cmd.add(scanAngleArg);
+        cmd.add(maxReturnsArg);
+        cmd.add(formatArg);
+
+        cmd.parse(argc, argv);
+
+        outFile = outputFileArg.getValue();
+        outFormat = formatArg.getValue();
+        crs = crsArg.getValue();
+
+        parameters.nPoints = numberArg.getValue();
+        parameters.seed = seedArg.getValue();
+        parameters.x0 = x0Arg.getValue();
+        parameters.y0 = y0Arg.getValue();
+        parameters.lineLength = lineLengthArg.getValue();
+        parameters.lineSpacing = lineSpacingArg.getValue();
+        parameters.flightHeight = heightArg.getValue();
+        parameters.speed = speedArg.getValue();
+        parameters.pulseRate = pulseRateArg.getValue();
+        parameters.scanRate = scanRateArg.getValue();
+        parameters.scanAngle = scanAngleArg.getValue();
+        parameters.maxReturns = maxReturnsArg.getValue();
+
+    } catch (TCLAP::ArgException &e) {
+
+        std::cerr << "Command line error: " << e.error() << " for argument " << e.argId() << std::endl;
+        return 1;
+
+    }
+
+    std::unique_ptr<SyntheticPointCloud> generator = SyntheticPointCloud::setupSyntheticPointCloud(parameters);
+
+    if (generator == nullptr) {
+        std::cerr << "Invalid acquisition parameters! Aborting!" << std::endl;
+        return 1;
+    }
+
+    StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+    AliasHeaderAttributes::AliasMap headerAttributes;
+    headerAttributes["crs"] = crs;
+
+    pointCloudStack.headerAccess = std::make_unique<AliasHeaderAttributes>(nullptr, headerAttributes);
+
+    ProgressCounter* progressCounter = new ProgressCounter(std::move(generator));
+    pointCloudStack.pointAccess = std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface>(progressCounter);
+
+    ProgressReporter progressReporter(progressCounter, parameters.nPoints, -1, true);
+    progressReporter.start();
+
+    bool ok = writePointCloud(std::filesystem::path(outFile), pointCloudStack, outFormat);
+
+    progressReporter.finish(ok);
+
+    if (!ok) {
+        std::cerr << "Error writing point cloud data to " << outFile << "!" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -19,6 +19,7 @@
 #include <string>
 #include <filesystem>
 #include <chrono>
+#include <cmath>
 
 #include <tclap/CmdLine.h>
 
@@ -27,28 +28,53 @@
 #include <StereoVision/io/pcd_pointcloud_io.h>
 
 #include "processingBlocks/aliasheaderattributes.h"
+#include "processingBlocks/mergedpointcloud.h"
 #include "processingBlocks/regionofinterestselector.h"
+#include "processingBlocks/regionofinterestset.h"
 #include "processingBlocks/attributebasedselector.h"
 #include "processingBlocks/attributesetbasedselector.h"
 #include "processingBlocks/pointsattributesfilters.h"
 #include "processingBlocks/pointsnumberlimit.h"
 #include "processingBlocks/crsconversion.h"
-
+#include "processingBlocks/crstransform.h"
+#include "processingBlocks/duplicateremover.h"
+#include "processingBlocks/stageprofiler.h"
+#include "processingBlocks/progresscounter.h"
+#include "processingBlocks/staticpipeline.h"
+#include "processingBlocks/groundclassifier.h"
+#include "processingBlocks/outlierremover.h"
+#include "processingBlocks/voxeldownsampler.h"
+#include "processingBlocks/pointsorter.h"
+
+#include "io/ldmcpointcloud.h"
+#include "io/partitionedwriter.h"
+#include "io/pointcloudinfo.h"
+#include "io/pointcloudrasterizer.h"
+#include "io/pointcloudwriter.h"
+#include "io/streamio.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
 #include <thread>
 
+#include <unistd.h>
+
 int main(int argc, char** argv) {
 
     const char* message = "Processed lidar data on the fly";
     constexpr char delimiter = '=';
     const char* version = "0.1";
 
-    std::string inFile;
+    std::vector<std::string> inFiles;
     std::string outFile;
 
     std::string inCrs = "";
     std::string outCrs = "";
+    double crsApproximationTolerance = -1;
 
     std::string roi = "";
+    std::string roiFile = "";
 
     double density = std::numeric_limits<double>::infinity();
     int number = -1;
@@ -62,17 +88,44 @@ int main(int argc, char** argv) {
     bool removeAllAttributes = false;
     std::vector<std::string> attributes2filter;
 
+    double duplicatesTolerance = -1;
+    double duplicatesTimeTolerance = -1;
+    double duplicatesTileSize = -1;
+    double voxelSize = -1;
+    VoxelDownsampler::Representative voxelRepresentative = VoxelDownsampler::Centroid;
+    double voxelTileSize = -1;
+    std::optional<OutlierRemover::Method> outliersMethod = std::nullopt;
+    OutlierRemover::Parameters outliersParameters;
+    bool classifyGround = false;
+    GroundClassifier::Parameters groundParameters;
+    std::optional<std::vector<PointCloudRasterizer::Product>> rasterProducts = std::nullopt;
+    double rasterCellSize = 1;
+    std::optional<PointSorter::Order> sortOrder = std::nullopt;
+    double sortMemoryLimit = PointSorter::DefaultMemoryLimit/double(1 << 20);
+    double sortCellSize = PointSorter::DefaultCellSize;
+    bool infoMode = false;
+
+    std::string partitionDefinition = "";
+
     bool benchmarkProcessing = false;
+    bool benchmarkJson = false;
+
+    bool dynamicPipeline = false;
+
+    int progressFd = -1;
 
     try {
 
         TCLAP::CmdLine cmd(message, delimiter, version);
 
-        TCLAP::UnlabeledValueArg<std::string> inputFileArg("inFile", "Input file",true,"","path to a point cloud or point cloud-like file");
-        TCLAP::ValueArg<std::string> outputFileArg("o", "output_file_path", "Output file",true,"","path to a point cloud or point cloud-like file");
+        TCLAP::UnlabeledMultiArg<std::string> inputFileArg("inFiles", "Input files, if multiple files are given they are merged in a single output. Use \"-\" to read from the standard input",true,"path to a point cloud or point cloud-like file");
+        TCLAP::ValueArg<std::string> outputFileArg("o", "output_file_path", "Output file, use \"-\" to write to the standard output. Optional with --info",false,"","path to a point cloud or point cloud-like file");
 
         TCLAP::ValueArg<std::string> inCrsArg("", "incrs", "Override the crs of the input data", false, "", "any string that can be parsed by PROJ, e.g. WTK string or \"EPSG:####\" codes");
         TCLAP::ValueArg<std::string> outCrsArg("", "outcrs", "The crs to use for the output data. If not specified, then no CRS transform is done.", false, "", "any string that can be parsed by PROJ, e.g. WTK string or \"EPSG:####\" codes");
+        TCLAP::ValueArg<double> crsApproxArg("", "crs-approx", "Approximate the crs conversion by interpolating exact samples, with at most the given error. "
+                                             "Much faster for dense data, the points where the tolerance cannot be met are converted exactly.",
+                                             false, crsApproximationTolerance, "A double, in the units of the output crs");
 
         const char* roiDescr = "A description of a region of interest formatted as \"x0,y0,z0,dx,dy,dz,rx,ry,rz\",\n"
                 "with x0,y0,z0 the origin of the Rectangular cuboid,"
@@ -80,6 +133,11 @@ int main(int argc, char** argv) {
                 "rx,ry,rz the axis angle of the rotation around x0,y0,z0 to apply";
         TCLAP::ValueArg<std::string> roiArg("", "roi", "Definition of a region of interest", false, "", roiDescr);
 
+        TCLAP::ValueArg<std::string> roiFileArg("", "roi-file", "Extract many named regions of interest in a single pass, each one to its own output. "
+                                                "The name of each region is appended to the output file name (or replaces \"{}\" in the output file name). "
+                                                "As --roi, the regions are defined in the input crs",
+                                                false, "", "path to a text file with one region per line, formatted as \"name x0,y0,z0,dx,dy,dz,rx,ry,rz\" (see --roi)");
+
         TCLAP::ValueArg<double> densityArg("d", "density", "The maximal density of the point cloud, as points per m^2", false, std::numeric_limits<double>::infinity(), "A double");
 
         TCLAP::ValueArg<int> numberArg("n", "number", "The maximal number of points in the output point cloud. The tool will try to spead the output points as uniformly as possible.",
@@ -91,7 +149,10 @@ int main(int argc, char** argv) {
         TCLAP::MultiArg<int> lineArg("l", "line", "The index of a line to export.",
                                      false, "An int, the index of a line to select");
 
-        TCLAP::SwitchArg benchmarkArg("b", "benchmark", "Time the export and print statistics at the end.");
+        TCLAP::SwitchArg benchmarkArg("b", "benchmark", "Time the export and print per stage statistics at the end.");
+        TCLAP::SwitchArg benchmarkJsonArg("", "benchmark-json", "Same as --benchmark, but print the statistics as json.");
+
+        TCLAP::SwitchArg dynamicPipelineArg("", "dynamic-pipeline", "Always use the generic processing chain, instead of a pipeline specialized for the requested operations.");
 
         TCLAP::MultiArg<std::string> lineRangeArg("", "line_range", "A range of index of lines to export in format start-end (both included)",
                                        false, "Astring representing a range of ints");
@@ -99,12 +160,101 @@ int main(int argc, char** argv) {
         std::vector<std::string> allowedOutFormats;
                 allowedOutFormats.push_back("pcd-ascii");
                 allowedOutFormats.push_back("pcd-bin");
+                allowedOutFormats.push_back("ply");
+                allowedOutFormats.push_back("ldmc");
+                #ifdef LDM_WITH_ZSTD
+                allowedOutFormats.push_back("ldmc-zstd");
+                #endif
+                allowedOutFormats.push_back("xyz");
+                allowedOutFormats.push_back("csv");
+                #ifdef LDM_WITH_ARROW
+                allowedOutFormats.push_back("arrow");
+                #endif
                 allowedOutFormats.push_back("lasv14");
                 allowedOutFormats.push_back("lasv13");
                 allowedOutFormats.push_back("lasv12");
                 TCLAP::ValuesConstraint<std::string> allowedOutFormatsConstraint( allowedOutFormats );
         TCLAP::ValueArg<std::string> formatArg("f", "format", "Output format", false, "pcd-ascii", &allowedOutFormatsConstraint);
 
+        TCLAP::ValueArg<int> progressFdArg("", "progress-fd", "Write the progress as NDJSON events (one json object per line) to a file descriptor.",
+                                           false, -1, "An int, the file descriptor to write to, e.g. 2 for stderr");
+
+        TCLAP::ValueArg<std::string> partitionArg("", "partition-by", "Split the output in multiple files in a single pass. "
+                                                  "The key of each partition is appended to the output file name (or replaces \"{}\" in the output file name)",
+                                                  false, "", "either \"tile:<size>\" to split the points in square tiles, or the name of an attribute, e.g. \"lineNumber\"");
+
+        TCLAP::ValueArg<double> dedupArg("", "dedup", "Remove the duplicated points, i.e. the points in the same cell of the given size as a previous point "
+                                         "(in the units of the input crs), e.g. in the overlap of merged tiles or reflown lines.",
+                                         false, -1, "A double, if below 0 then the duplicates are not removed");
+        TCLAP::ValueArg<double> dedupTimeArg("", "dedup-time", "Only consider points as duplicates if their gps time is also in the same interval of the given size.",
+                                             false, -1, "A double, if below 0 then the gps time is not considered");
+        TCLAP::ValueArg<double> dedupTileArg("", "dedup-tile", "Remove the duplicates in square tiles of the given size, spooled on disk, to process point clouds larger than the memory.",
+                                             false, -1, "A double, if below 0 then the points are not tiled");
+
+        TCLAP::ValueArg<double> voxelArg("", "voxel", "Keep a single point per voxel of the given size (in the units of the input crs).",
+                                         false, -1, "A double, if below 0 then no voxel downsampling is done");
+
+        std::vector<std::string> allowedVoxelModes = {"centroid", "nearest"};
+        TCLAP::ValuesConstraint<std::string> allowedVoxelModesConstraint(allowedVoxelModes);
+        TCLAP::ValueArg<std::string> voxelModeArg("", "voxel-mode", "Replace each voxel by the centroid of its points (with averaged color and attributes), "
+                                                  "or by the point nearest to the centroid", false, "centroid", &allowedVoxelModesConstraint);
+
+        TCLAP::ValueArg<double> voxelTileArg("", "voxel-tile", "Downsample the points in square tiles of the given size, spooled on disk, to process point clouds larger than the memory.",
+                                             false, -1, "A double, if below 0 then the points are not tiled");
+
+        std::vector<std::string> allowedOutliersMethods = {"statistical", "radius"};
+        TCLAP::ValuesConstraint<std::string> allowedOutliersMethodsConstraint(allowedOutliersMethods);
+        TCLAP::ValueArg<std::string> outliersArg("", "outliers", "Remove the outliers, either the points whose mean distance to their neighbors is far above the average (statistical), "
+                                                 "or the points with too few neighbors in a radius (radius)", false, "", &allowedOutliersMethodsConstraint);
+
+        TCLAP::ValueArg<int> outliersKArg("", "outliers-k", "Number of neighbors considered by the statistical outlier removal.",
+                                          false, outliersParameters.nNeighbors, "An int");
+        TCLAP::ValueArg<double> outliersSigmaArg("", "outliers-sigma", "Number of standard deviations above the mean distance to the neighbors a point is an outlier (statistical outlier removal).",
+                                                 false, outliersParameters.sigma, "A double");
+        TCLAP::ValueArg<double> outliersRadiusArg("", "outliers-radius", "Search radius of the radius outlier removal (in the units of the input crs).",
+                                                  false, outliersParameters.radius, "A double");
+        TCLAP::ValueArg<int> outliersMinNeighborsArg("", "outliers-min-neighbors", "Minimal number of neighbors in the radius for a point to be kept (radius outlier removal).",
+                                                     false, outliersParameters.minNeighbors, "An int");
+        TCLAP::ValueArg<double> outliersTileArg("", "outliers-tile", "Size of the tiles the outliers are searched in (in the units of the input crs).",
+                                                false, outliersParameters.tileSize, "A double");
+        TCLAP::ValueArg<double> outliersHaloArg("", "outliers-halo", "Size of the margin around each tile in which the neighbors are also searched.",
+                                                false, -1, "A double, if below 0 then the radius, or a tenth of the tile size for the statistical outlier removal, is used");
+
+        TCLAP::SwitchArg groundArg("", "ground", "Classify the points as ground (2) or unclassified (1) with a progressive morphological filter, "
+                                   "the classification attribute is added if needed");
+        TCLAP::ValueArg<double> groundCellArg("", "ground-cell", "Size of the cells of the minimal height raster of the ground classification (in the units of the input crs).",
+                                              false, groundParameters.cellSize, "A double");
+        TCLAP::ValueArg<double> groundMaxWindowArg("", "ground-max-window", "Size of the largest window of the ground classification, should be larger than the largest building.",
+                                                   false, groundParameters.maxWindowSize, "A double");
+        TCLAP::ValueArg<double> groundSlopeArg("", "ground-slope", "Expected slope of the terrain for the ground classification.",
+                                               false, groundParameters.slope, "A double");
+        TCLAP::ValueArg<double> groundInitialDistanceArg("", "ground-initial-distance", "Height above the ground surface points are still considered ground, for the smallest window.",
+                                                         false, groundParameters.initialDistance, "A double");
+        TCLAP::ValueArg<double> groundMaxDistanceArg("", "ground-max-distance", "Maximal height above the ground surface points are still considered ground.",
+                                                     false, groundParameters.maxDistance, "A double");
+        TCLAP::ValueArg<double> groundTileArg("", "ground-tile", "Size of the tiles the ground classification is computed in (in the units of the input crs).",
+                                              false, groundParameters.tileSize, "A double");
+
+        TCLAP::ValueArg<std::string> rasterArg("", "raster", "Bin the points in grids instead of writing them, in a single pass. "
+                                               "Each grid is written as an ESRI float grid, with the name of the grid appended to the output file name (e.g. out_zmin.flt and out_zmin.hdr)",
+                                               false, "", "A comma separated list of grids among zmin, zmax, zmean, intensity, count, "
+                                                          "and min:<attribute>, max:<attribute> or mean:<attribute>, e.g. \"zmin,zmax,count\"");
+        TCLAP::ValueArg<double> rasterCellArg("", "raster-cell", "Size of the cells of the grids (in the units of the output crs).",
+                                              false, rasterCellSize, "A double");
+
+        std::vector<std::string> allowedSortOrders = {"morton", "hilbert", "gpstime"};
+        TCLAP::ValuesConstraint<std::string> allowedSortOrdersConstraint(allowedSortOrders);
+        TCLAP::ValueArg<std::string> sortArg("", "sort", "Sort the output points along a space filling curve (morton or hilbert), for spatially coherent outputs, or by gps time. "
+                                             "Point clouds larger than the memory limit are sorted in runs spilled to disk, then merged",
+                                             false, "", &allowedSortOrdersConstraint);
+        TCLAP::ValueArg<double> memoryLimitArg("", "memory-limit", "Approximative memory the sort can use, in megabytes.",
+                                               false, sortMemoryLimit, "A double");
+        TCLAP::ValueArg<double> sortCellArg("", "sort-cell", "Size of the cells the positions are quantized on for the spatial sorts (in the units of the output crs).",
+                                            false, sortCellSize, "A double");
+
+        TCLAP::SwitchArg infoArg("", "info", "Print the statistics of each input file as json (to the output file if given, else to the standard output) instead of processing them. "
+                                          "The statistics are cached in a sidecar file next to the input (<input>.ldminfo), reused as long as the input is not modified.");
+
         TCLAP::SwitchArg removeColorArg("", "remove_color", "remove the color data, if present");
         TCLAP::SwitchArg removeAllAttributesArg("", "remove_all_attributes", "remove all data that is not geometry");
         TCLAP::MultiArg<std::string> removeAttributeArg("", "remove_attribute", "filter out an attribute in the data", false, "string, namming an attribute");
@@ -114,14 +264,46 @@ int main(int argc, char** argv) {
 
         cmd.add(inCrsArg);
         cmd.add(outCrsArg);
+        cmd.add(crsApproxArg);
         cmd.add(roiArg);
+        cmd.add(roiFileArg);
         cmd.add(densityArg);
         cmd.add(numberArg);
         cmd.add(returnCapArg);
         cmd.add(lineArg);
         cmd.add(lineRangeArg);
         cmd.add(formatArg);
+        cmd.add(partitionArg);
+        cmd.add(dedupArg);
+        cmd.add(dedupTimeArg);
+        cmd.add(dedupTileArg);
+        cmd.add(voxelArg);
+        cmd.add(voxelModeArg);
+        cmd.add(voxelTileArg);
+        cmd.add(outliersArg);
+        cmd.add(outliersKArg);
+        cmd.add(outliersSigmaArg);
+        cmd.add(outliersRadiusArg);
+        cmd.add(outliersMinNeighborsArg);
+        cmd.add(outliersTileArg);
+        cmd.add(outliersHaloArg);
+        cmd.add(groundArg);
+        cmd.add(groundCellArg);
+        cmd.add(groundMaxWindowArg);
+        cmd.add(groundSlopeArg);
+        cmd.add(groundInitialDistanceArg);
+        cmd.add(groundMaxDistanceArg);
+        cmd.add(groundTileArg);
+        cmd.add(rasterArg);
+        cmd.add(rasterCellArg);
+        cmd.add(sortArg);
+        cmd.add(memoryLimitArg);
+        cmd.add(sortCellArg);
+        cmd.add(infoArg);
         cmd.add(benchmarkArg);
+        cmd.add(benchmarkJsonArg);
+        cmd.add(dynamicPipelineArg);
+        cmd.add(progressFdArg);
 
         cmd.add(removeColorArg);
         cmd.add(removeAllAttributesArg);
@@ -129,24 +311,35 @@ int main(int argc, char** argv) {
 
         cmd.parse(argc, argv);
 
-        inFile = inputFileArg.getValue();
+        inFiles = inputFileArg.getValue();
         outFile = outputFileArg.getValue();
 
-        if (inCrsArg.isSet() and outCrsArg.isSet()) {
-            std::string inCrs = inCrsArg.getValue();
-            std::string outCrs = outCrsArg.getValue();
+        if (inCrsArg.isSet()) {
+            inCrs = inCrsArg.getValue();
         }
 
+        if (outCrsArg.isSet()) {
+            outCrs = outCrsArg.getValue();
+        }
+
+        crsApproximationTolerance = crsApproxArg.getValue();
+
         if (roiArg.isSet()) {
             roi = roiArg.getValue();
         }
 
+        roiFile = roiFileArg.getValue();
+
         density = densityArg.getValue();
         number = numberArg.getValue();
         returnCap = returnCapArg.getValue();
         lineIdxs = lineArg.getValue();
 
-        benchmarkProcessing = benchmarkArg.isSet();
+        benchmarkJson = benchmarkJsonArg.isSet();
+        dynamicPipeline = dynamicPipelineArg.isSet();
+        benchmarkProcessing = benchmarkArg.isSet() or benchmarkJson;
+
+        progressFd = progressFdArg.getValue();
 
         std::vector<std::string> const& linesRanges = lineRangeArg.getValue();
 
@@ -177,6 +370,62 @@ int main(int argc, char** argv) {
 
         outFormat = formatArg.getValue();
 
+        partitionDefinition = partitionArg.getValue();
+
+        duplicatesTolerance = dedupArg.getValue();
+        duplicatesTimeTolerance = dedupTimeArg.getValue();
+        duplicatesTileSize = dedupTileArg.getValue();
+
+        voxelSize = voxelArg.getValue();
+        voxelRepresentative = VoxelDownsampler::parseRepresentative(voxelModeArg.getValue()).value_or(VoxelDownsampler::Centroid);
+        voxelTileSize = voxelTileArg.getValue();
+
+        outliersMethod = OutlierRemover::parseMethod(outliersArg.getValue());
+
+        if (outliersMethod.has_value()) {
+            outliersParameters.method = outliersMethod.value();
+        }
+
+        outliersParameters.nNeighbors = outliersKArg.getValue();
+        outliersParameters.sigma = outliersSigmaArg.getValue();
+        outliersParameters.radius = outliersRadiusArg.getValue();
+        outliersParameters.minNeighbors = outliersMinNeighborsArg.getValue();
+        outliersParameters.tileSize = outliersTileArg.getValue();
+        outliersParameters.haloSize = outliersHaloArg.getValue();
+
+        classifyGround = groundArg.getValue();
+        groundParameters.cellSize = groundCellArg.getValue();
+        groundParameters.maxWindowSize = groundMaxWindowArg.getValue();
+        groundParameters.slope = groundSlopeArg.getValue();
+        groundParameters.initialDistance = groundInitialDistanceArg.getValue();
+        groundParameters.maxDistance = groundMaxDistanceArg.getValue();
+        groundParameters.tileSize = groundTileArg.getValue();
+
+        if (!rasterArg.getValue().empty()) {
+
+            rasterProducts = PointCloudRasterizer::parseProducts(rasterArg.getValue());
+
+            if (!rasterProducts.has_value()) {
+                throw TCLAP::ArgException("Invalid raster definition", rasterArg.getName());
+            }
+
+            rasterCellSize = rasterCellArg.getValue();
+
+            if (!std::isfinite(rasterCellSize) or rasterCellSize <= 0) {
+                throw TCLAP::ArgException("Invalid raster cell size", rasterCellArg.getName());
+            }
+        }
+
+        sortOrder = PointSorter::parseOrder(sortArg.getValue());
+        sortMemoryLimit = memoryLimitArg.getValue();
+        sortCellSize = sortCellArg.getValue();
+
+        infoMode = infoArg.getValue();
+
+        if (!infoMode and !outputFileArg.isSet()) {
+            throw TCLAP::ArgException("Required argument missing", outputFileArg.getName());
+        }
+
         removeColor = removeColorArg.isSet();
         removeAllAttributes = removeAllAttributesArg.isSet();
 
@@ -189,116 +438,262 @@ int main(int argc, char** argv) {
 
     }
 
-    //Open file
-    auto pointCloudStackOpt = StereoVision::IO::openPointCloud(inFile);
+    //the regions are loaded first, so that an invalid region file is reported before the processing.
+    std::optional<RegionOfInterestSet> roiSet;
 
-    if (!pointCloudStackOpt.has_value()) {
-        std::cerr << "Could not open file: \"" << inFile << "\"! \n\t error message is: \"" << pointCloudStackOpt.message() << "\" \n\tAborting!" << std::endl;
+    if (!roiFile.empty()) {
+
+        if (!partitionDefinition.empty()) {
+            std::cerr << "The output cannot be both partitioned and split in regions of interest! Aborting!" << std::endl;
+            return 1;
+        }
+
+        roiSet = RegionOfInterestSet::fromFile(roiFile);
+
+        if (!roiSet.has_value()) {
+            std::cerr << "Invalid region file: \"" << roiFile << "\"! Aborting!" << std::endl;
+            return 1;
+        }
+    }
+
+    bool partitionedOutput = !partitionDefinition.empty() or roiSet.has_value();
+
+    if (rasterProducts.has_value() and (isStandardStreamPath(outFile) or partitionedOutput)) {
+        std::cerr << "Rasters cannot be written to the standard output or partitioned! Aborting!" << std::endl;
         return 1;
     }
 
-    StereoVision::IO::FullPointCloudAccessInterface& pointCloudStack = pointCloudStackOpt.value();
+    //the standard input is spooled in memory, so that it can be read as a regular file.
+    std::optional<MemorySpool> inputSpool;
 
-    if (pointCloudStack.headerAccess == nullptr and pointCloudStack.pointAccess == nullptr) {
-        std::cerr << "Error reading file: \"" << inFile << "\", null accesss interfaces! Aborting!" << std::endl;
+    int nStdinInputs = std::count_if(inFiles.begin(), inFiles.end(), isStandardStreamPath);
+
+    if (nStdinInputs > 1) {
+        std::cerr << "The standard input can be used only once as input! Aborting!" << std::endl;
         return 1;
     }
 
-    //prepare points counting
+    if (nStdinInputs == 1) {
+
+        inputSpool = MemorySpool::create("ldm-stdin");
+
+        if (!inputSpool.has_value() or !inputSpool->fillFrom(STDIN_FILENO)) {
+            std::cerr << "Could not read the standard input! Aborting!" << std::endl;
+            return 1;
+        }
 
+        for (std::string & inFile : inFiles) {
+            if (isStandardStreamPath(inFile)) {
+                inFile = inputSpool->path().string();
+            }
+        }
+    }
 
-    constexpr int maxNumberOfStepWrite = 1000;
+    if (infoMode) {
 
-    int expectedNumberOfPoints = pointCloudStack.expectedNumberOfPoints();
+        std::ofstream outFileStream;
+        bool writeInfoToFile = !outFile.empty() and !isStandardStreamPath(outFile);
 
-    int nProcessedPoints = pointCloudStack.pointAccess->processedNumberOfPoints();
+        if (writeInfoToFile) {
 
-    StereoVision::IO::PointCloudPointAccessInterface* initialPointCloudReader = pointCloudStack.pointAccess.get();
+            outFileStream.open(outFile);
 
-    //process stack
+            if (!outFileStream.is_open()) {
+                std::cerr << "Could not open output file: \"" << outFile << "\"! Aborting!" << std::endl;
+                return 1;
+            }
+        }
 
-    //do the filtering first (so that the points are removed)
+        std::ostream & out = (writeInfoToFile) ? outFileStream : std::cout;
 
-    //region of interest
-    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> roiSelector =
-        RegionOfInterestSelector::setupRoiSelection(pointCloudStack.pointAccess, roi);
+        out << "[";
 
-    if (roiSelector != nullptr) {
-        pointCloudStack.pointAccess = std::move(roiSelector);
-    }
+        for (size_t i = 0; i < inFiles.size(); i++) {
+
+            std::string const& inFile = inFiles[i];
+            bool isSpooledInput = inputSpool.has_value() and inFile == inputSpool->path().string();
 
-    if (density > 0 and density < std::numeric_limits<double>::infinity()) {
-        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> densitySelector =
-                AttributeBasedSelector::setupAttributeBasedSelector(pointCloudStack.pointAccess,
-                                                                    "densityFilterAttr",
-                                                                    AttributeBasedSelector::SmallerOrEqual,
-                                                                    density);
+            std::optional<PointCloudInfo> info;
+            bool fromSidecar = false;
+
+            if (isSpooledInput) {
+
+                //the standard input has no stable identity, so its statistics are never cached.
+                auto pointCloudOpt = openPointCloudByContent(inFile);
+
+                if (pointCloudOpt.has_value() and pointCloudOpt.value().pointAccess != nullptr) {
+                    info = PointCloudInfo::compute(*pointCloudOpt.value().pointAccess);
+                }
+
+            } else {
+                info = PointCloudInfo::forFile(inFile, &fromSidecar);
+            }
+
+            if (!info.has_value()) {
+                std::cerr << "Could not read file: \"" << inFile << "\"! Aborting!" << std::endl;
+                return 1;
+            }
 
-        if (densitySelector != nullptr) {
-            pointCloudStack.pointAccess = std::move(densitySelector);
+            out << ((i > 0) ? "," : "") << "\n{\"file\":\"" << ((isSpooledInput) ? "-" : PointCloudInfo::jsonEscape(inFile)) << "\",\"cached\":" << ((fromSidecar) ? "true" : "false") << ",\"info\":";
+            info->writeJson(out);
+            out << "}";
         }
+
+        out << "\n]" << std::endl;
+
+        return (out) ? 0 : 1;
     }
 
-    if (number > 0) {
+    //Open file(s)
+    StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+    int64_t expectedNumberOfPoints = -1;
+
+    LdmcPointCloudReader* ldmcReader = nullptr;
+    MergedPointCloud const* mergedReader = nullptr;
+
+    if (inFiles.size() == 1) {
+
+        std::string const& inFile = inFiles[0];
+
+        auto pointCloudStackOpt = openPointCloudByContent(inFile);
+
+        if (!pointCloudStackOpt.has_value()) {
+            std::cerr << "Could not open file: \"" << inFile << "\"! \n\t error message is: \"" << pointCloudStackOpt.message() << "\" \n\tAborting!" << std::endl;
+            return 1;
+        }
 
-        long step = 1;
+        pointCloudStack = std::move(pointCloudStackOpt.value());
 
-        if (expectedNumberOfPoints >= 0) {
-            step = std::max<long>(1, std::floor(expectedNumberOfPoints/number));
+        if (pointCloudStack.headerAccess == nullptr and pointCloudStack.pointAccess == nullptr) {
+            std::cerr << "Error reading file: \"" << inFile << "\", null accesss interfaces! Aborting!" << std::endl;
+            return 1;
         }
 
-        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> numberSelector =
-                PointsNumberLimit::setupPointNumberLimit(
-                    pointCloudStack.pointAccess,
-                    number,
-                    step);
+        expectedNumberOfPoints = pointCloudStack.expectedNumberOfPoints();
+
+        //formats without a point count in their header (e.g. ascii files) can still get it from the statistics sidecar, if one is up to date.
+        if (expectedNumberOfPoints < 0) {
 
-        if (numberSelector != nullptr) {
-            pointCloudStack.pointAccess = std::move(numberSelector);
+            std::optional<PointCloudInfo> cachedInfo = PointCloudInfo::fromSidecar(inFile);
+
+            if (cachedInfo.has_value()) {
+                expectedNumberOfPoints = cachedInfo->nPoints;
+            }
         }
-    }
 
-    if (returnCap > 0) {
+        //ldmc files carry per chunk statistics, the chunks which cannot contain selected points are skipped.
+        ldmcReader = dynamic_cast<LdmcPointCloudReader*>(pointCloudStack.pointAccess.get());
+
+        if (ldmcReader != nullptr) {
 
-        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> returnNumberSelector =
-                AttributeBasedSelector::setupAttributeBasedSelector(pointCloudStack.pointAccess,
-                                                                    "returnNumber",
-                                                                    AttributeBasedSelector::SmallerOrEqual,
-                                                                    returnCap);
+            expectedNumberOfPoints = ldmcReader->numberOfPoints();
 
-        if (returnNumberSelector != nullptr) {
-            pointCloudStack.pointAccess = std::move(returnNumberSelector);
+            std::optional<StaticStages::Roi> roiStage = StaticStages::Roi::fromDefinition(roi);
+
+            if (roiStage.has_value()) {
+                ldmcReader->addChunkPredicate(Ldmc::boxPredicate(roiStage->world2rect, roiStage->extents));
+            }
+
+            //the return cap and the line selection are applied after the number limit, which depends on all the points.
+            if (number <= 0 and returnCap > 0) {
+                ldmcReader->addChunkPredicate(Ldmc::maxValuePredicate("returnNumber", returnCap));
+            }
+
+            if (number <= 0 and lineIdxs.size() > 0) {
+                ldmcReader->addChunkPredicate(Ldmc::valueSetPredicate("lineNumber", StaticStages::LineSet::fromIndices(lineIdxs).lines));
+            }
+        }
+
+    } else {
+
+        pointCloudStack = MergedPointCloud::setupMergedPointCloud(inFiles, inCrs, &expectedNumberOfPoints);
+
+        if (pointCloudStack.headerAccess == nullptr or pointCloudStack.pointAccess == nullptr) {
+            std::cerr << "Error merging the input files! Aborting!" << std::endl;
+            return 1;
         }
+
+        mergedReader = static_cast<MergedPointCloud const*>(pointCloudStack.pointAccess.get());
     }
 
-    if (lineIdxs.size() > 0) {
+    //prepare points counting
+    int64_t expectedNumberOfBytes = 0;
 
-        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> lineSelector =
-                AttributeSetBasedSelector::setupAttributeSetBasedSelector(pointCloudStack.pointAccess,
-                                                                    "lineNumber",
-                                                                    AttributeSetBasedSelector::InSet,
-                                                                    lineIdxs);
+    for (std::string const& inFile : inFiles) {
+        std::error_code ec;
+        uintmax_t size = std::filesystem::file_size(inFile, ec);
 
-        if (lineSelector != nullptr) {
-            pointCloudStack.pointAccess = std::move(lineSelector);
+        if (ec) {
+            expectedNumberOfBytes = -1;
+            break;
         }
+
+        expectedNumberOfBytes += size;
     }
 
-    //then processing (only on the leftover points).
+    ProgressCounter* progressCounter = new ProgressCounter(std::move(pointCloudStack.pointAccess));
+    pointCloudStack.pointAccess = std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface>(progressCounter);
+
+    bool writeToStdout = isStandardStreamPath(outFile);
+
+    //the reporting starts before the processing stack is built, as some stages (e.g. the voxel downsampling) consume the points when they are setup.
+    //when the data goes to the standard output, the progress is printed on the error output.
+    ProgressReporter progressReporter(progressCounter,
+                                      expectedNumberOfPoints,
+                                      expectedNumberOfBytes,
+                                      true,
+                                      progressFd,
+                                      (writeToStdout) ? std::cerr : std::cout);
+    progressReporter.start();
 
-    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> attributesFilter =
-            PointsAttributesFilters::setupPointAttributeFiltering(pointCloudStack.pointAccess,
-                                                                  removeColor,
-                                                                  attributes2filter,
-                                                                  removeAllAttributes);
+    std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+
+    //when benchmarking, a probe is inserted after each stage.
+    PipelineProfiler profiler;
+
+    auto probeStage = [benchmarkProcessing, &profiler, &pointCloudStack] (std::string const& name) {
+        if (benchmarkProcessing) {
+            pointCloudStack.pointAccess = profiler.addStage(name, std::move(pointCloudStack.pointAccess));
+        }
+    };
+
+    //the stages consuming their source when they are setup are timed from the start of their setup.
+    using SetupTimePoint = std::chrono::time_point<std::chrono::high_resolution_clock>;
+
+    auto probeBlockingStage = [benchmarkProcessing, &profiler, &pointCloudStack] (std::string const& name, SetupTimePoint setupStart) {
+        if (benchmarkProcessing) {
+            std::chrono::duration<double> setupTime = std::chrono::high_resolution_clock::now() - setupStart;
+            pointCloudStack.pointAccess = profiler.addBlockingStage(name, std::move(pointCloudStack.pointAccess), setupTime.count());
+        }
+    };
+
+    probeStage("reader");
+
+    //the blocking stages end their output early when they fail after their setup (e.g. a spooled tile which cannot be read back),
+    //so they are checked once the points have been written.
+    std::vector<std::function<bool()>> stagesChecks;
+
+    auto checkStage = [&stagesChecks] (auto const* stage) {
+        stagesChecks.push_back([stage] () {
+            return stage->ok();
+        });
+    };
 
-    if (attributesFilter != nullptr) {
-        pointCloudStack.pointAccess = std::move(attributesFilter);
+    //a corrupt chunk ends the points of a ldmc file early.
+    if (ldmcReader != nullptr) {
+        checkStage(static_cast<LdmcPointCloudReader const*>(ldmcReader));
     }
 
-    //crs conversion
+    //the merged files are opened one after the other, and one can fail to open again.
+    if (mergedReader != nullptr) {
+        checkStage(mergedReader);
+    }
+
+    //get the input crs, if a conversion is requested
+    std::string inCrsVal;
+
     if (!outCrs.empty()) {
-        std::string inCrsVal;
 
         std::optional<StereoVision::IO::PointCloudGenericAttribute> inCrsAttr =
                 pointCloudStack.headerAccess->getAttributeByName("crs");
@@ -313,75 +708,367 @@ int main(int argc, char** argv) {
             std::cerr << "Could not get input crs info, crs conversion error!";
             return 1;
         }
+    }
+
+    //process stack
+
+    //the common combinations of operations have a specialized pipeline, the other ones use the generic processing chain.
+    bool densityFilter = density > 0 and density < std::numeric_limits<double>::infinity();
+    bool attributesFiltering = removeColor or removeAllAttributes or !attributes2filter.empty();
+
+    bool staticPipelineUsed = false;
+
+    bool voxelDownsampling = voxelSize > 0;
+    bool outliersRemoval = outliersMethod.has_value();
+    bool duplicatesRemoval = duplicatesTolerance > 0;
+
+    if (!dynamicPipeline and !densityFilter and number <= 0 and !attributesFiltering and !duplicatesRemoval and
+            !voxelDownsampling and !outliersRemoval and !classifyGround) {
+
+        StaticPipelineConfig config;
+
+        config.roi = StaticStages::Roi::fromDefinition(roi);
+
+        if (returnCap > 0) {
+            config.returnCap = StaticStages::ReturnCap{double(returnCap)};
+        }
+
+        if (lineIdxs.size() > 0) {
+            config.lineSet = StaticStages::LineSet::fromIndices(lineIdxs);
+        }
+
+        if (!outCrs.empty() and inCrsVal != outCrs) {
+            config.crs = StaticStages::Crs::setup(inCrsVal, outCrs, crsApproximationTolerance);
+
+            if (!config.crs.has_value()) {
+                std::cerr << "Error building crs converter, crs conversion error!";
+                return 1;
+            }
+        }
+
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> staticPipeline =
+                setupStaticPipeline(pointCloudStack.pointAccess, std::move(config));
+
+        if (staticPipeline != nullptr) {
+            pointCloudStack.pointAccess = std::move(staticPipeline);
+            probeStage("static pipeline");
+        }
+
+        //if no stage is needed, the generic chain is a no-op too.
+        staticPipelineUsed = true;
+    }
+
+    if (!staticPipelineUsed) {
+
+        //do the filtering first (so that the points are removed)
+
+        //region of interest
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> roiSelector =
+            RegionOfInterestSelector::setupRoiSelection(pointCloudStack.pointAccess, roi);
+
+        if (roiSelector != nullptr) {
+            pointCloudStack.pointAccess = std::move(roiSelector);
+            probeStage("roi");
+        }
+
+        if (densityFilter) {
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> densitySelector =
+                    AttributeBasedSelector::setupAttributeBasedSelector(pointCloudStack.pointAccess,
+                                                                        "densityFilterAttr",
+                                                                        AttributeBasedSelector::SmallerOrEqual,
+                                                                        density);
+
+            if (densitySelector != nullptr) {
+                pointCloudStack.pointAccess = std::move(densitySelector);
+                probeStage("density");
+            }
+        }
+
+        if (number > 0) {
+
+            int64_t step = 1;
+
+            if (expectedNumberOfPoints >= 0) {
+                step = std::max<int64_t>(1, expectedNumberOfPoints/number);
+            }
+
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> numberSelector =
+                    PointsNumberLimit::setupPointNumberLimit(
+                        pointCloudStack.pointAccess,
+                        number,
+                        step);
+
+            if (numberSelector != nullptr) {
+                pointCloudStack.pointAccess = std::move(numberSelector);
+                probeStage("number limit");
+            }
+        }
+
+        if (returnCap > 0) {
+
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> returnNumberSelector =
+                    AttributeBasedSelector::setupAttributeBasedSelector(pointCloudStack.pointAccess,
+                                                                        "returnNumber",
+                                                                        AttributeBasedSelector::SmallerOrEqual,
+                                                                        returnCap);
+
+            if (returnNumberSelector != nullptr) {
+                pointCloudStack.pointAccess = std::move(returnNumberSelector);
+                probeStage("return cap");
+            }
+        }
+
+        if (lineIdxs.size() > 0) {
+
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> lineSelector =
+                    AttributeSetBasedSelector::setupAttributeSetBasedSelector(pointCloudStack.pointAccess,
+                                                                        "lineNumber",
+                                                                        AttributeSetBasedSelector::InSet,
+                                                                        lineIdxs);
+
+            if (lineSelector != nullptr) {
+                pointCloudStack.pointAccess = std::move(lineSelector);
+                probeStage("lines");
+            }
+        }
+
+        //then processing (only on the leftover points).
+
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> attributesFilter =
+                PointsAttributesFilters::setupPointAttributeFiltering(pointCloudStack.pointAccess,
+                                                                      removeColor,
+                                                                      attributes2filter,
+                                                                      removeAllAttributes);
+
+        if (attributesFilter != nullptr) {
+            pointCloudStack.pointAccess = std::move(attributesFilter);
+
+            if (attributesFiltering) {
+                probeStage("attributes");
+            }
+        }
+
+        //the duplicates are removed first, they would bias the neighborhoods of the following stages.
+        if (duplicatesRemoval) {
+
+            SetupTimePoint setupStart = std::chrono::high_resolution_clock::now();
+
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> duplicateRemover =
+                    DuplicateRemover::setupDuplicateRemover(pointCloudStack.pointAccess,
+                                                            duplicatesTolerance,
+                                                            duplicatesTimeTolerance,
+                                                            duplicatesTileSize);
+
+            if (duplicateRemover == nullptr) {
+                std::cerr << "Invalid duplicates removal parameters (the gps time tolerance needs a gpsTime attribute), or the points could not be spooled!" << std::endl;
+                return 1;
+            }
+
+            checkStage(static_cast<DuplicateRemover const*>(duplicateRemover.get()));
+            pointCloudStack.pointAccess = std::move(duplicateRemover);
+            probeBlockingStage("duplicates", setupStart);
+        }
+
+        //the outliers are removed before the downsampling, which would otherwise merge them with valid points.
+        if (outliersRemoval) {
+
+            SetupTimePoint setupStart = std::chrono::high_resolution_clock::now();
+
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> outlierRemover =
+                    OutlierRemover::setupOutlierRemover(pointCloudStack.pointAccess, outliersParameters);
+
+            if (outlierRemover == nullptr) {
+                std::cerr << "Invalid outliers removal parameters, or the points could not be spooled!" << std::endl;
+                return 1;
+            }
+
+            checkStage(static_cast<OutlierRemover const*>(outlierRemover.get()));
+            pointCloudStack.pointAccess = std::move(outlierRemover);
+            probeBlockingStage("outliers", setupStart);
+        }
+
+        if (classifyGround) {
+
+            SetupTimePoint setupStart = std::chrono::high_resolution_clock::now();
+
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> groundClassifier =
+                    GroundClassifier::setupGroundClassifier(pointCloudStack.pointAccess, groundParameters);
+
+            if (groundClassifier == nullptr) {
+                std::cerr << "Invalid ground classification parameters, or the points could not be spooled!" << std::endl;
+                return 1;
+            }
+
+            checkStage(static_cast<GroundClassifier const*>(groundClassifier.get()));
+            pointCloudStack.pointAccess = std::move(groundClassifier);
+            probeBlockingStage("ground", setupStart);
+        }
+
+        if (voxelDownsampling) {
+
+            SetupTimePoint setupStart = std::chrono::high_resolution_clock::now();
+
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> voxelDownsampler =
+                    VoxelDownsampler::setupVoxelDownsampler(pointCloudStack.pointAccess,
+                                                            voxelSize,
+                                                            voxelRepresentative,
+                                                            voxelTileSize);
+
+            if (voxelDownsampler == nullptr) {
+                std::cerr << "Invalid voxel downsampling parameters, or the points could not be spooled!" << std::endl;
+                return 1;
+            }
+
+            checkStage(static_cast<VoxelDownsampler const*>(voxelDownsampler.get()));
+            pointCloudStack.pointAccess = std::move(voxelDownsampler);
+            probeBlockingStage("voxels", setupStart);
+        }
+    }
+
+    //crs conversion
+    if (!outCrs.empty() and !staticPipelineUsed) {
 
         std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> crsConvertor =
                 CrsConversion::setupCrsConversion(pointCloudStack.pointAccess,
-                                                  inCrs,
-                                                  outCrs);
+                                                  inCrsVal,
+                                                  outCrs,
+                                                  crsApproximationTolerance);
 
         if (crsConvertor == nullptr) {
             std::cerr << "Error building crs converter, crs conversion error!";
             return 1;
         }
 
+        pointCloudStack.pointAccess = std::move(crsConvertor);
+        probeStage("crs");
+
+    }
+
+    if (!outCrs.empty()) {
         AliasHeaderAttributes::AliasMap headerAlias;
         headerAlias["crs"] = outCrs;
 
         pointCloudStack.headerAccess = std::make_unique<AliasHeaderAttributes>(std::move(pointCloudStack.headerAccess), headerAlias);
-        pointCloudStack.pointAccess = std::move(crsConvertor);
-
     }
 
-    //write file
+    //the points are sorted last, in the output crs.
+    if (sortOrder.has_value()) {
 
-    std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+        if (!std::isfinite(sortMemoryLimit) or sortMemoryLimit <= 0) {
+            std::cerr << "Invalid memory limit: " << sortMemoryLimit << "!" << std::endl;
+            return 1;
+        }
 
-    bool progressWriterContinue = true;
-    auto progressWriter = [expectedNumberOfPoints, nProcessedPoints, initialPointCloudReader, &progressWriterContinue] () {
+        SetupTimePoint setupStart = std::chrono::high_resolution_clock::now();
 
-        using namespace std::chrono_literals;
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> sorter =
+                PointSorter::setupPointSorter(pointCloudStack.pointAccess,
+                                              sortOrder.value(),
+                                              static_cast<size_t>(sortMemoryLimit*(1 << 20)),
+                                              sortCellSize);
 
-        if (nProcessedPoints < 0) {
-            return;
+        if (sorter == nullptr) {
+            std::cerr << "Could not sort the points (the gps time sort needs a gpsTime attribute)!" << std::endl;
+            return 1;
         }
 
+        pointCloudStack.pointAccess = std::move(sorter);
+        probeBlockingStage("sort", setupStart);
+    }
+
+    //write file
+
+    //the sequential formats are streamed to the standard output, the other writers need a seekable file,
+    //so the standard output is spooled in memory, then copied at the end.
+    std::optional<MemorySpool> outputSpool;
+    std::filesystem::path outPath(outFile);
+
+    bool streamToStdout = writeToStdout and isStreamableFormat(outFormat);
+
+    if (writeToStdout and partitionedOutput) {
+        std::cerr << "Partitioned output cannot be written to the standard output! Aborting!" << std::endl;
+        return 1;
+    }
 
-        #ifdef CONTAINER_EXTRAS
-        const char lineStartSymbol = '\n';
-        #else
-        const char lineStartSymbol = '\r';
-        #endif
+    if (writeToStdout and !streamToStdout) {
 
-        while (progressWriterContinue) {
-            std::cout << lineStartSymbol << "Processed " << initialPointCloudReader->processedNumberOfPoints() << "/" << expectedNumberOfPoints;
-            std::cout.flush();
-            std::this_thread::sleep_for(100ms);
+        outputSpool = MemorySpool::create("ldm-stdout");
+
+        if (!outputSpool.has_value()) {
+            std::cerr << "Could not create output spool! Aborting!" << std::endl;
+            return 1;
         }
 
-        std::cout << lineStartSymbol << "Processed " << expectedNumberOfPoints << "/" << expectedNumberOfPoints << " " << std::endl;
-    };
+        outPath = outputSpool->path();
+    }
+
+    if (rasterProducts.has_value()) {
+
+        PointCloudRasterizer rasterizer(rasterCellSize, rasterProducts.value());
+        rasterizer.addPoints(*pointCloudStack.pointAccess);
 
-    std::thread progressWritingThread(progressWriter);
+        if (!rasterizer.writeEsriGrids(outFile)) {
+            std::cerr << "Error writing rasters to " << outFile << "!" << std::endl;
+            return 1;
+        }
 
-    if (outFormat == "lasv13" or outFormat == "lasv12") {
+    } else if (outFormat == "lasv13" or outFormat == "lasv12") {
         std::cerr << "Older LAS version unsupported yet" << std::endl;
         return 1;
-    } else if (outFormat == "lasv14") {
-        bool ok = StereoVision::IO::writePointCloudLas(std::filesystem::path(outFile), pointCloudStack);
+    } else if (partitionedOutput) {
 
-        if (!ok) {
-            std::cerr << "Error writing point cloud data to " << outFile << "!" << std::endl;
+        //the regions are defined in the input crs, like the region of interest, so the converted points are converted back to test them.
+        std::shared_ptr<const CrsTransform> toRegionsCrs;
+
+        if (roiSet.has_value() and !outCrs.empty() and inCrsVal != outCrs) {
+
+            std::optional<CrsTransform> inverseConversion = CrsTransform::setup(outCrs, inCrsVal, crsApproximationTolerance);
+
+            if (!inverseConversion.has_value()) {
+                std::cerr << "Error building the conversion of the points to the crs of the regions of interest!" << std::endl;
+                return 1;
+            }
+
+            toRegionsCrs = std::make_shared<CrsTransform>(std::move(inverseConversion.value()));
+        }
+
+        //each point is routed to all the regions containing it.
+        std::optional<PartitionedWriter::PartitionFunction> partitionFunction = (roiSet.has_value()) ?
+                    roiSet->partitionFunction(toRegionsCrs) :
+                    PartitionedWriter::parsePartitionDefinition(partitionDefinition);
+
+        if (!partitionFunction.has_value()) {
+            std::cerr << "Invalid partition definition: \"" << partitionDefinition << "\"!" << std::endl;
             return 1;
         }
-    } else if (outFormat == "pcd-ascii" or outFormat == "pcd-bin") {
 
-        StereoVision::IO::PcdDataStorageType dataStorageType = StereoVision::IO::PcdDataStorageType::ascii;
+        PartitionedWriter writer(std::filesystem::path(outFile), partitionFunction.value());
+
+        bool ok = writer.write(pointCloudStack, [&outFormat] (std::filesystem::path const& path,
+                                                StereoVision::IO::FullPointCloudAccessInterface & partition) {
+            return writePointCloud(path, partition, outFormat);
+        });
+
+        if (!ok) {
+            std::cerr << "Error writing partitioned point cloud data to " << outFile << "!" << std::endl;
+            return 1;
+        }
 
-        if (outFormat == "pcd-bin") {
-            dataStorageType = StereoVision::IO::PcdDataStorageType::binary;
+        //the regions without any point have no output file.
+        if (roiSet.has_value()) {
+            for (std::string const& name : roiSet->emptyRegions(writer.partitionsSizes())) {
+                std::cerr << "Warning: the region of interest " << name << " contains no point, no output has been written for it!" << std::endl;
+            }
         }
+    } else if (streamToStdout) {
+        bool ok = writePointCloud(std::cout, pointCloudStack, outFormat);
 
-        bool ok = StereoVision::IO::writePointCloudPcd(std::filesystem::path(outFile), pointCloudStack, dataStorageType);
+        if (!ok) {
+            std::cerr << "Error writing point cloud data to " << outFile << "!" << std::endl;
+            return 1;
+        }
+    } else {
+        bool ok = writePointCloud(outPath, pointCloudStack, outFormat);
 
         if (!ok) {
             std::cerr << "Error writing point cloud data to " << outFile << "!" << std::endl;
@@ -389,14 +1076,33 @@ int main(int argc, char** argv) {
         }
     }
 
+    for (std::function<bool()> const& check : stagesChecks) {
+        if (!check()) {
+            std::cerr << "Error processing the point cloud, the output " << outFile << " is incomplete!" << std::endl;
+            return 1;
+        }
+    }
+
+    //nothing is sent to the standard output if the processing failed (except for the streamed formats, which are then truncated).
+    if (outputSpool.has_value() and !outputSpool->copyTo(STDOUT_FILENO)) {
+        std::cerr << "Error writing point cloud data to " << outFile << "!" << std::endl;
+        return 1;
+    }
+
     std::chrono::time_point end = std::chrono::high_resolution_clock::now();
 
-    progressWriterContinue = false;
-    progressWritingThread.join();
+    progressReporter.finish(true);
 
     if (benchmarkProcessing) {
-        auto time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-        std::cerr << "Processed the point cloud in " << (time.count()/1000.) << " seconds!" << std::endl;
+        auto time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        double seconds = time.count()/1e6;
+
+        if (benchmarkJson) {
+            profiler.reportJson(std::cerr, seconds);
+        } else {
+            std::cerr << "Processed the point cloud in " << seconds << " seconds!" << std::endl;
+            profiler.report(std::cerr, seconds);
+        }
     }
 
     return 0;
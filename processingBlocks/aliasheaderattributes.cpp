@@ -20,7 +20,9 @@
 #include <set>
 
 AliasHeaderAttributes::AliasHeaderAttributes(std::unique_ptr<StereoVision::IO::PointCloudHeaderInterface> source,
-                                             AliasMap const& aliasMap)
+                                             AliasMap const& aliasMap) :
+    _src(std::move(source)),
+    _aliasMap(aliasMap)
 {
 
     _initialAttributesSize = 0;
@@ -58,7 +60,7 @@ std::optional<StereoVision::IO::PointCloudGenericAttribute> AliasHeaderAttribute
         return _aliasMap.at(attributeName);
     }
 
-    if (id < _initialAttributesSize) {
+    if (id < _initialAttributesSize and _src != nullptr) {
         return _src->getAttributeById(id);
     }
 
@@ -72,6 +74,10 @@ std::optional<StereoVision::IO::PointCloudGenericAttribute> AliasHeaderAttribute
         return _aliasMap.at(attributeName);
     }
 
+    if (_src == nullptr) {
+        return std::nullopt;
+    }
+
     return _src->getAttributeByName(attributeName);
 
 }
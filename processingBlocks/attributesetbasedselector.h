@@ -83,7 +83,10 @@ public:
         AttributeSetBasedSelector(std::move(source), attributeName),
         _comparisonVals(valsset)
     {
-
+        //the first point need to be checked too.
+        if (_src->hasData() and !isCurrentIn()) {
+            gotoNext();
+        }
     }
 
     virtual bool gotoNext() override {
@@ -98,64 +101,49 @@ public:
                 break;
             }
 
-            std::optional<StereoVision::IO::PointCloudGenericAttribute> attributeOpt =
-                    getAttributeByName(_attributeName.c_str());
-
+            nextIsIn = isCurrentIn();
 
-            if (mode == Mode::InSet and !attributeOpt.has_value()) {
-                nextIsIn = true;
-                break;
-            }
+        } while (!nextIsIn);
 
-            if (!attributeOpt.has_value()) {
-                continue;
-            }
+        return sourceHasNotEnded;
+    }
 
-            StereoVision::IO::PointCloudGenericAttribute& attribute = attributeOpt.value();
+protected:
 
-            if (mode == Mode::NotInSet) {
-                nextIsIn = true;
-            }
+    bool isCurrentIn() const {
 
-            using CompT = std::conditional_t<std::is_arithmetic_v<AttrT>, double, std::string>; //ensure the comparison type is a type that can holds all possible alternatives
+        std::optional<StereoVision::IO::PointCloudGenericAttribute> attributeOpt =
+                getAttributeByName(_attributeName.c_str());
 
-            CompT attributeVal;
-            CompT comparisonVal;
+        if (!attributeOpt.has_value()) {
+            return mode == Mode::InSet;
+        }
 
-            if (std::holds_alternative<CompT>(attribute)) {
-                attributeVal = std::get<CompT>(attribute);
-            } else {
-                attributeVal = StereoVision::IO::castedPointCloudAttribute<CompT>(attribute);
-            }
+        StereoVision::IO::PointCloudGenericAttribute& attribute = attributeOpt.value();
 
-            for (AttrT const& compVal : _comparisonVals) {
+        using CompT = std::conditional_t<std::is_arithmetic_v<AttrT>, double, std::string>; //ensure the comparison type is a type that can holds all possible alternatives
 
-                comparisonVal = compVal;
+        CompT attributeVal;
+        CompT comparisonVal;
 
-                bool isAlike = comparisonVal == attributeVal;
+        if (std::holds_alternative<CompT>(attribute)) {
+            attributeVal = std::get<CompT>(attribute);
+        } else {
+            attributeVal = StereoVision::IO::castedPointCloudAttribute<CompT>(attribute);
+        }
 
-                if (isAlike) {
+        for (AttrT const& compVal : _comparisonVals) {
 
-                    if constexpr (mode == Mode::InSet) {
-                        nextIsIn = true;
-                        break;
-                    }
+            comparisonVal = compVal;
 
-                    if constexpr (mode == Mode::NotInSet) {
-                        nextIsIn = false;
-                        break;
-                    }
-                }
+            if (comparisonVal == attributeVal) {
+                return mode == Mode::InSet;
             }
+        }
 
-
-        } while (!nextIsIn);
-
-        return sourceHasNotEnded;
+        return mode == Mode::NotInSet;
     }
 
-protected:
-
     std::set<AttrT> _comparisonVals;
 
 
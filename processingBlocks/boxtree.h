@@ -0,0 +1,235 @@
+#ifndef BOXTREE_H
+#define BOXTREE_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+/*!
+ * \brief The BoxTree class is a static R-tree of axis aligned 3d boxes, used to find the boxes containing a position.
+ *
+ * The tree is bulk loaded with the sort-tile-recursive method: the boxes (then the nodes of each level) are sorted by x,
+ * split in vertical slices, sorted by y in each slice and packed in full nodes, so that the nodes overlap little.
+ * The queries are const and can be run from multiple threads at the same time.
+ */
+class BoxTree
+{
+public:
+
+    struct Box {
+        std::array<double, 3> min;
+        std::array<double, 3> max;
+
+        inline bool contains(double const* position) const {
+            return position[0] >= min[0] and position[0] <= max[0] and
+                    position[1] >= min[1] and position[1] <= max[1] and
+                    position[2] >= min[2] and position[2] <= max[2];
+        }
+
+        inline void extend(Box const& other) {
+            for (int i = 0; i < 3; i++) {
+                min[i] = std::min(min[i], other.min[i]);
+                max[i] = std::max(max[i], other.max[i]);
+            }
+        }
+
+        inline double center(int axis) const {
+            return (min[axis] + max[axis])/2;
+        }
+    };
+
+    static constexpr int NodeSize = 8;
+
+    BoxTree() :
+        _root(-1)
+    {
+
+    }
+
+    explicit BoxTree(std::vector<Box> const& boxes) :
+        _root(-1)
+    {
+
+        if (boxes.empty()) {
+            return;
+        }
+
+        _items.resize(boxes.size());
+        std::iota(_items.begin(), _items.end(), 0);
+        sortTileRecursive(boxes, _items);
+
+        std::vector<Node> level = pack(boxes, _items, 0, true);
+
+        while (level.size() > 1) {
+
+            std::vector<Box> bounds(level.size());
+            std::vector<int64_t> order(level.size());
+
+            for (size_t i = 0; i < level.size(); i++) {
+                bounds[i] = level[i].bounds;
+            }
+
+            std::iota(order.begin(), order.end(), 0);
+            sortTileRecursive(bounds, order);
+
+            int64_t offset = _nodes.size();
+
+            for (int64_t idx : order) {
+                _nodes.push_back(level[idx]);
+            }
+
+            std::vector<int64_t> children(order.size());
+            std::iota(children.begin(), children.end(), offset);
+
+            level = pack(std::vector<Box>(), children, offset, false);
+        }
+
+        _nodes.push_back(level[0]);
+        _root = _nodes.size()-1;
+    }
+
+    inline size_t size() const {
+        return _items.size();
+    }
+
+    /*!
+     * \brief query find the boxes containing a position.
+     * \param position the query position.
+     * \param out the indices of the boxes (in the vector the tree was built from), in increasing order.
+     */
+    void query(double const* position, std::vector<int64_t> & out) const {
+
+        out.clear();
+
+        if (_root < 0) {
+            return;
+        }
+
+        //the depth of the tree is logarithmic, so a small stack is enough.
+        std::array<int64_t, MaxStackSize> stack;
+        int stackSize = 0;
+
+        stack[stackSize++] = _root;
+
+        while (stackSize > 0) {
+
+            Node const& node = _nodes[stack[--stackSize]];
+
+            if (!node.bounds.contains(position)) {
+                continue;
+            }
+
+            for (int64_t i = node.first; i < node.first + node.count; i++) {
+
+                if (node.leaf) {
+                    if (_boxes[i].contains(position)) {
+                        out.push_back(_items[i]);
+                    }
+                } else {
+                    stack[stackSize++] = i;
+                }
+            }
+        }
+
+        std::sort(out.begin(), out.end());
+    }
+
+protected:
+
+    static constexpr int MaxStackSize = 512;
+
+    struct Node {
+        Box bounds;
+        int64_t first; //!< first child, in the items for the leaves, in the nodes otherwise.
+        int64_t count;
+        bool leaf;
+    };
+
+    /*!
+     * \brief sortTileRecursive order boxes so that consecutive groups of NodeSize boxes are spatially compact.
+     */
+    static void sortTileRecursive(std::vector<Box> const& boxes, std::vector<int64_t> & order) {
+
+        size_t nGroups = (order.size() + NodeSize - 1)/NodeSize;
+        size_t nSlices = std::ceil(std::sqrt(double(nGroups)));
+        size_t sliceSize = nSlices*NodeSize;
+
+        std::sort(order.begin(), order.end(), [&boxes] (int64_t i1, int64_t i2) {
+            return boxes[i1].center(0) < boxes[i2].center(0);
+        });
+
+        for (size_t start = 0; start < order.size(); start += sliceSize) {
+
+            size_t end = std::min(order.size(), start + sliceSize);
+
+            std::sort(order.begin() + start, order.begin() + end, [&boxes] (int64_t i1, int64_t i2) {
+                return boxes[i1].center(1) < boxes[i2].center(1);
+            });
+        }
+    }
+
+    /*!
+     * \brief pack group consecutive children in nodes.
+     * \param boxes the boxes, for the leaves (the nodes are read from _nodes otherwise).
+     * \param children the children, in order.
+     * \param offset the index of the first child.
+     * \param leaf if the nodes are leaves.
+     * \return the nodes of the next level.
+     */
+    std::vector<Node> pack(std::vector<Box> const& boxes, std::vector<int64_t> const& children, int64_t offset, bool leaf) {
+
+        if (leaf) {
+            _boxes.resize(children.size());
+
+            for (size_t i = 0; i < children.size(); i++) {
+                _boxes[i] = boxes[children[i]];
+            }
+        }
+
+        std::vector<Node> ret;
+
+        for (size_t start = 0; start < children.size(); start += NodeSize) {
+
+            Node node;
+            node.first = offset + start;
+            node.count = std::min<int64_t>(NodeSize, children.size() - start);
+            node.leaf = leaf;
+            node.bounds = (leaf) ? _boxes[start] : _nodes[node.first].bounds;
+
+            for (int64_t i = node.first; i < node.first + node.count; i++) {
+                node.bounds.extend((leaf) ? _boxes[i] : _nodes[i].bounds);
+            }
+
+            ret.push_back(node);
+        }
+
+        return ret;
+    }
+
+    std::vector<int64_t> _items; //!< index of the box of each leaf entry.
+    std::vector<Box> _boxes; //!< boxes in the leaves order.
+    std::vector<Node> _nodes;
+    int64_t _root;
+};
+
+#endif // BOXTREE_H
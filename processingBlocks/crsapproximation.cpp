@@ -0,0 +1,286 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "crsapproximation.h"
+
+#include "spatialkeys.h"
+
+#include <proj.h>
+
+#include <cmath>
+
+namespace {
+
+using Vec3 = std::array<double, 3>;
+
+inline bool isFinite(Vec3 const& v) {
+    return std::isfinite(v[0]) and std::isfinite(v[1]) and std::isfinite(v[2]);
+}
+
+inline Vec3 trilinear(std::array<Vec3, 8> const& corners, double u, double v, double w) {
+
+    Vec3 ret;
+
+    for (int c = 0; c < 3; c++) {
+        double c00 = corners[0][c]*(1 - u) + corners[1][c]*u;
+        double c10 = corners[2][c]*(1 - u) + corners[3][c]*u;
+        double c01 = corners[4][c]*(1 - u) + corners[5][c]*u;
+        double c11 = corners[6][c]*(1 - u) + corners[7][c]*u;
+
+        double c0 = c00*(1 - v) + c10*v;
+        double c1 = c01*(1 - v) + c11*v;
+
+        ret[c] = c0*(1 - w) + c1*w;
+    }
+
+    return ret;
+}
+
+bool isGeographicInput(PJ_CONTEXT* projContext, PJ* transform) {
+
+    PJ* sourceCrs = proj_get_source_crs(projContext, transform);
+
+    if (sourceCrs == nullptr) {
+        return false;
+    }
+
+    PJ_TYPE type = proj_get_type(sourceCrs);
+    proj_destroy(sourceCrs);
+
+    return type == PJ_TYPE_GEOGRAPHIC_2D_CRS or type == PJ_TYPE_GEOGRAPHIC_3D_CRS;
+}
+
+}
+
+CrsApproximation::CrsApproximation(ExactTransform const& exact, double tolerance, double cellSize, double cellHeight) :
+    _exact(exact),
+    _tolerance(tolerance),
+    _cellSize(cellSize),
+    _cellHeight(cellHeight),
+    _nInterpolated(0),
+    _nExact(0),
+    _nSamples(0)
+{
+
+}
+
+CrsApproximation::~CrsApproximation() = default;
+
+std::unique_ptr<CrsApproximation> CrsApproximation::forProjTransform(pj_ctx* projContext, PJconsts* transform, double tolerance) {
+
+    if (transform == nullptr or !std::isfinite(tolerance) or tolerance <= 0) {
+        return nullptr;
+    }
+
+    //the heights are always in meters, only the horizontal units depend on the crs.
+    double cellSize = (isGeographicInput(projContext, transform)) ? 1.0/400 : 250;
+    double cellHeight = 250;
+
+    ExactTransform exact = [transform] (StereoVision::IO::PtGeometry<double> & position) {
+
+        constexpr int n = 1;
+        constexpr int delta_x = 1;
+        constexpr int delta_y = 1;
+        constexpr int delta_z = 1;
+
+        proj_trans_generic(transform, PJ_FWD,
+                           &position.x, delta_x, n,
+                           &position.y, delta_y, n,
+                           &position.z, delta_z, n,
+                           nullptr, 0, 0);
+    };
+
+    return std::make_unique<CrsApproximation>(exact, tolerance, cellSize, cellHeight);
+}
+
+size_t CrsApproximation::CellKeyHash::operator()(CellKey const& key) const {
+    return SpatialKeys::mix(key.x ^ SpatialKeys::mix(key.y ^ SpatialKeys::mix(key.z)));
+}
+
+CrsApproximation::Vec3 CrsApproximation::sample(double x, double y, double z) {
+
+    StereoVision::IO::PtGeometry<double> position;
+    position.x = x;
+    position.y = y;
+    position.z = z;
+
+    _exact(position);
+    _nSamples++;
+
+    return {position.x, position.y, position.z};
+}
+
+void CrsApproximation::check(Cell & cell, Vec3 const& origin, Vec3 const& size, int depth) {
+
+    for (Vec3 const& corner : cell.corners) {
+        //the transform is not defined everywhere in the cell, so it cannot be interpolated.
+        if (!isFinite(corner)) {
+            cell.state = Cell::Exact;
+            return;
+        }
+    }
+
+    //the 3x3x3 lattice of the cell, the corners are the even nodes, the other ones are compared to the interpolation.
+    std::array<Vec3, 27> lattice;
+    bool withinTolerance = true;
+
+    for (int k = 0; k < 3; k++) {
+        for (int j = 0; j < 3; j++) {
+            for (int i = 0; i < 3; i++) {
+
+                int idx = i + 3*j + 9*k;
+
+                if (i%2 == 0 and j%2 == 0 and k%2 == 0) {
+                    lattice[idx] = cell.corners[i/2 + 2*(j/2) + 4*(k/2)];
+                    continue;
+                }
+
+                lattice[idx] = sample(origin[0] + 0.5*i*size[0],
+                                      origin[1] + 0.5*j*size[1],
+                                      origin[2] + 0.5*k*size[2]);
+
+                if (!isFinite(lattice[idx])) {
+                    withinTolerance = false;
+                    continue;
+                }
+
+                Vec3 interpolated = trilinear(cell.corners, 0.5*i, 0.5*j, 0.5*k);
+
+                for (int c = 0; c < 3; c++) {
+                    if (std::abs(interpolated[c] - lattice[idx][c]) > _tolerance) {
+                        withinTolerance = false;
+                    }
+                }
+            }
+        }
+    }
+
+    if (withinTolerance) {
+        cell.state = Cell::Interpolated;
+        return;
+    }
+
+    if (depth >= MaxDepth) {
+        cell.state = Cell::Exact;
+        return;
+    }
+
+    //the sub cells are only checked when a point falls in them.
+    cell.state = Cell::Subdivided;
+    cell.children = std::make_unique<std::array<Cell, 8>>();
+
+    for (int child = 0; child < 8; child++) {
+
+        int ci = child%2;
+        int cj = (child/2)%2;
+        int ck = child/4;
+
+        Cell & subCell = (*cell.children)[child];
+        subCell.state = Cell::Pending;
+
+        for (int corner = 0; corner < 8; corner++) {
+            int i = ci + corner%2;
+            int j = cj + (corner/2)%2;
+            int k = ck + corner/4;
+            subCell.corners[corner] = lattice[i + 3*j + 9*k];
+        }
+    }
+}
+
+void CrsApproximation::apply(StereoVision::IO::PtGeometry<double> & position) {
+
+    Vec3 point = {position.x, position.y, position.z};
+
+    if (!isFinite(point)) {
+        _exact(position);
+        _nExact++;
+        return;
+    }
+
+    CellKey key{static_cast<int64_t>(std::floor(point[0]/_cellSize)),
+                static_cast<int64_t>(std::floor(point[1]/_cellSize)),
+                static_cast<int64_t>(std::floor(point[2]/_cellHeight))};
+
+    Vec3 origin = {key.x*_cellSize, key.y*_cellSize, key.z*_cellHeight};
+    Vec3 size = {_cellSize, _cellSize, _cellHeight};
+
+    auto it = _cells.find(key);
+
+    if (it == _cells.end()) {
+
+        //the cache is bounded, the cells are sampled again if the points come back to them.
+        if (_cells.size() >= MaxCachedCells) {
+            _cells.clear();
+        }
+
+        Cell cell;
+        cell.state = Cell::Pending;
+
+        for (int corner = 0; corner < 8; corner++) {
+            cell.corners[corner] = sample(origin[0] + (corner%2)*size[0],
+                                          origin[1] + ((corner/2)%2)*size[1],
+                                          origin[2] + (corner/4)*size[2]);
+        }
+
+        it = _cells.emplace(key, std::move(cell)).first;
+    }
+
+    Cell* cell = &it->second;
+    int depth = 0;
+
+    while (true) {
+
+        if (cell->state == Cell::Pending) {
+            check(*cell, origin, size, depth);
+        }
+
+        if (cell->state != Cell::Subdivided) {
+            break;
+        }
+
+        int child = 0;
+
+        for (int c = 0; c < 3; c++) {
+            size[c] /= 2;
+
+            if (point[c] >= origin[c] + size[c]) {
+                origin[c] += size[c];
+                child += 1 << c;
+            }
+        }
+
+        cell = &(*cell->children)[child];
+        depth++;
+    }
+
+    if (cell->state == Cell::Exact) {
+        _exact(position);
+        _nExact++;
+        return;
+    }
+
+    Vec3 transformed = trilinear(cell->corners,
+                                 (point[0] - origin[0])/size[0],
+                                 (point[1] - origin[1])/size[1],
+                                 (point[2] - origin[2])/size[2]);
+
+    position.x = transformed[0];
+    position.y = transformed[1];
+    position.z = transformed[2];
+
+    _nInterpolated++;
+}
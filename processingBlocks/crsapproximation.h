@@ -0,0 +1,142 @@
+#ifndef CRSAPPROXIMATION_H
+#define CRSAPPROXIMATION_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+struct pj_ctx;
+struct PJconsts;
+
+/*!
+ * \brief The CrsApproximation class approximate a smooth coordinate transform by interpolating exact samples.
+ *
+ * The input space is split in cells, the transform is sampled exactly at the corners of a cell the first time a point falls in it,
+ * and the points in the cell are then transformed by trilinear interpolation of the samples.
+ *
+ * Before a cell is used, the interpolation is checked against exact samples at the center of its faces, edges and volume.
+ * If the error is above the tolerance, the cell is split in 8 sub cells (reusing the samples as corners), up to a maximal depth,
+ * beyond which the points in the cell are transformed exactly.
+ *
+ * The cells are cached, so the exact transform is only evaluated a few dozen times per cell, whatever the number of points.
+ */
+class CrsApproximation
+{
+public:
+
+    using ExactTransform = std::function<void(StereoVision::IO::PtGeometry<double> &)>;
+
+    static constexpr int MaxDepth = 6;
+    static constexpr size_t MaxCachedCells = 1 << 16;
+
+    /*!
+     * \brief CrsApproximation build an approximation of a transform
+     * \param exact the exact transform, used for the samples and the fallback, must set non finite values for the points it cannot transform.
+     * \param tolerance the maximal interpolation error, in the units of the output.
+     * \param cellSize the horizontal size of the largest cells, in the units of the input.
+     * \param cellHeight the vertical size of the largest cells, in the units of the input.
+     */
+    CrsApproximation(ExactTransform const& exact, double tolerance, double cellSize, double cellHeight);
+    ~CrsApproximation();
+
+    /*!
+     * \brief forProjTransform build an approximation of a PROJ transform, with cells of about 250m (or 1/400 degree for geographic input crs).
+     * \param projContext the context of the transform.
+     * \param transform the transform, not owned, must outlive the approximation.
+     * \param tolerance the maximal interpolation error, in the units of the output crs.
+     * \return the approximation, or nullptr if the parameters are invalid.
+     */
+    static std::unique_ptr<CrsApproximation> forProjTransform(pj_ctx* projContext, PJconsts* transform, double tolerance);
+
+    void apply(StereoVision::IO::PtGeometry<double> & position);
+
+    inline double tolerance() const {
+        return _tolerance;
+    }
+
+    inline int64_t numberOfInterpolatedPoints() const {
+        return _nInterpolated;
+    }
+
+    inline int64_t numberOfExactPoints() const {
+        return _nExact;
+    }
+
+    inline int64_t numberOfExactSamples() const {
+        return _nSamples;
+    }
+
+protected:
+
+    using Vec3 = std::array<double, 3>;
+
+    /*!
+     * \brief The Cell struct is a node of the octree of a top level cell.
+     *
+     * The corners are ordered by x, then y, then z (corner index = ix + 2*iy + 4*iz).
+     */
+    struct Cell {
+        enum State {
+            Pending, //!< the corners are known, but the interpolation has not been checked yet.
+            Interpolated,
+            Subdivided,
+            Exact
+        };
+
+        State state;
+        std::array<Vec3, 8> corners;
+        std::unique_ptr<std::array<Cell, 8>> children;
+    };
+
+    struct CellKey {
+        int64_t x;
+        int64_t y;
+        int64_t z;
+
+        inline bool operator==(CellKey const& other) const {
+            return x == other.x and y == other.y and z == other.z;
+        }
+    };
+
+    struct CellKeyHash {
+        size_t operator()(CellKey const& key) const;
+    };
+
+    Vec3 sample(double x, double y, double z);
+
+    void check(Cell & cell, Vec3 const& origin, Vec3 const& size, int depth);
+
+    ExactTransform _exact;
+    double _tolerance;
+    double _cellSize;
+    double _cellHeight;
+
+    std::unordered_map<CellKey, Cell, CellKeyHash> _cells;
+
+    int64_t _nInterpolated;
+    int64_t _nExact;
+    int64_t _nSamples;
+};
+
+#endif // CRSAPPROXIMATION_H
@@ -17,16 +17,11 @@
 
 #include "crsconversion.h"
 
-#include <proj.h>
-
-#include <cmath>
-
-
-
 std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> CrsConversion::setupCrsConversion(
         std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
         std::string inCrs,
-        std::string outCrs) {
+        std::string outCrs,
+        double approximationTolerance) {
 
     if (source == nullptr) {
         return nullptr;
@@ -36,38 +31,23 @@ std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> CrsConversion:
         return std::move(source);
     }
 
-    PJ_CONTEXT* proj_ctx;
-    PJ* transform;
+    std::optional<CrsTransform> transform = CrsTransform::setup(inCrs, outCrs, approximationTolerance);
 
-    proj_ctx = proj_context_create();
-
-    if (proj_ctx == 0) {
+    if (!transform.has_value()) {
         return nullptr;
     }
 
-    transform = proj_create_crs_to_crs(proj_ctx, inCrs.c_str(), outCrs.c_str(), nullptr);
-
-    if (transform == 0) {
-        return nullptr;
-    }
-
-    return std::unique_ptr<CrsConversion>(new CrsConversion(std::move(source),proj_ctx,transform));
+    return std::unique_ptr<CrsConversion>(new CrsConversion(std::move(source), std::move(transform.value())));
 
 }
 
 CrsConversion::CrsConversion(std::unique_ptr<PointCloudPointAccessInterface> && source,
-                             pj_ctx* projContext,
-                             PJconsts* projTransform) :
+                             CrsTransform && transform) :
     IdentityProcessor(std::move(source)),
-    _proj_ctx(projContext),
-    _transform(projTransform)
+    _transform(std::move(transform))
 {
     computeTransformedPoint();
 }
-CrsConversion::~CrsConversion() {
-    proj_destroy(_transform);
-    proj_context_destroy(_proj_ctx);
-}
 
 StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> CrsConversion::getPointPosition() const {
 
@@ -94,16 +74,5 @@ bool CrsConversion::gotoNext() {
 void CrsConversion::computeTransformedPoint() {
 
     _currentTransformedPosition = _src->castedPointGeometry<double>();
-
-    constexpr int n = 1;
-    constexpr int delta_x = 1;
-    constexpr int delta_y = 1;
-    constexpr int delta_z = 1;
-
-    proj_trans_generic(_transform, PJ_FWD,
-                       &_currentTransformedPosition.x, delta_x, n,
-                       &_currentTransformedPosition.y, delta_y, n,
-                       &_currentTransformedPosition.z, delta_z, n,
-                       nullptr, 0, 0);
-
+    _transform.apply(_currentTransformedPosition);
 }
@@ -19,14 +19,13 @@
  */
 
 #include <memory>
+#include <optional>
 #include <string>
 
 #include <StereoVision/io/pointcloud_io.h>
 
 #include "identityprocessor.h"
-
-struct pj_ctx;
-struct PJconsts;
+#include "crstransform.h"
 
 class CrsConversion : public IdentityProcessor
 {
@@ -37,14 +36,22 @@ public:
      * \param source a pointer to the source, will be moved to the output if return is not nullptr
      * \param inCrs the input crs
      * \param outCrs the output crs
+     * \param approximationTolerance if strictly positive, the points are transformed by interpolating exact samples,
+     * with at most this error (in the units of the output crs), see CrsApproximation.
      * \return a unique ptr to a PointCloudPointAccessInterface, or nullptr in case of error
      */
     static std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> setupCrsConversion(
             std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
             std::string inCrs,
-            std::string outCrs);
+            std::string outCrs,
+            double approximationTolerance = -1);
 
-    ~CrsConversion();
+    /*!
+     * \brief hasNativePipeline indicate if the conversion is computed by a NativeCrsPipeline rather than by PROJ.
+     */
+    inline bool hasNativePipeline() const {
+        return _transform.hasNativePipeline();
+    }
 
     virtual StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> getPointPosition() const override;
 
@@ -53,16 +60,14 @@ public:
 protected:
 
     CrsConversion(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source,
-                  pj_ctx* projContext,
-                  PJconsts* projTransform);
+                  CrsTransform && transform);
 
     void computeTransformedPoint();
 
     std::string _inCrs;
     std::string _outCrs;
 
-    pj_ctx* _proj_ctx;
-    PJconsts* _transform;
+    CrsTransform _transform;
 
     StereoVision::IO::PtGeometry<double> _currentTransformedPosition;
 
@@ -0,0 +1,121 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "crstransform.h"
+
+#include "crsapproximation.h"
+
+#include <proj.h>
+
+#include <utility>
+
+std::optional<CrsTransform> CrsTransform::setup(std::string const& inCrs, std::string const& outCrs, double approximationTolerance) {
+
+    PJ_CONTEXT* proj_ctx = proj_context_create();
+
+    if (proj_ctx == 0) {
+        return std::nullopt;
+    }
+
+    PJ* transform = proj_create_crs_to_crs(proj_ctx, inCrs.c_str(), outCrs.c_str(), nullptr);
+
+    if (transform == 0) {
+        proj_context_destroy(proj_ctx);
+        return std::nullopt;
+    }
+
+    //the common pipelines (affine transforms, geocentric and transverse Mercator conversions) are computed without PROJ.
+    std::optional<NativeCrsPipeline> native = NativeCrsPipeline::fromProjTransform(proj_ctx, transform);
+
+    std::unique_ptr<CrsApproximation> approximation;
+
+    //the native kernels are exact and faster than the interpolation, which is only used for the pipelines computed by PROJ.
+    if (approximationTolerance > 0 and !native.has_value()) {
+
+        approximation = CrsApproximation::forProjTransform(proj_ctx, transform, approximationTolerance);
+
+        if (approximation == nullptr) {
+            proj_destroy(transform);
+            proj_context_destroy(proj_ctx);
+            return std::nullopt;
+        }
+    }
+
+    return CrsTransform(proj_ctx, transform, std::move(approximation), native);
+}
+
+CrsTransform::CrsTransform(pj_ctx* projContext,
+                           PJconsts* projTransform,
+                           std::unique_ptr<CrsApproximation> && approximation,
+                           std::optional<NativeCrsPipeline> const& native) :
+    _proj_ctx(projContext),
+    _transform(projTransform),
+    _approximation(std::move(approximation)),
+    _native(native)
+{
+
+}
+
+CrsTransform::CrsTransform(CrsTransform && other) :
+    _proj_ctx(std::exchange(other._proj_ctx, nullptr)),
+    _transform(std::exchange(other._transform, nullptr)),
+    _approximation(std::move(other._approximation)),
+    _native(std::move(other._native))
+{
+
+}
+
+CrsTransform& CrsTransform::operator=(CrsTransform && other) {
+    std::swap(_proj_ctx, other._proj_ctx);
+    std::swap(_transform, other._transform);
+    std::swap(_approximation, other._approximation);
+    std::swap(_native, other._native);
+    return *this;
+}
+
+CrsTransform::~CrsTransform() {
+    if (_transform != nullptr) {
+        proj_destroy(_transform);
+    }
+    if (_proj_ctx != nullptr) {
+        proj_context_destroy(_proj_ctx);
+    }
+}
+
+void CrsTransform::apply(StereoVision::IO::PtGeometry<double> & position) const {
+
+    if (_native.has_value()) {
+        _native->apply(position);
+        return;
+    }
+
+    if (_approximation != nullptr) {
+        _approximation->apply(position);
+        return;
+    }
+
+    constexpr int n = 1;
+    constexpr int delta_x = 1;
+    constexpr int delta_y = 1;
+    constexpr int delta_z = 1;
+
+    proj_trans_generic(_transform, PJ_FWD,
+                       &position.x, delta_x, n,
+                       &position.y, delta_y, n,
+                       &position.z, delta_z, n,
+                       nullptr, 0, 0);
+}
@@ -0,0 +1,84 @@
+#ifndef CRSTRANSFORM_H
+#define CRSTRANSFORM_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+#include "nativecrspipeline.h"
+
+class CrsApproximation;
+
+struct pj_ctx;
+struct PJconsts;
+
+/*!
+ * \brief The CrsTransform class convert positions from a crs to another, the conversion being shared by CrsConversion and StaticStages::Crs.
+ *
+ * The PROJ transform is always created, but the points are converted by a NativeCrsPipeline when the PROJ pipeline has a native implementation,
+ * else by a CrsApproximation when an approximation tolerance is given, and by PROJ otherwise.
+ */
+class CrsTransform
+{
+public:
+
+    /*!
+     * \brief setup try to setup a crs conversion
+     * \param inCrs the input crs
+     * \param outCrs the output crs
+     * \param approximationTolerance if strictly positive, the points are transformed by interpolating exact samples,
+     * with at most this error (in the units of the output crs), see CrsApproximation. Ignored if the pipeline has a native implementation.
+     * \return the transform, or std::nullopt in case of error.
+     */
+    static std::optional<CrsTransform> setup(std::string const& inCrs, std::string const& outCrs, double approximationTolerance = -1);
+
+    CrsTransform(CrsTransform const& other) = delete;
+    CrsTransform(CrsTransform && other);
+    ~CrsTransform();
+
+    CrsTransform& operator=(CrsTransform const& other) = delete;
+    CrsTransform& operator=(CrsTransform && other);
+
+    /*!
+     * \brief hasNativePipeline indicate if the conversion is computed by a NativeCrsPipeline rather than by PROJ.
+     */
+    inline bool hasNativePipeline() const {
+        return _native.has_value();
+    }
+
+    void apply(StereoVision::IO::PtGeometry<double> & position) const;
+
+protected:
+
+    CrsTransform(pj_ctx* projContext,
+                 PJconsts* projTransform,
+                 std::unique_ptr<CrsApproximation> && approximation,
+                 std::optional<NativeCrsPipeline> const& native);
+
+    pj_ctx* _proj_ctx;
+    PJconsts* _transform;
+
+    std::unique_ptr<CrsApproximation> _approximation;
+    std::optional<NativeCrsPipeline> _native;
+};
+
+#endif // CRSTRANSFORM_H
@@ -0,0 +1,409 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "duplicateremover.h"
+
+#include "spatialkeys.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+constexpr size_t batchSize = 1 << 16;
+
+//key of the points without (or with a non numeric) gps time.
+constexpr int64_t noTime = std::numeric_limits<int64_t>::min();
+
+inline bool quantize(double value, double step, int64_t & idx) {
+
+    double v = std::floor(value/step);
+
+    constexpr double limit = 9e18;
+
+    if (!(std::abs(v) < limit)) {
+        return false;
+    }
+
+    idx = static_cast<int64_t>(v);
+    return true;
+}
+
+inline int64_t floorDiv(int64_t a, int64_t b) {
+    int64_t q = a/b;
+    return (a%b != 0 and (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+}
+
+std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> DuplicateRemover::setupDuplicateRemover(
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
+        double tolerance,
+        double timeTolerance,
+        double tileSize) {
+
+    if (source == nullptr) {
+        return nullptr;
+    }
+
+    if (!std::isfinite(tolerance) or tolerance <= 0 or !std::isfinite(timeTolerance) or !std::isfinite(tileSize)) {
+        return nullptr;
+    }
+
+    if (timeTolerance > 0) {
+
+        std::vector<std::string> attributes = source->attributeList();
+
+        if (std::find(attributes.begin(), attributes.end(), "gpsTime") == attributes.end()) {
+            return nullptr;
+        }
+    }
+
+    std::unique_ptr<DuplicateRemover> remover(new DuplicateRemover(std::move(source), tolerance, timeTolerance, tileSize));
+
+    if (!remover->start()) {
+        return nullptr;
+    }
+
+    return remover;
+}
+
+DuplicateRemover::DuplicateRemover(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source,
+                                   double tolerance,
+                                   double timeTolerance,
+                                   double tileSize) :
+    _src(std::move(source)),
+    _tolerance(tolerance),
+    _timeTolerance(timeTolerance),
+    _cellsPerTile((tileSize > 0) ? std::max<int64_t>(1, std::llround(tileSize/tolerance)) : 0),
+    _gpsTimeIdx(-1),
+    _nDuplicates(0),
+    _nextTile(0),
+    _hasMore(false),
+    _currentIdx(0),
+    _failed(false)
+{
+    _schema = _src->attributeList();
+
+    for (int i = 0; i < _schema.size(); i++) {
+        _schemaIdxs[_schema[i]] = i;
+    }
+
+    auto it = _schemaIdxs.find("gpsTime");
+
+    if (it != _schemaIdxs.end()) {
+        _gpsTimeIdx = it->second;
+    }
+
+    int nShards = 1;
+
+    #ifdef _OPENMP
+    nShards = omp_get_max_threads();
+    #endif
+
+    _shards.resize(nShards);
+}
+
+DuplicateRemover::~DuplicateRemover() {
+
+}
+
+size_t DuplicateRemover::KeyHash::operator()(Key const& key) const {
+    return SpatialKeys::mix(key.x ^ SpatialKeys::mix(key.y ^ SpatialKeys::mix(key.z ^ SpatialKeys::mix(key.t))));
+}
+
+bool DuplicateRemover::key(SpooledPoint const& point, Key & key) const {
+
+    bool ok = quantize(point.xyz.x, _tolerance, key.x) and
+            quantize(point.xyz.y, _tolerance, key.y) and
+            quantize(point.xyz.z, _tolerance, key.z);
+
+    if (!ok) {
+        return false;
+    }
+
+    key.t = noTime;
+
+    if (_timeTolerance > 0 and _gpsTimeIdx >= 0 and point.attributes[_gpsTimeIdx].has_value()) {
+
+        double time = std::visit([] (auto const& val) -> double {
+
+            using T = std::decay_t<decltype(val)>;
+
+            if constexpr (std::is_arithmetic_v<T>) {
+                return static_cast<double>(val);
+            } else {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+
+        }, point.attributes[_gpsTimeIdx].value());
+
+        if (!quantize(time, _timeTolerance, key.t)) {
+            key.t = noTime;
+        }
+    }
+
+    return true;
+}
+
+bool DuplicateRemover::start() {
+
+    if (_cellsPerTile > 0) {
+        if (!spoolTiles()) {
+            std::cerr << "Could not spool the points to remove the duplicates!" << std::endl;
+            return false;
+        }
+    } else {
+        _hasMore = _src->hasData();
+    }
+
+    nextBatch();
+
+    return !_failed;
+}
+
+bool DuplicateRemover::spoolTiles() {
+
+    _spool = std::make_unique<PartitionSpool>(PartitionSpool::temporarySpoolDir("duplicates"));
+
+    std::string record;
+    bool hasMore = _src->hasData();
+
+    while (hasMore) {
+
+        StereoVision::IO::PtGeometry<double> pos = _src->castedPointGeometry<double>();
+
+        int64_t cx;
+        int64_t cy;
+
+        //the tiles are aligned on the cells, so that the duplicates always end up in the same tile.
+        std::string key = "none";
+
+        if (quantize(pos.x, _tolerance, cx) and quantize(pos.y, _tolerance, cy)) {
+            key = std::to_string(floorDiv(cx, _cellsPerTile)) + "_" + std::to_string(floorDiv(cy, _cellsPerTile));
+        }
+
+        record.clear();
+        PointSpool::appendRecord(record, *_src, _schema);
+
+        if (!_spool->append(key, record)) {
+            return false;
+        }
+
+        hasMore = _src->gotoNext();
+    }
+
+    if (!_spool->flush()) {
+        return false;
+    }
+
+    _tileKeys = _spool->keys();
+    _nextTile = 0;
+
+    return true;
+}
+
+bool DuplicateRemover::nextBatch() {
+
+    _points.clear();
+    _currentIdx = 0;
+
+    while (true) {
+
+        if (_spool != nullptr and !_hasMore) {
+
+            _tile.reset();
+
+            if (_nextTile >= _tileKeys.size()) {
+                return false;
+            }
+
+            //the keys of the previous tiles cannot appear in the next ones.
+            for (std::unordered_set<Key, KeyHash> & shard : _shards) {
+                shard = std::unordered_set<Key, KeyHash>();
+            }
+
+            _tile = _spool->openPartition(_tileKeys[_nextTile], _schema, true);
+            _nextTile++;
+
+            if (_tile == nullptr) {
+                std::cerr << "Could not read back the spooled tile " << _tileKeys[_nextTile-1] << " to remove its duplicates!" << std::endl;
+                _failed = true;
+                return false;
+            }
+
+            _hasMore = _tile->hasData();
+            continue;
+        }
+
+        if (!_hasMore) {
+            return false;
+        }
+
+        StereoVision::IO::PointCloudPointAccessInterface & points = (_spool == nullptr) ? *_src : *_tile;
+
+        while (_hasMore and _points.size() < batchSize) {
+            _points.push_back(SpooledPoint::fromInterface(points, _schema));
+            _hasMore = points.gotoNext();
+        }
+
+        removeDuplicates(_points);
+
+        if (!_points.empty()) {
+            return true;
+        }
+    }
+}
+
+void DuplicateRemover::removeDuplicates(std::vector<SpooledPoint> & batch) {
+
+    int64_t nPoints = batch.size();
+    int nShards = _shards.size();
+
+    std::vector<Key> keys(nPoints);
+    std::vector<int> shardIdxs(nPoints);
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < nPoints; i++) {
+
+        //the points without a key are never duplicates.
+        if (!key(batch[i], keys[i])) {
+            shardIdxs[i] = -1;
+            continue;
+        }
+
+        shardIdxs[i] = (KeyHash()(keys[i]) >> 32)%nShards;
+    }
+
+    //the points are bucketed by shard with a counting sort, which keeps their order in each bucket.
+    std::vector<int64_t> bucketStarts(nShards+1, 0);
+
+    for (int64_t i = 0; i < nPoints; i++) {
+        if (shardIdxs[i] >= 0) {
+            bucketStarts[shardIdxs[i]+1]++;
+        }
+    }
+
+    for (int s = 0; s < nShards; s++) {
+        bucketStarts[s+1] += bucketStarts[s];
+    }
+
+    std::vector<int64_t> buckets(bucketStarts[nShards]);
+    std::vector<int64_t> bucketEnds(bucketStarts.begin(), bucketStarts.end()-1);
+
+    for (int64_t i = 0; i < nPoints; i++) {
+        if (shardIdxs[i] >= 0) {
+            buckets[bucketEnds[shardIdxs[i]]++] = i;
+        }
+    }
+
+    std::vector<uint8_t> duplicates(nPoints, 0);
+
+    //each shard is updated by a single thread, in the order of the points, so the first point of each key is kept.
+    #pragma omp parallel for schedule(dynamic)
+    for (int s = 0; s < nShards; s++) {
+
+        std::unordered_set<Key, KeyHash> & shard = _shards[s];
+
+        for (int64_t b = bucketStarts[s]; b < bucketStarts[s+1]; b++) {
+
+            int64_t i = buckets[b];
+
+            if (!shard.insert(keys[i]).second) {
+                duplicates[i] = 1;
+            }
+        }
+    }
+
+    size_t nKept = 0;
+
+    for (int64_t i = 0; i < nPoints; i++) {
+
+        if (duplicates[i]) {
+            _nDuplicates++;
+            continue;
+        }
+
+        if (nKept != i) {
+            batch[nKept] = std::move(batch[i]);
+        }
+
+        nKept++;
+    }
+
+    batch.resize(nKept);
+}
+
+StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> DuplicateRemover::getPointPosition() const {
+    StereoVision::IO::PtGeometry<double> const& pos = _points[_currentIdx].xyz;
+    return StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute>{pos.x, pos.y, pos.z};
+}
+
+std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> DuplicateRemover::getPointColor() const {
+    return _points[_currentIdx].rgba;
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> DuplicateRemover::getAttributeById(int id) const {
+
+    if (id < 0 or id >= _schema.size()) {
+        return std::nullopt;
+    }
+
+    return _points[_currentIdx].attributes[id];
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> DuplicateRemover::getAttributeByName(const char* attributeName) const {
+
+    auto it = _schemaIdxs.find(attributeName);
+
+    if (it == _schemaIdxs.end()) {
+        return std::nullopt;
+    }
+
+    return getAttributeById(it->second);
+}
+
+std::vector<std::string> DuplicateRemover::attributeList() const {
+    return _schema;
+}
+
+bool DuplicateRemover::gotoNext() {
+
+    if (_currentIdx >= _points.size()) {
+        return false;
+    }
+
+    _currentIdx++;
+
+    if (_currentIdx < _points.size()) {
+        return true;
+    }
+
+    return nextBatch();
+}
+
+bool DuplicateRemover::hasData() const {
+    return _currentIdx < _points.size();
+}
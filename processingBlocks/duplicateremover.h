@@ -0,0 +1,163 @@
+#ifndef DUPLICATEREMOVER_H
+#define DUPLICATEREMOVER_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+#include "../io/partitionspool.h"
+
+/*!
+ * \brief The DuplicateRemover class remove the duplicated points of a point cloud, e.g. in the overlap of merged tiles.
+ *
+ * The positions (and optionally the gps time) are quantized with a tolerance, and only the first point of each
+ * quantized key is kept, the other points being considered duplicates. Points closer than the tolerance but
+ * on both sides of the border of a cell are not detected, so the tolerance should be well above the noise of the duplicates.
+ * The points with a non finite position are always kept.
+ *
+ * The keys already seen are stored in a hash set split in shards (by hash of the key). The points are read in batches,
+ * their keys are computed in parallel, then each shard is updated by a single thread, in the order of the points,
+ * so that no lock is needed and the points which are kept do not depend on the number of threads.
+ *
+ * If a tile size is given, the points are first spooled to disk in square tiles (aligned on the cells), and the tiles
+ * are processed one after the other, so that only the keys of a single tile are kept in memory.
+ * Otherwise, the points are processed as a stream, in their original order.
+ */
+class DuplicateRemover : public StereoVision::IO::PointCloudPointAccessInterface
+{
+public:
+
+    /*!
+     * \brief setupDuplicateRemover setup a duplicate removal
+     * \param source a pointer to the source, will be moved to the output if return is not nullptr (or consumed if the points could not be spooled)
+     * \param tolerance the size of the cells the positions are quantized on, in the units of the point cloud.
+     * \param timeTolerance the size of the intervals the gps time is quantized on, if 0 or less the gps time is not part of the key.
+     * \param tileSize the size of the tiles, in the units of the point cloud, if 0 or less the points are not tiled.
+     * \return a unique ptr to a PointCloudPointAccessInterface, or nullptr in case of error
+     */
+    static std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> setupDuplicateRemover(
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
+            double tolerance,
+            double timeTolerance = 0,
+            double tileSize = 0);
+
+    ~DuplicateRemover();
+
+    virtual StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> getPointPosition() const override;
+    virtual std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> getPointColor() const override;
+
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeById(int id) const override;
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeByName(const char* attributeName) const override;
+
+    virtual std::vector<std::string> attributeList() const override;
+
+    virtual bool gotoNext() override;
+    virtual bool hasData() const override;
+
+    inline int64_t numberOfDuplicates() const {
+        return _nDuplicates;
+    }
+
+    /*!
+     * \brief ok check that no tile failed to be read back, needs to be checked once all the points have been read,
+     * as a failure ends the point cloud early.
+     */
+    inline bool ok() const {
+        return !_failed;
+    }
+
+protected:
+
+    DuplicateRemover(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source,
+                     double tolerance,
+                     double timeTolerance,
+                     double tileSize);
+
+    struct Key {
+        int64_t x;
+        int64_t y;
+        int64_t z;
+        int64_t t;
+
+        inline bool operator==(Key const& other) const {
+            return x == other.x and y == other.y and z == other.z and t == other.t;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(Key const& key) const;
+    };
+
+    /*!
+     * \brief key compute the quantized key of a point.
+     * \return false if the point has no key (non finite position), true otherwise.
+     */
+    bool key(SpooledPoint const& point, Key & key) const;
+
+    /*!
+     * \brief start spool the points (if they are tiled) and deduplicate the first batch.
+     * \return true on success, false otherwise.
+     */
+    bool start();
+
+    bool spoolTiles();
+
+    /*!
+     * \brief nextBatch fill the buffer with the next points which are not duplicates.
+     * \return true if points have been buffered, false at the end of the point cloud.
+     */
+    bool nextBatch();
+
+    /*!
+     * \brief removeDuplicates remove the duplicates from a batch of points (in place), and register their keys.
+     */
+    void removeDuplicates(std::vector<SpooledPoint> & batch);
+
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> _src;
+
+    double _tolerance;
+    double _timeTolerance;
+    int64_t _cellsPerTile; //!< 0 if the points are not tiled
+
+    std::vector<std::string> _schema;
+    std::map<std::string, int> _schemaIdxs;
+    int _gpsTimeIdx;
+
+    std::vector<std::unordered_set<Key, KeyHash>> _shards;
+    int64_t _nDuplicates;
+
+    std::unique_ptr<PartitionSpool> _spool;
+    std::vector<std::string> _tileKeys;
+    size_t _nextTile;
+    std::unique_ptr<PointSpoolReader> _tile;
+    bool _hasMore; //!< if the source (or the current tile) has points left to read.
+
+    std::vector<SpooledPoint> _points;
+    size_t _currentIdx;
+
+    bool _failed;
+};
+
+#endif // DUPLICATEREMOVER_H
@@ -0,0 +1,344 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "groundclassifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+namespace {
+
+using GenericAttribute = StereoVision::IO::PointCloudGenericAttribute;
+
+constexpr double emptyCell = std::numeric_limits<double>::infinity();
+
+std::optional<int64_t> classOf(std::optional<GenericAttribute> const& value) {
+
+    if (!value.has_value()) {
+        return std::nullopt;
+    }
+
+    return std::visit([] (auto const& val) -> std::optional<int64_t> {
+
+        using T = std::decay_t<decltype(val)>;
+
+        if constexpr (std::is_arithmetic_v<T>) {
+            return static_cast<int64_t>(val);
+        } else {
+            return std::nullopt;
+        }
+
+    }, value.value());
+}
+
+inline bool isNoise(std::optional<int64_t> const& classification) {
+    //low and high noise in the LAS specification.
+    return classification.has_value() and (classification.value() == 7 or classification.value() == 18);
+}
+
+/*!
+ * \brief classificationValue get a classification value, with the type of the original value if it is numeric.
+ */
+GenericAttribute classificationValue(std::optional<GenericAttribute> const& original, int classification) {
+
+    if (original.has_value()) {
+
+        std::optional<GenericAttribute> ret = std::visit([classification] (auto const& val) -> std::optional<GenericAttribute> {
+
+            using T = std::decay_t<decltype(val)>;
+
+            if constexpr (std::is_arithmetic_v<T> and !std::is_same_v<T, bool>) {
+                return static_cast<T>(classification);
+            } else {
+                return std::nullopt;
+            }
+
+        }, original.value());
+
+        if (ret.has_value()) {
+            return ret.value();
+        }
+    }
+
+    return static_cast<uint8_t>(classification);
+}
+
+/*!
+ * \brief The HeightRaster struct hold a raster of heights, empty cells are infinite.
+ */
+struct HeightRaster {
+
+    HeightRaster(int64_t x0, int64_t y0, int64_t nx, int64_t ny) :
+        x0(x0),
+        y0(y0),
+        nx(nx),
+        ny(ny),
+        heights(nx*ny, emptyCell)
+    {
+
+    }
+
+    inline int64_t cellIdx(double x, double y, double cellSize) const {
+        int64_t cx = std::clamp<int64_t>(std::floor(x/cellSize) - x0, 0, nx-1);
+        int64_t cy = std::clamp<int64_t>(std::floor(y/cellSize) - y0, 0, ny-1);
+        return cy*nx + cx;
+    }
+
+    int64_t x0;
+    int64_t y0;
+    int64_t nx;
+    int64_t ny;
+    std::vector<double> heights;
+};
+
+/*!
+ * \brief filter1d apply a running min or max filter along the rows (or the columns) of a raster, the empty cells are ignored.
+ */
+template<bool isMax, bool alongRows>
+void filter1d(std::vector<double> const& in, std::vector<double> & out, int64_t nx, int64_t ny, int half, bool parallel) {
+
+    int64_t nLines = (alongRows) ? ny : nx;
+    int64_t lineLength = (alongRows) ? nx : ny;
+    int64_t stride = (alongRows) ? 1 : nx;
+    int64_t lineStride = (alongRows) ? nx : 1;
+
+    #pragma omp parallel for schedule(static) if(parallel)
+    for (int64_t l = 0; l < nLines; l++) {
+
+        double const* line = in.data() + l*lineStride;
+        double* outLine = out.data() + l*lineStride;
+
+        for (int64_t i = 0; i < lineLength; i++) {
+
+            int64_t begin = std::max<int64_t>(0, i - half);
+            int64_t end = std::min<int64_t>(lineLength, i + half + 1);
+
+            double acc = (isMax) ? -emptyCell : emptyCell;
+
+            for (int64_t j = begin; j < end; j++) {
+
+                double val = line[j*stride];
+
+                if constexpr (isMax) {
+                    if (val != emptyCell) {
+                        acc = std::max(acc, val);
+                    }
+                } else {
+                    acc = std::min(acc, val);
+                }
+            }
+
+            outLine[i*stride] = (acc == -emptyCell) ? emptyCell : acc;
+        }
+    }
+}
+
+/*!
+ * \brief opening compute the morphological opening of a raster, with a square window.
+ */
+void opening(std::vector<double> & heights, std::vector<double> & buffer, int64_t nx, int64_t ny, int half, bool parallel) {
+
+    //erosion
+    filter1d<false, true>(heights, buffer, nx, ny, half, parallel);
+    filter1d<false, false>(buffer, heights, nx, ny, half, parallel);
+
+    //dilation
+    filter1d<true, true>(heights, buffer, nx, ny, half, parallel);
+    filter1d<true, false>(buffer, heights, nx, ny, half, parallel);
+}
+
+}
+
+std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> GroundClassifier::setupGroundClassifier(
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
+        Parameters const& parameters) {
+
+    if (source == nullptr) {
+        return nullptr;
+    }
+
+    if (!std::isfinite(parameters.cellSize) or parameters.cellSize <= 0) {
+        return nullptr;
+    }
+
+    if (!std::isfinite(parameters.tileSize) or parameters.tileSize < parameters.cellSize or !std::isfinite(parameters.haloSize)) {
+        return nullptr;
+    }
+
+    if (!std::isfinite(parameters.maxWindowSize) or !std::isfinite(parameters.slope) or parameters.slope < 0) {
+        return nullptr;
+    }
+
+    if (!std::isfinite(parameters.initialDistance) or !std::isfinite(parameters.maxDistance)
+            or parameters.initialDistance < 0 or parameters.maxDistance < parameters.initialDistance) {
+        return nullptr;
+    }
+
+    std::unique_ptr<GroundClassifier> processor(new GroundClassifier(std::move(source), parameters));
+
+    if (!processor->start()) {
+        return nullptr;
+    }
+
+    return processor;
+}
+
+namespace {
+
+std::vector<int> windowSizes(GroundClassifier::Parameters const& parameters) {
+
+    int maxWindow = std::max<int>(3, std::floor(parameters.maxWindowSize/parameters.cellSize));
+
+    std::vector<int> ret;
+
+    for (int w = 3; w <= maxWindow; w = 2*w - 1) {
+        ret.push_back(w);
+    }
+
+    return ret;
+}
+
+double defaultHaloSize(GroundClassifier::Parameters const& parameters) {
+
+    if (parameters.haloSize > 0) {
+        return parameters.haloSize;
+    }
+
+    //each opening depends on the cells up to the window size away.
+    int reach = 0;
+
+    for (int w : windowSizes(parameters)) {
+        reach += w - 1;
+    }
+
+    return (reach + 1)*parameters.cellSize;
+}
+
+}
+
+GroundClassifier::GroundClassifier(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source,
+                                   Parameters const& parameters) :
+    TiledProcessor(std::move(source), "ground", parameters.tileSize, defaultHaloSize(parameters)),
+    _parameters(parameters)
+{
+
+    auto it = std::find(_schema.begin(), _schema.end(), ClassificationAttribute);
+    _classificationInSource = it != _schema.end();
+
+    if (_classificationInSource) {
+        _classificationIdx = it - _schema.begin();
+    } else {
+        _classificationIdx = _schema.size();
+        _schema.push_back(ClassificationAttribute);
+    }
+
+    _windowSizes = windowSizes(_parameters);
+
+    for (int k = 0; k < _windowSizes.size(); k++) {
+
+        double threshold = _parameters.initialDistance;
+
+        if (k > 0) {
+            threshold += _parameters.slope*(_windowSizes[k] - _windowSizes[k-1])*_parameters.cellSize;
+        }
+
+        _heightThresholds.push_back(std::min(threshold, _parameters.maxDistance));
+    }
+}
+
+void GroundClassifier::processTile(TileSpool::Tile const& tile,
+                                   std::vector<SpooledPoint> & points,
+                                   std::vector<SpooledPoint> const& halo,
+                                   bool parallel) const {
+
+    double cellSize = _parameters.cellSize;
+    double tileSize = _spool->tileSize();
+    double haloSize = _spool->haloSize();
+
+    int64_t x0 = std::floor((tile.x*tileSize - haloSize)/cellSize);
+    int64_t y0 = std::floor((tile.y*tileSize - haloSize)/cellSize);
+    int64_t x1 = std::floor(((tile.x+1)*tileSize + haloSize)/cellSize);
+    int64_t y1 = std::floor(((tile.y+1)*tileSize + haloSize)/cellSize);
+
+    HeightRaster raster(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+
+    int64_t nPoints = points.size();
+
+    std::vector<int64_t> cells(nPoints);
+    std::vector<char> ground(nPoints);
+
+    auto pointClass = [this] (SpooledPoint const& point) -> std::optional<int64_t> {
+        if (!_classificationInSource) {
+            return std::nullopt;
+        }
+        return classOf(point.attributes[_classificationIdx]);
+    };
+
+    for (int64_t i = 0; i < nPoints; i++) {
+
+        SpooledPoint const& point = points[i];
+
+        cells[i] = raster.cellIdx(point.xyz.x, point.xyz.y, cellSize);
+        ground[i] = !isNoise(pointClass(point));
+
+        if (ground[i]) {
+            raster.heights[cells[i]] = std::min(raster.heights[cells[i]], point.xyz.z);
+        }
+    }
+
+    for (SpooledPoint const& point : halo) {
+
+        if (isNoise(pointClass(point))) {
+            continue;
+        }
+
+        int64_t cell = raster.cellIdx(point.xyz.x, point.xyz.y, cellSize);
+        raster.heights[cell] = std::min(raster.heights[cell], point.xyz.z);
+    }
+
+    std::vector<double> buffer(raster.heights.size());
+
+    for (int k = 0; k < _windowSizes.size(); k++) {
+
+        opening(raster.heights, buffer, raster.nx, raster.ny, _windowSizes[k]/2, parallel);
+
+        double threshold = _heightThresholds[k];
+
+        #pragma omp parallel for schedule(static) if(parallel)
+        for (int64_t i = 0; i < nPoints; i++) {
+            if (ground[i] and points[i].xyz.z - raster.heights[cells[i]] > threshold) {
+                ground[i] = false;
+            }
+        }
+    }
+
+    for (int64_t i = 0; i < nPoints; i++) {
+
+        SpooledPoint & point = points[i];
+        point.attributes.resize(_schema.size());
+
+        std::optional<GenericAttribute> & classification = point.attributes[_classificationIdx];
+
+        if (isNoise(pointClass(point))) {
+            continue;
+        }
+
+        classification = classificationValue(classification, (ground[i]) ? GroundClass : UnclassifiedClass);
+    }
+}
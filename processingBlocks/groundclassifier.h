@@ -0,0 +1,86 @@
+#ifndef GROUNDCLASSIFIER_H
+#define GROUNDCLASSIFIER_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "tiledprocessor.h"
+
+/*!
+ * \brief The GroundClassifier class classify the points as ground or non ground with a progressive morphological filter.
+ *
+ * The minimal height of the points is rasterized in each tile (and its halo), then the raster is opened (eroded then dilated)
+ * with square windows of increasing sizes (3, 5, 9, 17, ... cells). After each opening, the points higher than
+ * the opened surface by more than a threshold, growing with the window size and the slope, are marked as non ground.
+ *
+ * The classification attribute is set to 2 (ground) or 1 (unclassified), following the LAS conventions,
+ * and added to the points if it is not present. The points classified as noise (7 or 18) are left unchanged and ignored.
+ * The result is independent of the tiling if the halo of the tiles is as large as the cumulated reach of the openings
+ * (about twice the largest window size), which is the default.
+ */
+class GroundClassifier : public TiledProcessor
+{
+public:
+
+    static constexpr int GroundClass = 2;
+    static constexpr int UnclassifiedClass = 1;
+
+    static constexpr char const* ClassificationAttribute = "classification";
+
+    struct Parameters {
+        double cellSize = 1; //!< the size of the raster cells, in the units of the point cloud.
+        double maxWindowSize = 33; //!< the size of the largest window, in the units of the point cloud.
+        double slope = 0.15; //!< the slope of the terrain, used to scale the height threshold with the window size.
+        double initialDistance = 0.15; //!< the height threshold of the smallest window.
+        double maxDistance = 2.5; //!< the maximal height threshold.
+        double tileSize = 200; //!< the size of the tiles, in the units of the point cloud.
+        double haloSize = -1; //!< the size of the tiles halo, if 0 or less the cumulated reach of the openings is used.
+    };
+
+    /*!
+     * \brief setupGroundClassifier setup a ground classification
+     * \param source a pointer to the source, will be moved to the output if return is not nullptr
+     * \param parameters the parameters of the morphological filter.
+     * \return a unique ptr to a PointCloudPointAccessInterface, or nullptr in case of error
+     */
+    static std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> setupGroundClassifier(
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
+            Parameters const& parameters);
+
+protected:
+
+    GroundClassifier(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source,
+                     Parameters const& parameters);
+
+    virtual void processTile(TileSpool::Tile const& tile,
+                             std::vector<SpooledPoint> & points,
+                             std::vector<SpooledPoint> const& halo,
+                             bool parallel) const override;
+
+    Parameters _parameters;
+
+    int _classificationIdx;
+    bool _classificationInSource;
+
+    std::vector<int> _windowSizes; //!< in cells
+    std::vector<double> _heightThresholds;
+};
+
+#endif // GROUNDCLASSIFIER_H
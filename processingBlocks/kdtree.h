@@ -0,0 +1,245 @@
+#ifndef KDTREE_H
+#define KDTREE_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+/*!
+ * \brief The KdTree class is a static 3d kd-tree, used for nearest neighbors and radius queries.
+ *
+ * The points are copied in the tree order, so that the points of a leaf are contiguous in memory.
+ * The queries are const and can be run from multiple threads at the same time.
+ */
+class KdTree
+{
+public:
+
+    struct Neighbor {
+        double squaredDistance;
+        int64_t index; //!< index of the point in the vector the tree was built from.
+
+        inline bool operator<(Neighbor const& other) const {
+            return squaredDistance < other.squaredDistance;
+        }
+    };
+
+    explicit KdTree(std::vector<std::array<double, 3>> const& points) :
+        _points(points.size()),
+        _indices(points.size())
+    {
+
+        if (points.empty()) {
+            return;
+        }
+
+        std::iota(_indices.begin(), _indices.end(), 0);
+        _nodes.reserve(2*(points.size()/LeafSize + 1));
+        build(points, 0, points.size());
+
+        for (size_t i = 0; i < _indices.size(); i++) {
+            _points[i] = points[_indices[i]];
+        }
+    }
+
+    inline size_t size() const {
+        return _points.size();
+    }
+
+    /*!
+     * \brief nearestNeighbors find the k nearest neighbors of a position.
+     * \param position the query position.
+     * \param k the number of neighbors.
+     * \param out the neighbors, sorted by increasing distance (less than k if the tree has less points).
+     * \param exclude the index of a point to ignore (e.g. the query point itself), -1 for none.
+     */
+    void nearestNeighbors(double const* position, int k, std::vector<Neighbor> & out, int64_t exclude = -1) const {
+
+        out.clear();
+
+        if (_nodes.empty() or k <= 0) {
+            return;
+        }
+
+        out.reserve(k+1);
+        nearestNeighbors(0, position, k, out, exclude);
+        std::sort_heap(out.begin(), out.end());
+    }
+
+    /*!
+     * \brief countInRadius count the points within a radius of a position.
+     * \param position the query position.
+     * \param radius the search radius.
+     * \param maxCount stop searching once this number of points is reached.
+     * \param exclude the index of a point to ignore (e.g. the query point itself), -1 for none.
+     * \return the number of points found, at most maxCount.
+     */
+    int64_t countInRadius(double const* position, double radius, int64_t maxCount, int64_t exclude = -1) const {
+
+        if (_nodes.empty() or maxCount <= 0) {
+            return 0;
+        }
+
+        int64_t count = 0;
+        countInRadius(0, position, radius*radius, maxCount, exclude, count);
+        return count;
+    }
+
+protected:
+
+    static constexpr size_t LeafSize = 16;
+
+    struct Node {
+        size_t begin;
+        size_t end;
+        double split;
+        int axis; //!< -1 for leaves
+        int64_t right; //!< the left child is the next node
+    };
+
+    int64_t build(std::vector<std::array<double, 3>> const& points, size_t begin, size_t end) {
+
+        int64_t nodeIdx = _nodes.size();
+        _nodes.push_back(Node{begin, end, 0, -1, -1});
+
+        if (end - begin <= LeafSize) {
+            return nodeIdx;
+        }
+
+        //split along the axis with the largest extent.
+        std::array<double, 3> min = points[_indices[begin]];
+        std::array<double, 3> max = min;
+
+        for (size_t i = begin; i < end; i++) {
+            for (int a = 0; a < 3; a++) {
+                min[a] = std::min(min[a], points[_indices[i]][a]);
+                max[a] = std::max(max[a], points[_indices[i]][a]);
+            }
+        }
+
+        int axis = 0;
+
+        for (int a = 1; a < 3; a++) {
+            if (max[a] - min[a] > max[axis] - min[axis]) {
+                axis = a;
+            }
+        }
+
+        size_t mid = begin + (end - begin)/2;
+
+        std::nth_element(_indices.begin() + begin, _indices.begin() + mid, _indices.begin() + end,
+                         [&points, axis] (int64_t i1, int64_t i2) {
+            return points[i1][axis] < points[i2][axis];
+        });
+
+        double split = points[_indices[mid]][axis];
+
+        build(points, begin, mid);
+        int64_t right = build(points, mid, end);
+
+        Node & node = _nodes[nodeIdx];
+        node.axis = axis;
+        node.split = split;
+        node.right = right;
+
+        return nodeIdx;
+    }
+
+    inline double squaredDistance(size_t i, double const* position) const {
+        double dx = _points[i][0] - position[0];
+        double dy = _points[i][1] - position[1];
+        double dz = _points[i][2] - position[2];
+        return dx*dx + dy*dy + dz*dz;
+    }
+
+    void nearestNeighbors(int64_t nodeIdx, double const* position, int k, std::vector<Neighbor> & heap, int64_t exclude) const {
+
+        Node const& node = _nodes[nodeIdx];
+
+        if (node.axis < 0) {
+
+            for (size_t i = node.begin; i < node.end; i++) {
+
+                if (_indices[i] == exclude) {
+                    continue;
+                }
+
+                double d2 = squaredDistance(i, position);
+
+                if (heap.size() < k) {
+                    heap.push_back(Neighbor{d2, _indices[i]});
+                    std::push_heap(heap.begin(), heap.end());
+                } else if (d2 < heap.front().squaredDistance) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = Neighbor{d2, _indices[i]};
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+
+            return;
+        }
+
+        double delta = position[node.axis] - node.split;
+
+        int64_t near = (delta < 0) ? nodeIdx + 1 : node.right;
+        int64_t far = (delta < 0) ? node.right : nodeIdx + 1;
+
+        nearestNeighbors(near, position, k, heap, exclude);
+
+        if (heap.size() < k or delta*delta < heap.front().squaredDistance) {
+            nearestNeighbors(far, position, k, heap, exclude);
+        }
+    }
+
+    void countInRadius(int64_t nodeIdx, double const* position, double squaredRadius, int64_t maxCount, int64_t exclude, int64_t & count) const {
+
+        Node const& node = _nodes[nodeIdx];
+
+        if (node.axis < 0) {
+
+            for (size_t i = node.begin; i < node.end and count < maxCount; i++) {
+                if (_indices[i] != exclude and squaredDistance(i, position) <= squaredRadius) {
+                    count++;
+                }
+            }
+
+            return;
+        }
+
+        double delta = position[node.axis] - node.split;
+
+        int64_t near = (delta < 0) ? nodeIdx + 1 : node.right;
+        int64_t far = (delta < 0) ? node.right : nodeIdx + 1;
+
+        countInRadius(near, position, squaredRadius, maxCount, exclude, count);
+
+        if (count < maxCount and delta*delta <= squaredRadius) {
+            countInRadius(far, position, squaredRadius, maxCount, exclude, count);
+        }
+    }
+
+    std::vector<std::array<double, 3>> _points;
+    std::vector<int64_t> _indices;
+    std::vector<Node> _nodes;
+};
+
+#endif // KDTREE_H
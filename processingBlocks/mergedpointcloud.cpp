@@ -0,0 +1,434 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mergedpointcloud.h"
+
+#include "crsconversion.h"
+
+#include "../io/streamio.h"
+
+#include <algorithm>
+#include <cctype>
+#include <future>
+#include <iostream>
+#include <set>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+enum class BoundType {
+    None,
+    Min,
+    Max
+};
+
+BoundType boundType(std::string const& attributeName) {
+
+    if (attributeName.size() < 3) {
+        return BoundType::None;
+    }
+
+    std::string prefix = attributeName.substr(0,3);
+    std::transform(prefix.begin(), prefix.end(), prefix.begin(), [] (unsigned char c) { return std::tolower(c); });
+
+    if (prefix == "min") {
+        return BoundType::Min;
+    }
+
+    if (prefix == "max") {
+        return BoundType::Max;
+    }
+
+    return BoundType::None;
+}
+
+bool isArithmetic(StereoVision::IO::PointCloudGenericAttribute const& attribute) {
+    return std::visit([] (auto const& val) {
+        using T = std::decay_t<decltype (val)>;
+        return std::is_arithmetic_v<T>;
+    }, attribute);
+}
+
+/*!
+ * \brief prefetchFile hint the kernel that a file is going to be read soon, so that it get loaded in the page cache in the background.
+ */
+void prefetchFile(std::string const& file) {
+
+    int fd = open(file.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        return;
+    }
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+}
+
+}
+
+MergedPointCloudHeader::MergedPointCloudHeader(std::vector<std::unique_ptr<StereoVision::IO::PointCloudHeaderInterface>> const& sources,
+                                               std::vector<bool> const& converted,
+                                               std::string const& crs)
+{
+
+    std::set<std::string> droppedBounds;
+
+    for (int i = 0; i < sources.size(); i++) {
+
+        auto const& src = sources[i];
+
+        if (src == nullptr) {
+            continue;
+        }
+
+        bool isConverted = i < converted.size() and converted[i];
+
+        for (std::string const& name : src->attributeList()) {
+
+            std::optional<StereoVision::IO::PointCloudGenericAttribute> attr = src->getAttributeByName(name.c_str());
+
+            BoundType type = boundType(name);
+
+            if (isConverted and type != BoundType::None) {
+                droppedBounds.insert(name);
+                continue;
+            }
+
+            if (_attributes.count(name) <= 0) {
+                _attributeList.push_back(name);
+
+                if (attr.has_value()) {
+                    _attributes[name] = attr.value();
+                }
+                continue;
+            }
+
+            if (!attr.has_value()) {
+                continue;
+            }
+
+            if (type == BoundType::None or !isArithmetic(attr.value()) or !isArithmetic(_attributes[name])) {
+                continue;
+            }
+
+            double current = StereoVision::IO::castedPointCloudAttribute<double>(_attributes[name]);
+            double candidate = StereoVision::IO::castedPointCloudAttribute<double>(attr.value());
+
+            if ((type == BoundType::Min and candidate < current) or
+                    (type == BoundType::Max and candidate > current)) {
+                _attributes[name] = attr.value();
+            }
+        }
+    }
+
+    //the bounds reduced without the converted sources would not contain all the points.
+    for (std::string const& name : droppedBounds) {
+        _attributes.erase(name);
+    }
+
+    _attributeList.erase(std::remove_if(_attributeList.begin(), _attributeList.end(), [&droppedBounds] (std::string const& name) {
+        return droppedBounds.count(name) > 0;
+    }), _attributeList.end());
+
+    if (!crs.empty()) {
+        if (_attributes.count("crs") <= 0) {
+            _attributeList.push_back("crs");
+        }
+        _attributes["crs"] = crs;
+    }
+
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> MergedPointCloudHeader::getAttributeById(int id) const {
+
+    if (id < 0 or id >= _attributeList.size()) {
+        return std::nullopt;
+    }
+
+    return getAttributeByName(_attributeList[id].c_str());
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> MergedPointCloudHeader::getAttributeByName(const char* attributeName) const {
+
+    auto it = _attributes.find(attributeName);
+
+    if (it == _attributes.end()) {
+        return std::nullopt;
+    }
+
+    return it->second;
+}
+
+std::vector<std::string> MergedPointCloudHeader::attributeList() const {
+    return _attributeList;
+}
+
+StereoVision::IO::FullPointCloudAccessInterface MergedPointCloud::setupMergedPointCloud(
+        std::vector<std::string> const& files,
+        std::string const& defaultCrs,
+        int64_t* expectedNumberOfPoints) {
+
+    StereoVision::IO::FullPointCloudAccessInterface ret;
+
+    if (files.empty()) {
+        return ret;
+    }
+
+    //read the headers of the files concurrently, the files are closed once their header is read, and opened again when their points are needed.
+    int nConcurrent = std::max<int>(1, std::thread::hardware_concurrency());
+
+    std::vector<std::unique_ptr<StereoVision::IO::PointCloudHeaderInterface>> headers;
+    std::vector<Source> sources(files.size());
+
+    headers.reserve(files.size());
+
+    std::set<std::string> attributes;
+    std::vector<std::string> attributeList;
+
+    int64_t nExpected = 0;
+
+    for (int batchStart = 0; batchStart < files.size(); batchStart += nConcurrent) {
+
+        int batchEnd = std::min<int>(files.size(), batchStart + nConcurrent);
+
+        std::vector<std::future<StatusOptional<StereoVision::IO::FullPointCloudAccessInterface>>> futures;
+
+        for (int i = batchStart; i < batchEnd; i++) {
+            std::string const& file = files[i];
+            futures.push_back(std::async(std::launch::async, [&file] () {
+                return openPointCloudByContent(file);
+            }));
+        }
+
+        for (int i = batchStart; i < batchEnd; i++) {
+
+            StatusOptional<StereoVision::IO::FullPointCloudAccessInterface> stackOpt = futures[i-batchStart].get();
+
+            if (!stackOpt.has_value()) {
+                std::cerr << "Could not open file: \"" << files[i] << "\"! \n\t error message is: \"" << stackOpt.message() << "\"" << std::endl;
+                return ret;
+            }
+
+            StereoVision::IO::FullPointCloudAccessInterface & stack = stackOpt.value();
+
+            if (stack.headerAccess == nullptr or stack.pointAccess == nullptr) {
+                std::cerr << "Error reading file: \"" << files[i] << "\", null accesss interfaces!" << std::endl;
+                return ret;
+            }
+
+            int64_t fileExpected = stack.expectedNumberOfPoints();
+
+            if (fileExpected < 0 or nExpected < 0) {
+                nExpected = -1;
+            } else {
+                nExpected += fileExpected;
+            }
+
+            for (std::string const& name : stack.pointAccess->attributeList()) {
+                if (attributes.count(name) > 0) {
+                    continue;
+                }
+                attributes.insert(name);
+                attributeList.push_back(name);
+            }
+
+            std::optional<StereoVision::IO::PointCloudGenericAttribute> crsAttr = stack.headerAccess->getAttributeByName("crs");
+
+            sources[i].file = files[i];
+
+            if (crsAttr.has_value()) {
+                sources[i].crs = StereoVision::IO::castedPointCloudAttribute<std::string>(crsAttr.value());
+            }
+
+            if (sources[i].crs.empty()) {
+                sources[i].crs = defaultCrs;
+            }
+
+            //the points of the file are released here, only its header is kept until the merged header is built.
+            headers.push_back(std::move(stack.headerAccess));
+        }
+    }
+
+    //reconcile the crs, the first crs found is used as the reference.
+    std::string refCrs;
+
+    for (Source const& source : sources) {
+        if (!source.crs.empty()) {
+            refCrs = source.crs;
+            break;
+        }
+    }
+
+    std::vector<bool> converted(sources.size());
+
+    for (int i = 0; i < sources.size(); i++) {
+        converted[i] = !sources[i].crs.empty() and sources[i].crs != refCrs;
+    }
+
+    if (expectedNumberOfPoints != nullptr) {
+        *expectedNumberOfPoints = nExpected;
+    }
+
+    ret.headerAccess = std::make_unique<MergedPointCloudHeader>(headers, converted, refCrs);
+    headers.clear();
+
+    std::unique_ptr<MergedPointCloud> merged(new MergedPointCloud(sources, refCrs, attributeList));
+
+    if (!merged->ok()) {
+        ret.headerAccess = nullptr;
+        return ret;
+    }
+
+    ret.pointAccess = std::move(merged);
+
+    return ret;
+
+}
+
+MergedPointCloud::MergedPointCloud(std::vector<Source> const& sources,
+                                   std::string const& crs,
+                                   std::vector<std::string> const& attributeList) :
+    _srcs(sources),
+    _crs(crs),
+    _currentSrc(0),
+    _nextSrc(-1),
+    _failed(false),
+    _attributeList(attributeList)
+{
+    gotoSource(0);
+}
+
+MergedPointCloud::~MergedPointCloud() {
+
+}
+
+std::optional<StereoVision::IO::FullPointCloudAccessInterface> MergedPointCloud::openSource(Source const& source, std::string const& crs) {
+
+    StatusOptional<StereoVision::IO::FullPointCloudAccessInterface> stackOpt = openPointCloudByContent(source.file);
+
+    if (!stackOpt.has_value()) {
+        std::cerr << "Could not open file: \"" << source.file << "\"! \n\t error message is: \"" << stackOpt.message() << "\"" << std::endl;
+        return std::nullopt;
+    }
+
+    StereoVision::IO::FullPointCloudAccessInterface stack = std::move(stackOpt.value());
+
+    if (stack.headerAccess == nullptr or stack.pointAccess == nullptr) {
+        std::cerr << "Error reading file: \"" << source.file << "\", null accesss interfaces!" << std::endl;
+        return std::nullopt;
+    }
+
+    if (!source.crs.empty() and source.crs != crs) {
+
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> crsConvertor =
+                CrsConversion::setupCrsConversion(stack.pointAccess, source.crs, crs);
+
+        if (crsConvertor == nullptr) {
+            std::cerr << "Error building crs converter for file \"" << source.file << "\", crs conversion error!" << std::endl;
+            return std::nullopt;
+        }
+
+        stack.pointAccess = std::move(crsConvertor);
+    }
+
+    return stack;
+}
+
+StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> MergedPointCloud::getPointPosition() const {
+    return _current.pointAccess->getPointPosition();
+}
+std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> MergedPointCloud::getPointColor() const {
+    return _current.pointAccess->getPointColor();
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> MergedPointCloud::getAttributeById(int id) const {
+
+    if (id < 0 or id >= _attributeList.size()) {
+        return std::nullopt;
+    }
+
+    return _current.pointAccess->getAttributeByName(_attributeList[id].c_str());
+}
+std::optional<StereoVision::IO::PointCloudGenericAttribute> MergedPointCloud::getAttributeByName(const char* attributeName) const {
+    return _current.pointAccess->getAttributeByName(attributeName);
+}
+
+std::vector<std::string> MergedPointCloud::attributeList() const {
+    return _attributeList;
+}
+
+bool MergedPointCloud::gotoNext() {
+
+    if (_failed or _current.pointAccess == nullptr) {
+        return false;
+    }
+
+    if (_current.pointAccess->gotoNext()) {
+        return true;
+    }
+
+    return gotoSource(_currentSrc+1);
+}
+
+bool MergedPointCloud::hasData() const {
+
+    if (_failed or _current.pointAccess == nullptr) {
+        return false;
+    }
+
+    return _current.pointAccess->hasData();
+}
+
+bool MergedPointCloud::gotoSource(int idx) {
+
+    for (int i = idx; i < _srcs.size(); i++) {
+
+        std::optional<StereoVision::IO::FullPointCloudAccessInterface> stack =
+                (i == _nextSrc) ? _next.get() : openSource(_srcs[i], _crs);
+
+        _nextSrc = -1;
+
+        if (!stack.has_value()) {
+            _failed = true;
+            return false;
+        }
+
+        //the previous source is closed, only the current source and the next one are open at the same time.
+        _current = std::move(stack.value());
+        _currentSrc = i;
+
+        if (!_current.pointAccess->hasData()) {
+            continue;
+        }
+
+        if (i+1 < _srcs.size()) {
+
+            _nextSrc = i+1;
+            _next = std::async(std::launch::async, [source = _srcs[i+1], crs = _crs] () {
+                prefetchFile(source.file);
+                return openSource(source, crs);
+            });
+        }
+
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,141 @@
+#ifndef MERGEDPOINTCLOUD_H
+#define MERGEDPOINTCLOUD_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <future>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+/*!
+ * \brief The MergedPointCloudHeader class reconcile the headers of multiple point clouds.
+ *
+ * The attribute list is the union of the attributes of all the sources.
+ * Attributes starting with "min" or "max" are treated as bounds and reduced accordingly,
+ * except that the bounds defined by a source converted to another crs are dropped (they are not in the crs of the merged cloud).
+ * The crs is the one of the merged cloud, other attributes are taken from the first source defining them.
+ *
+ * The attributes are copied when the header is built, the sources are not kept.
+ */
+class MergedPointCloudHeader : public StereoVision::IO::PointCloudHeaderInterface
+{
+public:
+    MergedPointCloudHeader(std::vector<std::unique_ptr<StereoVision::IO::PointCloudHeaderInterface>> const& sources,
+                           std::vector<bool> const& converted,
+                           std::string const& crs);
+
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeById(int id) const override;
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeByName(const char* attributeName) const override;
+
+    virtual std::vector<std::string> attributeList() const override;
+
+protected:
+
+    std::vector<std::string> _attributeList;
+    std::map<std::string, StereoVision::IO::PointCloudGenericAttribute> _attributes;
+};
+
+/*!
+ * \brief The MergedPointCloud class stream multiple point clouds back to back, as if they were a single one.
+ *
+ * The attribute list is the union of the attributes of all the sources,
+ * attributes missing in the current source are returned as std::nullopt.
+ *
+ * The headers of all the sources are read when the merged point cloud is setup, but the files are then opened one at a time:
+ * only the current source is open, and the next one is opened in the background while the current one is processed.
+ */
+class MergedPointCloud : public StereoVision::IO::PointCloudPointAccessInterface
+{
+public:
+
+    /*!
+     * \brief setupMergedPointCloud open multiple files and merge them in a single point cloud.
+     * \param files the paths to the files to merge
+     * \param defaultCrs the crs to assume for the files which do not define one (can be empty).
+     * \param expectedNumberOfPoints if not nullptr, will be set to the total expected number of points (or -1 if unknown).
+     * \return the merged point cloud, with null access interfaces in case of error.
+     *
+     * If the files do not share the same crs, they are converted to the crs of the first file defining one.
+     */
+    static StereoVision::IO::FullPointCloudAccessInterface setupMergedPointCloud(
+            std::vector<std::string> const& files,
+            std::string const& defaultCrs,
+            int64_t* expectedNumberOfPoints = nullptr);
+
+    ~MergedPointCloud();
+
+    virtual StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> getPointPosition() const override;
+    virtual std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> getPointColor() const override;
+
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeById(int id) const override;
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeByName(const char* attributeName) const override;
+
+    virtual std::vector<std::string> attributeList() const override;
+
+    virtual bool gotoNext() override;
+    virtual bool hasData() const override;
+
+    /*!
+     * \brief ok indicate if all the sources could be opened again (the points end at the first source which could not otherwise).
+     */
+    inline bool ok() const {
+        return !_failed;
+    }
+
+protected:
+
+    struct Source {
+        std::string file;
+        std::string crs; //!< the crs of the file, converted to the crs of the merged cloud if they differ (empty if unknown).
+    };
+
+    MergedPointCloud(std::vector<Source> const& sources,
+                     std::string const& crs,
+                     std::vector<std::string> const& attributeList);
+
+    /*!
+     * \brief openSource open a source, converted to the crs of the merged cloud if needed.
+     * \return the source, or std::nullopt in case of error.
+     */
+    static std::optional<StereoVision::IO::FullPointCloudAccessInterface> openSource(Source const& source, std::string const& crs);
+
+    /*!
+     * \brief gotoSource move to the first source from idx onward which has data, and start opening the next one.
+     * \return true if such a source exist, false otherwise.
+     */
+    bool gotoSource(int idx);
+
+    std::vector<Source> _srcs;
+    std::string _crs;
+
+    int _currentSrc;
+    StereoVision::IO::FullPointCloudAccessInterface _current;
+
+    int _nextSrc; //!< the source being opened in the background, or -1.
+    std::future<std::optional<StereoVision::IO::FullPointCloudAccessInterface>> _next;
+
+    bool _failed;
+
+    std::vector<std::string> _attributeList;
+};
+
+#endif // MERGEDPOINTCLOUD_H
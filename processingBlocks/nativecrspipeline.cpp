@@ -0,0 +1,1102 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "nativecrspipeline.h"
+
+#include <proj.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace {
+
+/*!
+ * \brief The AffineMap struct is an affine map y = A*x + b.
+ */
+struct AffineMap {
+    Eigen::Matrix3d A = Eigen::Matrix3d::Identity();
+    Eigen::Vector3d b = Eigen::Vector3d::Zero();
+
+    AffineMap inverse() const {
+        AffineMap ret;
+        ret.A = A.inverse();
+        ret.b = -ret.A*b;
+        return ret;
+    }
+
+    //this step applied after other.
+    AffineMap after(AffineMap const& other) const {
+        AffineMap ret;
+        ret.A = A*other.A;
+        ret.b = A*other.b + b;
+        return ret;
+    }
+};
+
+using StepParameters = std::map<std::string, std::string>;
+
+std::optional<double> parameterValue(StepParameters const& parameters, std::string const& name, double defaultValue) {
+
+    auto it = parameters.find(name);
+
+    if (it == parameters.end()) {
+        return defaultValue;
+    }
+
+    try {
+        size_t pos;
+        double value = std::stod(it->second, &pos);
+
+        if (pos != it->second.size()) {
+            return std::nullopt;
+        }
+
+        return value;
+    } catch (std::exception const&) {
+        return std::nullopt;
+    }
+}
+
+/*!
+ * \brief unitFactor get the factor to convert a unit to the base unit (meter or radian).
+ */
+std::optional<double> unitFactor(std::string const& unit) {
+
+    static const std::map<std::string, double> factors = {
+        {"m", 1},
+        {"km", 1000},
+        {"dm", 0.1},
+        {"cm", 0.01},
+        {"mm", 0.001},
+        {"ft", 0.3048},
+        {"us-ft", 1200.0/3937},
+        {"yd", 0.9144},
+        {"mi", 1609.344},
+        {"kmi", 1852},
+        {"rad", 1},
+        {"deg", M_PI/180},
+        {"grad", M_PI/200}
+    };
+
+    auto it = factors.find(unit);
+
+    if (it != factors.end()) {
+        return it->second;
+    }
+
+    //the unit can also be given directly as a conversion factor.
+    StepParameters parameters = {{"unit", unit}};
+    std::optional<double> factor = parameterValue(parameters, "unit", 1);
+
+    if (!factor.has_value() or factor.value() <= 0) {
+        return std::nullopt;
+    }
+
+    return factor;
+}
+
+std::optional<AffineMap> axisswapStep(StepParameters const& parameters) {
+
+    auto it = parameters.find("order");
+
+    if (it == parameters.end()) {
+        return std::nullopt;
+    }
+
+    AffineMap ret;
+    ret.A.setZero();
+
+    std::istringstream order(it->second);
+    std::string item;
+    int i = 0;
+
+    while (std::getline(order, item, ',')) {
+
+        int axis;
+
+        try {
+            axis = std::stoi(item);
+        } catch (std::exception const&) {
+            return std::nullopt;
+        }
+
+        //the fourth axis is the time, which is not transformed.
+        if (i >= 4 or axis == 0 or std::abs(axis) > 4 or (i < 3) != (std::abs(axis) < 4)) {
+            return std::nullopt;
+        }
+
+        if (i < 3) {
+            ret.A(i, std::abs(axis) - 1) = (axis > 0) ? 1 : -1;
+        }
+
+        i++;
+    }
+
+    //the axes which are not listed are kept.
+    for (; i < 3; i++) {
+        ret.A(i, i) = 1;
+    }
+
+    if (std::abs(ret.A.determinant()) != 1) {
+        return std::nullopt;
+    }
+
+    return ret;
+}
+
+std::optional<AffineMap> unitconvertStep(StepParameters const& parameters) {
+
+    AffineMap ret;
+
+    std::array<std::string, 2> coordsSets = {"xy", "z"};
+
+    for (std::string const& coords : coordsSets) {
+
+        auto in = parameters.find(coords + "_in");
+        auto out = parameters.find(coords + "_out");
+
+        if (in == parameters.end() and out == parameters.end()) {
+            continue;
+        }
+
+        if (in == parameters.end() or out == parameters.end()) {
+            return std::nullopt;
+        }
+
+        std::optional<double> inFactor = unitFactor(in->second);
+        std::optional<double> outFactor = unitFactor(out->second);
+
+        if (!inFactor.has_value() or !outFactor.has_value()) {
+            return std::nullopt;
+        }
+
+        double factor = inFactor.value()/outFactor.value();
+
+        if (coords == "xy") {
+            ret.A(0, 0) = factor;
+            ret.A(1, 1) = factor;
+        } else {
+            ret.A(2, 2) = factor;
+        }
+    }
+
+    return ret;
+}
+
+std::optional<AffineMap> affineStep(StepParameters const& parameters) {
+
+    AffineMap ret;
+
+    std::array<const char*, 3> offsets = {"xoff", "yoff", "zoff"};
+
+    for (int i = 0; i < 3; i++) {
+
+        std::optional<double> offset = parameterValue(parameters, offsets[i], 0);
+
+        if (!offset.has_value()) {
+            return std::nullopt;
+        }
+
+        ret.b[i] = offset.value();
+
+        for (int j = 0; j < 3; j++) {
+
+            std::string name = "s" + std::to_string(i+1) + std::to_string(j+1);
+            std::optional<double> coefficient = parameterValue(parameters, name, (i == j) ? 1 : 0);
+
+            if (!coefficient.has_value()) {
+                return std::nullopt;
+            }
+
+            ret.A(i, j) = coefficient.value();
+        }
+    }
+
+    return ret;
+}
+
+std::optional<AffineMap> helmertStep(StepParameters const& parameters) {
+
+    //time dependent, 2d and Molodensky-Badekas transforms are not supported.
+    for (const char* name : {"dx", "dy", "dz", "drx", "dry", "drz", "ds", "theta", "px", "py", "pz", "transpose"}) {
+        if (parameters.count(name) > 0) {
+            return std::nullopt;
+        }
+    }
+
+    std::array<double, 7> values;
+    std::array<const char*, 7> names = {"x", "y", "z", "rx", "ry", "rz", "s"};
+
+    for (int i = 0; i < 7; i++) {
+
+        std::optional<double> value = parameterValue(parameters, names[i], 0);
+
+        if (!value.has_value()) {
+            return std::nullopt;
+        }
+
+        values[i] = value.value();
+    }
+
+    constexpr double arcsec2rad = M_PI/(180*3600);
+
+    double rx = values[3]*arcsec2rad;
+    double ry = values[4]*arcsec2rad;
+    double rz = values[5]*arcsec2rad;
+    double scale = 1 + values[6]*1e-6;
+
+    bool hasRotation = rx != 0 or ry != 0 or rz != 0;
+
+    auto convention = parameters.find("convention");
+
+    if (hasRotation and convention == parameters.end()) {
+        return std::nullopt;
+    }
+
+    AffineMap ret;
+
+    //same rotation matrix as PROJ, in the coordinate frame convention.
+    if (parameters.count("exact") > 0) {
+
+        double cx = std::cos(rx);
+        double sx = std::sin(rx);
+        double cy = std::cos(ry);
+        double sy = std::sin(ry);
+        double cz = std::cos(rz);
+        double sz = std::sin(rz);
+
+        ret.A << cy*cz, cx*sz + sx*sy*cz, sx*sz - cx*sy*cz,
+                -cy*sz, cx*cz - sx*sy*sz, sx*cz + cx*sy*sz,
+                sy, -sx*cy, cx*cy;
+
+    } else {
+
+        ret.A << 1, rz, -ry,
+                -rz, 1, rx,
+                ry, -rx, 1;
+    }
+
+    if (convention != parameters.end()) {
+        if (convention->second == "position_vector") {
+            ret.A.transposeInPlace();
+        } else if (convention->second != "coordinate_frame") {
+            return std::nullopt;
+        }
+    }
+
+    ret.A *= scale;
+    ret.b << values[0], values[1], values[2];
+
+    return ret;
+}
+
+
+AffineMap toMap(StereoVision::Geometry::AffineTransform<double> const& transform) {
+    AffineMap ret;
+    ret.A = transform.R;
+    ret.b = transform.t;
+    return ret;
+}
+
+StereoVision::Geometry::AffineTransform<double> toTransform(AffineMap const& map) {
+    return StereoVision::Geometry::AffineTransform<double>(map.A, map.b);
+}
+
+/*!
+ * \brief adjlon wrap a longitude in [-pi, pi], as PROJ does.
+ */
+inline double adjlon(double lon) {
+
+    if (std::abs(lon) <= M_PI) {
+        return lon;
+    }
+
+    return std::remainder(lon, 2*M_PI);
+}
+
+/*!
+ * \brief hasOnly check that a step has no other parameters than the ones supported.
+ */
+bool hasOnly(StepParameters const& parameters, std::set<std::string> const& supported) {
+
+    for (auto const& [name, value] : parameters) {
+        if (supported.count(name) <= 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+const std::set<std::string> ellipsoidParameters = {"ellps", "a", "b", "rf", "f", "R"};
+
+std::optional<NativeCrsPipeline::Ellipsoid> ellipsoidFromParameters(StepParameters const& parameters) {
+
+    //same definitions as PROJ, the default being GRS80.
+    static const std::map<std::string, NativeCrsPipeline::Ellipsoid> ellipsoids = {
+        {"GRS80", NativeCrsPipeline::GRS80},
+        {"WGS84", NativeCrsPipeline::WGS84},
+        {"WGS72", {6378135, 1/298.26}},
+        {"GRS67", {6378160, 1/298.2471674270}},
+        {"intl", {6378388, 1/297.}},
+        {"bessel", {6377397.155, 1/299.1528128}},
+        {"krass", {6378245, 1/298.3}},
+        {"clrk66", {6378206.4, 1 - 6356583.8/6378206.4}},
+        {"clrk80ign", {6378249.2, 1/293.4660212936269}},
+        {"airy", {6377563.396, 1 - 6356256.910/6377563.396}}
+    };
+
+    NativeCrsPipeline::Ellipsoid ret = NativeCrsPipeline::GRS80;
+
+    auto ellps = parameters.find("ellps");
+
+    if (ellps != parameters.end()) {
+
+        auto it = ellipsoids.find(ellps->second);
+
+        if (it == ellipsoids.end()) {
+            return std::nullopt;
+        }
+
+        ret = it->second;
+    }
+
+    if (parameters.count("R") > 0) {
+        std::optional<double> radius = parameterValue(parameters, "R", 0);
+
+        if (!radius.has_value() or radius.value() <= 0) {
+            return std::nullopt;
+        }
+
+        return NativeCrsPipeline::Ellipsoid{radius.value(), 0};
+    }
+
+    std::optional<double> a = parameterValue(parameters, "a", ret.a);
+
+    if (!a.has_value() or a.value() <= 0) {
+        return std::nullopt;
+    }
+
+    //the flattening is given by the first of rf, f or b, else kept from the named ellipsoid.
+    double f = ret.f;
+
+    if (parameters.count("rf") > 0) {
+        std::optional<double> rf = parameterValue(parameters, "rf", 0);
+
+        if (!rf.has_value() or rf.value() <= 0) {
+            return std::nullopt;
+        }
+
+        f = 1/rf.value();
+    } else if (parameters.count("f") > 0) {
+        std::optional<double> flattening = parameterValue(parameters, "f", 0);
+
+        if (!flattening.has_value()) {
+            return std::nullopt;
+        }
+
+        f = flattening.value();
+    } else if (parameters.count("b") > 0) {
+        std::optional<double> b = parameterValue(parameters, "b", 0);
+
+        if (!b.has_value() or b.value() <= 0) {
+            return std::nullopt;
+        }
+
+        f = 1 - b.value()/a.value();
+    }
+
+    if (f < 0 or f >= 1) {
+        return std::nullopt;
+    }
+
+    return NativeCrsPipeline::Ellipsoid{a.value(), f};
+}
+
+std::optional<NativeCrsPipeline::TransverseMercator> transverseMercatorFromParameters(std::string const& operation,
+                                                                                        StepParameters const& parameters) {
+
+    std::set<std::string> supported = {"proj", "inv", "units", "no_defs"};
+    supported.insert(ellipsoidParameters.begin(), ellipsoidParameters.end());
+
+    if (operation == "utm") {
+        supported.insert({"zone", "south"});
+    } else {
+        supported.insert({"lon_0", "lat_0", "k_0", "k", "x_0", "y_0"});
+    }
+
+    //the approximate algorithm (+approx), other units or axis orders are left to PROJ.
+    if (!hasOnly(parameters, supported)) {
+        return std::nullopt;
+    }
+
+    auto units = parameters.find("units");
+
+    if (units != parameters.end() and units->second != "m") {
+        return std::nullopt;
+    }
+
+    std::optional<NativeCrsPipeline::Ellipsoid> ellipsoid = ellipsoidFromParameters(parameters);
+
+    if (!ellipsoid.has_value()) {
+        return std::nullopt;
+    }
+
+    constexpr double deg2rad = M_PI/180;
+
+    if (operation == "utm") {
+
+        std::optional<double> zone = parameterValue(parameters, "zone", 0);
+
+        if (!zone.has_value() or zone.value() < 1 or zone.value() > 60 or zone.value() != std::floor(zone.value())) {
+            return std::nullopt;
+        }
+
+        double lon0 = ((zone.value() - 1)*6 - 180 + 3)*deg2rad;
+        double y0 = (parameters.count("south") > 0) ? 10000000 : 0;
+
+        return NativeCrsPipeline::TransverseMercator(ellipsoid.value(), lon0, 0, 0.9996, 500000, y0);
+    }
+
+    std::optional<double> lon0 = parameterValue(parameters, "lon_0", 0);
+    std::optional<double> lat0 = parameterValue(parameters, "lat_0", 0);
+    std::optional<double> k0 = parameterValue(parameters, "k_0", 1);
+    std::optional<double> x0 = parameterValue(parameters, "x_0", 0);
+    std::optional<double> y0 = parameterValue(parameters, "y_0", 0);
+
+    if (parameters.count("k") > 0 and parameters.count("k_0") <= 0) {
+        k0 = parameterValue(parameters, "k", 1);
+    }
+
+    if (!lon0.has_value() or !lat0.has_value() or !k0.has_value() or !x0.has_value() or !y0.has_value() or k0.value() <= 0) {
+        return std::nullopt;
+    }
+
+    return NativeCrsPipeline::TransverseMercator(ellipsoid.value(),
+                                                 lon0.value()*deg2rad,
+                                                 lat0.value()*deg2rad,
+                                                 k0.value(),
+                                                 x0.value(),
+                                                 y0.value());
+}
+
+inline double sq(double v) {
+    return v*v;
+}
+
+/*!
+ * \brief conformalTau get the tangent of the conformal latitude from the tangent of the latitude.
+ */
+inline double conformalTau(double tau, double e) {
+    double sigma = std::sinh(e*std::atanh(e*tau/std::sqrt(1 + sq(tau))));
+    return tau*std::sqrt(1 + sq(sigma)) - sigma*std::sqrt(1 + sq(tau));
+}
+
+}
+
+NativeCrsPipeline::TransverseMercator::TransverseMercator(Ellipsoid const& ellipsoid,
+                                                         double lon0,
+                                                         double lat0,
+                                                         double k0,
+                                                         double x0,
+                                                         double y0) :
+    _e(std::sqrt(ellipsoid.es())),
+    _lon0(lon0),
+    _x0(x0)
+{
+
+    double n = ellipsoid.f/(2 - ellipsoid.f);
+    double n2 = n*n;
+    double n3 = n2*n;
+    double n4 = n3*n;
+    double n5 = n4*n;
+    double n6 = n5*n;
+
+    double A = ellipsoid.a/(1 + n)*(1 + n2/4 + n4/64 + n6/256);
+
+    _k0A = k0*A;
+
+    //Krüger series, see Karney (2011), Transverse Mercator with an accuracy of a few nanometers.
+    _alpha = {n/2 - 2*n2/3 + 5*n3/16 + 41*n4/180 - 127*n5/288 + 7891*n6/37800,
+              13*n2/48 - 3*n3/5 + 557*n4/1440 + 281*n5/630 - 1983433*n6/1935360,
+              61*n3/240 - 103*n4/140 + 15061*n5/26880 + 167603*n6/181440,
+              49561*n4/161280 - 179*n5/168 + 6601661*n6/7257600,
+              34729*n5/80640 - 3418889*n6/1995840,
+              212378941*n6/319334400};
+
+    _beta = {n/2 - 2*n2/3 + 37*n3/96 - n4/360 - 81*n5/512 + 96199*n6/604800,
+             n2/48 + n3/15 - 437*n4/1440 + 46*n5/105 - 1118711*n6/3870720,
+             17*n3/480 - 37*n4/840 - 209*n5/4480 + 5569*n6/90720,
+             4397*n4/161280 - 11*n5/504 - 830251*n6/7257600,
+             4583*n5/161280 - 108847*n6/3991680,
+             20648693*n6/638668800};
+
+    //northing of the latitude of origin on the central meridian.
+    double xi0 = std::atan(conformalTau(std::tan(lat0), _e));
+    double xi = xi0;
+
+    for (int j = 1; j <= 6; j++) {
+        xi += _alpha[j-1]*std::sin(2*j*xi0);
+    }
+
+    _y0 = y0 - _k0A*xi;
+}
+
+void NativeCrsPipeline::TransverseMercator::forward(double lon, double lat, double & x, double & y) const {
+
+    //same domain as the PROJ implementation.
+    constexpr double maxEta = 2.623395162778;
+
+    if (!std::isfinite(lon) or !(std::abs(lat) <= M_PI/2)) {
+        x = HUGE_VAL;
+        y = HUGE_VAL;
+        return;
+    }
+
+    double lam = adjlon(lon - _lon0);
+
+    double sinPhi = std::sin(lat);
+    double taup = std::sinh(std::atanh(sinPhi) - _e*std::atanh(_e*sinPhi));
+
+    double cosLam = std::cos(lam);
+
+    double xip = std::atan2(taup, cosLam);
+    double etap = std::asinh(std::sin(lam)/std::sqrt(sq(taup) + sq(cosLam)));
+
+    if (std::abs(etap) > maxEta) {
+        x = HUGE_VAL;
+        y = HUGE_VAL;
+        return;
+    }
+
+    double xi = xip;
+    double eta = etap;
+
+    for (int j = 1; j <= 6; j++) {
+        xi += _alpha[j-1]*std::sin(2*j*xip)*std::cosh(2*j*etap);
+        eta += _alpha[j-1]*std::cos(2*j*xip)*std::sinh(2*j*etap);
+    }
+
+    x = _x0 + _k0A*eta;
+    y = _y0 + _k0A*xi;
+}
+
+void NativeCrsPipeline::TransverseMercator::inverse(double x, double y, double & lon, double & lat) const {
+
+    constexpr double maxEta = 2.623395162778;
+
+    double xi = (y - _y0)/_k0A;
+    double eta = (x - _x0)/_k0A;
+
+    if (!std::isfinite(xi) or !(std::abs(eta) <= maxEta)) {
+        lon = HUGE_VAL;
+        lat = HUGE_VAL;
+        return;
+    }
+
+    double xip = xi;
+    double etap = eta;
+
+    for (int j = 1; j <= 6; j++) {
+        xip -= _beta[j-1]*std::sin(2*j*xi)*std::cosh(2*j*eta);
+        etap -= _beta[j-1]*std::cos(2*j*xi)*std::sinh(2*j*eta);
+    }
+
+    double sinhEtap = std::sinh(etap);
+    double cosXip = std::cos(xip);
+
+    double taup = std::sin(xip)/std::sqrt(sq(sinhEtap) + sq(cosXip));
+
+    //newton iterations to get the latitude from the conformal latitude.
+    double e2m = 1 - sq(_e);
+    double tau = taup/e2m;
+
+    for (int i = 0; i < 5; i++) {
+
+        double taupi = conformalTau(tau, _e);
+        double dtau = (taup - taupi)/std::sqrt(1 + sq(taupi))*(1 + e2m*sq(tau))/(e2m*std::sqrt(1 + sq(tau)));
+
+        tau += dtau;
+
+        if (!(std::abs(dtau) >= 1e-14*std::max(1.0, std::abs(tau)))) {
+            break;
+        }
+    }
+
+    lat = std::atan(tau);
+    lon = adjlon(std::atan2(sinhEtap, cosXip) + _lon0);
+}
+
+void NativeCrsPipeline::geodeticToCartesian(Ellipsoid const& ellipsoid, double lon, double lat, double h, double & x, double & y, double & z) {
+
+    if (!(std::abs(lat) <= M_PI/2)) {
+        x = HUGE_VAL;
+        y = HUGE_VAL;
+        z = HUGE_VAL;
+        return;
+    }
+
+    double es = ellipsoid.es();
+
+    double sinPhi = std::sin(lat);
+    double cosPhi = std::cos(lat);
+
+    double N = ellipsoid.a/std::sqrt(1 - es*sq(sinPhi));
+
+    x = (N + h)*cosPhi*std::cos(lon);
+    y = (N + h)*cosPhi*std::sin(lon);
+    z = (N*(1 - es) + h)*sinPhi;
+}
+
+void NativeCrsPipeline::cartesianToGeodetic(Ellipsoid const& ellipsoid, double x, double y, double z, double & lon, double & lat, double & h) {
+
+    double a = ellipsoid.a;
+    double b = ellipsoid.b();
+    double es = ellipsoid.es();
+    double e2s = es/(1 - es); //second eccentricity squared
+
+    double p = std::hypot(x, y);
+
+    double theta = std::atan2(z*a, p*b);
+    double c = std::cos(theta);
+    double s = std::sin(theta);
+
+    lat = std::atan2(z + e2s*b*s*s*s, p - es*a*c*c*c);
+    lon = std::atan2(y, x);
+
+    double N = a/std::sqrt(1 - es*sq(std::sin(lat)));
+    double cosPhi = std::cos(lat);
+
+    //close to the poles, the height is measured along the polar axis.
+    if (std::abs(cosPhi) < 1e-6) {
+        h = std::abs(z) - b;
+    } else {
+        h = p/cosPhi - N;
+    }
+}
+
+std::optional<NativeCrsPipeline> NativeCrsPipeline::parse(std::string const& projString) {
+
+    //split the string in steps, each step being a map of parameters.
+    std::vector<StepParameters> steps;
+    steps.emplace_back();
+
+    std::istringstream tokens(projString);
+    std::string token;
+
+    while (tokens >> token) {
+
+        if (token.empty() or token[0] != '+') {
+            return std::nullopt;
+        }
+
+        token = token.substr(1);
+
+        if (token == "step") {
+            steps.emplace_back();
+            continue;
+        }
+
+        size_t equal = token.find('=');
+
+        if (equal == std::string::npos) {
+            steps.back()[token] = "";
+        } else {
+            steps.back()[token.substr(0, equal)] = token.substr(equal+1);
+        }
+    }
+
+    //the first step is the pipeline itself, with its global parameters, or the single operation.
+    StepParameters globals;
+
+    if (steps.size() > 1) {
+
+        globals = steps.front();
+        steps.erase(steps.begin());
+
+        if (globals["proj"] != "pipeline") {
+            return std::nullopt;
+        }
+
+        globals.erase("proj");
+
+        //only the ellipsoid can be shared between the steps.
+        if (!hasOnly(globals, ellipsoidParameters)) {
+            return std::nullopt;
+        }
+    }
+
+    NativeCrsPipeline ret;
+
+    for (StepParameters step : steps) {
+
+        //the global ellipsoid applies to the steps which do not define their own.
+        bool hasEllipsoid = std::any_of(ellipsoidParameters.begin(), ellipsoidParameters.end(), [&step] (std::string const& name) {
+            return step.count(name) > 0;
+        });
+
+        if (!hasEllipsoid) {
+            step.insert(globals.begin(), globals.end());
+        }
+
+        auto proj = step.find("proj");
+
+        if (proj == step.end()) {
+            return std::nullopt;
+        }
+
+        std::string const& operation = proj->second;
+        bool inverse = step.count("inv") > 0;
+
+        if (operation == "push" or operation == "pop") {
+
+            StackStep stackStep;
+            stackStep.push = (operation == "push") != inverse;
+
+            for (int i = 0; i < 3; i++) {
+                stackStep.coordinates[i] = step.count("v_" + std::to_string(i+1)) > 0;
+            }
+
+            ret._steps.push_back(stackStep);
+            continue;
+        }
+
+        if (operation == "cart") {
+
+            std::set<std::string> supported = {"proj", "inv"};
+            supported.insert(ellipsoidParameters.begin(), ellipsoidParameters.end());
+
+            std::optional<Ellipsoid> ellipsoid = ellipsoidFromParameters(step);
+
+            if (!hasOnly(step, supported) or !ellipsoid.has_value()) {
+                return std::nullopt;
+            }
+
+            ret._steps.push_back(CartStep{ellipsoid.value(), inverse});
+            continue;
+        }
+
+        if (operation == "tmerc" or operation == "etmerc" or operation == "utm") {
+
+            std::optional<TransverseMercator> projection = transverseMercatorFromParameters(operation, step);
+
+            if (!projection.has_value()) {
+                return std::nullopt;
+            }
+
+            ret._steps.push_back(TransverseMercatorStep{projection.value(), inverse});
+            continue;
+        }
+
+        std::optional<AffineMap> affine;
+
+        if (operation == "noop") {
+            affine = AffineMap();
+        } else if (operation == "axisswap") {
+            affine = axisswapStep(step);
+        } else if (operation == "unitconvert") {
+            affine = unitconvertStep(step);
+        } else if (operation == "affine") {
+            affine = affineStep(step);
+        } else if (operation == "helmert") {
+            affine = helmertStep(step);
+        }
+
+        if (!affine.has_value()) {
+            return std::nullopt;
+        }
+
+        if (inverse) {
+
+            if (std::abs(affine->A.determinant()) < 1e-12) {
+                return std::nullopt;
+            }
+
+            affine = affine->inverse();
+        }
+
+        ret._steps.push_back(AffineStep{toTransform(affine.value())});
+    }
+
+    //check that the stack is used consistently.
+    std::array<int, 3> depths = {0, 0, 0};
+
+    for (Step const& step : ret._steps) {
+
+        if (!std::holds_alternative<StackStep>(step)) {
+            continue;
+        }
+
+        StackStep const& stackStep = std::get<StackStep>(step);
+
+        for (int i = 0; i < 3; i++) {
+
+            if (!stackStep.coordinates[i]) {
+                continue;
+            }
+
+            depths[i] += (stackStep.push) ? 1 : -1;
+
+            if (depths[i] < 0 or depths[i] > MaxStackDepth) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    bool allAffine = std::all_of(ret._steps.begin(), ret._steps.end(), [] (Step const& step) {
+        return std::holds_alternative<AffineStep>(step) or std::holds_alternative<StackStep>(step);
+    });
+
+    //an affine pipeline is composed in a single step, the coordinates pushed on the stack being the rows of the transform.
+    if (allAffine) {
+
+        AffineMap total;
+        std::array<std::vector<std::pair<Eigen::RowVector3d, double>>, 3> pushed;
+
+        for (Step const& step : ret._steps) {
+
+            if (std::holds_alternative<AffineStep>(step)) {
+                total = toMap(std::get<AffineStep>(step).transform).after(total);
+                continue;
+            }
+
+            StackStep const& stackStep = std::get<StackStep>(step);
+
+            for (int i = 0; i < 3; i++) {
+
+                if (!stackStep.coordinates[i]) {
+                    continue;
+                }
+
+                if (stackStep.push) {
+                    pushed[i].emplace_back(total.A.row(i), total.b[i]);
+                    continue;
+                }
+
+                total.A.row(i) = pushed[i].back().first;
+                total.b[i] = pushed[i].back().second;
+                pushed[i].pop_back();
+            }
+        }
+
+        ret._steps = {AffineStep{toTransform(total)}};
+
+        return ret;
+    }
+
+    //else the consecutive affine steps are composed.
+    std::vector<Step> composed;
+
+    for (Step const& step : ret._steps) {
+
+        if (std::holds_alternative<AffineStep>(step) and !composed.empty() and std::holds_alternative<AffineStep>(composed.back())) {
+            AffineMap previous = toMap(std::get<AffineStep>(composed.back()).transform);
+            AffineMap current = toMap(std::get<AffineStep>(step).transform);
+            composed.back() = AffineStep{toTransform(current.after(previous))};
+            continue;
+        }
+
+        composed.push_back(step);
+    }
+
+    ret._steps = std::move(composed);
+
+    return ret;
+}
+
+std::optional<NativeCrsPipeline> NativeCrsPipeline::fromProjTransform(pj_ctx* projContext, PJconsts* transform) {
+
+    if (transform == nullptr) {
+        return std::nullopt;
+    }
+
+    //transforms with multiple candidate operations (chosen per point) have no single pipeline, and no proj string.
+    const char* projString = proj_as_proj_string(projContext, transform, PJ_PROJ_5, nullptr);
+
+    if (projString == nullptr) {
+        return std::nullopt;
+    }
+
+    std::optional<NativeCrsPipeline> pipeline = parse(projString);
+
+    if (!pipeline.has_value()) {
+        return std::nullopt;
+    }
+
+    //the pipeline is checked against PROJ, on points in the domain of its first non affine step,
+    //brought back to the input of the pipeline by the inverse of the affine steps before it.
+    AffineMap prefix;
+    std::vector<Eigen::Vector3d> samples;
+
+    for (Step const& step : pipeline->_steps) {
+
+        if (std::holds_alternative<AffineStep>(step)) {
+            prefix = toMap(std::get<AffineStep>(step).transform).after(prefix);
+            continue;
+        }
+
+        if (std::holds_alternative<StackStep>(step)) {
+            continue;
+        }
+
+        std::array<double, 3> lonOffsets = {0.02, -0.05, 0.03};
+        std::array<double, 3> lats = {0.8, -0.6, 0.1};
+        std::array<double, 3> heights = {500, 10, 2000};
+
+        for (int i = 0; i < 3; i++) {
+
+            Eigen::Vector3d sample;
+
+            if (std::holds_alternative<CartStep>(step)) {
+
+                CartStep const& cart = std::get<CartStep>(step);
+                sample = Eigen::Vector3d(0.1 + 1.1*i + lonOffsets[i], lats[i], heights[i]);
+
+                if (cart.inverse) {
+                    geodeticToCartesian(cart.ellipsoid, sample.x(), sample.y(), sample.z(), sample.x(), sample.y(), sample.z());
+                }
+
+            } else {
+
+                TransverseMercatorStep const& tmerc = std::get<TransverseMercatorStep>(step);
+
+                //points close to the central meridian.
+                sample = Eigen::Vector3d(tmerc.projection.centralMeridian() + lonOffsets[i], lats[i], heights[i]);
+
+                if (tmerc.inverse) {
+                    tmerc.projection.forward(sample.x(), sample.y(), sample.x(), sample.y());
+                }
+            }
+
+            samples.push_back(prefix.inverse().A*sample + prefix.inverse().b);
+        }
+
+        break;
+    }
+
+    if (samples.empty()) {
+        samples = {Eigen::Vector3d(1, 2, 3),
+                   Eigen::Vector3d(10, 40, 500),
+                   Eigen::Vector3d(-7, -30, -50),
+                   Eigen::Vector3d(45, 8, 1000)};
+    }
+
+    for (Eigen::Vector3d const& sample : samples) {
+
+        Eigen::Vector3d expected = sample;
+
+        proj_trans_generic(transform, PJ_FWD,
+                           &expected.x(), 1, 1,
+                           &expected.y(), 1, 1,
+                           &expected.z(), 1, 1,
+                           nullptr, 0, 0);
+
+        StereoVision::IO::PtGeometry<double> transformed;
+        transformed.x = sample.x();
+        transformed.y = sample.y();
+        transformed.z = sample.z();
+
+        pipeline->apply(transformed);
+
+        Eigen::Vector3d obtained(transformed.x, transformed.y, transformed.z);
+
+        for (int i = 0; i < 3; i++) {
+            if (!std::isfinite(expected[i]) or !(std::abs(expected[i] - obtained[i]) <= 1e-7 + 1e-9*std::abs(expected[i]))) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    return pipeline;
+}
+
+bool NativeCrsPipeline::isAffine() const {
+    return _steps.size() == 1 and std::holds_alternative<AffineStep>(_steps.front());
+}
+
+StereoVision::Geometry::AffineTransform<double> NativeCrsPipeline::affine() const {
+
+    if (!isAffine()) {
+        return StereoVision::Geometry::AffineTransform<double>();
+    }
+
+    return std::get<AffineStep>(_steps.front()).transform;
+}
+
+void NativeCrsPipeline::apply(StereoVision::IO::PtGeometry<double> & position) const {
+
+    std::array<double, 3> v = {position.x, position.y, position.z};
+
+    std::array<std::array<double, MaxStackDepth>, 3> stack;
+    std::array<int, 3> depths = {0, 0, 0};
+
+    for (Step const& step : _steps) {
+
+        switch (step.index()) {
+        case 0: {
+            StereoVision::Geometry::AffineTransform<double> const& transform = std::get<AffineStep>(step).transform;
+            Eigen::Vector3d transformed = transform*Eigen::Vector3d(v[0], v[1], v[2]);
+            v = {transformed.x(), transformed.y(), transformed.z()};
+            break;
+        }
+        case 1: {
+            CartStep const& cart = std::get<CartStep>(step);
+
+            if (cart.inverse) {
+                cartesianToGeodetic(cart.ellipsoid, v[0], v[1], v[2], v[0], v[1], v[2]);
+            } else {
+                geodeticToCartesian(cart.ellipsoid, v[0], v[1], v[2], v[0], v[1], v[2]);
+            }
+            break;
+        }
+        case 2: {
+            TransverseMercatorStep const& tmerc = std::get<TransverseMercatorStep>(step);
+
+            if (tmerc.inverse) {
+                tmerc.projection.inverse(v[0], v[1], v[0], v[1]);
+            } else {
+                tmerc.projection.forward(v[0], v[1], v[0], v[1]);
+            }
+            break;
+        }
+        case 3: {
+            StackStep const& stackStep = std::get<StackStep>(step);
+
+            for (int i = 0; i < 3; i++) {
+
+                if (!stackStep.coordinates[i]) {
+                    continue;
+                }
+
+                if (stackStep.push) {
+                    stack[i][depths[i]++] = v[i];
+                } else {
+                    v[i] = stack[i][--depths[i]];
+                }
+            }
+            break;
+        }
+        }
+    }
+
+    position.x = v[0];
+    position.y = v[1];
+    position.z = v[2];
+}
@@ -0,0 +1,171 @@
+#ifndef NATIVECRSPIPELINE_H
+#define NATIVECRSPIPELINE_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <StereoVision/geometry/rotations.h>
+#include <StereoVision/io/pointcloud_io.h>
+
+struct pj_ctx;
+struct PJconsts;
+
+/*!
+ * \brief The NativeCrsPipeline class evaluate the most common PROJ pipelines without PROJ.
+ *
+ * The pipeline of a PROJ transform is parsed from its PROJ string, and each step is replaced by a built-in kernel:
+ * - the affine steps (noop, axisswap, unitconvert, affine, helmert without rates nor reference point), consecutive ones being composed in a single matrix;
+ * - cart, the conversion between geodetic (longitude, latitude, height) and geocentric (ECEF) coordinates;
+ * - tmerc, etmerc and utm, the transverse Mercator projection, with the 6th order Krüger series used by PROJ;
+ * - push and pop, to save and restore coordinates around other steps.
+ *
+ * As in PROJ, the angles are in radians between the steps, the pipelines converting from and to degrees with unitconvert steps.
+ * If a step is not supported, the pipeline cannot be built and PROJ has to be used.
+ */
+class NativeCrsPipeline
+{
+public:
+
+    struct Ellipsoid {
+        double a; //!< semi major axis
+        double f; //!< flattening
+
+        inline double b() const {
+            return a*(1 - f);
+        }
+
+        inline double es() const {
+            return f*(2 - f);
+        }
+    };
+
+    static constexpr Ellipsoid GRS80 = {6378137, 1/298.257222101};
+    static constexpr Ellipsoid WGS84 = {6378137, 1/298.257223563};
+
+    /*!
+     * \brief The TransverseMercator class implement the transverse Mercator projection with the Krüger series (to the 6th order in n),
+     * accurate to a few nanometers within 4000km of the central meridian.
+     */
+    class TransverseMercator {
+    public:
+
+        TransverseMercator(Ellipsoid const& ellipsoid,
+                           double lon0,
+                           double lat0,
+                           double k0,
+                           double x0,
+                           double y0);
+
+        /*!
+         * \brief forward project geodetic coordinates (in radians) to easting and northing.
+         */
+        void forward(double lon, double lat, double & x, double & y) const;
+
+        /*!
+         * \brief inverse get the geodetic coordinates (in radians) of an easting and northing.
+         */
+        void inverse(double x, double y, double & lon, double & lat) const;
+
+        inline double centralMeridian() const {
+            return _lon0;
+        }
+
+    protected:
+
+        double _e;
+        double _lon0;
+        double _k0A; //!< scale times rectifying radius
+        double _x0;
+        double _y0; //!< false northing, including the northing of the latitude of origin.
+
+        std::array<double, 6> _alpha;
+        std::array<double, 6> _beta;
+    };
+
+    /*!
+     * \brief geodeticToCartesian convert geodetic coordinates (longitude and latitude in radians, height in meters) to geocentric coordinates.
+     */
+    static void geodeticToCartesian(Ellipsoid const& ellipsoid, double lon, double lat, double h, double & x, double & y, double & z);
+
+    /*!
+     * \brief cartesianToGeodetic convert geocentric coordinates to geodetic coordinates (longitude and latitude in radians, height in meters),
+     * with the same closed form approximation (Bowring) as PROJ.
+     */
+    static void cartesianToGeodetic(Ellipsoid const& ellipsoid, double x, double y, double z, double & lon, double & lat, double & h);
+
+    /*!
+     * \brief parse build the pipeline corresponding to a PROJ string.
+     * \param projString the PROJ string, e.g. "+proj=pipeline +step +proj=axisswap +order=2,1 +step +proj=unitconvert +xy_in=deg +xy_out=rad +step +proj=utm +zone=32 +ellps=WGS84".
+     * \return the pipeline, or std::nullopt if one of the steps is not supported.
+     */
+    static std::optional<NativeCrsPipeline> parse(std::string const& projString);
+
+    /*!
+     * \brief fromProjTransform build the pipeline of a PROJ transform.
+     * \return the pipeline, or std::nullopt if the transform has no single pipeline, or one of the steps is not supported.
+     *
+     * The pipeline is checked against the transform on a few points.
+     */
+    static std::optional<NativeCrsPipeline> fromProjTransform(pj_ctx* projContext, PJconsts* transform);
+
+    /*!
+     * \brief isAffine indicate if the whole pipeline is a single affine transform.
+     */
+    bool isAffine() const;
+
+    /*!
+     * \brief affine get the affine transform of an affine pipeline.
+     */
+    StereoVision::Geometry::AffineTransform<double> affine() const;
+
+    void apply(StereoVision::IO::PtGeometry<double> & position) const;
+
+protected:
+
+    static constexpr int MaxStackDepth = 8;
+
+    struct AffineStep {
+        StereoVision::Geometry::AffineTransform<double> transform;
+    };
+
+    struct CartStep {
+        Ellipsoid ellipsoid;
+        bool inverse;
+    };
+
+    struct TransverseMercatorStep {
+        TransverseMercator projection;
+        bool inverse;
+    };
+
+    struct StackStep {
+        bool push;
+        std::array<bool, 3> coordinates;
+    };
+
+    using Step = std::variant<AffineStep, CartStep, TransverseMercatorStep, StackStep>;
+
+    std::vector<Step> _steps;
+};
+
+#endif // NATIVECRSPIPELINE_H
@@ -0,0 +1,214 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "outlierremover.h"
+
+#include "kdtree.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> OutlierRemover::setupOutlierRemover(
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
+        Parameters const& parameters) {
+
+    if (source == nullptr) {
+        return nullptr;
+    }
+
+    if (!std::isfinite(parameters.tileSize) or parameters.tileSize <= 0 or !std::isfinite(parameters.haloSize)) {
+        return nullptr;
+    }
+
+    if (parameters.method == Statistical and (parameters.nNeighbors <= 0 or !std::isfinite(parameters.sigma))) {
+        return nullptr;
+    }
+
+    if (parameters.method == Radius and (!std::isfinite(parameters.radius) or parameters.radius <= 0 or parameters.minNeighbors < 0)) {
+        return nullptr;
+    }
+
+    std::unique_ptr<OutlierRemover> processor(new OutlierRemover(std::move(source), parameters));
+
+    if (!processor->start()) {
+        return nullptr;
+    }
+
+    return processor;
+}
+
+std::optional<OutlierRemover::Method> OutlierRemover::parseMethod(std::string const& name) {
+
+    if (name == "statistical") {
+        return Statistical;
+    } else if (name == "radius") {
+        return Radius;
+    }
+
+    return std::nullopt;
+}
+
+namespace {
+
+double defaultHaloSize(OutlierRemover::Parameters const& parameters) {
+
+    if (parameters.haloSize > 0) {
+        return parameters.haloSize;
+    }
+
+    return (parameters.method == OutlierRemover::Radius) ? parameters.radius : parameters.tileSize/10;
+}
+
+}
+
+OutlierRemover::OutlierRemover(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source,
+                               Parameters const& parameters) :
+    TiledProcessor(std::move(source), "outliers", parameters.tileSize, defaultHaloSize(parameters)),
+    _parameters(parameters)
+{
+
+}
+
+void OutlierRemover::processTile(TileSpool::Tile const& tile,
+                                 std::vector<SpooledPoint> & points,
+                                 std::vector<SpooledPoint> const& halo,
+                                 bool parallel) const {
+
+    std::vector<std::array<double, 3>> corePositions(points.size());
+    std::vector<std::array<double, 3>> haloPositions(halo.size());
+
+    for (size_t i = 0; i < points.size(); i++) {
+        corePositions[i] = {points[i].xyz.x, points[i].xyz.y, points[i].xyz.z};
+    }
+
+    for (size_t i = 0; i < halo.size(); i++) {
+        haloPositions[i] = {halo[i].xyz.x, halo[i].xyz.y, halo[i].xyz.z};
+    }
+
+    std::vector<bool> kept = filterTile(corePositions, haloPositions, parallel);
+
+    size_t nKept = 0;
+
+    for (size_t i = 0; i < points.size(); i++) {
+        if (!kept[i]) {
+            continue;
+        }
+
+        if (nKept != i) {
+            points[nKept] = std::move(points[i]);
+        }
+
+        nKept++;
+    }
+
+    points.resize(nKept);
+}
+
+std::vector<bool> OutlierRemover::filterTile(std::vector<std::array<double, 3>> const& core,
+                                             std::vector<std::array<double, 3>> const& halo,
+                                             bool parallel) const {
+
+    int64_t nCore = core.size();
+
+    std::vector<std::array<double, 3>> positions;
+    positions.reserve(core.size() + halo.size());
+    positions.insert(positions.end(), core.begin(), core.end());
+    positions.insert(positions.end(), halo.begin(), halo.end());
+
+    KdTree tree(positions);
+
+    //vector<bool> cannot be written concurrently.
+    std::vector<char> kept(nCore, 1);
+
+    if (_parameters.method == Radius) {
+
+        double radius = _parameters.radius;
+        int64_t minNeighbors = _parameters.minNeighbors;
+
+        #pragma omp parallel for schedule(static) if(parallel)
+        for (int64_t i = 0; i < nCore; i++) {
+            kept[i] = tree.countInRadius(core[i].data(), radius, minNeighbors, i) >= minNeighbors;
+        }
+
+    } else {
+
+        //the mean distances of the halo points are computed too, so that the statistics do not depend on the number of points in the tile
+        //(a tile with a single isolated point is compared to the points around it).
+        int64_t nPositions = positions.size();
+
+        std::vector<double> meanDistances(nPositions);
+        int k = _parameters.nNeighbors;
+
+        #pragma omp parallel if(parallel)
+        {
+            std::vector<KdTree::Neighbor> neighbors;
+
+            #pragma omp for schedule(static)
+            for (int64_t i = 0; i < nPositions; i++) {
+
+                tree.nearestNeighbors(positions[i].data(), k, neighbors, i);
+
+                //without k neighbors in the tile and its halo, the point is isolated.
+                if (neighbors.size() < k) {
+                    meanDistances[i] = std::numeric_limits<double>::infinity();
+                    continue;
+                }
+
+                double sum = 0;
+
+                for (KdTree::Neighbor const& neighbor : neighbors) {
+                    sum += std::sqrt(neighbor.squaredDistance);
+                }
+
+                meanDistances[i] = sum/neighbors.size();
+            }
+        }
+
+        double sum = 0;
+        double sumSquared = 0;
+        int64_t count = 0;
+
+        for (double distance : meanDistances) {
+            if (std::isfinite(distance)) {
+                sum += distance;
+                sumSquared += distance*distance;
+                count++;
+            }
+        }
+
+        double threshold = std::numeric_limits<double>::infinity();
+
+        if (count > 1) {
+            double mean = sum/count;
+            double variance = std::max(0.0, (sumSquared - count*mean*mean)/(count - 1));
+            threshold = mean + _parameters.sigma*std::sqrt(variance);
+        }
+
+        for (int64_t i = 0; i < nCore; i++) {
+            //isolated points, without k neighbors, are always removed.
+            kept[i] = std::isfinite(meanDistances[i]) and meanDistances[i] <= threshold;
+        }
+    }
+
+    return std::vector<bool>(kept.begin(), kept.end());
+}
@@ -0,0 +1,99 @@
+#ifndef OUTLIERREMOVER_H
+#define OUTLIERREMOVER_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "tiledprocessor.h"
+
+/*!
+ * \brief The OutlierRemover class remove isolated points (e.g. birds or multipath noise).
+ *
+ * Two criteria are available:
+ * - Statistical: the mean distance of each point to its k nearest neighbors is computed,
+ *   and the points whose mean distance is above the mean plus sigma standard deviations (over the tile and its halo) are removed,
+ *   as well as the points with less than k neighbors in their tile and its halo.
+ * - Radius: the points with less than a given number of neighbors within a radius are removed.
+ *
+ * The points are processed in tiles (see TiledProcessor), the halo of the tiles ensuring that the neighborhoods of the points
+ * near the border of a tile are complete. A kd-tree is built for each tile, with the points of the tile and of its halo.
+ */
+class OutlierRemover : public TiledProcessor
+{
+public:
+
+    enum Method {
+        Statistical = 0,
+        Radius = 1
+    };
+
+    struct Parameters {
+        Method method = Statistical;
+        int nNeighbors = 8; //!< the number of neighbors for the statistical method.
+        double sigma = 2; //!< the number of standard deviations above the mean distance a point is considered an outlier.
+        double radius = 1; //!< the search radius for the radius method.
+        int minNeighbors = 2; //!< the minimal number of neighbors in the radius of a point for it to be kept.
+        double tileSize = 100; //!< the size of the tiles, in the units of the point cloud.
+        double haloSize = -1; //!< the size of the tiles halo, if 0 or less the radius is used for the radius method, and a tenth of the tile size for the statistical method.
+    };
+
+    /*!
+     * \brief setupOutlierRemover setup an outlier removal
+     * \param source a pointer to the source, will be moved to the output if return is not nullptr
+     * \param parameters the parameters of the outlier removal.
+     * \return a unique ptr to a PointCloudPointAccessInterface, or nullptr in case of error
+     */
+    static std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> setupOutlierRemover(
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
+            Parameters const& parameters);
+
+    /*!
+     * \brief parseMethod parse the name of a method, either "statistical" or "radius".
+     */
+    static std::optional<Method> parseMethod(std::string const& name);
+
+protected:
+
+    OutlierRemover(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source,
+                   Parameters const& parameters);
+
+    virtual void processTile(TileSpool::Tile const& tile,
+                             std::vector<SpooledPoint> & points,
+                             std::vector<SpooledPoint> const& halo,
+                             bool parallel) const override;
+
+    /*!
+     * \brief filterTile compute which core points of a tile are kept.
+     * \param core the positions of the points of the tile.
+     * \param halo the positions of the points in the halo of the tile.
+     * \param parallel if true, the neighborhoods are computed with multiple threads.
+     * \return a flag per core point, true if the point is kept.
+     */
+    std::vector<bool> filterTile(std::vector<std::array<double, 3>> const& core,
+                                 std::vector<std::array<double, 3>> const& halo,
+                                 bool parallel) const;
+
+    Parameters _parameters;
+};
+
+#endif // OUTLIERREMOVER_H
@@ -0,0 +1,612 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pointsorter.h"
+
+#include "spatialkeys.h"
+
+#include "../io/partitionspool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+constexpr uint64_t noKey = std::numeric_limits<uint64_t>::max();
+
+//the quantized positions are offset, so that the first point is at the center of the range of the keys.
+constexpr int64_t centerCell = int64_t(1) << 20;
+constexpr int64_t maxCell = 2*centerCell - 1;
+
+constexpr size_t writeBufferSize = 1 << 20;
+
+//approximate memory needed by each run during a merge (the read buffer of the spool reader).
+constexpr size_t mergedRunMemory = 1 << 20;
+
+//smallest number of points worth sorting in a separate chunk.
+constexpr int64_t minChunkSize = 1 << 14;
+
+/*!
+ * \brief orderedBits map a double to an unsigned integer with the same order, nan is mapped to the largest value.
+ */
+inline uint64_t orderedBits(double value) {
+
+    if (std::isnan(value)) {
+        return noKey;
+    }
+
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(double));
+
+    constexpr uint64_t signBit = uint64_t(1) << 63;
+
+    return (bits & signBit) ? ~bits : bits | signBit;
+}
+
+bool writeBuffer(std::ofstream & file, std::string & buffer) {
+    file.write(buffer.data(), buffer.size());
+    buffer.clear();
+    return bool(file);
+}
+
+}
+
+std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> PointSorter::setupPointSorter(
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
+        Order order,
+        size_t memoryLimit,
+        double cellSize) {
+
+    if (source == nullptr) {
+        return nullptr;
+    }
+
+    if (memoryLimit == 0 or !std::isfinite(cellSize) or cellSize <= 0) {
+        return nullptr;
+    }
+
+    if (order == GpsTime) {
+
+        std::vector<std::string> attributes = source->attributeList();
+
+        if (std::find(attributes.begin(), attributes.end(), "gpsTime") == attributes.end()) {
+            return nullptr;
+        }
+    }
+
+    std::unique_ptr<PointSorter> sorter(new PointSorter(std::move(source), order, memoryLimit, cellSize));
+
+    //the points are read and sorted during the setup, so that a failure (e.g. a full disk) is reported as an error instead of a truncated output.
+    if (!sorter->sortRuns()) {
+        std::cerr << "Could not sort the points, the sorted runs could not be written to " << sorter->_spoolDir << "!" << std::endl;
+        return nullptr;
+    }
+
+    return sorter;
+}
+
+std::optional<PointSorter::Order> PointSorter::parseOrder(std::string const& name) {
+
+    if (name == "morton") {
+        return Morton;
+    } else if (name == "hilbert") {
+        return Hilbert;
+    } else if (name == "gpstime") {
+        return GpsTime;
+    }
+
+    return std::nullopt;
+}
+
+PointSorter::PointSorter(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source,
+                         Order order,
+                         size_t memoryLimit,
+                         double cellSize) :
+    _src(std::move(source)),
+    _order(order),
+    _runSize(std::max<size_t>(1, memoryLimit/2)),
+    _maxMergedRuns(std::clamp<size_t>(memoryLimit/mergedRunMemory, 2, MaxMergedRuns)),
+    _cellSize(cellSize),
+    _origin({0, 0, 0}),
+    _nClamped(0),
+    _gpsTimeIdx(-1),
+    _nRuns(0),
+    _currentIdx(0)
+{
+    _schema = _src->attributeList();
+
+    for (int i = 0; i < _schema.size(); i++) {
+        _schemaIdxs[_schema[i]] = i;
+    }
+
+    auto it = _schemaIdxs.find("gpsTime");
+
+    if (it != _schemaIdxs.end()) {
+        _gpsTimeIdx = it->second;
+    }
+
+    if (_src->hasData()) {
+
+        StereoVision::IO::PtGeometry<double> pos = _src->castedPointGeometry<double>();
+        std::array<double, 3> position = {pos.x, pos.y, pos.z};
+
+        for (int c = 0; c < 3; c++) {
+            if (std::isfinite(position[c])) {
+                _origin[c] = std::floor(position[c]/_cellSize)*_cellSize;
+            }
+        }
+    }
+}
+
+PointSorter::~PointSorter() {
+
+    //the readers remove their runs, the directory is removed afterward.
+    _merge.runs.clear();
+
+    if (!_spoolDir.empty()) {
+        std::error_code ec;
+        std::filesystem::remove_all(_spoolDir, ec);
+    }
+}
+
+uint64_t PointSorter::key(SpooledPoint const& point) const {
+    bool clamped;
+    return key(point, clamped);
+}
+
+uint64_t PointSorter::key(SpooledPoint const& point, bool & clamped) const {
+
+    clamped = false;
+
+    if (_order == GpsTime) {
+
+        if (_gpsTimeIdx < 0 or !point.attributes[_gpsTimeIdx].has_value()) {
+            return noKey;
+        }
+
+        double time = std::visit([] (auto const& val) -> double {
+
+            using T = std::decay_t<decltype(val)>;
+
+            if constexpr (std::is_arithmetic_v<T>) {
+                return static_cast<double>(val);
+            } else {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+
+        }, point.attributes[_gpsTimeIdx].value());
+
+        return orderedBits(time);
+    }
+
+    constexpr double limit = 9e18;
+
+    std::array<double, 3> position = {point.xyz.x, point.xyz.y, point.xyz.z};
+    std::array<uint64_t, 3> cell;
+
+    for (int c = 0; c < 3; c++) {
+
+        double v = std::floor((position[c] - _origin[c])/_cellSize);
+
+        if (!(std::abs(v) < limit)) {
+            return noKey;
+        }
+
+        int64_t idx = static_cast<int64_t>(v) + centerCell;
+
+        //the cells out of the range of the keys are clamped on its border, instead of wrapping around.
+        if (idx < 0 or idx > maxCell) {
+            idx = std::clamp<int64_t>(idx, 0, maxCell);
+            clamped = true;
+        }
+
+        cell[c] = static_cast<uint64_t>(idx);
+    }
+
+    if (_order == Hilbert) {
+        return SpatialKeys::hilbert3d(cell[0], cell[1], cell[2]);
+    }
+
+    return SpatialKeys::morton3d(cell[0], cell[1], cell[2]);
+}
+
+bool PointSorter::readRun(std::vector<SpooledPoint> & run) {
+
+    run.clear();
+
+    //the point, its key and its index in the order.
+    constexpr size_t overhead = sizeof(std::pair<uint64_t, size_t>) + sizeof(size_t);
+
+    size_t size = 0;
+    bool hasMore = _src->hasData();
+
+    while (hasMore and size < _runSize) {
+
+        run.push_back(SpooledPoint::fromInterface(*_src, _schema));
+        size += run.back().approximateSize() + overhead;
+
+        hasMore = _src->gotoNext();
+    }
+
+    return hasMore;
+}
+
+void PointSorter::fitGrid(std::vector<SpooledPoint> const& run) {
+
+    if (_order == GpsTime) {
+        return;
+    }
+
+    //largest distance to the origin, in cells of the requested size.
+    double extent = 0;
+
+    for (SpooledPoint const& point : run) {
+
+        std::array<double, 3> position = {point.xyz.x, point.xyz.y, point.xyz.z};
+
+        for (int c = 0; c < 3; c++) {
+            if (std::isfinite(position[c])) {
+                extent = std::max(extent, std::abs(position[c] - _origin[c])/_cellSize);
+            }
+        }
+    }
+
+    //the cells are doubled, so that the grid stays aligned with the requested one, until the points of the run fit in the range of the keys.
+    double factor = 1;
+
+    while (extent/factor >= centerCell - 1 and std::isfinite(factor*_cellSize)) {
+        factor *= 2;
+    }
+
+    if (factor > 1) {
+
+        _cellSize *= factor;
+
+        for (int c = 0; c < 3; c++) {
+            _origin[c] = std::floor(_origin[c]/_cellSize)*_cellSize;
+        }
+
+        std::cerr << "Warning: the points span more than 2^21 sort cells per axis, the sort cell size has been enlarged to " << _cellSize << "!" << std::endl;
+    }
+}
+
+std::vector<size_t> PointSorter::sortRun(std::vector<SpooledPoint> const& run) const {
+
+    int64_t nPoints = run.size();
+
+    //the index of the point is part of the key, so that the sort is stable.
+    std::vector<std::pair<uint64_t, size_t>> keys(nPoints);
+
+    int64_t nClamped = 0;
+
+    #pragma omp parallel for schedule(static) reduction(+:nClamped)
+    for (int64_t i = 0; i < nPoints; i++) {
+        bool clamped;
+        keys[i] = std::make_pair(key(run[i], clamped), size_t(i));
+        nClamped += clamped ? 1 : 0;
+    }
+
+    _nClamped += nClamped;
+
+    int nChunks = 1;
+
+    #ifdef _OPENMP
+    nChunks = omp_get_max_threads();
+    #endif
+
+    nChunks = std::max<int64_t>(1, std::min<int64_t>(nChunks, nPoints/minChunkSize));
+
+    std::vector<int64_t> bounds(nChunks+1);
+
+    for (int c = 0; c <= nChunks; c++) {
+        bounds[c] = nPoints*c/nChunks;
+    }
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < nChunks; c++) {
+        std::sort(keys.begin() + bounds[c], keys.begin() + bounds[c+1]);
+    }
+
+    //merge the sorted chunks pairwise.
+    for (int stride = 1; stride < nChunks; stride *= 2) {
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int c = 0; c < nChunks - stride; c += 2*stride) {
+            int end = std::min(c + 2*stride, nChunks);
+            std::inplace_merge(keys.begin() + bounds[c], keys.begin() + bounds[c+stride], keys.begin() + bounds[end]);
+        }
+    }
+
+    std::vector<size_t> order(nPoints);
+
+    for (int64_t i = 0; i < nPoints; i++) {
+        order[i] = keys[i].second;
+    }
+
+    return order;
+}
+
+bool PointSorter::spillRun(std::vector<SpooledPoint> const& run, std::filesystem::path const& path) const {
+
+    std::vector<size_t> order = sortRun(run);
+
+    std::ofstream file(path, std::ios_base::binary | std::ios_base::out);
+
+    if (!file.is_open()) {
+        std::cerr << "Could not open spool file " << path << "!" << std::endl;
+        return false;
+    }
+
+    std::string buffer;
+    buffer.reserve(writeBufferSize);
+
+    for (size_t idx : order) {
+
+        PointSpool::appendRecord(buffer, run[idx]);
+
+        if (buffer.size() >= writeBufferSize and !writeBuffer(file, buffer)) {
+            return false;
+        }
+    }
+
+    return writeBuffer(file, buffer);
+}
+
+bool PointSorter::sortRuns() {
+
+    std::vector<SpooledPoint> current;
+    std::vector<SpooledPoint> next;
+
+    bool hasMore = readRun(current);
+
+    fitGrid(current);
+
+    //the whole point cloud fits in a single run, no need to go through the disk.
+    if (!hasMore) {
+
+        std::vector<size_t> order = sortRun(current);
+        _points.reserve(order.size());
+
+        for (size_t idx : order) {
+            _points.push_back(std::move(current[idx]));
+        }
+
+        return true;
+    }
+
+    _spoolDir = PartitionSpool::temporarySpoolDir("sort");
+
+    std::error_code ec;
+    std::filesystem::create_directories(_spoolDir, ec);
+
+    if (ec) {
+        std::cerr << "Could not create spool directory " << _spoolDir << "!" << std::endl;
+        return false;
+    }
+
+    std::vector<std::filesystem::path> runs;
+
+    auto spill = [this] (std::vector<SpooledPoint> const& run, std::filesystem::path const& path) {
+        return spillRun(run, path);
+    };
+
+    //the next run is read while the current one is sorted and spilled.
+    while (!current.empty()) {
+
+        runs.push_back(_spoolDir / ("run_" + std::to_string(runs.size()) + ".spool"));
+
+        std::future<bool> spilling = std::async(std::launch::async, spill, std::cref(current), runs.back());
+
+        next.clear();
+
+        if (hasMore) {
+            hasMore = readRun(next);
+        }
+
+        if (!spilling.get()) {
+            return false;
+        }
+
+        std::swap(current, next);
+    }
+
+    current = std::vector<SpooledPoint>();
+    next = std::vector<SpooledPoint>();
+
+    _nRuns = runs.size();
+
+    //the grid is fitted on the first run, the points of the next runs can be out of its range.
+    if (_nClamped > 0) {
+        std::cerr << "Warning: " << _nClamped << " points are out of the range of the sort keys, they have been sorted on the border of the grid (use a larger --sort-cell)!" << std::endl;
+    }
+
+    //consecutive runs are merged, so that the sort stays stable, until they are few enough to be merged at once.
+    for (int pass = 0; runs.size() > _maxMergedRuns; pass++) {
+
+        std::vector<std::filesystem::path> merged;
+
+        for (size_t first = 0; first < runs.size(); first += _maxMergedRuns) {
+
+            size_t last = std::min(runs.size(), first + _maxMergedRuns);
+
+            if (last - first == 1) {
+                merged.push_back(runs[first]);
+                continue;
+            }
+
+            std::vector<std::filesystem::path> group(runs.begin() + first, runs.begin() + last);
+            merged.push_back(_spoolDir / ("merge_" + std::to_string(pass) + "_" + std::to_string(merged.size()) + ".spool"));
+
+            Merge merge;
+
+            if (!openMerge(merge, group)) {
+                return false;
+            }
+
+            std::ofstream file(merged.back(), std::ios_base::binary | std::ios_base::out);
+
+            if (!file.is_open()) {
+                std::cerr << "Could not open spool file " << merged.back() << "!" << std::endl;
+                return false;
+            }
+
+            std::string buffer;
+            buffer.reserve(writeBufferSize);
+
+            while (merge.hasData()) {
+
+                PointSpool::appendRecord(buffer, merge.current());
+
+                if (buffer.size() >= writeBufferSize and !writeBuffer(file, buffer)) {
+                    return false;
+                }
+
+                advanceMerge(merge);
+            }
+
+            if (!writeBuffer(file, buffer)) {
+                return false;
+            }
+        }
+
+        runs = std::move(merged);
+    }
+
+    return openMerge(_merge, runs);
+}
+
+bool PointSorter::openMerge(Merge & merge, std::vector<std::filesystem::path> const& runs) const {
+
+    merge.runs.clear();
+    merge.heap.clear();
+
+    for (std::filesystem::path const& path : runs) {
+
+        merge.runs.push_back(std::make_unique<PointSpoolReader>(path, _schema, true));
+
+        if (merge.runs.back()->hasData()) {
+            merge.heap.emplace_back(key(merge.runs.back()->currentPoint()), merge.runs.size()-1);
+        }
+    }
+
+    std::make_heap(merge.heap.begin(), merge.heap.end(), std::greater<>());
+
+    return true;
+}
+
+void PointSorter::advanceMerge(Merge & merge) const {
+
+    if (merge.heap.empty()) {
+        return;
+    }
+
+    std::pop_heap(merge.heap.begin(), merge.heap.end(), std::greater<>());
+    size_t run = merge.heap.back().second;
+    merge.heap.pop_back();
+
+    if (!merge.runs[run]->gotoNext()) {
+        //the run is done, its spool file is removed.
+        merge.runs[run].reset();
+        return;
+    }
+
+    merge.heap.emplace_back(key(merge.runs[run]->currentPoint()), run);
+    std::push_heap(merge.heap.begin(), merge.heap.end(), std::greater<>());
+}
+
+SpooledPoint const& PointSorter::current() const {
+
+    if (_nRuns > 0) {
+        return _merge.current();
+    }
+
+    return _points[_currentIdx];
+}
+
+StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> PointSorter::getPointPosition() const {
+    StereoVision::IO::PtGeometry<double> const& pos = current().xyz;
+    return StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute>{pos.x, pos.y, pos.z};
+}
+
+std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> PointSorter::getPointColor() const {
+    return current().rgba;
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> PointSorter::getAttributeById(int id) const {
+
+    if (id < 0 or id >= _schema.size()) {
+        return std::nullopt;
+    }
+
+    return current().attributes[id];
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> PointSorter::getAttributeByName(const char* attributeName) const {
+
+    auto it = _schemaIdxs.find(attributeName);
+
+    if (it == _schemaIdxs.end()) {
+        return std::nullopt;
+    }
+
+    return getAttributeById(it->second);
+}
+
+std::vector<std::string> PointSorter::attributeList() const {
+    return _schema;
+}
+
+bool PointSorter::gotoNext() {
+
+    if (_nRuns > 0) {
+
+        if (!_merge.hasData()) {
+            return false;
+        }
+
+        advanceMerge(_merge);
+        return _merge.hasData();
+    }
+
+    if (_currentIdx >= _points.size()) {
+        return false;
+    }
+
+    _currentIdx++;
+
+    return _currentIdx < _points.size();
+}
+
+bool PointSorter::hasData() const {
+
+    if (_nRuns > 0) {
+        return _merge.hasData();
+    }
+
+    return _currentIdx < _points.size();
+}
@@ -0,0 +1,192 @@
+#ifndef POINTSORTER_H
+#define POINTSORTER_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+#include "../io/pointspool.h"
+
+/*!
+ * \brief The PointSorter class reorder the points of a point cloud, along a space filling curve or by gps time.
+ *
+ * The spatial orders quantize the positions on a grid of cells (centered on the first point, with 21 bits per axis)
+ * and sort the cells by their morton or hilbert index. The cells are enlarged (by powers of two) until the first run fits in the 2^21 cells per axis,
+ * the points of the next runs which are still out of range are clamped on the border of the grid (with a warning) rather than wrapping around.
+ * The points without a key (non finite position or missing gps time) are put at the end. The sort is stable,
+ * so the points with the same key stay in their original order.
+ *
+ * The points are read in runs filling half of the memory limit, each run is sorted in memory in parallel while the next one is read.
+ * If the whole point cloud fits in a single run, it is output directly, else the sorted runs are spilled to disk and merged.
+ * The number of runs merged at the same time is bounded (each one needs a read buffer), so very large inputs are merged in multiple passes.
+ */
+class PointSorter : public StereoVision::IO::PointCloudPointAccessInterface
+{
+public:
+
+    enum Order {
+        Morton = 0,
+        Hilbert = 1,
+        GpsTime = 2
+    };
+
+    static constexpr size_t DefaultMemoryLimit = size_t(1) << 30;
+    static constexpr double DefaultCellSize = 0.1;
+    static constexpr int MaxMergedRuns = 64;
+
+    /*!
+     * \brief setupPointSorter setup a sort of the points
+     * \param source a pointer to the source, will be moved to the output if return is not nullptr (or consumed if the sort failed)
+     * \param order the order of the output points.
+     * \param memoryLimit the approximative memory the sort can use, in bytes.
+     * \param cellSize the size of the cells the positions are quantized on for the spatial orders, in the units of the point cloud.
+     * \return a unique ptr to a PointCloudPointAccessInterface, or nullptr in case of error
+     */
+    static std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> setupPointSorter(
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
+            Order order,
+            size_t memoryLimit = DefaultMemoryLimit,
+            double cellSize = DefaultCellSize);
+
+    /*!
+     * \brief parseOrder parse the name of an order, either "morton", "hilbert" or "gpstime".
+     */
+    static std::optional<Order> parseOrder(std::string const& name);
+
+    ~PointSorter();
+
+    virtual StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> getPointPosition() const override;
+    virtual std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> getPointColor() const override;
+
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeById(int id) const override;
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeByName(const char* attributeName) const override;
+
+    virtual std::vector<std::string> attributeList() const override;
+
+    virtual bool gotoNext() override;
+    virtual bool hasData() const override;
+
+    /*!
+     * \brief numberOfRuns the number of sorted runs spilled to disk, 0 if the points have been sorted in memory.
+     */
+    inline int numberOfRuns() const {
+        return _nRuns;
+    }
+
+    /*!
+     * \brief key compute the sort key of a point.
+     */
+    uint64_t key(SpooledPoint const& point) const;
+
+    /*!
+     * \brief cellSize the size of the cells of the spatial orders, which can be larger than the requested one.
+     */
+    inline double cellSize() const {
+        return _cellSize;
+    }
+
+protected:
+
+    PointSorter(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source,
+                Order order,
+                size_t memoryLimit,
+                double cellSize);
+
+    /*!
+     * \brief The Merge struct hold the state of a k-way merge of sorted runs.
+     *
+     * The heap contains the key of the current point of each run which has points left (and the index of the run, to keep the merge stable).
+     * The current point of the merge is the current point of the run on top of the heap.
+     */
+    struct Merge {
+        std::vector<std::unique_ptr<PointSpoolReader>> runs;
+        std::vector<std::pair<uint64_t, size_t>> heap;
+
+        inline bool hasData() const {
+            return !heap.empty();
+        }
+
+        inline SpooledPoint const& current() const {
+            return runs[heap.front().second]->currentPoint();
+        }
+    };
+
+    /*!
+     * \brief readRun read the points of a run, until its approximate size reach the run size.
+     * \return true if the source has more points, false otherwise.
+     */
+    bool readRun(std::vector<SpooledPoint> & run);
+
+    /*!
+     * \brief fitGrid enlarge the cells of the spatial orders until the points of the run fit in the range of the keys.
+     */
+    void fitGrid(std::vector<SpooledPoint> const& run);
+
+    uint64_t key(SpooledPoint const& point, bool & clamped) const;
+
+    /*!
+     * \brief sortRun get the order of the points of a run.
+     */
+    std::vector<size_t> sortRun(std::vector<SpooledPoint> const& run) const;
+
+    bool spillRun(std::vector<SpooledPoint> const& run, std::filesystem::path const& path) const;
+
+    bool sortRuns();
+
+    bool openMerge(Merge & merge, std::vector<std::filesystem::path> const& runs) const;
+    void advanceMerge(Merge & merge) const;
+
+    SpooledPoint const& current() const;
+
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> _src;
+
+    Order _order;
+    size_t _runSize;
+    int _maxMergedRuns;
+
+    double _cellSize;
+    std::array<double, 3> _origin;
+    mutable std::atomic<int64_t> _nClamped;
+    int _gpsTimeIdx;
+
+    std::vector<std::string> _schema;
+    std::map<std::string, int> _schemaIdxs;
+
+    std::filesystem::path _spoolDir;
+    int _nRuns;
+
+    //points sorted in memory.
+    std::vector<SpooledPoint> _points;
+    size_t _currentIdx;
+
+    //merge of the runs spilled on disk.
+    Merge _merge;
+};
+
+#endif // POINTSORTER_H
@@ -0,0 +1,318 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "progresscounter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include <unistd.h>
+
+namespace {
+
+void writeAll(int fd, std::string const& data) {
+
+    size_t written = 0;
+
+    while (written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n <= 0) {
+            return;
+        }
+        written += n;
+    }
+}
+
+std::string formatDuration(double seconds) {
+
+    long long s = seconds;
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%02lld:%02lld:%02lld", s/3600, (s/60)%60, s%60);
+    return buffer;
+}
+
+}
+
+ProgressCounter::ProgressCounter(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source) :
+    IdentityProcessor(std::move(source)),
+    _nPoints(0)
+{
+    if (_src->hasData()) {
+        _nPoints.store(1, std::memory_order_relaxed);
+    }
+}
+
+bool ProgressCounter::gotoNext() {
+
+    bool ok = _src->gotoNext();
+
+    if (ok) {
+        //only this thread write the counter, no need for an atomic read-modify-write.
+        _nPoints.store(_nPoints.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    return ok;
+}
+
+ProgressReporter::ProgressReporter(ProgressCounter const* counter,
+                                   int64_t expectedNumberOfPoints,
+                                   int64_t expectedNumberOfBytes,
+                                   bool printOnTerminal,
+                                   int ndjsonFd,
+                                   std::ostream & terminal) :
+    _counter(counter),
+    _expectedPoints(expectedNumberOfPoints),
+    _expectedBytes(expectedNumberOfBytes),
+    _printOnTerminal(printOnTerminal),
+    _ndjsonFd(ndjsonFd),
+    _terminal(terminal),
+    _initialBytes(bytesReadByProcess()),
+    _start(std::chrono::steady_clock::now()),
+    _running(false),
+    _finished(false)
+{
+
+}
+
+ProgressReporter::~ProgressReporter() {
+    finish(false);
+}
+
+void ProgressReporter::start() {
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_running or _finished) {
+        return;
+    }
+
+    _running = true;
+
+    if (_ndjsonFd >= 0) {
+        writeEvent("start", currentStatus());
+    }
+
+    _thread = std::thread(&ProgressReporter::run, this);
+}
+
+void ProgressReporter::finish(bool success) {
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_finished) {
+            return;
+        }
+
+        _finished = true;
+        _running = false;
+    }
+
+    _stopCondition.notify_all();
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+
+    Status status = currentStatus();
+
+    if (success) {
+        status.fraction = 1;
+        status.eta = 0;
+    }
+
+    if (_printOnTerminal) {
+        printStatus(status, true);
+    }
+
+    if (_ndjsonFd >= 0) {
+        writeEvent("end", status, std::string(",\"status\":\"") + (success ? "ok" : "error") + "\"");
+    }
+}
+
+int64_t ProgressReporter::bytesReadByProcess() {
+
+    std::ifstream procIo("/proc/self/io");
+
+    if (!procIo.is_open()) {
+        return -1;
+    }
+
+    std::string key;
+    int64_t val;
+
+    while (procIo >> key >> val) {
+        if (key == "rchar:") {
+            return val;
+        }
+    }
+
+    return -1;
+}
+
+ProgressReporter::Status ProgressReporter::currentStatus() const {
+
+    Status ret;
+
+    ret.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+    ret.points = (_counter != nullptr) ? _counter->processedPoints() : 0;
+
+    int64_t bytes = bytesReadByProcess();
+    ret.bytes = (bytes >= 0 and _initialBytes >= 0) ? bytes - _initialBytes : -1;
+
+    ret.fraction = -1;
+
+    if (_expectedPoints > 0) {
+        ret.fraction = double(ret.points)/_expectedPoints;
+    } else if (_expectedBytes > 0 and ret.bytes >= 0) {
+        ret.fraction = double(ret.bytes)/_expectedBytes;
+    }
+
+    if (ret.fraction >= 0) {
+        ret.fraction = std::clamp(ret.fraction, 0., 1.);
+    }
+
+    ret.pointsPerSecond = (ret.elapsed > 0) ? ret.points/ret.elapsed : 0;
+    ret.bytesPerSecond = (ret.elapsed > 0 and ret.bytes >= 0) ? ret.bytes/ret.elapsed : -1;
+
+    ret.eta = -1;
+
+    if (ret.fraction > 0) {
+        ret.eta = ret.elapsed*(1 - ret.fraction)/ret.fraction;
+    }
+
+    return ret;
+}
+
+void ProgressReporter::printStatus(Status const& status, bool last) const {
+
+    #ifdef CONTAINER_EXTRAS
+    const char lineStartSymbol = '\n';
+    #else
+    const char lineStartSymbol = '\r';
+    #endif
+
+    std::ostringstream line;
+    line.setf(std::ios_base::fixed);
+    line.precision(1);
+
+    line << lineStartSymbol << "Processed " << status.points;
+
+    if (_expectedPoints > 0) {
+        line << "/" << _expectedPoints;
+    }
+
+    line << " points";
+
+    if (status.fraction >= 0) {
+        line << " (" << 100*status.fraction << "%)";
+    }
+
+    line << ", " << status.pointsPerSecond/1e6 << " Mpts/s";
+
+    if (status.bytesPerSecond >= 0) {
+        line << ", " << status.bytesPerSecond/(1 << 20) << " MiB/s";
+    }
+
+    if (last) {
+        line << ", done in " << formatDuration(status.elapsed) << "   \n";
+    } else if (status.eta >= 0) {
+        line << ", ETA " << formatDuration(status.eta) << "   ";
+    }
+
+    _terminal << line.str();
+    _terminal.flush();
+}
+
+void ProgressReporter::writeEvent(std::string const& event, Status const& status, std::string const& extra) const {
+
+    //the doubles are written with all their significant digits, the counts as integers.
+    constexpr int doublePrecision = std::numeric_limits<double>::max_digits10;
+
+    auto number = [] (double val) -> std::string {
+        std::ostringstream strm;
+        strm.precision(doublePrecision);
+        strm << val;
+        return strm.str();
+    };
+
+    auto optNumber = [&number] (double val) -> std::string {
+        if (val < 0) {
+            return "null";
+        }
+        return number(val);
+    };
+
+    auto optInteger = [] (int64_t val) -> std::string {
+        if (val < 0) {
+            return "null";
+        }
+        return std::to_string(val);
+    };
+
+    std::ostringstream line;
+
+    line << "{\"event\":\"" << event << "\""
+         << ",\"elapsed_s\":" << number(status.elapsed)
+         << ",\"points\":" << status.points
+         << ",\"bytes\":" << optInteger(status.bytes)
+         << ",\"total_points\":" << optInteger(_expectedPoints)
+         << ",\"total_bytes\":" << optInteger(_expectedBytes)
+         << ",\"fraction\":" << optNumber(status.fraction)
+         << ",\"points_per_s\":" << number(status.pointsPerSecond)
+         << ",\"bytes_per_s\":" << optNumber(status.bytesPerSecond)
+         << ",\"eta_s\":" << optNumber(status.eta)
+         << extra << "}\n";
+
+    writeAll(_ndjsonFd, line.str());
+}
+
+void ProgressReporter::run() {
+
+    using namespace std::chrono_literals;
+
+    constexpr int ticksPerEvent = 10;
+
+    int tick = 0;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (_running) {
+
+        _stopCondition.wait_for(lock, 100ms);
+
+        if (!_running) {
+            break;
+        }
+
+        Status status = currentStatus();
+
+        if (_printOnTerminal) {
+            printStatus(status, false);
+        }
+
+        tick++;
+
+        if (_ndjsonFd >= 0 and tick % ticksPerEvent == 0) {
+            writeEvent("progress", status);
+        }
+    }
+}
@@ -0,0 +1,134 @@
+#ifndef PROGRESSCOUNTER_H
+#define PROGRESSCOUNTER_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+#include "./identityprocessor.h"
+
+/*!
+ * \brief The ProgressCounter class count the points read from its source, the count can be read from any thread.
+ */
+class ProgressCounter : public IdentityProcessor
+{
+public:
+    ProgressCounter(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source);
+
+    virtual bool gotoNext() override;
+
+    inline int64_t processedPoints() const {
+        return _nPoints.load(std::memory_order_relaxed);
+    }
+
+protected:
+    std::atomic<int64_t> _nPoints;
+};
+
+/*!
+ * \brief The ProgressReporter class periodically report the progress of the processing.
+ *
+ * The progress is computed from the number of points read, or from the number of bytes read
+ * by the process if the number of points is not known in advance.
+ * The progress can be printed on a terminal and/or written as NDJSON events on a file descriptor.
+ *
+ * The reporting thread is stopped when the reporter is destroyed.
+ */
+class ProgressReporter
+{
+public:
+
+    /*!
+     * \brief ProgressReporter
+     * \param counter the counter to read the number of processed points from.
+     * \param expectedNumberOfPoints the expected number of points, or a negative number if unknown.
+     * \param expectedNumberOfBytes the expected number of bytes to read, or a negative number if unknown.
+     * \param printOnTerminal if true, print the progress on the terminal.
+     * \param ndjsonFd the file descriptor to write the NDJSON events to, or a negative number to disable NDJSON output.
+     * \param terminal the stream to print the progress to, e.g. std::cerr when the output data is written to std::cout.
+     */
+    ProgressReporter(ProgressCounter const* counter,
+                     int64_t expectedNumberOfPoints,
+                     int64_t expectedNumberOfBytes,
+                     bool printOnTerminal,
+                     int ndjsonFd = -1,
+                     std::ostream & terminal = std::cout);
+    ~ProgressReporter();
+
+    void start();
+
+    /*!
+     * \brief finish stop the reporting and emit the final event.
+     * \param success if the processing was successful.
+     */
+    void finish(bool success);
+
+    /*!
+     * \brief bytesReadByProcess give the number of bytes read by the process so far.
+     * \return the number of bytes, or -1 if the information is not available.
+     */
+    static int64_t bytesReadByProcess();
+
+protected:
+
+    struct Status {
+        double elapsed;
+        int64_t points;
+        int64_t bytes;
+        double fraction;
+        double pointsPerSecond;
+        double bytesPerSecond;
+        double eta;
+    };
+
+    Status currentStatus() const;
+
+    void printStatus(Status const& status, bool last) const;
+    void writeEvent(std::string const& event, Status const& status, std::string const& extra = "") const;
+
+    void run();
+
+    ProgressCounter const* _counter;
+
+    int64_t _expectedPoints;
+    int64_t _expectedBytes;
+
+    bool _printOnTerminal;
+    int _ndjsonFd;
+    std::ostream & _terminal;
+
+    int64_t _initialBytes;
+    std::chrono::steady_clock::time_point _start;
+
+    bool _running;
+    bool _finished;
+    std::mutex _mutex;
+    std::condition_variable _stopCondition;
+    std::thread _thread;
+};
+
+#endif // PROGRESSCOUNTER_H
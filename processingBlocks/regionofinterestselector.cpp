@@ -26,6 +26,22 @@ std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> RegionOfIntere
         return nullptr;
     }
 
+    StereoVision::Geometry::AffineTransform<double> world2rect;
+    std::array<double, 3> extents;
+
+    if (!parseDefinition(definition, world2rect, extents)) {
+        return nullptr;
+    }
+
+    return std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface>(
+                new RegionOfInterestSelector(std::move(source), world2rect, extents)
+                );
+}
+
+bool RegionOfInterestSelector::parseDefinition(std::string const& definition,
+                                               StereoVision::Geometry::AffineTransform<double> & world2rect,
+                                               std::array<double, 3> & extents) {
+
     std::istringstream reader(definition);
     std::string s;
     bool ok = true;
@@ -66,20 +82,18 @@ std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> RegionOfIntere
         rz = stod(s);
 
     } catch (std::exception & e) {
-        return nullptr;
+        return false;
     }
 
     Eigen::Vector3d r(rx,ry,rz);
     Eigen::Vector3d t(x,y,z);
 
-    std::array<double, 3> extents{std::abs(dx), std::abs(dy), std::abs(dz)};
+    extents = {std::abs(dx), std::abs(dy), std::abs(dz)};
 
     StereoVision::Geometry::RigidBodyTransform<double> rect2world(r,t);
-    StereoVision::Geometry::AffineTransform<double> world2rect = rect2world.inverse().toAffineTransform();
+    world2rect = rect2world.inverse().toAffineTransform();
 
-    return std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface>(
-                new RegionOfInterestSelector(std::move(source), world2rect, extents)
-                );
+    return true;
 }
 
 RegionOfInterestSelector::RegionOfInterestSelector(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> &&source,
@@ -89,7 +103,10 @@ RegionOfInterestSelector::RegionOfInterestSelector(std::unique_ptr<StereoVision:
     _transform(transform),
     _extends(extents)
 {
-
+    //the first point need to be checked too.
+    if (_src->hasData() and !isInside(_transform, _extends, _src->castedPointGeometry<double>())) {
+        gotoNext();
+    }
 }
 
 RegionOfInterestSelector::~RegionOfInterestSelector() {
@@ -104,18 +121,7 @@ bool RegionOfInterestSelector::gotoNext() {
     do {
         sourceHasNotEnded = _src->gotoNext();
 
-        auto pointData = _src->castedPointGeometry<double>();
-
-        Eigen::Vector3d pos;
-        pos << pointData.x, pointData.y, pointData.z;
-
-        Eigen::Vector3d transformed = _transform*pos;
-
-        if (std::abs(transformed.x()) <= _extends[0] and
-                std::abs(transformed.y()) <= _extends[1] and
-                std::abs(transformed.z()) <= _extends[2]) {
-            nextIsIn = true;
-        }
+        nextIsIn = isInside(_transform, _extends, _src->castedPointGeometry<double>());
 
     } while (!nextIsIn and sourceHasNotEnded);
 
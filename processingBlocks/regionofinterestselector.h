@@ -39,6 +39,31 @@ public:
             std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
             std::string const& definition);
 
+    /*!
+     * \brief parseDefinition parse the definition of a region of interest
+     * \param definition the definition, formatted as "x0,y0,z0,dx,dy,dz,rx,ry,rz"
+     * \param world2rect output, the transform from the world frame to the frame of the region of interest
+     * \param extents output, the half extents of the region of interest
+     * \return true on success, false otherwise.
+     */
+    static bool parseDefinition(std::string const& definition,
+                                StereoVision::Geometry::AffineTransform<double> & world2rect,
+                                std::array<double, 3> & extents);
+
+    static inline bool isInside(StereoVision::Geometry::AffineTransform<double> const& world2rect,
+                                std::array<double, 3> const& extents,
+                                StereoVision::IO::PtGeometry<double> const& point) {
+
+        Eigen::Vector3d pos;
+        pos << point.x, point.y, point.z;
+
+        Eigen::Vector3d transformed = world2rect*pos;
+
+        return std::abs(transformed.x()) <= extents[0] and
+                std::abs(transformed.y()) <= extents[1] and
+                std::abs(transformed.z()) <= extents[2];
+    }
+
     ~RegionOfInterestSelector();
 
     virtual bool gotoNext() override;
@@ -0,0 +1,217 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "regionofinterestset.h"
+
+#include "crstransform.h"
+#include "regionofinterestselector.h"
+
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
+
+namespace {
+
+bool isValidName(std::string const& name) {
+
+    if (name.empty() or name == "." or name == "..") {
+        return false;
+    }
+
+    for (char c : name) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) and c != '-' and c != '_' and c != '.') {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * \brief boundingBox get the axis aligned bounding box of a region.
+ */
+BoxTree::Box boundingBox(RegionOfInterestSet::Region const& region) {
+
+    //the region is centered on the inverse of the translation of world2rect, its rotation is the transpose of the linear part.
+    Eigen::Matrix3d R = region.world2rect.R;
+    Eigen::Vector3d center = -R.transpose()*region.world2rect.t;
+
+    BoxTree::Box box;
+
+    for (int i = 0; i < 3; i++) {
+
+        double halfExtent = 0;
+
+        for (int j = 0; j < 3; j++) {
+            halfExtent += std::abs(R(j,i))*region.extents[j];
+        }
+
+        //a small margin, so that the points on the faces are not missed due to rounding.
+        halfExtent += 1e-9*(std::abs(center[i]) + halfExtent);
+
+        box.min[i] = center[i] - halfExtent;
+        box.max[i] = center[i] + halfExtent;
+    }
+
+    return box;
+}
+
+}
+
+std::optional<RegionOfInterestSet> RegionOfInterestSet::parse(std::istream & in) {
+
+    std::vector<Region> regions;
+    std::set<std::string> names;
+
+    std::string line;
+    int lineIdx = 0;
+
+    while (std::getline(in, line)) {
+
+        lineIdx++;
+
+        std::istringstream reader(line);
+        std::string name;
+        std::string definition;
+        std::string trailing;
+
+        reader >> name;
+
+        if (name.empty() or name[0] == '#') {
+            continue;
+        }
+
+        reader >> definition;
+        reader >> trailing;
+
+        Region region;
+        region.name = name;
+
+        if (!isValidName(name)) {
+            std::cerr << "Invalid region name \"" << name << "\" at line " << lineIdx << "!" << std::endl;
+            return std::nullopt;
+        }
+
+        if (!trailing.empty() or !RegionOfInterestSelector::parseDefinition(definition, region.world2rect, region.extents)) {
+            std::cerr << "Invalid region definition at line " << lineIdx << "!" << std::endl;
+            return std::nullopt;
+        }
+
+        if (!names.insert(name).second) {
+            std::cerr << "Duplicated region name \"" << name << "\" at line " << lineIdx << "!" << std::endl;
+            return std::nullopt;
+        }
+
+        regions.push_back(std::move(region));
+    }
+
+    if (regions.empty()) {
+        std::cerr << "No region of interest defined!" << std::endl;
+        return std::nullopt;
+    }
+
+    return RegionOfInterestSet(std::move(regions));
+}
+
+std::optional<RegionOfInterestSet> RegionOfInterestSet::fromFile(std::filesystem::path const& path) {
+
+    std::ifstream file(path);
+
+    if (!file.is_open()) {
+        std::cerr << "Could not open region file " << path << "!" << std::endl;
+        return std::nullopt;
+    }
+
+    return parse(file);
+}
+
+RegionOfInterestSet::RegionOfInterestSet(std::vector<Region> && regions) :
+    _regions(std::move(regions))
+{
+
+    std::vector<BoxTree::Box> boxes(_regions.size());
+
+    for (size_t i = 0; i < _regions.size(); i++) {
+        boxes[i] = boundingBox(_regions[i]);
+    }
+
+    _tree = BoxTree(boxes);
+}
+
+void RegionOfInterestSet::regionsContaining(StereoVision::IO::PtGeometry<double> const& point, std::vector<int64_t> & out) const {
+
+    std::array<double, 3> position = {point.x, point.y, point.z};
+
+    _tree.query(position.data(), out);
+
+    //the candidates from the bounding boxes are checked exactly.
+    size_t nInside = 0;
+
+    for (int64_t idx : out) {
+
+        Region const& region = _regions[idx];
+
+        if (RegionOfInterestSelector::isInside(region.world2rect, region.extents, point)) {
+            out[nInside] = idx;
+            nInside++;
+        }
+    }
+
+    out.resize(nInside);
+}
+
+PartitionedWriter::PartitionFunction RegionOfInterestSet::partitionFunction(std::shared_ptr<const CrsTransform> const& toRegionsCrs) const {
+
+    std::shared_ptr<const RegionOfInterestSet> regions = std::make_shared<RegionOfInterestSet>(*this);
+
+    return [regions, toRegionsCrs] (StereoVision::IO::PointCloudPointAccessInterface const& src, std::vector<std::string> & keys) {
+
+        //per thread, so that the function can be called concurrently, and reused, so that it is not reallocated for each point.
+        thread_local std::vector<int64_t> candidates;
+
+        StereoVision::IO::PtGeometry<double> position = src.castedPointGeometry<double>();
+
+        if (toRegionsCrs != nullptr) {
+            toRegionsCrs->apply(position);
+        }
+
+        regions->regionsContaining(position, candidates);
+
+        for (int64_t idx : candidates) {
+            keys.push_back(regions->region(idx).name);
+        }
+    };
+}
+
+std::vector<std::string> RegionOfInterestSet::emptyRegions(std::map<std::string, size_t> const& partitionsSizes) const {
+
+    std::vector<std::string> ret;
+
+    for (Region const& region : _regions) {
+
+        auto it = partitionsSizes.find(region.name);
+
+        if (it == partitionsSizes.end() or it->second == 0) {
+            ret.push_back(region.name);
+        }
+    }
+
+    return ret;
+}
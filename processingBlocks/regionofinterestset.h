@@ -0,0 +1,105 @@
+#ifndef REGIONOFINTERESTSET_H
+#define REGIONOFINTERESTSET_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <StereoVision/geometry/rotations.h>
+#include <StereoVision/io/pointcloud_io.h>
+
+#include "./boxtree.h"
+#include "../io/partitionedwriter.h"
+
+class CrsTransform;
+
+/*!
+ * \brief The RegionOfInterestSet class hold many named regions of interest, to extract them all in a single pass.
+ *
+ * A region file contains one region per line, as a name followed by the definition of the region
+ * (in the same format as a single region of interest, "x0,y0,z0,dx,dy,dz,rx,ry,rz"), empty lines and lines starting with '#' being ignored.
+ * The names can only contain letters, digits, '-', '_' and '.', as they are used in the names of the output files.
+ * As a single region of interest, the regions are defined in the crs of the input points.
+ *
+ * The axis aligned bounding boxes of the regions are indexed in an R-tree, so that only the few regions whose box
+ * contain a point are tested exactly, whatever the number of regions.
+ */
+class RegionOfInterestSet
+{
+public:
+
+    struct Region {
+        std::string name;
+        StereoVision::Geometry::AffineTransform<double> world2rect;
+        std::array<double, 3> extents;
+    };
+
+    /*!
+     * \brief parse read the regions of a region file.
+     * \return the regions, or std::nullopt in case of error (the error is printed).
+     */
+    static std::optional<RegionOfInterestSet> parse(std::istream & in);
+
+    static std::optional<RegionOfInterestSet> fromFile(std::filesystem::path const& path);
+
+    inline size_t size() const {
+        return _regions.size();
+    }
+
+    inline Region const& region(size_t idx) const {
+        return _regions[idx];
+    }
+
+    /*!
+     * \brief regionsContaining find the regions containing a point.
+     * \param point the point
+     * \param out the indices of the regions containing the point, in the order of the file.
+     */
+    void regionsContaining(StereoVision::IO::PtGeometry<double> const& point, std::vector<int64_t> & out) const;
+
+    /*!
+     * \brief partitionFunction get a partition function dispatching each point to the regions containing it, using their names as keys.
+     * \param toRegionsCrs if not nullptr, the conversion from the crs of the points to the crs of the regions, applied before testing the regions
+     * (e.g. the inverse of the crs conversion of the processing, so that the regions are defined in the input crs, like a single region of interest).
+     */
+    PartitionedWriter::PartitionFunction partitionFunction(std::shared_ptr<const CrsTransform> const& toRegionsCrs = nullptr) const;
+
+    /*!
+     * \brief emptyRegions get the names of the regions which did not receive any point, and thus have no output.
+     * \param partitionsSizes the number of points of each partition, see PartitionedWriter::partitionsSizes.
+     * \return the names, in the order of the file.
+     */
+    std::vector<std::string> emptyRegions(std::map<std::string, size_t> const& partitionsSizes) const;
+
+protected:
+
+    explicit RegionOfInterestSet(std::vector<Region> && regions);
+
+    std::vector<Region> _regions;
+    BoxTree _tree;
+};
+
+#endif // REGIONOFINTERESTSET_H
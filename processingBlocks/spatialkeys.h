@@ -0,0 +1,103 @@
+#ifndef SPATIALKEYS_H
+#define SPATIALKEYS_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+
+/*!
+ * Keys ordering integer grid coordinates along space filling curves.
+ */
+namespace SpatialKeys {
+
+/*!
+ * \brief spreadBits21 spread the 21 lower bits of a value, so that there are two zero bits between each of them.
+ */
+inline uint64_t spreadBits21(uint64_t v) {
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffff;
+    v = (v | v << 16) & 0x1f0000ff0000ff;
+    v = (v | v << 8) & 0x100f00f00f00f00f;
+    v = (v | v << 4) & 0x10c30c30c30c30c3;
+    v = (v | v << 2) & 0x1249249249249249;
+    return v;
+}
+
+/*!
+ * \brief morton3d interleave the 21 lower bits of three coordinates in a morton (z-order) code.
+ */
+inline uint64_t morton3d(uint64_t x, uint64_t y, uint64_t z) {
+    return spreadBits21(x) | (spreadBits21(y) << 1) | (spreadBits21(z) << 2);
+}
+
+/*!
+ * \brief hilbert3d compute the index of a cell along a 3d hilbert curve, using the 21 lower bits of the three coordinates.
+ *
+ * The coordinates are first transformed to the transposed hilbert index (Skilling, 2004), which is then interleaved like a morton code.
+ * Unlike the morton order, two consecutive cells along the curve are always adjacent.
+ * The loops are branch free, so that the keys of a batch of points can be vectorized.
+ */
+inline uint64_t hilbert3d(uint64_t x, uint64_t y, uint64_t z) {
+
+    constexpr uint64_t topBit = uint64_t(1) << 20;
+
+    uint64_t coords[3] = {x & 0x1fffff, y & 0x1fffff, z & 0x1fffff};
+
+    //inverse undo excess work.
+    for (uint64_t q = topBit; q > 1; q >>= 1) {
+
+        uint64_t p = q - 1;
+
+        for (int i = 0; i < 3; i++) {
+            uint64_t set = uint64_t(0) - ((coords[i] & q) != 0);
+            coords[0] ^= p & set;
+            uint64_t t = (coords[0] ^ coords[i]) & p & ~set;
+            coords[0] ^= t;
+            coords[i] ^= t;
+        }
+    }
+
+    //gray encode.
+    coords[1] ^= coords[0];
+    coords[2] ^= coords[1];
+
+    uint64_t t = 0;
+
+    for (uint64_t q = topBit; q > 1; q >>= 1) {
+        t ^= (q - 1) & (uint64_t(0) - ((coords[2] & q) != 0));
+    }
+
+    for (int i = 0; i < 3; i++) {
+        coords[i] ^= t;
+    }
+
+    return (spreadBits21(coords[0]) << 2) | (spreadBits21(coords[1]) << 1) | spreadBits21(coords[2]);
+}
+
+/*!
+ * \brief mix a 64 bits finalizer (from splitmix64), to use a key with structure (e.g. a morton code) in a hash table.
+ */
+inline uint64_t mix(uint64_t v) {
+    v = (v ^ (v >> 30)) * 0xbf58476d1ce4e5b9;
+    v = (v ^ (v >> 27)) * 0x94d049bb133111eb;
+    return v ^ (v >> 31);
+}
+
+}
+
+#endif // SPATIALKEYS_H
@@ -0,0 +1,209 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stageprofiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+StageProbe::StageProbe(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source, int sampleRate) :
+    IdentityProcessor(std::move(source)),
+    _sampleRate(std::max(1, sampleRate)),
+    _rngState(0x9e3779b97f4a7c15ull ^ reinterpret_cast<uintptr_t>(this)),
+    _nextSample(-1),
+    _nCalls(0),
+    _nSampledCalls(0),
+    _nPointsOut(0),
+    _sampledTimeNs(0)
+{
+    if (_src->hasData()) {
+        _nPointsOut = 1;
+    }
+
+    drawNextSample();
+}
+
+void StageProbe::drawNextSample() {
+
+    _rngState ^= _rngState << 13;
+    _rngState ^= _rngState >> 7;
+    _rngState ^= _rngState << 17;
+
+    int64_t nextWindow = (_nextSample < 0) ? 0 : (_nCalls/_sampleRate + 1)*_sampleRate;
+    _nextSample = nextWindow + static_cast<int64_t>(_rngState % _sampleRate);
+}
+
+bool StageProbe::gotoNext() {
+
+    bool ok;
+
+    if (_nCalls == _nextSample) {
+        auto start = std::chrono::steady_clock::now();
+        ok = _src->gotoNext();
+        auto end = std::chrono::steady_clock::now();
+
+        _sampledTimeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        _nSampledCalls++;
+
+        drawNextSample();
+    } else {
+        ok = _src->gotoNext();
+    }
+
+    _nCalls++;
+
+    if (ok) {
+        _nPointsOut++;
+    }
+
+    return ok;
+}
+
+double StageProbe::cumulativeTime() const {
+
+    if (_nSampledCalls <= 0) {
+        return 0;
+    }
+
+    return 1e-9*double(_sampledTimeNs)*double(_nCalls)/double(_nSampledCalls);
+}
+
+PipelineProfiler::PipelineProfiler(int sampleRate) :
+    _sampleRate(sampleRate)
+{
+
+}
+
+std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> PipelineProfiler::addStage(
+        std::string const& name,
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && stage) {
+    return addBlockingStage(name, std::move(stage), 0);
+}
+
+std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> PipelineProfiler::addBlockingStage(
+        std::string const& name,
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && stage,
+        double setupTime) {
+
+    if (stage == nullptr) {
+        return nullptr;
+    }
+
+    StageProbe* probe = new StageProbe(std::move(stage), _sampleRate);
+
+    _names.push_back(name);
+    _probes.push_back(probe);
+    _setupTimes.push_back(std::max(0., setupTime));
+
+    return std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface>(probe);
+}
+
+std::vector<PipelineProfiler::StageStats> PipelineProfiler::stats(double totalTime) const {
+
+    std::vector<StageStats> ret;
+    ret.reserve(_probes.size()+1);
+
+    int64_t previousPoints = -1;
+    double previousTime = 0;
+
+    //the setup of a blocking stage include the time spent upstream during the setup (measured by the previous probes), but not
+    //the setup of the previous blocking stages, so the cumulative time of a probe is its measured time plus the setup times up to it.
+    double setupTime = 0;
+
+    for (int i = 0; i < _probes.size(); i++) {
+
+        setupTime += _setupTimes[i];
+        double cumulative = setupTime + _probes[i]->cumulativeTime();
+
+        StageStats stage;
+        stage.name = _names[i];
+        stage.pointsIn = (previousPoints < 0) ? _probes[i]->pointsOut() : previousPoints;
+        stage.pointsOut = _probes[i]->pointsOut();
+        stage.time = std::max(0., cumulative - previousTime);
+
+        ret.push_back(stage);
+
+        previousPoints = stage.pointsOut;
+        previousTime = std::max(previousTime, cumulative);
+    }
+
+    StageStats writer;
+    writer.name = "writer";
+    writer.pointsIn = std::max<int64_t>(0, previousPoints);
+    writer.pointsOut = writer.pointsIn;
+    writer.time = std::max(0., totalTime - previousTime);
+
+    ret.push_back(writer);
+
+    return ret;
+}
+
+void PipelineProfiler::report(std::ostream & out, double totalTime) const {
+
+    std::vector<StageStats> stages = stats(totalTime);
+
+    out << std::left << std::setw(16) << "Stage"
+        << std::right << std::setw(14) << "points in"
+        << std::setw(14) << "points out"
+        << std::setw(12) << "time [s]"
+        << std::setw(12) << "ns/point"
+        << std::setw(10) << "share" << "\n";
+
+    for (StageStats const& stage : stages) {
+
+        double nsPerPoint = (stage.pointsIn > 0) ? 1e9*stage.time/stage.pointsIn : 0;
+        double share = (totalTime > 0) ? 100*stage.time/totalTime : 0;
+
+        out << std::left << std::setw(16) << stage.name
+            << std::right << std::setw(14) << stage.pointsIn
+            << std::setw(14) << stage.pointsOut
+            << std::setw(12) << std::fixed << std::setprecision(3) << stage.time
+            << std::setw(12) << std::setprecision(1) << nsPerPoint
+            << std::setw(9) << std::setprecision(1) << share << "%\n";
+    }
+
+    out << std::left << std::setw(16) << "total"
+        << std::right << std::setw(40) << std::fixed << std::setprecision(3) << totalTime << std::endl;
+
+    out.unsetf(std::ios_base::floatfield);
+}
+
+void PipelineProfiler::reportJson(std::ostream & out, double totalTime) const {
+
+    std::vector<StageStats> stages = stats(totalTime);
+
+    out << "{\"total_seconds\":" << totalTime << ",\"stages\":[";
+
+    for (int i = 0; i < stages.size(); i++) {
+
+        StageStats const& stage = stages[i];
+        double nsPerPoint = (stage.pointsIn > 0) ? 1e9*stage.time/stage.pointsIn : 0;
+
+        if (i > 0) {
+            out << ",";
+        }
+
+        out << "{\"name\":\"" << stage.name << "\""
+            << ",\"points_in\":" << stage.pointsIn
+            << ",\"points_out\":" << stage.pointsOut
+            << ",\"seconds\":" << stage.time
+            << ",\"ns_per_point\":" << nsPerPoint << "}";
+    }
+
+    out << "]}" << std::endl;
+}
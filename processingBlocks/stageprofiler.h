@@ -0,0 +1,140 @@
+#ifndef STAGEPROFILER_H
+#define STAGEPROFILER_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+#include "./identityprocessor.h"
+
+/*!
+ * \brief The StageProbe class count the points going out of a processing block, and estimate the time spent upstream.
+ *
+ * To keep the overhead negligible, only one call to gotoNext every sampleRate calls is timed,
+ * the total time is then extrapolated from the sampled calls. The sampled call is drawn at random in each window
+ * of sampleRate calls, as the upstream blocks often do their heavy work (e.g. reading a new chunk) at a fixed period.
+ */
+class StageProbe : public IdentityProcessor
+{
+public:
+    StageProbe(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source, int sampleRate = 64);
+
+    virtual bool gotoNext() override;
+
+    inline int64_t pointsOut() const {
+        return _nPointsOut;
+    }
+
+    /*!
+     * \brief cumulativeTime give the estimated time spent in the upstream processing blocks, including the source.
+     * \return the time in seconds.
+     */
+    double cumulativeTime() const;
+
+protected:
+
+    /*!
+     * \brief drawNextSample draw the call to time in the window following the current call.
+     */
+    void drawNextSample();
+
+    int _sampleRate;
+    uint64_t _rngState; //!< state of a xorshift generator, cheaper than the standard generators.
+    int64_t _nextSample;
+
+    int64_t _nCalls;
+    int64_t _nSampledCalls;
+    int64_t _nPointsOut;
+    int64_t _sampledTimeNs;
+};
+
+/*!
+ * \brief The PipelineProfiler class manage the probes of a processing chain and report per stage statistics.
+ *
+ * The time of a stage is the difference between the cumulative times of its probe and the probe of the previous stage,
+ * the time spent writing is the difference between the total time and the cumulative time of the last probe.
+ *
+ * The blocking stages (e.g. a sort) consume their source when they are setup, outside of any probe, so their setup is timed
+ * separately and added to the cumulative time of their probe and of the following ones.
+ */
+class PipelineProfiler
+{
+public:
+
+    PipelineProfiler(int sampleRate = 64);
+
+    /*!
+     * \brief addStage insert a probe after a stage.
+     * \param name the name of the stage
+     * \param stage the stage to probe
+     * \return the probe, which should replace the stage in the processing chain.
+     */
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> addStage(
+            std::string const& name,
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && stage);
+
+    /*!
+     * \brief addBlockingStage insert a probe after a stage which did part of its work when it was setup.
+     * \param name the name of the stage
+     * \param stage the stage to probe
+     * \param setupTime the time spent setting up the stage (including reading its source), in seconds.
+     * \return the probe, which should replace the stage in the processing chain.
+     */
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> addBlockingStage(
+            std::string const& name,
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && stage,
+            double setupTime);
+
+    /*!
+     * \brief report print the statistics as a table
+     * \param out the stream to write to
+     * \param totalTime the total processing time, including writing, in seconds.
+     */
+    void report(std::ostream & out, double totalTime) const;
+
+    /*!
+     * \brief reportJson print the statistics as json
+     * \param out the stream to write to
+     * \param totalTime the total processing time, including writing, in seconds.
+     */
+    void reportJson(std::ostream & out, double totalTime) const;
+
+protected:
+
+    struct StageStats {
+        std::string name;
+        int64_t pointsIn;
+        int64_t pointsOut;
+        double time;
+    };
+
+    std::vector<StageStats> stats(double totalTime) const;
+
+    int _sampleRate;
+
+    std::vector<std::string> _names;
+    std::vector<StageProbe*> _probes;
+    std::vector<double> _setupTimes;
+};
+
+#endif // STAGEPROFILER_H
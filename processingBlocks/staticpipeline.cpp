@@ -0,0 +1,148 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "staticpipeline.h"
+
+#include <utility>
+
+namespace StaticStages {
+
+std::optional<Roi> Roi::fromDefinition(std::string const& definition) {
+
+    Roi ret;
+
+    if (!RegionOfInterestSelector::parseDefinition(definition, ret.world2rect, ret.extents)) {
+        return std::nullopt;
+    }
+
+    return ret;
+}
+
+LineSet LineSet::fromIndices(std::vector<int> const& indices) {
+
+    LineSet ret;
+    ret.lines.assign(indices.begin(), indices.end());
+
+    std::sort(ret.lines.begin(), ret.lines.end());
+    ret.lines.erase(std::unique(ret.lines.begin(), ret.lines.end()), ret.lines.end());
+
+    return ret;
+}
+
+std::optional<Crs> Crs::setup(std::string const& inCrs, std::string const& outCrs, double approximationTolerance) {
+
+    std::optional<CrsTransform> transform = CrsTransform::setup(inCrs, outCrs, approximationTolerance);
+
+    if (!transform.has_value()) {
+        return std::nullopt;
+    }
+
+    return Crs(std::move(transform.value()));
+}
+
+Crs::Crs(CrsTransform && transform) :
+    _transform(std::move(transform))
+{
+
+}
+
+}
+
+namespace {
+
+enum StageFlags {
+    RoiFlag = 1,
+    ReturnCapFlag = 2,
+    LineSetFlag = 4,
+    CrsFlag = 8,
+    AllStagesFlags = 16
+};
+
+template<bool present, typename StageT>
+auto optionalStage(std::optional<StageT> & stage) {
+    if constexpr (present) {
+        return std::tuple<StageT>(std::move(stage.value()));
+    } else {
+        return std::tuple<>();
+    }
+}
+
+template<typename ... Stages>
+std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> makeStaticPipeline(
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
+        std::tuple<Stages...> && stages) {
+    return std::make_unique<StaticPipeline<Stages...>>(std::move(source), std::move(stages));
+}
+
+template<int flags>
+std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> buildStaticPipeline(
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
+        StaticPipelineConfig & config) {
+
+    return makeStaticPipeline(source, std::tuple_cat(optionalStage<(flags & RoiFlag) != 0>(config.roi),
+                                                     optionalStage<(flags & ReturnCapFlag) != 0>(config.returnCap),
+                                                     optionalStage<(flags & LineSetFlag) != 0>(config.lineSet),
+                                                     optionalStage<(flags & CrsFlag) != 0>(config.crs)));
+}
+
+using StaticPipelineBuilder = std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface>(*)(
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> &,
+        StaticPipelineConfig &);
+
+template<int ... flags>
+constexpr std::array<StaticPipelineBuilder, sizeof...(flags)> makeDispatchTable(std::integer_sequence<int, flags...>) {
+    return {&buildStaticPipeline<flags>...};
+}
+
+//one specialization for each combination of stages.
+constexpr std::array<StaticPipelineBuilder, AllStagesFlags> dispatchTable =
+        makeDispatchTable(std::make_integer_sequence<int, AllStagesFlags>());
+
+}
+
+std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> setupStaticPipeline(
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
+        StaticPipelineConfig && config) {
+
+    if (source == nullptr) {
+        return nullptr;
+    }
+
+    int flags = 0;
+
+    if (config.roi.has_value()) {
+        flags |= RoiFlag;
+    }
+
+    if (config.returnCap.has_value()) {
+        flags |= ReturnCapFlag;
+    }
+
+    if (config.lineSet.has_value()) {
+        flags |= LineSetFlag;
+    }
+
+    if (config.crs.has_value()) {
+        flags |= CrsFlag;
+    }
+
+    if (flags == 0) {
+        return nullptr;
+    }
+
+    return dispatchTable[flags](source, config);
+}
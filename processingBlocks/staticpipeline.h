@@ -0,0 +1,264 @@
+#ifndef STATICPIPELINE_H
+#define STATICPIPELINE_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+#include "./crstransform.h"
+#include "./identityprocessor.h"
+#include "./regionofinterestselector.h"
+
+/*!
+ * The stages of a StaticPipeline are plain classes, known at compile time, so that they can be inlined in the pipeline.
+ *
+ * A stage is either a filter (isFilter == true), with a function bool accept(PointCloudPointAccessInterface const& src),
+ * or a geometry transform (isFilter == false), with a function void apply(PtGeometry<double> & position).
+ */
+namespace StaticStages {
+
+/*!
+ * \brief The Roi stage select the points in a region of interest, same as RegionOfInterestSelector.
+ */
+struct Roi {
+    static constexpr bool isFilter = true;
+
+    StereoVision::Geometry::AffineTransform<double> world2rect;
+    std::array<double, 3> extents;
+
+    static std::optional<Roi> fromDefinition(std::string const& definition);
+
+    inline bool accept(StereoVision::IO::PointCloudPointAccessInterface const& src) const {
+        return RegionOfInterestSelector::isInside(world2rect, extents, src.castedPointGeometry<double>());
+    }
+};
+
+/*!
+ * \brief The ReturnCap stage select the points with a return number lower or equal than a cap, same as an AttributeBasedSelector with SmallerOrEqual.
+ */
+struct ReturnCap {
+    static constexpr bool isFilter = true;
+
+    double cap;
+    std::string attributeName = "returnNumber";
+
+    inline bool accept(StereoVision::IO::PointCloudPointAccessInterface const& src) const {
+
+        std::optional<StereoVision::IO::PointCloudGenericAttribute> attribute = src.getAttributeByName(attributeName.c_str());
+
+        if (!attribute.has_value()) {
+            return false;
+        }
+
+        return StereoVision::IO::castedPointCloudAttribute<double>(attribute.value()) <= cap;
+    }
+};
+
+/*!
+ * \brief The LineSet stage select the points of a set of lines, same as an AttributeSetBasedSelector with InSet.
+ */
+struct LineSet {
+    static constexpr bool isFilter = true;
+
+    std::vector<double> lines; //!< sorted line indices
+    std::string attributeName = "lineNumber";
+
+    static LineSet fromIndices(std::vector<int> const& indices);
+
+    inline bool accept(StereoVision::IO::PointCloudPointAccessInterface const& src) const {
+
+        std::optional<StereoVision::IO::PointCloudGenericAttribute> attribute = src.getAttributeByName(attributeName.c_str());
+
+        if (!attribute.has_value()) {
+            return true;
+        }
+
+        return std::binary_search(lines.begin(), lines.end(), StereoVision::IO::castedPointCloudAttribute<double>(attribute.value()));
+    }
+};
+
+/*!
+ * \brief The Crs stage convert the points from a crs to another, same as CrsConversion.
+ */
+class Crs {
+public:
+    static constexpr bool isFilter = false;
+
+    /*!
+     * \brief setup try to setup a crs conversion
+     * \param approximationTolerance if strictly positive, the conversion is approximated, see CrsApproximation.
+     * \return the stage, or std::nullopt in case of error.
+     */
+    static std::optional<Crs> setup(std::string const& inCrs, std::string const& outCrs, double approximationTolerance = -1);
+
+    inline void apply(StereoVision::IO::PtGeometry<double> & position) const {
+        _transform.apply(position);
+    }
+
+protected:
+    explicit Crs(CrsTransform && transform);
+
+    CrsTransform _transform;
+};
+
+}
+
+template<typename ... Stages>
+constexpr bool filtersBeforeTransforms() {
+
+    constexpr std::array<bool, sizeof...(Stages)+1> isFilter = {Stages::isFilter..., false};
+
+    for (size_t i = 1; i < sizeof...(Stages); i++) {
+        if (isFilter[i] and !isFilter[i-1]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * \brief The StaticPipeline class fuse a chain of processing stages known at compile time in a single processing block.
+ *
+ * In the dynamic chain each block is a separate object behind a virtual interface, and each point goes through all of them.
+ * In a StaticPipeline, the stages are stored by value and the filters are evaluated in a single loop, which the compiler can inline.
+ *
+ * The filters are evaluated in order, on the source geometry, then the transforms are applied in order on the accepted points.
+ * Thus, all the filters must come before the transforms.
+ */
+template<typename ... Stages>
+class StaticPipeline : public IdentityProcessor
+{
+public:
+
+    static_assert(filtersBeforeTransforms<Stages...>(), "The filters of a static pipeline must come before its transforms");
+
+    StaticPipeline(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source, std::tuple<Stages...> && stages) :
+        IdentityProcessor(std::move(source)),
+        _stages(std::move(stages))
+    {
+        if (_src->hasData()) {
+            if (acceptCurrent()) {
+                updatePosition();
+            } else {
+                advance();
+            }
+        }
+    }
+
+    virtual StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> getPointPosition() const override {
+
+        if constexpr (hasTransform) {
+            StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> ret;
+            ret.x = _position.x;
+            ret.y = _position.y;
+            ret.z = _position.z;
+            return ret;
+        } else {
+            return _src->getPointPosition();
+        }
+    }
+
+    virtual bool gotoNext() override {
+        return advance();
+    }
+
+protected:
+
+    static constexpr bool hasTransform = (!Stages::isFilter or ...);
+
+    template<typename StageT>
+    inline bool acceptStage(StageT const& stage) const {
+        if constexpr (StageT::isFilter) {
+            return stage.accept(*_src);
+        } else {
+            return true;
+        }
+    }
+
+    template<typename StageT>
+    inline void applyStage(StageT const& stage) {
+        if constexpr (!StageT::isFilter) {
+            stage.apply(_position);
+        }
+    }
+
+    inline bool acceptCurrent() const {
+        return std::apply([this] (Stages const& ... stages) {
+            return (acceptStage(stages) and ...);
+        }, _stages);
+    }
+
+    inline void updatePosition() {
+        if constexpr (hasTransform) {
+            _position = _src->castedPointGeometry<double>();
+            std::apply([this] (Stages const& ... stages) {
+                (applyStage(stages), ...);
+            }, _stages);
+        }
+    }
+
+    bool advance() {
+
+        do {
+            if (!_src->gotoNext()) {
+                return false;
+            }
+        } while (!acceptCurrent());
+
+        updatePosition();
+
+        return true;
+    }
+
+    std::tuple<Stages...> _stages;
+    StereoVision::IO::PtGeometry<double> _position;
+};
+
+/*!
+ * \brief The StaticPipelineConfig struct list the stages of a static pipeline, absent stages are skipped.
+ */
+struct StaticPipelineConfig {
+    std::optional<StaticStages::Roi> roi;
+    std::optional<StaticStages::ReturnCap> returnCap;
+    std::optional<StaticStages::LineSet> lineSet;
+    std::optional<StaticStages::Crs> crs;
+};
+
+/*!
+ * \brief setupStaticPipeline build the StaticPipeline specialized for the stages in a config.
+ *
+ * The specialization is selected at runtime in a dispatch table with one entry per combination of stages.
+ *
+ * \param source a pointer to the source, will be moved to the output if return is not nullptr
+ * \param config the stages to use, the stages are moved to the pipeline.
+ * \return a unique ptr to a PointCloudPointAccessInterface, or nullptr if the config is empty or the source is nullptr.
+ */
+std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> setupStaticPipeline(
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
+        StaticPipelineConfig && config);
+
+#endif // STATICPIPELINE_H
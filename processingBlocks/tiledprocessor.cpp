@@ -0,0 +1,229 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tiledprocessor.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+TiledProcessor::TiledProcessor(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source,
+                               std::string const& name,
+                               double tileSize,
+                               double haloSize) :
+    _src(std::move(source)),
+    _name(name),
+    _tileSize(std::max(tileSize, haloSize)),
+    _haloSize(haloSize),
+    _nextTile(0),
+    _currentIdx(0),
+    _nRemoved(0),
+    _failed(false)
+{
+    //the halo of a tile only covers its direct neighbors, so the tiles have to be at least as large as the halo.
+    if (haloSize > tileSize) {
+        std::cerr << "Warning: the halo of the tiles (" << haloSize << ") is larger than the tiles (" << tileSize
+                  << "), the tiles are enlarged to " << haloSize << " (" << name << ")." << std::endl;
+    }
+
+    _sourceSchema = _src->attributeList();
+    _schema = _sourceSchema;
+}
+
+TiledProcessor::~TiledProcessor() {
+
+}
+
+bool TiledProcessor::start() {
+
+    _schemaIdxs.clear();
+
+    for (int i = 0; i < _schema.size(); i++) {
+        _schemaIdxs[_schema[i]] = i;
+    }
+
+    _spool = std::make_unique<TileSpool>(_name, _tileSize, _haloSize);
+
+    bool hasMore = _src->hasData();
+
+    while (hasMore) {
+
+        if (!_spool->append(*_src, _sourceSchema)) {
+            std::cerr << "Could not spool the points in tiles (" << _name << ")!" << std::endl;
+            return false;
+        }
+
+        hasMore = _src->gotoNext();
+    }
+
+    if (!_spool->flush()) {
+        std::cerr << "Could not spool the points in tiles (" << _name << ")!" << std::endl;
+        return false;
+    }
+
+    _nRemoved += _spool->numberOfSkippedPoints();
+    _nextTile = 0;
+
+    processNextTiles();
+
+    return !_failed;
+}
+
+bool TiledProcessor::processNextTiles() {
+
+    int nThreads = 1;
+
+    #ifdef _OPENMP
+    nThreads = omp_get_max_threads();
+    #endif
+
+    std::vector<TileSpool::Tile> const& tiles = _spool->tiles();
+
+    while (_nextTile < tiles.size()) {
+
+        //a few tiles per thread, so that the threads stay busy when the tiles have different numbers of points.
+        size_t nTiles = std::min<size_t>(2*nThreads, tiles.size() - _nextTile);
+
+        std::vector<std::vector<SpooledPoint>> tilesPoints(nTiles);
+        bool ok = true;
+
+        //a single tile is processed with all the threads.
+        bool parallelTiles = nTiles > 1;
+
+        #pragma omp parallel for schedule(dynamic) if(parallelTiles)
+        for (size_t t = 0; t < nTiles; t++) {
+
+            TileSpool::Tile const& tile = tiles[_nextTile + t];
+
+            std::unique_ptr<PointSpoolReader> coreReader = _spool->openCore(tile, _sourceSchema);
+            std::unique_ptr<PointSpoolReader> haloReader = _spool->openHalo(tile, _sourceSchema);
+
+            if (coreReader == nullptr or (haloReader == nullptr and _spool->hasHalo(tile))) {
+                #pragma omp atomic write
+                ok = false;
+                continue;
+            }
+
+            std::vector<SpooledPoint> & points = tilesPoints[t];
+            std::vector<SpooledPoint> halo;
+
+            bool hasMore = coreReader->hasData();
+
+            while (hasMore) {
+                points.push_back(coreReader->currentPoint());
+                hasMore = coreReader->gotoNext();
+            }
+
+            //tiles might have no halo.
+            hasMore = haloReader != nullptr and haloReader->hasData();
+
+            while (hasMore) {
+                halo.push_back(haloReader->currentPoint());
+                hasMore = haloReader->gotoNext();
+            }
+
+            int64_t nPoints = points.size();
+
+            processTile(tile, points, halo, !parallelTiles);
+
+            int64_t nRemoved = nPoints - int64_t(points.size());
+
+            #pragma omp atomic
+            _nRemoved += nRemoved;
+        }
+
+        _nextTile += nTiles;
+
+        if (!ok) {
+            std::cerr << "Could not read back the spooled tiles (" << _name << ")!" << std::endl;
+            _failed = true;
+            break;
+        }
+
+        _points.clear();
+        _currentIdx = 0;
+
+        for (std::vector<SpooledPoint> & points : tilesPoints) {
+            std::move(points.begin(), points.end(), std::back_inserter(_points));
+        }
+
+        if (!_points.empty()) {
+            return true;
+        }
+    }
+
+    _points.clear();
+    _currentIdx = 0;
+
+    return false;
+}
+
+StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> TiledProcessor::getPointPosition() const {
+    StereoVision::IO::PtGeometry<double> const& pos = _points[_currentIdx].xyz;
+    return StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute>{pos.x, pos.y, pos.z};
+}
+
+std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> TiledProcessor::getPointColor() const {
+    return _points[_currentIdx].rgba;
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> TiledProcessor::getAttributeById(int id) const {
+
+    if (id < 0 or id >= _schema.size() or id >= _points[_currentIdx].attributes.size()) {
+        return std::nullopt;
+    }
+
+    return _points[_currentIdx].attributes[id];
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> TiledProcessor::getAttributeByName(const char* attributeName) const {
+
+    auto it = _schemaIdxs.find(attributeName);
+
+    if (it == _schemaIdxs.end()) {
+        return std::nullopt;
+    }
+
+    return getAttributeById(it->second);
+}
+
+std::vector<std::string> TiledProcessor::attributeList() const {
+    return _schema;
+}
+
+bool TiledProcessor::gotoNext() {
+
+    if (_currentIdx >= _points.size()) {
+        return false;
+    }
+
+    _currentIdx++;
+
+    if (_currentIdx < _points.size()) {
+        return true;
+    }
+
+    return processNextTiles();
+}
+
+bool TiledProcessor::hasData() const {
+    return _currentIdx < _points.size();
+}
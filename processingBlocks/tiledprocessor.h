@@ -0,0 +1,127 @@
+#ifndef TILEDPROCESSOR_H
+#define TILEDPROCESSOR_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+#include "../io/tilespool.h"
+
+/*!
+ * \brief The TiledProcessor class is the base class of the processing blocks which need the neighborhood of the points.
+ *
+ * The source points are spooled to disk in square tiles with halos (see TileSpool), then the tiles are loaded
+ * and processed in parallel, a few tiles per thread at a time, so that the memory used is bounded by the size of the tiles.
+ * The points with a non finite position are removed. The output points are ordered by tile.
+ */
+class TiledProcessor : public StereoVision::IO::PointCloudPointAccessInterface
+{
+public:
+
+    ~TiledProcessor();
+
+    virtual StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> getPointPosition() const override;
+    virtual std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> getPointColor() const override;
+
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeById(int id) const override;
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeByName(const char* attributeName) const override;
+
+    virtual std::vector<std::string> attributeList() const override;
+
+    virtual bool gotoNext() override;
+    virtual bool hasData() const override;
+
+    inline int64_t numberOfRemovedPoints() const {
+        return _nRemoved;
+    }
+
+    /*!
+     * \brief ok check that no tile failed to be read back, needs to be checked once all the points have been read,
+     * as a failure ends the point cloud early.
+     */
+    inline bool ok() const {
+        return !_failed;
+    }
+
+protected:
+
+    /*!
+     * \brief TiledProcessor build the base of a tiled processor, the setup of the derived classes have to call start once the processor is built.
+     * \param source the source of the points.
+     * \param name a name to identify the spool of the processor.
+     * \param tileSize the size of the tiles, enlarged to the size of the halo (with a warning) if it is smaller.
+     * \param haloSize the size of the halo around each tile.
+     */
+    TiledProcessor(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source,
+                   std::string const& name,
+                   double tileSize,
+                   double haloSize);
+
+    /*!
+     * \brief start spool the source points and process the first tiles.
+     *
+     * The attributes added to _schema by the derived class before calling start are not read from the source.
+     * \return true on success, false if the points could not be spooled or the first tiles could not be read back.
+     */
+    bool start();
+
+    /*!
+     * \brief processTile process the points of a tile, called from multiple threads at the same time.
+     * \param tile the tile.
+     * \param points the points of the tile, with attributes in the order of the source schema, to modify in place
+     * (points can be removed, attributes added to the schema have to be set).
+     * \param halo the points in the halo of the tile.
+     * \param parallel if true, the processing of the tile can use multiple threads.
+     */
+    virtual void processTile(TileSpool::Tile const& tile,
+                             std::vector<SpooledPoint> & points,
+                             std::vector<SpooledPoint> const& halo,
+                             bool parallel) const = 0;
+
+    /*!
+     * \brief processNextTiles process the next tiles, until some points are available.
+     * \return true if some points are available, false otherwise.
+     */
+    bool processNextTiles();
+
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> _src;
+
+    std::string _name;
+    double _tileSize;
+    double _haloSize;
+
+    std::vector<std::string> _sourceSchema;
+    std::vector<std::string> _schema;
+    std::map<std::string, int> _schemaIdxs;
+
+    std::unique_ptr<TileSpool> _spool;
+    size_t _nextTile;
+
+    std::vector<SpooledPoint> _points;
+    size_t _currentIdx;
+
+    int64_t _nRemoved;
+    bool _failed;
+};
+
+#endif // TILEDPROCESSOR_H
@@ -0,0 +1,708 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "voxeldownsampler.h"
+
+#include "spatialkeys.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+using GenericAttribute = StereoVision::IO::PointCloudGenericAttribute;
+
+constexpr size_t batchSize = 1 << 16;
+
+struct VoxelIndex {
+    int64_t x;
+    int64_t y;
+    int64_t z;
+
+    inline bool operator==(VoxelIndex const& other) const {
+        return x == other.x and y == other.y and z == other.z;
+    }
+
+    inline uint64_t mortonKey() const {
+        return SpatialKeys::morton3d(x, y, z);
+    }
+};
+
+struct VoxelIndexHash {
+    inline size_t operator()(VoxelIndex const& idx) const {
+        return SpatialKeys::mix(idx.mortonKey());
+    }
+};
+
+inline bool voxelIndex(double const* position, double voxelSize, VoxelIndex & idx) {
+
+    double vx = std::floor(position[0]/voxelSize);
+    double vy = std::floor(position[1]/voxelSize);
+    double vz = std::floor(position[2]/voxelSize);
+
+    constexpr double limit = 9e18;
+
+    if (!(std::abs(vx) < limit and std::abs(vy) < limit and std::abs(vz) < limit)) {
+        return false;
+    }
+
+    idx = VoxelIndex{int64_t(vx), int64_t(vy), int64_t(vz)};
+    return true;
+}
+
+inline int64_t floorDiv(int64_t a, int64_t b) {
+    int64_t q = a/b;
+    return (a%b != 0 and (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+bool isNumeric(std::optional<GenericAttribute> const& value) {
+
+    if (!value.has_value()) {
+        return false;
+    }
+
+    return std::visit([] (auto const& val) {
+        return std::is_arithmetic_v<std::decay_t<decltype(val)>>;
+    }, value.value());
+}
+
+/*!
+ * \brief castLike cast an averaged value to the type of a prototype, integers are rounded.
+ */
+GenericAttribute castLike(GenericAttribute const& prototype, double value) {
+
+    return std::visit([value] (auto const& proto) -> GenericAttribute {
+
+        using T = std::decay_t<decltype(proto)>;
+
+        if constexpr (std::is_same_v<T, bool>) {
+            return value >= 0.5;
+        } else if constexpr (std::is_integral_v<T>) {
+            return static_cast<T>(std::llround(value));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            return static_cast<T>(value);
+        } else {
+            return proto;
+        }
+
+    }, prototype);
+}
+
+/*!
+ * \brief The PointBatch struct hold the numeric values of a batch of points, missing values are nan.
+ */
+struct PointBatch {
+    std::vector<double> positions; //!< 3 per point
+    std::vector<double> colors; //!< 4 per point
+    std::vector<double> attributes; //!< one per numeric attribute per point
+
+    inline size_t size() const {
+        return positions.size()/3;
+    }
+};
+
+/*!
+ * \brief readBatch read a batch of points.
+ * \return true if the source has more points, false otherwise.
+ */
+bool readBatch(StereoVision::IO::PointCloudPointAccessInterface & points,
+               std::vector<std::string> const& numericAttributes,
+               PointBatch & batch) {
+
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+    batch.positions.clear();
+    batch.colors.clear();
+    batch.attributes.clear();
+
+    bool hasMore = points.hasData();
+
+    while (hasMore and batch.size() < batchSize) {
+
+        StereoVision::IO::PtGeometry<double> pos = points.castedPointGeometry<double>();
+        batch.positions.insert(batch.positions.end(), {pos.x, pos.y, pos.z});
+
+        auto color = points.castedPointColor<double>();
+
+        if (color.has_value()) {
+            batch.colors.insert(batch.colors.end(), {color->r, color->g, color->b, color->a});
+        } else {
+            batch.colors.insert(batch.colors.end(), {nan, nan, nan, nan});
+        }
+
+        for (std::string const& name : numericAttributes) {
+            std::optional<GenericAttribute> value = points.getAttributeByName(name.c_str());
+            batch.attributes.push_back((isNumeric(value)) ? StereoVision::IO::castedPointCloudAttribute<double>(value.value()) : nan);
+        }
+
+        hasMore = points.gotoNext();
+    }
+
+    return hasMore;
+}
+
+/*!
+ * \brief The VoxelGrid class accumulate the points of each voxel.
+ *
+ * The sums are stored in flat arrays, indexed by the slot of the voxel.
+ */
+class VoxelGrid {
+public:
+
+    VoxelGrid(int nAttributes) :
+        _nAttributes(nAttributes)
+    {
+
+    }
+
+    inline size_t size() const {
+        return indices.size();
+    }
+
+    size_t slot(VoxelIndex const& idx) {
+
+        auto it = slots.find(idx);
+
+        if (it != slots.end()) {
+            return it->second;
+        }
+
+        size_t ret = indices.size();
+        slots.emplace(idx, ret);
+
+        indices.push_back(idx);
+        counts.push_back(0);
+        positionSums.resize(positionSums.size() + 3, 0);
+        colorCounts.push_back(0);
+        colorSums.resize(colorSums.size() + 4, 0);
+        attributeCounts.resize(attributeCounts.size() + _nAttributes, 0);
+        attributeSums.resize(attributeSums.size() + _nAttributes, 0);
+
+        return ret;
+    }
+
+    void add(VoxelIndex const& idx, double const* position, double const* color, double const* attributes) {
+
+        size_t s = slot(idx);
+
+        counts[s]++;
+
+        for (int i = 0; i < 3; i++) {
+            positionSums[3*s+i] += position[i];
+        }
+
+        if (!std::isnan(color[0])) {
+            colorCounts[s]++;
+            for (int i = 0; i < 4; i++) {
+                colorSums[4*s+i] += color[i];
+            }
+        }
+
+        for (int i = 0; i < _nAttributes; i++) {
+            if (!std::isnan(attributes[i])) {
+                attributeCounts[_nAttributes*s+i]++;
+                attributeSums[_nAttributes*s+i] += attributes[i];
+            }
+        }
+    }
+
+    void merge(VoxelGrid const& other) {
+
+        for (size_t o = 0; o < other.size(); o++) {
+
+            size_t s = slot(other.indices[o]);
+
+            counts[s] += other.counts[o];
+            colorCounts[s] += other.colorCounts[o];
+
+            for (int i = 0; i < 3; i++) {
+                positionSums[3*s+i] += other.positionSums[3*o+i];
+            }
+
+            for (int i = 0; i < 4; i++) {
+                colorSums[4*s+i] += other.colorSums[4*o+i];
+            }
+
+            for (int i = 0; i < _nAttributes; i++) {
+                attributeCounts[_nAttributes*s+i] += other.attributeCounts[_nAttributes*o+i];
+                attributeSums[_nAttributes*s+i] += other.attributeSums[_nAttributes*o+i];
+            }
+        }
+    }
+
+    inline double centroid(size_t s, int axis) const {
+        return positionSums[3*s+axis]/counts[s];
+    }
+
+    std::unordered_map<VoxelIndex, size_t, VoxelIndexHash> slots;
+
+    std::vector<VoxelIndex> indices;
+    std::vector<int64_t> counts;
+    std::vector<double> positionSums;
+    std::vector<int64_t> colorCounts;
+    std::vector<double> colorSums;
+    std::vector<int64_t> attributeCounts;
+    std::vector<double> attributeSums;
+
+protected:
+    int _nAttributes;
+};
+
+}
+
+std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> VoxelDownsampler::setupVoxelDownsampler(
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
+        double voxelSize,
+        Representative representative,
+        double tileSize) {
+
+    if (source == nullptr) {
+        return nullptr;
+    }
+
+    if (!std::isfinite(voxelSize) or voxelSize <= 0 or !std::isfinite(tileSize)) {
+        return nullptr;
+    }
+
+    std::unique_ptr<VoxelDownsampler> downsampler(new VoxelDownsampler(std::move(source), voxelSize, representative, tileSize));
+
+    if (!downsampler->start()) {
+        return nullptr;
+    }
+
+    return downsampler;
+}
+
+std::optional<VoxelDownsampler::Representative> VoxelDownsampler::parseRepresentative(std::string const& name) {
+
+    if (name == "centroid") {
+        return Centroid;
+    } else if (name == "nearest") {
+        return NearestToCentroid;
+    }
+
+    return std::nullopt;
+}
+
+VoxelDownsampler::VoxelDownsampler(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source,
+                                   double voxelSize,
+                                   Representative representative,
+                                   double tileSize) :
+    _src(std::move(source)),
+    _voxelSize(voxelSize),
+    _representative(representative),
+    _voxelsPerTile((tileSize > 0) ? std::max<int64_t>(1, std::llround(tileSize/voxelSize)) : 0),
+    _nextTile(0),
+    _currentIdx(0),
+    _failed(false)
+{
+    _schema = _src->attributeList();
+
+    for (int i = 0; i < _schema.size(); i++) {
+        _schemaIdxs[_schema[i]] = i;
+    }
+
+    _attributePrototypes.resize(_schema.size());
+
+    if (_src->hasData()) {
+
+        _colorPrototype = _src->getPointColor();
+
+        for (int i = 0; i < _schema.size(); i++) {
+            _attributePrototypes[i] = _src->getAttributeByName(_schema[i].c_str());
+        }
+    }
+}
+
+VoxelDownsampler::~VoxelDownsampler() {
+
+}
+
+bool VoxelDownsampler::start() {
+
+    //the centroids of an untiled point cloud can be computed directly from the stream, else the points need to be spooled first.
+    if (_voxelsPerTile <= 0 and _representative == Centroid) {
+        return downsample(*_src, nullptr);
+    }
+
+    if (!spoolTiles()) {
+        std::cerr << "Could not spool the points to downsample them!" << std::endl;
+        return false;
+    }
+
+    processNextTile();
+
+    return !_failed;
+}
+
+bool VoxelDownsampler::spoolTiles() {
+
+    _spool = std::make_unique<PartitionSpool>(PartitionSpool::temporarySpoolDir("voxels"));
+
+    std::string record;
+    bool hasMore = _src->hasData();
+
+    while (hasMore) {
+
+        std::string key = "all";
+
+        if (_voxelsPerTile > 0) {
+
+            StereoVision::IO::PtGeometry<double> pos = _src->castedPointGeometry<double>();
+            std::array<double, 3> position = {pos.x, pos.y, pos.z};
+            VoxelIndex idx;
+
+            if (!voxelIndex(position.data(), _voxelSize, idx)) {
+                hasMore = _src->gotoNext();
+                continue;
+            }
+
+            key = std::to_string(floorDiv(idx.x, _voxelsPerTile)) + "_" + std::to_string(floorDiv(idx.y, _voxelsPerTile));
+        }
+
+        record.clear();
+        PointSpool::appendRecord(record, *_src, _schema);
+
+        if (!_spool->append(key, record)) {
+            return false;
+        }
+
+        hasMore = _src->gotoNext();
+    }
+
+    if (!_spool->flush()) {
+        return false;
+    }
+
+    _tileKeys = _spool->keys();
+    _nextTile = 0;
+
+    return true;
+}
+
+bool VoxelDownsampler::processNextTile() {
+
+    while (_nextTile < _tileKeys.size()) {
+
+        std::string const& key = _tileKeys[_nextTile];
+        _nextTile++;
+
+        bool nearest = _representative == NearestToCentroid;
+
+        //the nearest point representative read the points twice, the second reader remove the spool file.
+        std::unique_ptr<PointSpoolReader> points = _spool->openPartition(key, _schema, !nearest);
+        std::unique_ptr<PointSpoolReader> secondPass = (nearest) ? _spool->openPartition(key, _schema, true) : nullptr;
+
+        if (points == nullptr or (nearest and secondPass == nullptr) or !downsample(*points, secondPass.get())) {
+            std::cerr << "Could not read back the spooled tile " << key << " to downsample it!" << std::endl;
+            _failed = true;
+            break;
+        }
+
+        if (!_voxels.empty()) {
+            return true;
+        }
+    }
+
+    _voxels.clear();
+    _currentIdx = 0;
+
+    return false;
+}
+
+bool VoxelDownsampler::downsample(StereoVision::IO::PointCloudPointAccessInterface & points, PointSpoolReader* secondPass) {
+
+    _voxels.clear();
+    _currentIdx = 0;
+
+    std::vector<int> numericIdxs;
+    std::vector<std::string> numericAttributes;
+
+    for (int i = 0; i < _schema.size(); i++) {
+        if (isNumeric(_attributePrototypes[i])) {
+            numericIdxs.push_back(i);
+            numericAttributes.push_back(_schema[i]);
+        }
+    }
+
+    int nAttributes = numericAttributes.size();
+
+    int nThreads = 1;
+
+    #ifdef _OPENMP
+    nThreads = omp_get_max_threads();
+    #endif
+
+    //partial grids, one per thread.
+    std::vector<VoxelGrid> grids(nThreads, VoxelGrid(nAttributes));
+    double voxelSize = _voxelSize;
+
+    auto accumulate = [&grids, voxelSize, nAttributes, nThreads] (PointBatch const& batch) {
+
+        int64_t nPoints = batch.size();
+
+        #pragma omp parallel num_threads(nThreads)
+        {
+            int thread = 0;
+
+            #ifdef _OPENMP
+            thread = omp_get_thread_num();
+            #endif
+
+            VoxelGrid & grid = grids[thread];
+
+            #pragma omp for schedule(static)
+            for (int64_t i = 0; i < nPoints; i++) {
+
+                VoxelIndex idx;
+
+                if (!voxelIndex(&batch.positions[3*i], voxelSize, idx)) {
+                    continue;
+                }
+
+                grid.add(idx, batch.positions.data() + 3*i, batch.colors.data() + 4*i, batch.attributes.data() + nAttributes*i);
+            }
+        }
+    };
+
+    //the next batch is read while the current one is accumulated.
+    PointBatch current;
+    PointBatch next;
+
+    bool hasMore = readBatch(points, numericAttributes, current);
+
+    while (current.size() > 0) {
+
+        std::future<void> accumulating = std::async(std::launch::async, accumulate, std::cref(current));
+
+        next.positions.clear();
+
+        if (hasMore) {
+            hasMore = readBatch(points, numericAttributes, next);
+        }
+
+        accumulating.get();
+        std::swap(current, next);
+    }
+
+    //merge the partial grids pairwise.
+    for (int stride = 1; stride < nThreads; stride *= 2) {
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < nThreads - stride; i += 2*stride) {
+            grids[i].merge(grids[i+stride]);
+            grids[i+stride] = VoxelGrid(nAttributes);
+        }
+    }
+
+    VoxelGrid & grid = grids[0];
+    size_t nVoxels = grid.size();
+
+    std::vector<SpooledPoint> voxels(nVoxels);
+
+    if (secondPass == nullptr) {
+
+        //the voxels are replaced by their centroid.
+        #pragma omp parallel for schedule(static)
+        for (size_t s = 0; s < nVoxels; s++) {
+
+            SpooledPoint & voxel = voxels[s];
+
+            voxel.xyz = StereoVision::IO::PtGeometry<double>{grid.centroid(s, 0), grid.centroid(s, 1), grid.centroid(s, 2)};
+
+            if (grid.colorCounts[s] > 0 and _colorPrototype.has_value()) {
+
+                int64_t n = grid.colorCounts[s];
+
+                voxel.rgba = StereoVision::IO::PtColor<GenericAttribute>{castLike(_colorPrototype->r, grid.colorSums[4*s]/n),
+                                                                         castLike(_colorPrototype->g, grid.colorSums[4*s+1]/n),
+                                                                         castLike(_colorPrototype->b, grid.colorSums[4*s+2]/n),
+                                                                         castLike(_colorPrototype->a, grid.colorSums[4*s+3]/n)};
+            }
+
+            voxel.attributes.resize(_schema.size());
+
+            for (int i = 0; i < nAttributes; i++) {
+
+                int64_t n = grid.attributeCounts[nAttributes*s+i];
+
+                if (n > 0) {
+                    int attributeIdx = numericIdxs[i];
+                    voxel.attributes[attributeIdx] = castLike(_attributePrototypes[attributeIdx].value(), grid.attributeSums[nAttributes*s+i]/n);
+                }
+            }
+        }
+
+    } else {
+
+        //the voxels are replaced by the point nearest to their centroid.
+        std::vector<double> bestDistances(nVoxels, std::numeric_limits<double>::infinity());
+
+        std::vector<SpooledPoint> batch;
+        std::vector<int64_t> slots;
+        std::vector<double> distances;
+
+        bool more = secondPass->hasData();
+
+        while (more) {
+
+            batch.clear();
+
+            while (more and batch.size() < batchSize) {
+                batch.push_back(secondPass->currentPoint());
+                more = secondPass->gotoNext();
+            }
+
+            int64_t nPoints = batch.size();
+            slots.assign(nPoints, -1);
+            distances.resize(nPoints);
+
+            #pragma omp parallel for schedule(static)
+            for (int64_t i = 0; i < nPoints; i++) {
+
+                std::array<double, 3> position = {batch[i].xyz.x, batch[i].xyz.y, batch[i].xyz.z};
+                VoxelIndex idx;
+
+                if (!voxelIndex(position.data(), voxelSize, idx)) {
+                    continue;
+                }
+
+                auto it = grid.slots.find(idx);
+
+                if (it == grid.slots.end()) {
+                    continue;
+                }
+
+                size_t s = it->second;
+                slots[i] = s;
+
+                double dx = position[0] - grid.centroid(s, 0);
+                double dy = position[1] - grid.centroid(s, 1);
+                double dz = position[2] - grid.centroid(s, 2);
+
+                distances[i] = dx*dx + dy*dy + dz*dz;
+            }
+
+            //in order, so that ties are resolved deterministically.
+            for (int64_t i = 0; i < nPoints; i++) {
+
+                if (slots[i] < 0 or distances[i] >= bestDistances[slots[i]]) {
+                    continue;
+                }
+
+                bestDistances[slots[i]] = distances[i];
+                voxels[slots[i]] = std::move(batch[i]);
+            }
+        }
+    }
+
+    //the voxels are output in morton order, to keep the output spatially coherent.
+    std::vector<size_t> order(nVoxels);
+    std::iota(order.begin(), order.end(), 0);
+
+    std::sort(order.begin(), order.end(), [&grid] (size_t s1, size_t s2) {
+
+        VoxelIndex const& i1 = grid.indices[s1];
+        VoxelIndex const& i2 = grid.indices[s2];
+
+        uint64_t k1 = i1.mortonKey();
+        uint64_t k2 = i2.mortonKey();
+
+        if (k1 != k2) {
+            return k1 < k2;
+        }
+
+        return std::tie(i1.x, i1.y, i1.z) < std::tie(i2.x, i2.y, i2.z);
+    });
+
+    _voxels.reserve(nVoxels);
+
+    for (size_t s : order) {
+        _voxels.push_back(std::move(voxels[s]));
+    }
+
+    return true;
+}
+
+StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> VoxelDownsampler::getPointPosition() const {
+    StereoVision::IO::PtGeometry<double> const& pos = _voxels[_currentIdx].xyz;
+    return StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute>{pos.x, pos.y, pos.z};
+}
+
+std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> VoxelDownsampler::getPointColor() const {
+    return _voxels[_currentIdx].rgba;
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> VoxelDownsampler::getAttributeById(int id) const {
+
+    if (id < 0 or id >= _schema.size()) {
+        return std::nullopt;
+    }
+
+    return _voxels[_currentIdx].attributes[id];
+}
+
+std::optional<StereoVision::IO::PointCloudGenericAttribute> VoxelDownsampler::getAttributeByName(const char* attributeName) const {
+
+    auto it = _schemaIdxs.find(attributeName);
+
+    if (it == _schemaIdxs.end()) {
+        return std::nullopt;
+    }
+
+    return getAttributeById(it->second);
+}
+
+std::vector<std::string> VoxelDownsampler::attributeList() const {
+    return _schema;
+}
+
+bool VoxelDownsampler::gotoNext() {
+
+    if (_currentIdx >= _voxels.size()) {
+        return false;
+    }
+
+    _currentIdx++;
+
+    if (_currentIdx < _voxels.size()) {
+        return true;
+    }
+
+    if (_spool == nullptr) {
+        return false;
+    }
+
+    return processNextTile();
+}
+
+bool VoxelDownsampler::hasData() const {
+    return _currentIdx < _voxels.size();
+}
@@ -0,0 +1,142 @@
+#ifndef VOXELDOWNSAMPLER_H
+#define VOXELDOWNSAMPLER_H
+
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+#include "../io/partitionspool.h"
+
+/*!
+ * \brief The VoxelDownsampler class keep a single point per voxel of a regular grid.
+ *
+ * Each voxel is replaced either by the centroid of its points, with the color and numeric attributes averaged
+ * (and cast back to their original type), or by the point nearest to the centroid, which keep its own color and attributes.
+ *
+ * The voxels are accumulated in a hash map keyed by the morton code of the voxel index. The points are read in batches,
+ * each batch is accumulated in parallel in partial grids (one per thread), which are merged at the end.
+ *
+ * If a tile size is given, the points are first spooled to disk in square tiles (aligned on the voxels), and the tiles are
+ * downsampled one after the other, so that only the voxels of a single tile are kept in memory.
+ * The nearest point representative need to read the points twice, so they are always spooled in this case.
+ *
+ * The output points are ordered by tile, then by morton code.
+ */
+class VoxelDownsampler : public StereoVision::IO::PointCloudPointAccessInterface
+{
+public:
+
+    enum Representative {
+        Centroid = 0,
+        NearestToCentroid = 1
+    };
+
+    /*!
+     * \brief setupVoxelDownsampler setup a voxel downsampling
+     * \param source a pointer to the source, will be moved to the output if return is not nullptr (or consumed if the points could not be spooled)
+     * \param voxelSize the size of the voxels, in the units of the point cloud.
+     * \param representative how each voxel is represented.
+     * \param tileSize the size of the tiles, in the units of the point cloud, if 0 or less the points are not tiled.
+     * \return a unique ptr to a PointCloudPointAccessInterface, or nullptr in case of error
+     */
+    static std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> setupVoxelDownsampler(
+            std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> & source,
+            double voxelSize,
+            Representative representative = Centroid,
+            double tileSize = 0);
+
+    /*!
+     * \brief parseRepresentative parse the name of a representative, either "centroid" or "nearest".
+     */
+    static std::optional<Representative> parseRepresentative(std::string const& name);
+
+    ~VoxelDownsampler();
+
+    virtual StereoVision::IO::PtGeometry<StereoVision::IO::PointCloudGenericAttribute> getPointPosition() const override;
+    virtual std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> getPointColor() const override;
+
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeById(int id) const override;
+    virtual std::optional<StereoVision::IO::PointCloudGenericAttribute> getAttributeByName(const char* attributeName) const override;
+
+    virtual std::vector<std::string> attributeList() const override;
+
+    virtual bool gotoNext() override;
+    virtual bool hasData() const override;
+
+    /*!
+     * \brief ok check that no tile failed to be read back, needs to be checked once all the points have been read,
+     * as a failure ends the point cloud early.
+     */
+    inline bool ok() const {
+        return !_failed;
+    }
+
+protected:
+
+    VoxelDownsampler(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source,
+                     double voxelSize,
+                     Representative representative,
+                     double tileSize);
+
+    /*!
+     * \brief downsample compute the voxels of a set of points.
+     * \param points the points, read until the end.
+     * \param secondPass the same points, used to find the points nearest to the centroids, nullptr for the centroid representative.
+     * \return true on success, false otherwise.
+     */
+    bool downsample(StereoVision::IO::PointCloudPointAccessInterface & points, PointSpoolReader* secondPass);
+
+    /*!
+     * \brief start downsample the points (or spool them and downsample the first tile).
+     * \return true on success, false otherwise.
+     */
+    bool start();
+
+    bool spoolTiles();
+    bool processNextTile();
+
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> _src;
+
+    double _voxelSize;
+    Representative _representative;
+    int64_t _voxelsPerTile; //!< 0 if the points are not tiled
+
+    std::vector<std::string> _schema;
+    std::map<std::string, int> _schemaIdxs;
+
+    //values of the first point, used to cast the averaged values back to their original types.
+    std::optional<StereoVision::IO::PtColor<StereoVision::IO::PointCloudGenericAttribute>> _colorPrototype;
+    std::vector<std::optional<StereoVision::IO::PointCloudGenericAttribute>> _attributePrototypes;
+
+    std::unique_ptr<PartitionSpool> _spool;
+    std::vector<std::string> _tileKeys;
+    size_t _nextTile;
+
+    std::vector<SpooledPoint> _voxels;
+    size_t _currentIdx;
+
+    bool _failed;
+};
+
+#endif // VOXELDOWNSAMPLER_H
@@ -0,0 +1,112 @@
+/*
+ * This file is part of the LidarDataManager tool.
+ * Copyright (c) 2025 Laurent Valentin Jospin <laurent.jospin@epfl.ch>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//the headers of Arrow need C++20, so this test is built separately from test_processing_blocks.cpp.
+
+#include <gtest/gtest.h>
+
+#include <StereoVision/io/pointcloud_io.h>
+
+#include "../io/arrowwriter.h"
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+
+#include <array>
+#include <random>
+
+using GenericCloud = StereoVision::IO::GenericPointCloud<float, float>;
+using GenericCloudHeaderInterface = StereoVision::IO::GenericPointCloudHeaderInterface<float, float>;
+using GenericCloudInterface = StereoVision::IO::GenericPointCloudPointAccessInterface<float, float>;
+
+TEST(ArrowWriterTest, TestWriteReadBack) {
+
+    constexpr int nPoints = 1024;
+    constexpr int batchSize = 100;
+    constexpr char const* attribute_name = "number";
+    constexpr std::array<int,2> attribute_options = {42, 69};
+
+    std::default_random_engine re;
+    std::uniform_real_distribution<float> points_dist(-1000, 1000);
+
+    GenericCloud testCloud;
+
+    for (int i = 0; i < nPoints; i++) {
+        GenericCloud::Point point;
+
+        point.xyz.x = points_dist(re);
+        point.xyz.y = points_dist(re);
+        point.xyz.z = points_dist(re);
+
+        point.rgba.r = 0;
+        point.rgba.g = 0;
+        point.rgba.b = 0;
+        point.rgba.a = 1;
+
+        testCloud.addPoint(point);
+    }
+
+    testCloud.addAttribute(attribute_name);
+
+    for (int i = 0; i < nPoints; i++) {
+        testCloud[i].attributes[attribute_name] = attribute_options[i%2];
+    }
+
+    StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+    pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(testCloud);
+    pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+    ASSERT_TRUE(ArrowIpc::writePointCloudArrow("test_points.arrow", pointCloudStack, batchSize));
+
+    auto file = arrow::io::ReadableFile::Open("test_points.arrow");
+    ASSERT_TRUE(file.ok());
+
+    auto reader = arrow::ipc::RecordBatchFileReader::Open(file.ValueUnsafe());
+    ASSERT_TRUE(reader.ok());
+
+    std::shared_ptr<arrow::Schema> schema = reader.ValueUnsafe()->schema();
+
+    //x, y, z, the four color channels and the attribute.
+    ASSERT_EQ(schema->num_fields(), 8);
+    EXPECT_EQ(schema->field(0)->type()->id(), arrow::Type::FLOAT);
+    ASSERT_EQ(reader.ValueUnsafe()->num_record_batches(), (nPoints + batchSize - 1)/batchSize);
+
+    int row = 0;
+
+    for (int b = 0; b < reader.ValueUnsafe()->num_record_batches(); b++) {
+
+        auto batch = reader.ValueUnsafe()->ReadRecordBatch(b);
+        ASSERT_TRUE(batch.ok());
+
+        auto x = std::static_pointer_cast<arrow::FloatArray>(batch.ValueUnsafe()->column(0));
+        auto attribute = batch.ValueUnsafe()->GetColumnByName(attribute_name);
+
+        ASSERT_NE(attribute, nullptr);
+        auto number = std::static_pointer_cast<arrow::Int32Array>(attribute);
+
+        for (int i = 0; i < batch.ValueUnsafe()->num_rows(); i++) {
+            EXPECT_EQ(x->Value(i), testCloud[row].xyz.x);
+            EXPECT_EQ(number->Value(i), attribute_options[row%2]);
+            row++;
+        }
+    }
+
+    EXPECT_EQ(row, nPoints);
+
+}
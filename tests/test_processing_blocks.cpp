@@ -20,9 +20,54 @@
 #include <StereoVision/io/pointcloud_io.h>
 #include <StereoVision/io/pcd_pointcloud_io.h>
 
+#include <proj.h>
+
+#include "../processingBlocks/aliasheaderattributes.h"
 #include "../processingBlocks/attributebasedselector.h"
+#include "../processingBlocks/boxtree.h"
+#include "../processingBlocks/kdtree.h"
+#include "../processingBlocks/mergedpointcloud.h"
+#include "../processingBlocks/nativecrspipeline.h"
+#include "../processingBlocks/attributesetbasedselector.h"
+#include "../processingBlocks/crsapproximation.h"
+#include "../processingBlocks/crsconversion.h"
+#include "../processingBlocks/crstransform.h"
+#include "../processingBlocks/duplicateremover.h"
+#include "../processingBlocks/groundclassifier.h"
+#include "../processingBlocks/outlierremover.h"
+#include "../processingBlocks/pointsorter.h"
+#include "../processingBlocks/progresscounter.h"
+#include "../processingBlocks/regionofinterestselector.h"
+#include "../processingBlocks/regionofinterestset.h"
+#include "../processingBlocks/spatialkeys.h"
+#include "../processingBlocks/stageprofiler.h"
+#include "../processingBlocks/staticpipeline.h"
+#include "../processingBlocks/voxeldownsampler.h"
+
+#include "../io/asciipointcloudreader.h"
+#include "../io/asciipointcloudwriter.h"
+#include "../io/ldmcpointcloud.h"
+#include "../io/partitionedwriter.h"
+#include "../io/partitionspool.h"
+#include "../io/plypointcloud.h"
+#include "../io/pointcloudinfo.h"
+#include "../io/pointcloudrasterizer.h"
+#include "../io/pointcloudwriter.h"
+#include "../io/streamio.h"
+#include "../io/syntheticpointcloud.h"
 
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <numeric>
 #include <random>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 using GenericCloud = StereoVision::IO::GenericPointCloud<float, float>;
 using GenericCloudHeaderInterface = StereoVision::IO::GenericPointCloudHeaderInterface<float, float>;
@@ -63,6 +108,37 @@ GenericCloud getRandomPointCloud(int nPoints) {
 
 }
 
+/*!
+ * \brief The UnwritableTemporaryDirectory class point the temporary directory to /proc (where no directory can be created)
+ * while it is in scope, to test the failures of the stages spooling points to disk.
+ */
+class UnwritableTemporaryDirectory {
+public:
+    UnwritableTemporaryDirectory() {
+
+        char const* tmpDir = std::getenv("TMPDIR");
+        _hadTmpDir = tmpDir != nullptr;
+
+        if (_hadTmpDir) {
+            _previousTmpDir = tmpDir;
+        }
+
+        setenv("TMPDIR", "/proc", 1);
+    }
+
+    ~UnwritableTemporaryDirectory() {
+        if (_hadTmpDir) {
+            setenv("TMPDIR", _previousTmpDir.c_str(), 1);
+        } else {
+            unsetenv("TMPDIR");
+        }
+    }
+
+protected:
+    bool _hadTmpDir;
+    std::string _previousTmpDir;
+};
+
 class PointCloudTest : public testing::Test {
 protected:
     static constexpr int nPoints = 1024;
@@ -127,6 +203,2940 @@ TEST_F(PointCloudTest, TestAttributeBasedSelector) {
 
 }
 
+TEST_F(PointCloudTest, TestMergedPointCloud) {
+
+    std::vector<std::string> files = {"test_merge_0.pcd", "test_merge_1.pcd"};
+
+    for (std::string const& file : files) {
+
+        StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+        pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(testCloud);
+        pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+        bool ok = StereoVision::IO::writePointCloudPcd(std::filesystem::path(file),
+                                                       pointCloudStack,
+                                                       StereoVision::IO::PcdDataStorageType::binary);
+
+        ASSERT_TRUE(ok);
+    }
+
+    int64_t expected = 0;
+
+    StereoVision::IO::FullPointCloudAccessInterface merged = MergedPointCloud::setupMergedPointCloud(files, "", &expected);
+
+    ASSERT_NE(merged.headerAccess, nullptr);
+    ASSERT_NE(merged.pointAccess, nullptr);
+
+    int count = 0;
+
+    bool hasMore = true;
+
+    do {
+
+        auto attr = merged.pointAccess->getAttributeByName(filter_attribute_name);
+
+        ASSERT_TRUE(attr.has_value());
+        ASSERT_EQ(StereoVision::IO::castedPointCloudAttribute<int>(attr.value()),
+                  filter_attribute_options[count%2]);
+
+        count++;
+
+        hasMore = merged.pointAccess->gotoNext();
+
+    } while (hasMore);
+
+    ASSERT_EQ(count, files.size()*nPoints);
+
+}
+
+TEST_F(PointCloudTest, TestMergedPointCloudLazySources) {
+
+    constexpr int nFiles = 3;
+
+    std::vector<std::string> files;
+
+    for (int f = 0; f < nFiles; f++) {
+
+        GenericCloud part;
+        part.addAttribute(filter_attribute_name);
+
+        for (int i = f; i < nPoints; i += nFiles) {
+            part.addPoint(testCloud[i]);
+        }
+
+        StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+        pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(part);
+        pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(part);
+
+        files.push_back("test_merge_" + std::to_string(f) + ".ldmc");
+        ASSERT_TRUE(Ldmc::writePointCloudLdmc(files.back(), pointCloudStack));
+    }
+
+    StereoVision::IO::FullPointCloudAccessInterface merged = MergedPointCloud::setupMergedPointCloud(files, "");
+
+    ASSERT_NE(merged.headerAccess, nullptr);
+    ASSERT_NE(merged.pointAccess, nullptr);
+
+    //the sources are read in order, each one being opened when the previous one ends.
+    std::vector<int> order;
+
+    for (int f = 0; f < nFiles; f++) {
+        for (int i = f; i < nPoints; i += nFiles) {
+            order.push_back(i);
+        }
+    }
+
+    int count = 0;
+
+    do {
+
+        ASSERT_LT(count, nPoints);
+
+        auto position = merged.pointAccess->castedPointGeometry<float>();
+        auto attr = merged.pointAccess->getAttributeByName(filter_attribute_name);
+
+        EXPECT_EQ(position.x, testCloud[order[count]].xyz.x);
+        ASSERT_TRUE(attr.has_value());
+        EXPECT_EQ(StereoVision::IO::castedPointCloudAttribute<int>(attr.value()), filter_attribute_options[order[count]%2]);
+
+        count++;
+
+    } while (merged.pointAccess->gotoNext());
+
+    EXPECT_EQ(count, nPoints);
+    EXPECT_TRUE(static_cast<MergedPointCloud const*>(merged.pointAccess.get())->ok());
+
+    //a source removed after the setup ends the points, and is reported.
+    merged = MergedPointCloud::setupMergedPointCloud(files, "");
+    ASSERT_NE(merged.pointAccess, nullptr);
+
+    std::filesystem::remove(files.back());
+
+    count = 0;
+
+    do {
+        count++;
+    } while (merged.pointAccess->gotoNext());
+
+    EXPECT_LT(count, nPoints);
+    EXPECT_FALSE(static_cast<MergedPointCloud const*>(merged.pointAccess.get())->ok());
+
+    for (std::string const& file : files) {
+        std::filesystem::remove(file);
+    }
+
+}
+
+TEST(MergedPointCloudTest, TestConvertedSourcesBounds) {
+
+    std::vector<std::unique_ptr<StereoVision::IO::PointCloudHeaderInterface>> headers;
+
+    headers.push_back(std::make_unique<AliasHeaderAttributes>(nullptr, AliasHeaderAttributes::AliasMap{{"minX", 0.}, {"maxX", 10.}, {"maxZ", 5.}, {"name", std::string("a")}}));
+    headers.push_back(std::make_unique<AliasHeaderAttributes>(nullptr, AliasHeaderAttributes::AliasMap{{"minX", -5.}, {"maxX", 20.}, {"name", std::string("b")}}));
+
+    //without conversion, the bounds are reduced.
+    MergedPointCloudHeader sameCrs(headers, {false, false}, "EPSG:2056");
+
+    ASSERT_TRUE(sameCrs.getAttributeByName("minX").has_value());
+    EXPECT_EQ(StereoVision::IO::castedPointCloudAttribute<double>(sameCrs.getAttributeByName("minX").value()), -5);
+    EXPECT_EQ(StereoVision::IO::castedPointCloudAttribute<double>(sameCrs.getAttributeByName("maxX").value()), 20);
+
+    //the bounds of a converted source are in another crs, the merged bounds are dropped.
+    MergedPointCloudHeader converted(headers, {false, true}, "EPSG:2056");
+
+    EXPECT_FALSE(converted.getAttributeByName("minX").has_value());
+    EXPECT_FALSE(converted.getAttributeByName("maxX").has_value());
+    ASSERT_TRUE(converted.getAttributeByName("maxZ").has_value());
+    ASSERT_TRUE(converted.getAttributeByName("name").has_value());
+    EXPECT_EQ(StereoVision::IO::castedPointCloudAttribute<std::string>(converted.getAttributeByName("name").value()), "a");
+
+    std::vector<std::string> attributes = converted.attributeList();
+    EXPECT_EQ(std::count(attributes.begin(), attributes.end(), "minX"), 0);
+    EXPECT_EQ(std::count(attributes.begin(), attributes.end(), "crs"), 1);
+
+}
+
+TEST_F(PointCloudTest, TestPartitionedWriter) {
+
+    StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+    pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(testCloud);
+    pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+    std::optional<PartitionedWriter::PartitionFunction> partitionFunction =
+            PartitionedWriter::parsePartitionDefinition(filter_attribute_name);
+
+    ASSERT_TRUE(partitionFunction.has_value());
+
+    //use a single open file, to exercise the file handles recycling.
+    PartitionedWriter writer("test_partition.pcd", partitionFunction.value(), 1, 64);
+
+    std::map<std::string, int> counts;
+
+    bool ok = writer.write(pointCloudStack, [&counts] (std::filesystem::path const& path,
+                           StereoVision::IO::FullPointCloudAccessInterface & partition) {
+
+        int& count = counts[path.filename().string()];
+
+        do {
+
+            auto attr = partition.pointAccess->getAttributeByName(filter_attribute_name);
+
+            if (!attr.has_value()) {
+                return false;
+            }
+
+            count++;
+
+        } while (partition.pointAccess->gotoNext());
+
+        return true;
+    });
+
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(counts.size(), filter_attribute_options.size());
+
+    for (int option : filter_attribute_options) {
+        std::string key = std::string(filter_attribute_name) + "_" + std::to_string(option);
+        std::string filename = PartitionedWriter::partitionPath("test_partition.pcd", key).filename().string();
+        ASSERT_EQ(counts[filename], nPoints/filter_attribute_options.size());
+    }
+
+}
+
+TEST(PartitionSpoolTest, TestBoundedMemory) {
+
+    constexpr int nPartitions = 4096;
+    constexpr int nPointsPerPartition = 8;
+    constexpr size_t maxBufferedBytes = 1 << 16;
+
+    PartitionSpool spool(PartitionSpool::temporarySpoolDir("test"), 16, 1 << 18, maxBufferedBytes);
+
+    std::string record;
+
+    //the points are dispatched round robin, so that no partition ever fills its own buffer.
+    for (int i = 0; i < nPointsPerPartition; i++) {
+        for (int p = 0; p < nPartitions; p++) {
+
+            SpooledPoint point;
+            point.xyz = StereoVision::IO::PtGeometry<double>{double(p), double(i), 0};
+
+            record.clear();
+            PointSpool::appendRecord(record, point);
+
+            ASSERT_TRUE(spool.append(std::to_string(p), record));
+            ASSERT_LE(spool.bufferedBytes(), maxBufferedBytes);
+        }
+    }
+
+    ASSERT_TRUE(spool.flush());
+    ASSERT_EQ(spool.bufferedBytes(), 0);
+    ASSERT_EQ(spool.keys().size(), nPartitions);
+
+    for (int p = 0; p < nPartitions; p += 511) {
+
+        std::unique_ptr<PointSpoolReader> reader = spool.openPartition(std::to_string(p), {});
+        ASSERT_NE(reader, nullptr);
+
+        int nRead = 0;
+        bool hasMore = reader->hasData();
+
+        while (hasMore) {
+            EXPECT_EQ(reader->currentPoint().xyz.x, p);
+            EXPECT_EQ(reader->currentPoint().xyz.y, nRead);
+            nRead++;
+            hasMore = reader->gotoNext();
+        }
+
+        EXPECT_EQ(nRead, nPointsPerPartition);
+    }
+
+}
+
+TEST_F(PointCloudTest, TestAsciiWriter) {
+
+    StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+    pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(testCloud);
+    pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+    //use small chunks, so that the points are dispatched to multiple chunks and batches.
+    bool ok = AsciiPointCloud::writePointCloudAscii("test_ascii.csv", pointCloudStack, AsciiPointCloud::Format::Csv, 100);
+
+    ASSERT_TRUE(ok);
+
+    std::ifstream in("test_ascii.csv");
+    ASSERT_TRUE(in.is_open());
+
+    std::string line;
+    ASSERT_TRUE(std::getline(in, line));
+    ASSERT_EQ(line, std::string("x,y,z,r,g,b,") + filter_attribute_name);
+
+    int nLines = 0;
+
+    while (std::getline(in, line)) {
+
+        ASSERT_LT(nLines, nPoints);
+
+        std::istringstream lineStream(line);
+        std::array<float, 6> values;
+        int attribute;
+        char separator;
+
+        for (float & value : values) {
+            lineStream >> value >> separator;
+        }
+
+        lineStream >> attribute;
+
+        ASSERT_FALSE(lineStream.fail());
+
+        //the shortest representation should read back to the exact same value.
+        EXPECT_EQ(values[0], testCloud[nLines].xyz.x);
+        EXPECT_EQ(values[1], testCloud[nLines].xyz.y);
+        EXPECT_EQ(values[2], testCloud[nLines].xyz.z);
+        EXPECT_EQ(values[3], testCloud[nLines].rgba.r);
+        EXPECT_EQ(attribute, filter_attribute_options[nLines%2]);
+
+        nLines++;
+    }
+
+    ASSERT_EQ(nLines, nPoints);
+
+    pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+    ok = AsciiPointCloud::writePointCloudAscii("test_ascii.pcd", pointCloudStack, AsciiPointCloud::Format::PcdAscii, 100);
+
+    ASSERT_TRUE(ok);
+
+    std::ifstream pcd("test_ascii.pcd");
+    ASSERT_TRUE(pcd.is_open());
+
+    int64_t width = -1;
+    int64_t points = -1;
+
+    while (std::getline(pcd, line) and line.rfind("DATA", 0) != 0) {
+
+        std::istringstream lineStream(line);
+        std::string key;
+        lineStream >> key;
+
+        if (key == "WIDTH") {
+            lineStream >> width;
+        } else if (key == "POINTS") {
+            lineStream >> points;
+        }
+    }
+
+    EXPECT_EQ(width, nPoints);
+    EXPECT_EQ(points, nPoints);
+
+    //the columns come from the attributes of the point cloud, not only from those of the first point.
+    GenericCloud sparse;
+    sparse.addAttribute("first");
+    sparse.addAttribute("second");
+
+    for (int i = 0; i < 2; i++) {
+        GenericCloud::Point point;
+        point.xyz.x = point.xyz.y = point.xyz.z = i;
+        point.rgba.r = point.rgba.g = point.rgba.b = point.rgba.a = 0.5;
+        point.attributes["first"] = i;
+
+        if (i > 0) {
+            point.attributes["second"] = 2*i;
+        }
+
+        sparse.addPoint(point);
+    }
+
+    pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(sparse);
+
+    std::ostringstream sparseCsv;
+    ASSERT_TRUE(AsciiPointCloud::writePointCloudAscii(sparseCsv, pointCloudStack, AsciiPointCloud::Format::Csv));
+
+    EXPECT_EQ(sparseCsv.str(), "x,y,z,r,g,b,first,second\n0,0,0,0.5,0.5,0.5,0,\n1,1,1,0.5,0.5,0.5,1,2\n");
+
+}
+
+TEST_F(PointCloudTest, TestStreamedOutput) {
+
+    for (std::string const& format : {"csv", "xyz", "pcd-ascii"}) {
+
+        ASSERT_TRUE(isStreamableFormat(format));
+
+        StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+        pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(testCloud);
+        pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+        std::string fileName = "test_streamed." + format;
+        ASSERT_TRUE(writePointCloud(fileName, pointCloudStack, format));
+
+        pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+        std::ostringstream streamed;
+        ASSERT_TRUE(writePointCloud(streamed, pointCloudStack, format));
+
+        std::ifstream in(fileName, std::ios_base::binary);
+        std::string written((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        EXPECT_EQ(streamed.str(), written);
+    }
+
+    //the formats patching their header need a seekable file.
+    EXPECT_FALSE(isStreamableFormat("ply"));
+    EXPECT_FALSE(isStreamableFormat("lasv14"));
+
+    //the header of an ascii pcd is written after the existing content of the output, with the exact number of points.
+    StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+    pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(testCloud);
+    pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+    std::stringstream pcd;
+    pcd << "prefix\n";
+
+    ASSERT_TRUE(AsciiPointCloud::writePointCloudAscii(pcd, pointCloudStack, AsciiPointCloud::Format::PcdAscii));
+
+    EXPECT_EQ(pcd.str().rfind("prefix\n", 0), 0);
+
+    EXPECT_NE(pcd.str().find("\nWIDTH " + std::to_string(nPoints) + "\n"), std::string::npos);
+    EXPECT_NE(pcd.str().find("\nPOINTS " + std::to_string(nPoints) + "\n"), std::string::npos);
+
+}
+
+TEST_F(PointCloudTest, TestAsciiReader) {
+
+    for (AsciiPointCloud::Format format : {AsciiPointCloud::Format::Csv, AsciiPointCloud::Format::PcdAscii}) {
+
+        std::string fileName = (format == AsciiPointCloud::Format::Csv) ? "test_ascii_reader.csv" : "test_ascii_reader.pcd";
+
+        StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+        pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(testCloud);
+        pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+        ASSERT_TRUE(AsciiPointCloud::writePointCloudAscii(fileName, pointCloudStack, format));
+
+        std::optional<AsciiPointCloud::Format> detectedFormat = AsciiPointCloud::formatFromPath(fileName);
+
+        ASSERT_TRUE(detectedFormat.has_value());
+        ASSERT_EQ(detectedFormat.value(), format);
+
+        //use small blocks, so that the file is split in multiple blocks and batches.
+        std::unique_ptr<AsciiPointCloudReader> reader = AsciiPointCloudReader::setupAsciiPointCloudReader(fileName, format, 512);
+
+        ASSERT_NE(reader, nullptr);
+        ASSERT_TRUE(reader->hasData());
+
+        int nRead = 0;
+
+        do {
+
+            ASSERT_LT(nRead, nPoints);
+
+            auto position = reader->castedPointGeometry<float>();
+            auto color = reader->castedPointColor<float>();
+            auto attribute = reader->getAttributeByName(filter_attribute_name);
+
+            EXPECT_EQ(position.x, testCloud[nRead].xyz.x);
+            EXPECT_EQ(position.y, testCloud[nRead].xyz.y);
+            EXPECT_EQ(position.z, testCloud[nRead].xyz.z);
+
+            ASSERT_TRUE(color.has_value());
+            EXPECT_EQ(color->g, testCloud[nRead].rgba.g);
+
+            ASSERT_TRUE(attribute.has_value());
+            EXPECT_EQ(StereoVision::IO::castedPointCloudAttribute<int>(attribute.value()), filter_attribute_options[nRead%2]);
+
+            nRead++;
+
+        } while (reader->gotoNext());
+
+        EXPECT_EQ(nRead, nPoints);
+        EXPECT_FALSE(reader->hasData());
+    }
+
+}
+
+TEST(AsciiPointCloudTest, TestFormatDetection) {
+
+    struct Case {
+        std::string content;
+        std::optional<AsciiPointCloud::Format> format;
+    };
+
+    //files without extension, as the spooled standard input.
+    std::vector<Case> cases = {
+        {"1 2 3\n4 5 6\n", AsciiPointCloud::Format::Xyz},
+        {"# comment\n\n1\t2 3 4\n", AsciiPointCloud::Format::Xyz},
+        {"1,2,3\n4,5,6\n", AsciiPointCloud::Format::Csv},
+        {"1;2;3\n4;5;6\n", AsciiPointCloud::Format::Csv},
+        {"x,y,z,intensity\n1,2,3,4\n", AsciiPointCloud::Format::Csv},
+        {"\"X\";\"Y\";\"Z\"\r\n1.5;2;3e2\r\n", AsciiPointCloud::Format::Csv},
+        {"VERSION .7\nFIELDS x y z\nDATA ascii\n1 2 3\n", AsciiPointCloud::Format::PcdAscii},
+        {"VERSION .7\nFIELDS x y z\nDATA binary\n", std::nullopt},
+        {"x,y,z\n1,2\n", std::nullopt},
+        {"x,y,z\n1;2;3\n", std::nullopt},
+        {"x,y\n1,2\n", std::nullopt},
+        {"x,y,z\nu,v,w\n", std::nullopt},
+        {"1 2\n", std::nullopt},
+        {"", std::nullopt}
+    };
+
+    for (Case const& testCase : cases) {
+
+        {
+            std::ofstream file("test_ascii_detection", std::ios_base::binary);
+            file << testCase.content;
+        }
+
+        std::optional<AsciiPointCloud::Format> format = AsciiPointCloud::formatFromPath("test_ascii_detection");
+
+        EXPECT_EQ(format, testCase.format) << testCase.content;
+
+        if (!format.has_value() or format.value() == AsciiPointCloud::Format::PcdAscii) {
+            continue;
+        }
+
+        //the detected files can be read.
+        std::optional<StereoVision::IO::FullPointCloudAccessInterface> pointCloud = AsciiPointCloud::openPointCloudAscii("test_ascii_detection");
+
+        ASSERT_TRUE(pointCloud.has_value()) << testCase.content;
+        ASSERT_TRUE(pointCloud->pointAccess->hasData()) << testCase.content;
+        EXPECT_EQ(pointCloud->pointAccess->castedPointGeometry<double>().y, 2) << testCase.content;
+    }
+}
+
+TEST_F(PointCloudTest, TestPlyReadWrite) {
+
+    StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+    pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(testCloud);
+    pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+    ASSERT_TRUE(Ply::writePointCloudPly("test_ply.ply", pointCloudStack));
+
+    std::unique_ptr<PlyPointCloudReader> reader = PlyPointCloudReader::setupPlyPointCloudReader("test_ply.ply");
+
+    ASSERT_NE(reader, nullptr);
+    ASSERT_EQ(reader->numberOfVertices(), nPoints);
+
+    std::vector<std::string> attributes = reader->attributeList();
+
+    ASSERT_EQ(attributes.size(), 1);
+    ASSERT_EQ(attributes[0], filter_attribute_name);
+
+    int nRead = 0;
+
+    do {
+
+        ASSERT_LT(nRead, nPoints);
+
+        auto position = reader->getPointPosition();
+        auto color = reader->castedPointColor<float>();
+        auto attribute = reader->getAttributeByName(filter_attribute_name);
+
+        //the types of the properties are preserved.
+        ASSERT_TRUE(std::holds_alternative<float>(position.x));
+        EXPECT_EQ(std::get<float>(position.x), testCloud[nRead].xyz.x);
+        EXPECT_EQ(std::get<float>(position.y), testCloud[nRead].xyz.y);
+        EXPECT_EQ(std::get<float>(position.z), testCloud[nRead].xyz.z);
+
+        ASSERT_TRUE(color.has_value());
+        EXPECT_EQ(color->b, testCloud[nRead].rgba.b);
+        EXPECT_EQ(color->a, testCloud[nRead].rgba.a);
+
+        ASSERT_TRUE(attribute.has_value());
+        EXPECT_EQ(StereoVision::IO::castedPointCloudAttribute<int>(attribute.value()), filter_attribute_options[nRead%2]);
+
+        nRead++;
+
+    } while (reader->gotoNext());
+
+    EXPECT_EQ(nRead, nPoints);
+    EXPECT_FALSE(reader->hasData());
+
+}
+
+TEST_F(PointCloudTest, TestLdmcReadWrite) {
+
+    constexpr int chunkSize = 100;
+    constexpr int nChunks = (nPoints + chunkSize - 1)/chunkSize;
+
+    std::vector<bool> compressOptions = {false};
+
+    if (Ldmc::compressionAvailable()) {
+        compressOptions.push_back(true);
+    }
+
+    for (bool compress : compressOptions) {
+
+        StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+        pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(testCloud);
+        pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+        ASSERT_TRUE(Ldmc::writePointCloudLdmc("test_points.ldmc", pointCloudStack, compress, chunkSize));
+
+        std::unique_ptr<LdmcPointCloudReader> reader = LdmcPointCloudReader::setupLdmcPointCloudReader("test_points.ldmc");
+
+        ASSERT_NE(reader, nullptr);
+        ASSERT_EQ(reader->numberOfPoints(), nPoints);
+        ASSERT_EQ(reader->chunkStatistics().size(), nChunks);
+
+        Ldmc::ChunkStatistics const& firstChunk = reader->chunkStatistics()[0];
+
+        ASSERT_EQ(firstChunk.columns.count(filter_attribute_name), 1);
+        EXPECT_EQ(firstChunk.columns.at(filter_attribute_name).min, filter_attribute_options[0]);
+        EXPECT_EQ(firstChunk.columns.at(filter_attribute_name).max, filter_attribute_options[1]);
+        EXPECT_EQ(firstChunk.columns.at(filter_attribute_name).count, chunkSize);
+
+        std::vector<std::string> attributes = reader->attributeList();
+
+        ASSERT_EQ(attributes.size(), 1);
+        ASSERT_EQ(attributes[0], filter_attribute_name);
+
+        //skip the odd chunks.
+        int chunkIdx = 0;
+
+        reader->addChunkPredicate([&chunkIdx] (Ldmc::ChunkStatistics const&) {
+            return (chunkIdx++)%2 == 0;
+        });
+
+        int nRead = 0;
+        int expectedRead = 0;
+
+        for (int i = 0; i < nPoints; i++) {
+            if ((i/chunkSize)%2 == 0) {
+                expectedRead++;
+            }
+        }
+
+        do {
+
+            ASSERT_LT(nRead, expectedRead);
+
+            int pointIdx = (nRead/chunkSize)*2*chunkSize + nRead%chunkSize;
+
+            auto position = reader->getPointPosition();
+            auto color = reader->castedPointColor<float>();
+            auto attribute = reader->getAttributeByName(filter_attribute_name);
+
+            ASSERT_TRUE(std::holds_alternative<float>(position.x));
+            EXPECT_EQ(std::get<float>(position.x), testCloud[pointIdx].xyz.x);
+            EXPECT_EQ(std::get<float>(position.y), testCloud[pointIdx].xyz.y);
+            EXPECT_EQ(std::get<float>(position.z), testCloud[pointIdx].xyz.z);
+
+            ASSERT_TRUE(color.has_value());
+            EXPECT_EQ(color->b, testCloud[pointIdx].rgba.b);
+            EXPECT_EQ(color->a, testCloud[pointIdx].rgba.a);
+
+            ASSERT_TRUE(attribute.has_value());
+            EXPECT_EQ(StereoVision::IO::castedPointCloudAttribute<int>(attribute.value()), filter_attribute_options[pointIdx%2]);
+
+            nRead++;
+
+        } while (reader->gotoNext());
+
+        EXPECT_EQ(nRead, expectedRead);
+        EXPECT_EQ(reader->numberOfSkippedChunks(), nChunks/2);
+        EXPECT_FALSE(reader->hasData());
+    }
+
+}
+
+TEST_F(PointCloudTest, TestLdmcCorruptChunk) {
+
+    if (!Ldmc::compressionAvailable()) {
+        GTEST_SKIP() << "zstd is not available, the chunks cannot be corrupted without breaking the file layout.";
+    }
+
+    constexpr int chunkSize = 100;
+    constexpr int nChunks = (nPoints + chunkSize - 1)/chunkSize;
+
+    StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+    pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(testCloud);
+    pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+    ASSERT_TRUE(Ldmc::writePointCloudLdmc("test_corrupt.ldmc", pointCloudStack, true, chunkSize));
+
+    std::string data;
+
+    {
+        std::ifstream in("test_corrupt.ldmc", std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    //the segments are zstd frames, in the order of the chunks, the first frame of the second chunk gets a corrupt magic number.
+    std::string const zstdMagic = "\x28\xB5\x2F\xFD";
+    std::vector<size_t> frames;
+
+    for (size_t pos = data.find(zstdMagic); pos != std::string::npos; pos = data.find(zstdMagic, pos+1)) {
+        frames.push_back(pos);
+    }
+
+    ASSERT_EQ(frames.size()%nChunks, 0);
+
+    data[frames[frames.size()/nChunks]] = 0;
+
+    {
+        std::ofstream out("test_corrupt.ldmc", std::ios::binary);
+        out.write(data.data(), data.size());
+    }
+
+    std::unique_ptr<LdmcPointCloudReader> reader = LdmcPointCloudReader::setupLdmcPointCloudReader("test_corrupt.ldmc");
+
+    ASSERT_NE(reader, nullptr);
+    EXPECT_TRUE(reader->ok());
+
+    int nRead = 0;
+
+    do {
+        nRead++;
+    } while (reader->gotoNext());
+
+    //the points end at the corrupt chunk, and the failure is reported.
+    EXPECT_EQ(nRead, chunkSize);
+    EXPECT_FALSE(reader->hasData());
+    EXPECT_FALSE(reader->ok());
+
+}
+
+TEST(LdmcTest, TestChunkPredicates) {
+
+    Ldmc::ChunkStatistics statistics;
+    statistics.nPoints = 10;
+    statistics.columns["x"] = {0, 1, 10};
+    statistics.columns["y"] = {0, 1, 10};
+    statistics.columns["z"] = {0, 1, 10};
+    statistics.columns["lineNumber"] = {3, 5, 10};
+
+    StereoVision::Geometry::AffineTransform<double> world2rect;
+
+    //region centered in (2,2,2), with half extents of 0.5 or 1.5.
+    world2rect.t << -2, -2, -2;
+
+    EXPECT_FALSE(Ldmc::boxPredicate(world2rect, {0.5, 0.5, 0.5})(statistics));
+    EXPECT_TRUE(Ldmc::boxPredicate(world2rect, {1.5, 1.5, 1.5})(statistics));
+
+    EXPECT_FALSE(Ldmc::valueSetPredicate("lineNumber", {1, 2, 6})(statistics));
+    EXPECT_TRUE(Ldmc::valueSetPredicate("lineNumber", {1, 4, 6})(statistics));
+    EXPECT_TRUE(Ldmc::valueSetPredicate("missing", {1})(statistics));
+
+    EXPECT_FALSE(Ldmc::maxValuePredicate("lineNumber", 2)(statistics));
+    EXPECT_TRUE(Ldmc::maxValuePredicate("lineNumber", 3)(statistics));
+
+    //with missing values, the points without the attribute are selected by the line selection.
+    statistics.columns["lineNumber"].count = 5;
+    EXPECT_TRUE(Ldmc::valueSetPredicate("lineNumber", {1, 2, 6})(statistics));
+
+}
+
+/*!
+ * \brief readAll read a file descriptor (e.g. the read end of a pipe) until the end of the stream.
+ */
+std::string readAll(int fd) {
+
+    std::string data;
+    std::array<char, 4096> buffer;
+
+    ssize_t n;
+
+    while ((n = ::read(fd, buffer.data(), buffer.size())) > 0) {
+        data.append(buffer.data(), n);
+    }
+
+    return data;
+}
+
+TEST(MemorySpoolTest, TestPipeRoundTrip) {
+
+    //more than the capacity of a pipe, and not a multiple of the copy buffer.
+    std::string data(3*(1 << 20) + 12345, '\0');
+
+    std::default_random_engine re(7);
+    std::uniform_int_distribution<int> bytes(0, 255);
+
+    for (char & c : data) {
+        c = static_cast<char>(bytes(re));
+    }
+
+    std::optional<MemorySpool> spool = MemorySpool::create("test-spool");
+
+    ASSERT_TRUE(spool.has_value());
+
+    //from a pipe, as the standard input.
+    std::array<int, 2> inPipe;
+    ASSERT_EQ(::pipe(inPipe.data()), 0);
+
+    std::thread writer([&data, fd = inPipe[1]] () {
+
+        size_t written = 0;
+
+        while (written < data.size()) {
+
+            ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+
+            if (n <= 0) {
+                break;
+            }
+
+            written += n;
+        }
+
+        ::close(fd);
+    });
+
+    bool filled = spool->fillFrom(inPipe[0]);
+
+    writer.join();
+    ::close(inPipe[0]);
+
+    ASSERT_TRUE(filled);
+
+    //the spool is rewound, and can be read as a regular file from its path.
+    {
+        std::ifstream file(spool->path(), std::ios_base::binary);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        EXPECT_EQ(content.size(), data.size());
+        EXPECT_TRUE(content == data);
+    }
+
+    //to a pipe, as the standard output.
+    std::array<int, 2> outPipe;
+    ASSERT_EQ(::pipe(outPipe.data()), 0);
+
+    std::string received;
+
+    std::thread reader([&received, fd = outPipe[0]] () {
+        received = readAll(fd);
+    });
+
+    bool copied = spool->copyTo(outPipe[1]);
+
+    ::close(outPipe[1]);
+    reader.join();
+    ::close(outPipe[0]);
+
+    ASSERT_TRUE(copied);
+    EXPECT_EQ(received.size(), data.size());
+    EXPECT_TRUE(received == data);
+
+    //sendfile cannot write to a file opened in append mode, so the buffered copy is used.
+    int appendFd = ::open("test_spool_append", O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+
+    ASSERT_GE(appendFd, 0);
+
+    copied = spool->copyTo(appendFd);
+    ::close(appendFd);
+
+    ASSERT_TRUE(copied);
+
+    {
+        std::ifstream file("test_spool_append", std::ios_base::binary);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        EXPECT_EQ(content.size(), data.size());
+        EXPECT_TRUE(content == data);
+    }
+}
+
+TEST_F(PointCloudTest, TestOpenPointCloudByContent) {
+
+    using Writer = std::function<bool(std::filesystem::path const&, StereoVision::IO::FullPointCloudAccessInterface &)>;
+
+    std::vector<std::pair<std::string, Writer>> writers = {
+        {"ply", [] (std::filesystem::path const& path, StereoVision::IO::FullPointCloudAccessInterface & stack) {
+             return Ply::writePointCloudPly(path, stack);
+         }},
+        {"ldmc", [] (std::filesystem::path const& path, StereoVision::IO::FullPointCloudAccessInterface & stack) {
+             return Ldmc::writePointCloudLdmc(path, stack);
+         }},
+        {"csv", [] (std::filesystem::path const& path, StereoVision::IO::FullPointCloudAccessInterface & stack) {
+             return AsciiPointCloud::writePointCloudAscii(path, stack, AsciiPointCloud::Format::Csv);
+         }},
+        {"xyz", [] (std::filesystem::path const& path, StereoVision::IO::FullPointCloudAccessInterface & stack) {
+             return AsciiPointCloud::writePointCloudAscii(path, stack, AsciiPointCloud::Format::Xyz);
+         }},
+        {"pcd", [] (std::filesystem::path const& path, StereoVision::IO::FullPointCloudAccessInterface & stack) {
+             return AsciiPointCloud::writePointCloudAscii(path, stack, AsciiPointCloud::Format::PcdAscii);
+         }}
+    };
+
+    for (auto const& [format, writer] : writers) {
+
+        //without extension, as the spooled standard input.
+        std::filesystem::path path = "test_by_content_" + format;
+
+        StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+        pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(testCloud);
+        pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+        ASSERT_TRUE(writer(path, pointCloudStack)) << format;
+
+        StatusOptional<StereoVision::IO::FullPointCloudAccessInterface> opened = openPointCloudByContent(path);
+
+        ASSERT_TRUE(opened.has_value()) << format << ": " << opened.message();
+        ASSERT_NE(opened.value().pointAccess, nullptr) << format;
+
+        StereoVision::IO::PointCloudPointAccessInterface & points = *opened.value().pointAccess;
+
+        int nRead = 0;
+        bool hasMore = points.hasData();
+
+        while (hasMore) {
+
+            ASSERT_LT(nRead, nPoints) << format;
+
+            auto position = points.castedPointGeometry<float>();
+
+            EXPECT_NEAR(position.x, testCloud[nRead].xyz.x, 1e-3) << format;
+            EXPECT_NEAR(position.z, testCloud[nRead].xyz.z, 1e-3) << format;
+
+            nRead++;
+            hasMore = points.gotoNext();
+        }
+
+        EXPECT_EQ(nRead, nPoints) << format;
+    }
+}
+
+TEST(VoxelDownsamplerTest, TestRepresentatives) {
+
+    using Point = GenericCloud::Point;
+
+    constexpr double voxelSize = 2;
+    constexpr std::array<float,3> offsets = {0.2, 1.0, 1.6};
+    constexpr std::array<int,3> numbers = {42, 69, 42};
+
+    //three points along the diagonal of each voxel of a 4x4x2 grid, with negative indices.
+    GenericCloud cloud;
+    cloud.addAttribute("number");
+
+    for (int ix = -2; ix < 2; ix++) {
+        for (int iy = -2; iy < 2; iy++) {
+            for (int iz = 0; iz < 2; iz++) {
+                for (int i = 0; i < 3; i++) {
+                    Point point;
+                    point.xyz.x = voxelSize*ix + offsets[i];
+                    point.xyz.y = voxelSize*iy + offsets[i];
+                    point.xyz.z = voxelSize*iz + offsets[i];
+                    point.rgba.r = point.rgba.g = point.rgba.b = point.rgba.a = 0.5;
+                    point.attributes["number"] = numbers[i];
+                    cloud.addPoint(point);
+                }
+            }
+        }
+    }
+
+    constexpr int nVoxels = 32;
+    constexpr double centroidOffset = (offsets[0] + offsets[1] + offsets[2])/3;
+
+    auto checkVoxels = [&] (VoxelDownsampler::Representative representative, double tileSize) {
+
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> source =
+                std::make_unique<GenericCloudInterface>(cloud);
+
+        auto downsampled = VoxelDownsampler::setupVoxelDownsampler(source, voxelSize, representative, tileSize);
+        ASSERT_NE(downsampled, nullptr);
+
+        double expectedOffset = (representative == VoxelDownsampler::Centroid) ? centroidOffset : offsets[1];
+        int expectedNumber = (representative == VoxelDownsampler::Centroid) ? 51 : numbers[1];
+
+        std::set<std::array<int,3>> voxels;
+
+        bool hasMore = downsampled->hasData();
+
+        while (hasMore) {
+
+            auto pos = downsampled->castedPointGeometry<double>();
+            std::array<int,3> voxel = {int(std::floor(pos.x/voxelSize)),
+                                       int(std::floor(pos.y/voxelSize)),
+                                       int(std::floor(pos.z/voxelSize))};
+
+            EXPECT_NEAR(pos.x - voxelSize*voxel[0], expectedOffset, 1e-5);
+            EXPECT_NEAR(pos.y - voxelSize*voxel[1], expectedOffset, 1e-5);
+            EXPECT_NEAR(pos.z - voxelSize*voxel[2], expectedOffset, 1e-5);
+
+            auto number = downsampled->getAttributeByName("number");
+            EXPECT_TRUE(number.has_value());
+
+            if (number.has_value()) {
+                EXPECT_EQ(StereoVision::IO::castedPointCloudAttribute<int>(number.value()), expectedNumber);
+            }
+
+            EXPECT_TRUE(voxels.insert(voxel).second) << "voxel returned twice";
+
+            hasMore = downsampled->gotoNext();
+        }
+
+        EXPECT_EQ(voxels.size(), nVoxels);
+        EXPECT_TRUE(static_cast<VoxelDownsampler*>(downsampled.get())->ok());
+    };
+
+    checkVoxels(VoxelDownsampler::Centroid, 0);
+    checkVoxels(VoxelDownsampler::NearestToCentroid, 0);
+
+    //tiles of 2x2 voxels.
+    checkVoxels(VoxelDownsampler::Centroid, 2*voxelSize);
+    checkVoxels(VoxelDownsampler::NearestToCentroid, 2*voxelSize);
+
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> source =
+            std::make_unique<GenericCloudInterface>(cloud);
+    EXPECT_EQ(VoxelDownsampler::setupVoxelDownsampler(source, 0), nullptr);
+
+    //the tiles cannot be spooled, which is reported by the setup.
+    UnwritableTemporaryDirectory unwritable;
+    EXPECT_EQ(VoxelDownsampler::setupVoxelDownsampler(source, voxelSize, VoxelDownsampler::Centroid, 2*voxelSize), nullptr);
+
+}
+
+TEST(PointSorterTest, TestOrders) {
+
+    using Point = GenericCloud::Point;
+
+    //the hilbert curve visit all the cells of a 16x16x16 block before leaving it, moving to an adjacent cell at each step.
+    std::map<uint64_t, std::array<int, 3>> curve;
+
+    for (int x = 0; x < 16; x++) {
+        for (int y = 0; y < 16; y++) {
+            for (int z = 0; z < 16; z++) {
+                curve[SpatialKeys::hilbert3d(x, y, z)] = {x, y, z};
+            }
+        }
+    }
+
+    ASSERT_EQ(curve.size(), 4096);
+    EXPECT_EQ(curve.rbegin()->first, 4095);
+
+    for (auto it = std::next(curve.begin()); it != curve.end(); it++) {
+        std::array<int, 3> const& previous = std::prev(it)->second;
+        std::array<int, 3> const& cell = it->second;
+        EXPECT_EQ(std::abs(cell[0] - previous[0]) + std::abs(cell[1] - previous[1]) + std::abs(cell[2] - previous[2]), 1);
+    }
+
+    constexpr int nPoints = 5000;
+
+    std::default_random_engine re(42);
+    std::uniform_real_distribution<float> positionDist(0, 20);
+
+    std::vector<int> times(nPoints);
+    std::iota(times.begin(), times.end(), 0);
+    std::shuffle(times.begin(), times.end(), re);
+
+    //some points are duplicated, to check that the sort is stable.
+    GenericCloud cloud;
+    cloud.addAttribute("gpsTime");
+    cloud.addAttribute("index");
+
+    for (int i = 0; i < nPoints; i++) {
+        Point point;
+
+        if (i%10 == 9) {
+            point.xyz = cloud[i-1].xyz;
+        } else {
+            point.xyz.x = positionDist(re);
+            point.xyz.y = positionDist(re);
+            point.xyz.z = positionDist(re);
+        }
+
+        point.rgba.r = point.rgba.g = point.rgba.b = point.rgba.a = 0.5;
+        point.attributes["gpsTime"] = times[i];
+        point.attributes["index"] = i;
+        cloud.addPoint(point);
+    }
+
+    auto sortedIndices = [&cloud] (PointSorter::Order order, size_t memoryLimit, int & nRuns) {
+
+        std::vector<int> ret;
+
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> source =
+                std::make_unique<GenericCloudInterface>(cloud);
+
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> sorted =
+                PointSorter::setupPointSorter(source, order, memoryLimit);
+
+        PointSorter* sorter = dynamic_cast<PointSorter*>(sorted.get());
+
+        EXPECT_NE(sorter, nullptr);
+
+        if (sorter == nullptr) {
+            return ret;
+        }
+
+        nRuns = sorter->numberOfRuns();
+
+        std::vector<std::string> schema = sorted->attributeList();
+        uint64_t previousKey = 0;
+
+        bool hasMore = sorted->hasData();
+
+        while (hasMore) {
+
+            SpooledPoint point = SpooledPoint::fromInterface(*sorted, schema);
+            uint64_t key = sorter->key(point);
+
+            int index = StereoVision::IO::castedPointCloudAttribute<int>(sorted->getAttributeByName("index").value());
+
+            EXPECT_GE(key, previousKey);
+
+            if (!ret.empty() and key == previousKey) {
+                EXPECT_GT(index, ret.back());
+            }
+
+            previousKey = key;
+            ret.push_back(index);
+
+            hasMore = sorted->gotoNext();
+        }
+
+        return ret;
+    };
+
+    for (PointSorter::Order order : {PointSorter::Morton, PointSorter::Hilbert, PointSorter::GpsTime}) {
+
+        int nRuns = -1;
+
+        std::vector<int> inMemory = sortedIndices(order, PointSorter::DefaultMemoryLimit, nRuns);
+
+        EXPECT_EQ(nRuns, 0);
+        ASSERT_EQ(inMemory.size(), nPoints);
+
+        //runs of a few hundred points, merged in multiple passes.
+        std::vector<int> spilled = sortedIndices(order, 1 << 16, nRuns);
+
+        EXPECT_GT(nRuns, PointSorter::MaxMergedRuns/8);
+        EXPECT_EQ(spilled, inMemory);
+
+        std::vector<int> indices = inMemory;
+        std::sort(indices.begin(), indices.end());
+
+        for (int i = 0; i < nPoints; i++) {
+            ASSERT_EQ(indices[i], i);
+        }
+
+        if (order == PointSorter::GpsTime) {
+            for (int i = 0; i < nPoints; i++) {
+                EXPECT_EQ(times[inMemory[i]], i);
+            }
+        }
+    }
+
+    //no gps time to sort on.
+    GenericCloud untimed = getRandomPointCloud(10);
+
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> source = std::make_unique<GenericCloudInterface>(untimed);
+    EXPECT_EQ(PointSorter::setupPointSorter(source, PointSorter::GpsTime), nullptr);
+    EXPECT_EQ(PointSorter::setupPointSorter(source, PointSorter::Morton, 1 << 20, 0), nullptr);
+
+    //the runs cannot be spilled, which is reported by the setup.
+    UnwritableTemporaryDirectory unwritable;
+
+    source = std::make_unique<GenericCloudInterface>(cloud);
+    EXPECT_EQ(PointSorter::setupPointSorter(source, PointSorter::Morton, 1 << 16), nullptr);
+}
+
+TEST(PointSorterTest, TestLargeExtent) {
+
+    using Point = GenericCloud::Point;
+
+    //300km along the x axis, which is more than 2^21 cells of the default size.
+    constexpr int nPoints = 301;
+
+    std::vector<int> xs(nPoints);
+    std::iota(xs.begin(), xs.end(), 0);
+
+    std::default_random_engine re(42);
+    std::shuffle(xs.begin(), xs.end(), re);
+
+    GenericCloud cloud;
+
+    for (int x : xs) {
+        Point point;
+        point.xyz.x = 1000.0*x;
+        point.xyz.y = 0;
+        point.xyz.z = 0;
+        point.rgba.r = point.rgba.g = point.rgba.b = point.rgba.a = 0.5;
+        cloud.addPoint(point);
+    }
+
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> source =
+            std::make_unique<GenericCloudInterface>(cloud);
+
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> sorted =
+            PointSorter::setupPointSorter(source, PointSorter::Morton);
+
+    PointSorter* sorter = dynamic_cast<PointSorter*>(sorted.get());
+
+    ASSERT_NE(sorter, nullptr);
+    EXPECT_GT(sorter->cellSize(), PointSorter::DefaultCellSize);
+
+    //the morton order of cells on a line along x is the order of x, the keys would wrap around on the original cells.
+    std::vector<double> sortedXs;
+
+    for (bool hasMore = sorted->hasData(); hasMore; hasMore = sorted->gotoNext()) {
+        sortedXs.push_back(sorted->castedPointGeometry<double>().x);
+    }
+
+    ASSERT_EQ(sortedXs.size(), nPoints);
+    EXPECT_TRUE(std::is_sorted(sortedXs.begin(), sortedXs.end()));
+}
+
+TEST(DuplicateRemoverTest, TestDuplicates) {
+
+    using Point = GenericCloud::Point;
+
+    constexpr double tolerance = 0.01;
+
+    //a 10x10x10 grid of points, with negative coordinates, in the middle of their cells.
+    GenericCloud cloud;
+    cloud.addAttribute("gpsTime");
+    cloud.addAttribute("index");
+
+    int nPoints = 0;
+
+    for (int ix = -5; ix < 5; ix++) {
+        for (int iy = -5; iy < 5; iy++) {
+            for (int iz = 0; iz < 10; iz++) {
+                Point point;
+                point.xyz.x = ix + tolerance/2;
+                point.xyz.y = iy + tolerance/2;
+                point.xyz.z = iz + tolerance/2;
+                point.rgba.r = point.rgba.g = point.rgba.b = point.rgba.a = 0.5;
+                point.attributes["gpsTime"] = 10*nPoints;
+                point.attributes["index"] = nPoints++;
+                cloud.addPoint(point);
+            }
+        }
+    }
+
+    constexpr int nUnique = 1000;
+
+    int nExactCopies = 0;
+    int nNearCopies = 0;
+
+    //exact copies, with the same gps time, and near copies, acquired later.
+    for (int i = 0; i < nUnique; i++) {
+
+        if (i%3 == 2) {
+            continue;
+        }
+
+        Point point = cloud[i];
+        point.attributes["index"] = nPoints++;
+
+        if (i%3 == 0) {
+            nExactCopies++;
+        } else {
+            point.xyz.x += tolerance/5;
+            point.attributes["gpsTime"] = 10*i + 5;
+            nNearCopies++;
+        }
+
+        cloud.addPoint(point);
+    }
+
+    //the points without a position are always kept.
+    for (int i = 0; i < 2; i++) {
+        Point point;
+        point.xyz.x = point.xyz.y = point.xyz.z = std::numeric_limits<float>::quiet_NaN();
+        point.rgba.r = point.rgba.g = point.rgba.b = point.rgba.a = 0.5;
+        point.attributes["gpsTime"] = 0;
+        point.attributes["index"] = nPoints++;
+        cloud.addPoint(point);
+    }
+
+    auto keptIndices = [&cloud] (double timeTolerance, double tileSize, int64_t & nDuplicates) {
+
+        std::set<int> ret;
+
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> source =
+                std::make_unique<GenericCloudInterface>(cloud);
+
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> deduplicated =
+                DuplicateRemover::setupDuplicateRemover(source, tolerance, timeTolerance, tileSize);
+
+        DuplicateRemover* remover = dynamic_cast<DuplicateRemover*>(deduplicated.get());
+
+        EXPECT_NE(remover, nullptr);
+
+        if (remover == nullptr) {
+            return ret;
+        }
+
+        bool hasMore = deduplicated->hasData();
+
+        while (hasMore) {
+            int index = StereoVision::IO::castedPointCloudAttribute<int>(deduplicated->getAttributeByName("index").value());
+            EXPECT_TRUE(ret.insert(index).second) << "point returned twice";
+            hasMore = deduplicated->gotoNext();
+        }
+
+        nDuplicates = remover->numberOfDuplicates();
+        EXPECT_TRUE(remover->ok());
+
+        return ret;
+    };
+
+    for (double tileSize : {0.0, 2.0}) {
+
+        int64_t nDuplicates = -1;
+
+        std::set<int> kept = keptIndices(-1, tileSize, nDuplicates);
+
+        EXPECT_EQ(kept.size(), nUnique + 2);
+        EXPECT_EQ(nDuplicates, nExactCopies + nNearCopies);
+
+        //the first point of each cell is kept.
+        for (int i = 0; i < nUnique; i++) {
+            EXPECT_EQ(kept.count(i), 1);
+        }
+
+        //the near copies are in another gps time interval.
+        kept = keptIndices(1, tileSize, nDuplicates);
+
+        EXPECT_EQ(kept.size(), nUnique + nNearCopies + 2);
+        EXPECT_EQ(nDuplicates, nExactCopies);
+        EXPECT_EQ(kept.size() + nDuplicates, nPoints);
+    }
+
+    GenericCloud untimed = getRandomPointCloud(10);
+
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> source = std::make_unique<GenericCloudInterface>(untimed);
+    EXPECT_EQ(DuplicateRemover::setupDuplicateRemover(source, tolerance, 1), nullptr);
+    EXPECT_EQ(DuplicateRemover::setupDuplicateRemover(source, 0), nullptr);
+
+    //the tiles cannot be spooled, which is reported by the setup.
+    UnwritableTemporaryDirectory unwritable;
+    EXPECT_EQ(DuplicateRemover::setupDuplicateRemover(source, tolerance, 0, 2), nullptr);
+}
+
+TEST(KdTreeTest, TestQueries) {
+
+    std::default_random_engine re(42);
+    std::uniform_real_distribution<double> dist(-10, 10);
+
+    std::vector<std::array<double, 3>> points(2000);
+
+    for (std::array<double, 3> & point : points) {
+        point = {dist(re), dist(re), dist(re)};
+    }
+
+    KdTree tree(points);
+
+    constexpr int k = 7;
+    constexpr double radius = 2;
+
+    std::vector<KdTree::Neighbor> neighbors;
+
+    for (int q = 0; q < 50; q++) {
+
+        std::vector<double> distances;
+        int64_t inRadius = 0;
+
+        for (int i = 0; i < points.size(); i++) {
+
+            if (i == q) {
+                continue;
+            }
+
+            double dx = points[i][0] - points[q][0];
+            double dy = points[i][1] - points[q][1];
+            double dz = points[i][2] - points[q][2];
+            double d2 = dx*dx + dy*dy + dz*dz;
+
+            distances.push_back(d2);
+            inRadius += (d2 <= radius*radius) ? 1 : 0;
+        }
+
+        std::sort(distances.begin(), distances.end());
+
+        tree.nearestNeighbors(points[q].data(), k, neighbors, q);
+
+        ASSERT_EQ(neighbors.size(), k);
+
+        for (int i = 0; i < k; i++) {
+            EXPECT_EQ(neighbors[i].squaredDistance, distances[i]);
+            EXPECT_NE(neighbors[i].index, q);
+        }
+
+        EXPECT_EQ(tree.countInRadius(points[q].data(), radius, points.size(), q), inRadius);
+        EXPECT_EQ(tree.countInRadius(points[q].data(), radius, 3, q), std::min<int64_t>(3, inRadius));
+    }
+
+}
+
+TEST(BoxTreeTest, TestQueries) {
+
+    std::default_random_engine re(42);
+    std::uniform_real_distribution<double> centerDist(-100, 100);
+    std::uniform_real_distribution<double> sizeDist(0.1, 10);
+
+    std::vector<BoxTree::Box> boxes(1000);
+
+    for (BoxTree::Box & box : boxes) {
+        for (int i = 0; i < 3; i++) {
+            double center = centerDist(re);
+            double halfSize = sizeDist(re);
+            box.min[i] = center - halfSize;
+            box.max[i] = center + halfSize;
+        }
+    }
+
+    BoxTree tree(boxes);
+
+    EXPECT_EQ(tree.size(), boxes.size());
+
+    std::vector<int64_t> found;
+    int64_t nFound = 0;
+
+    for (int q = 0; q < 2000; q++) {
+
+        std::array<double, 3> position = {centerDist(re), centerDist(re), centerDist(re)/20};
+
+        //the corner of a box is inside.
+        if (q%10 == 0) {
+            position = boxes[q].max;
+        }
+
+        tree.query(position.data(), found);
+
+        std::vector<int64_t> expected;
+
+        for (int64_t i = 0; i < boxes.size(); i++) {
+            if (boxes[i].contains(position.data())) {
+                expected.push_back(i);
+            }
+        }
+
+        EXPECT_EQ(found, expected);
+        nFound += found.size();
+    }
+
+    EXPECT_GT(nFound, 0);
+
+    BoxTree empty;
+    empty.query(boxes[0].min.data(), found);
+    EXPECT_TRUE(found.empty());
+}
+
+TEST(OutlierRemoverTest, TestMethods) {
+
+    using Point = GenericCloud::Point;
+
+    //a flat 20x20 grid with a spacing of 0.5, spread over tiles of 2x2, and a few isolated points above and below it.
+    constexpr int gridSize = 20;
+    constexpr double spacing = 0.5;
+    const std::vector<std::array<float,3>> outliers = {{0.1, 0.1, 30}, {-3.9, 4.1, -20}, {2.05, -2.0, 15}};
+
+    GenericCloud cloud;
+    cloud.addAttribute("outlier");
+
+    for (int i = 0; i < gridSize; i++) {
+        for (int j = 0; j < gridSize; j++) {
+            Point point;
+            point.xyz.x = (i - gridSize/2)*spacing + spacing/2;
+            point.xyz.y = (j - gridSize/2)*spacing + spacing/2;
+            point.xyz.z = 0;
+            point.attributes["outlier"] = 0;
+            cloud.addPoint(point);
+        }
+    }
+
+    for (std::array<float,3> const& pos : outliers) {
+        Point point;
+        point.xyz.x = pos[0];
+        point.xyz.y = pos[1];
+        point.xyz.z = pos[2];
+        point.attributes["outlier"] = 1;
+        cloud.addPoint(point);
+    }
+
+    constexpr int64_t nPoints = gridSize*gridSize;
+
+    auto filter = [&cloud] (OutlierRemover::Parameters const& parameters, int64_t & nKept, int64_t & nOutliersKept, int64_t & nRemoved) {
+
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> source =
+                std::make_unique<GenericCloudInterface>(cloud);
+
+        auto filtered = OutlierRemover::setupOutlierRemover(source, parameters);
+        ASSERT_NE(filtered, nullptr);
+
+        nKept = 0;
+        nOutliersKept = 0;
+
+        bool hasMore = filtered->hasData();
+
+        while (hasMore) {
+
+            auto outlier = filtered->getAttributeByName("outlier");
+            ASSERT_TRUE(outlier.has_value());
+
+            nKept++;
+            nOutliersKept += StereoVision::IO::castedPointCloudAttribute<int>(outlier.value());
+
+            hasMore = filtered->gotoNext();
+        }
+
+        nRemoved = static_cast<OutlierRemover*>(filtered.get())->numberOfRemovedPoints();
+        EXPECT_TRUE(static_cast<OutlierRemover*>(filtered.get())->ok());
+    };
+
+    int64_t nKept;
+    int64_t nOutliersKept;
+    int64_t nRemoved;
+
+    OutlierRemover::Parameters parameters;
+    parameters.tileSize = 2;
+
+    //with the radius method, only the points on the border of the grid have less than 4 neighbors,
+    //the points on the border of the tiles have their neighbors in the halo.
+    parameters.method = OutlierRemover::Radius;
+    parameters.radius = 0.6;
+    parameters.minNeighbors = 4;
+
+    filter(parameters, nKept, nOutliersKept, nRemoved);
+
+    EXPECT_EQ(nOutliersKept, 0);
+    EXPECT_EQ(nKept, (gridSize-2)*(gridSize-2));
+    EXPECT_EQ(nKept + nRemoved, nPoints + outliers.size());
+
+    parameters.method = OutlierRemover::Statistical;
+    parameters.nNeighbors = 4;
+    parameters.sigma = 2;
+
+    filter(parameters, nKept, nOutliersKept, nRemoved);
+
+    EXPECT_EQ(nOutliersKept, 0);
+    EXPECT_GE(nKept, nPoints*95/100);
+    EXPECT_EQ(nKept + nRemoved, nPoints + outliers.size());
+
+    parameters.nNeighbors = 0;
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> source =
+            std::make_unique<GenericCloudInterface>(cloud);
+    EXPECT_EQ(OutlierRemover::setupOutlierRemover(source, parameters), nullptr);
+
+    //the tiles cannot be spooled, which is reported by the setup.
+    UnwritableTemporaryDirectory unwritable;
+
+    parameters.nNeighbors = 4;
+    EXPECT_EQ(OutlierRemover::setupOutlierRemover(source, parameters), nullptr);
+
+}
+
+TEST(OutlierRemoverTest, TestIsolatedPointInOwnTile) {
+
+    using Point = GenericCloud::Point;
+
+    //a flat grid with a spacing of 1 filling the tile [0, 100)x[0, 100), and a point alone in the next tile,
+    //with only the grid points of its halo around it.
+    constexpr int gridSize = 100;
+
+    GenericCloud cloud;
+    cloud.addAttribute("outlier");
+
+    for (int i = 0; i < gridSize; i++) {
+        for (int j = 0; j < gridSize; j++) {
+            Point point;
+            point.xyz.x = i + 0.5;
+            point.xyz.y = j + 0.5;
+            point.xyz.z = 0;
+            point.attributes["outlier"] = 0;
+            cloud.addPoint(point);
+        }
+    }
+
+    Point isolated;
+    isolated.xyz.x = 105;
+    isolated.xyz.y = 50;
+    isolated.xyz.z = 20;
+    isolated.attributes["outlier"] = 1;
+    cloud.addPoint(isolated);
+
+    OutlierRemover::Parameters parameters;
+    parameters.method = OutlierRemover::Statistical;
+    parameters.nNeighbors = 8;
+    parameters.sigma = 2;
+    parameters.tileSize = 100;
+
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> source =
+            std::make_unique<GenericCloudInterface>(cloud);
+
+    auto filtered = OutlierRemover::setupOutlierRemover(source, parameters);
+    ASSERT_NE(filtered, nullptr);
+
+    int64_t nKept = 0;
+    int64_t nOutliersKept = 0;
+
+    bool hasMore = filtered->hasData();
+
+    while (hasMore) {
+
+        auto outlier = filtered->getAttributeByName("outlier");
+        ASSERT_TRUE(outlier.has_value());
+
+        nKept++;
+        nOutliersKept += StereoVision::IO::castedPointCloudAttribute<int>(outlier.value());
+
+        hasMore = filtered->gotoNext();
+    }
+
+    //the corners of the grid, with farther neighbors, can be removed too.
+    EXPECT_EQ(nOutliersKept, 0);
+    EXPECT_GE(nKept, gridSize*gridSize - 4);
+
+}
+
+TEST(GroundClassifierTest, TestTiledClassification) {
+
+    using Point = GenericCloud::Point;
+
+    enum Kind {
+        Ground = 0,
+        Object = 1,
+        Noise = 2
+    };
+
+    //a sloped terrain sampled every 0.5 units, with a 8x8 building, some vegetation and a noise point below the ground.
+    GenericCloud cloud;
+    cloud.addAttribute("id");
+    cloud.addAttribute("kind");
+    cloud.addAttribute("classification");
+
+    int nPoints = 0;
+
+    auto addPoint = [&cloud, &nPoints] (float x, float y, float z, Kind kind) {
+        Point point;
+        point.xyz.x = x;
+        point.xyz.y = y;
+        point.xyz.z = z;
+        point.attributes["id"] = static_cast<int32_t>(nPoints);
+        point.attributes["kind"] = static_cast<int32_t>(kind);
+        point.attributes["classification"] = static_cast<uint8_t>((kind == Noise) ? 7 : 0);
+        cloud.addPoint(point);
+        nPoints++;
+    };
+
+    for (int i = 0; i < 120; i++) {
+        for (int j = 0; j < 120; j++) {
+
+            float x = 0.5*i;
+            float y = 0.5*j;
+            float ground = 0.05*x + 0.02*y;
+
+            if (x >= 20 and x < 28 and y >= 20 and y < 28) {
+                addPoint(x, y, ground + 6, Object);
+                continue;
+            }
+
+            addPoint(x, y, ground, Ground);
+
+            if ((i*120 + j)%7 == 0) {
+                addPoint(x + 0.1, y + 0.1, ground + 3, Object);
+            }
+        }
+    }
+
+    addPoint(10, 10, -50, Noise);
+
+    auto classify = [&cloud, nPoints] (double tileSize, double haloSize, std::vector<int> & classes) {
+
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> source =
+                std::make_unique<GenericCloudInterface>(cloud);
+
+        GroundClassifier::Parameters parameters;
+        parameters.tileSize = tileSize;
+        parameters.haloSize = haloSize;
+
+        auto classified = GroundClassifier::setupGroundClassifier(source, parameters);
+        ASSERT_NE(classified, nullptr);
+
+        classes.assign(nPoints, -1);
+
+        bool hasMore = classified->hasData();
+
+        while (hasMore) {
+
+            auto id = classified->getAttributeByName("id");
+            auto classification = classified->getAttributeByName(GroundClassifier::ClassificationAttribute);
+
+            ASSERT_TRUE(id.has_value() and classification.has_value());
+
+            classes[StereoVision::IO::castedPointCloudAttribute<int>(id.value())] =
+                    StereoVision::IO::castedPointCloudAttribute<int>(classification.value());
+
+            hasMore = classified->gotoNext();
+        }
+    };
+
+    std::vector<int> tiledClasses;
+    std::vector<int> untiledClasses;
+    std::vector<int> enlargedClasses;
+
+    //a halo of 20 units is larger than the building, the default halo (63 units) larger than the tiles, which are then enlarged.
+    classify(20, 20, tiledClasses);
+    classify(1000, -1, untiledClasses);
+    classify(10, -1, enlargedClasses);
+
+    for (int i = 0; i < nPoints; i++) {
+
+        int kind = std::get<int32_t>(cloud[i].attributes["kind"]);
+        int expected = (kind == Ground) ? GroundClassifier::GroundClass : (kind == Object) ? GroundClassifier::UnclassifiedClass : 7;
+
+        EXPECT_EQ(tiledClasses[i], expected) << "point " << i;
+        EXPECT_EQ(untiledClasses[i], tiledClasses[i]) << "point " << i;
+        EXPECT_EQ(enlargedClasses[i], untiledClasses[i]) << "point " << i;
+    }
+
+}
+
+TEST(RasterizerTest, TestProducts) {
+
+    using Point = GenericCloud::Point;
+
+    std::optional<std::vector<PointCloudRasterizer::Product>> products =
+            PointCloudRasterizer::parseProducts("zmin,zmax,zmean,intensity,count,max:classification");
+
+    ASSERT_TRUE(products.has_value());
+    ASSERT_EQ(products->size(), 6);
+    EXPECT_EQ(products->back().name, "max_classification");
+
+    EXPECT_FALSE(PointCloudRasterizer::parseProducts("zmin,median").has_value());
+    EXPECT_FALSE(PointCloudRasterizer::parseProducts("").has_value());
+
+    GenericCloud cloud;
+    cloud.addAttribute("intensity");
+    cloud.addAttribute("classification");
+
+    auto addPoint = [&cloud] (float x, float y, float z, std::optional<int> intensity, int classification) {
+        Point point;
+        point.xyz.x = x;
+        point.xyz.y = y;
+        point.xyz.z = z;
+        if (intensity.has_value()) {
+            point.attributes["intensity"] = static_cast<uint16_t>(intensity.value());
+        }
+        point.attributes["classification"] = static_cast<uint8_t>(classification);
+        cloud.addPoint(point);
+    };
+
+    //cells of size 1, cell (0,0) has two points, cell (2,-1) one and cell (-1,1) one without intensity.
+    addPoint(0.2, 0.3, 1, 10, 2);
+    addPoint(0.7, 0.9, 3, 20, 5);
+    addPoint(2.5, -0.5, 5, 7, 1);
+    addPoint(-0.5, 1.5, 2, std::nullopt, 2);
+
+    GenericCloudInterface points(cloud);
+
+    PointCloudRasterizer rasterizer(1, products.value());
+    rasterizer.addPoints(points);
+
+    ASSERT_EQ(rasterizer.width(), 4);
+    ASSERT_EQ(rasterizer.height(), 3);
+    EXPECT_EQ(rasterizer.xMin(), -1);
+    EXPECT_EQ(rasterizer.yMin(), -1);
+
+    constexpr float noData = PointCloudRasterizer::NoData;
+
+    //column then row, the first row is the northernmost, at y = 1.
+    auto cell = [] (Multidim::Array<float, 2> const& grid, int cx, int cy) {
+        return grid.atUnchecked(cx + 1, 1 - cy);
+    };
+
+    Multidim::Array<float, 2> zmin = rasterizer.grid(0);
+    Multidim::Array<float, 2> zmax = rasterizer.grid(1);
+    Multidim::Array<float, 2> zmean = rasterizer.grid(2);
+    Multidim::Array<float, 2> intensity = rasterizer.grid(3);
+    Multidim::Array<float, 2> count = rasterizer.grid(4);
+    Multidim::Array<float, 2> classification = rasterizer.grid(5);
+
+    EXPECT_EQ(cell(zmin, 0, 0), 1);
+    EXPECT_EQ(cell(zmax, 0, 0), 3);
+    EXPECT_EQ(cell(zmean, 0, 0), 2);
+    EXPECT_EQ(cell(intensity, 0, 0), 15);
+    EXPECT_EQ(cell(count, 0, 0), 2);
+    EXPECT_EQ(cell(classification, 0, 0), 5);
+
+    EXPECT_EQ(cell(zmin, 2, -1), 5);
+    EXPECT_EQ(cell(intensity, 2, -1), 7);
+    EXPECT_EQ(cell(count, 2, -1), 1);
+
+    EXPECT_EQ(cell(zmax, -1, 1), 2);
+    EXPECT_EQ(cell(intensity, -1, 1), noData);
+    EXPECT_EQ(cell(count, -1, 1), 1);
+
+    EXPECT_EQ(cell(zmin, 1, 0), noData);
+    EXPECT_EQ(cell(count, 1, 0), 0);
+
+    std::filesystem::path base = std::filesystem::temp_directory_path() / "ldm_test_raster";
+    ASSERT_TRUE(rasterizer.writeEsriGrids(base));
+
+    std::filesystem::path flt = base;
+    flt += "_zmin.flt";
+    std::filesystem::path hdr = base;
+    hdr += "_zmin.hdr";
+
+    ASSERT_TRUE(std::filesystem::exists(flt));
+    ASSERT_TRUE(std::filesystem::exists(hdr));
+    EXPECT_EQ(std::filesystem::file_size(flt), 4*3*sizeof(float));
+
+    std::ifstream hdrFile(hdr);
+    std::stringstream hdrContent;
+    hdrContent << hdrFile.rdbuf();
+
+    EXPECT_NE(hdrContent.str().find("ncols 4\n"), std::string::npos);
+    EXPECT_NE(hdrContent.str().find("nrows 3\n"), std::string::npos);
+    EXPECT_NE(hdrContent.str().find("xllcorner -1\n"), std::string::npos);
+
+    for (PointCloudRasterizer::Product const& product : products.value()) {
+        std::filesystem::path path = base;
+        path += "_" + product.name;
+        std::filesystem::remove(path.string() + ".flt");
+        std::filesystem::remove(path.string() + ".hdr");
+    }
+
+}
+
+TEST_F(PointCloudTest, TestRasterizerCount) {
+
+    //enough points for the binning to be split between the threads.
+    GenericCloud cloud;
+
+    for (int i = 0; i < 50; i++) {
+        for (int p = 0; p < nPoints; p++) {
+            cloud.addPoint(testCloud[p]);
+        }
+    }
+
+    GenericCloudInterface points(cloud);
+
+    PointCloudRasterizer rasterizer(100, PointCloudRasterizer::parseProducts("count,zmax").value());
+    rasterizer.addPoints(points);
+
+    Multidim::Array<float, 2> count = rasterizer.grid(0);
+    Multidim::Array<float, 2> zmax = rasterizer.grid(1);
+
+    double total = 0;
+
+    for (int i = 0; i < count.shape()[0]; i++) {
+        for (int j = 0; j < count.shape()[1]; j++) {
+            total += count.atUnchecked(i, j);
+            EXPECT_EQ(count.atUnchecked(i, j) == 0, zmax.atUnchecked(i, j) == PointCloudRasterizer::NoData);
+        }
+    }
+
+    EXPECT_EQ(total, 50*nPoints);
+
+}
+
+TEST(RasterizerTest, TestGridCellsLimit) {
+
+    using Point = GenericCloud::Point;
+
+    GenericCloud cloud;
+
+    //two points 100 km apart, with cells of 1 unit.
+    for (float coord : {0.f, 1e5f}) {
+        Point point;
+        point.xyz.x = coord;
+        point.xyz.y = coord;
+        point.xyz.z = 0;
+        cloud.addPoint(point);
+    }
+
+    GenericCloudInterface points(cloud);
+
+    PointCloudRasterizer rasterizer(1, PointCloudRasterizer::parseProducts("zmax").value());
+    rasterizer.addPoints(points);
+
+    EXPECT_FALSE(rasterizer.fitsInMemory());
+
+    std::filesystem::path base = std::filesystem::temp_directory_path() / "ldm_test_raster_limit";
+    EXPECT_FALSE(rasterizer.writeEsriGrids(base));
+
+    std::filesystem::path flt = base;
+    flt += "_zmax.flt";
+    EXPECT_FALSE(std::filesystem::exists(flt));
+
+}
+
+TEST(PointCloudInfoTest, TestStatistics) {
+
+    using Point = GenericCloud::Point;
+
+    GenericCloud cloud;
+    cloud.addAttribute("returnNumber");
+    cloud.addAttribute("classification");
+    cloud.addAttribute("lineNumber");
+    cloud.addAttribute("intensity");
+
+    //enough points for the reduction to be split between batches and threads.
+    constexpr int nCloudPoints = 100000;
+
+    for (int i = 0; i < nCloudPoints; i++) {
+        Point point;
+        point.xyz.x = i%100;
+        point.xyz.y = -(i/100);
+        point.xyz.z = 0.5*(i%7);
+        point.attributes["returnNumber"] = static_cast<uint8_t>(1 + i%3);
+        point.attributes["classification"] = static_cast<uint8_t>((i%4 == 0) ? 2 : 1);
+        point.attributes["lineNumber"] = static_cast<int32_t>(i/50000);
+        if (i%2 == 0) {
+            point.attributes["intensity"] = static_cast<uint16_t>(i%1000);
+        }
+        cloud.addPoint(point);
+    }
+
+    GenericCloudInterface points(cloud);
+
+    PointCloudInfo info = PointCloudInfo::compute(points);
+
+    EXPECT_EQ(info.nPoints, nCloudPoints);
+
+    EXPECT_EQ(info.min[0], 0);
+    EXPECT_EQ(info.max[0], 99);
+    EXPECT_EQ(info.min[1], -(nCloudPoints/100 - 1));
+    EXPECT_EQ(info.max[1], 0);
+    EXPECT_EQ(info.min[2], 0);
+    EXPECT_EQ(info.max[2], 3);
+
+    ASSERT_EQ(info.attributes.size(), 4);
+    ASSERT_EQ(info.ranges.count("intensity"), 1);
+    EXPECT_EQ(info.ranges["intensity"].count, nCloudPoints/2);
+    EXPECT_EQ(info.ranges["intensity"].min, 0);
+    EXPECT_EQ(info.ranges["intensity"].max, 998);
+
+    ASSERT_EQ(info.returnsCounts.size(), 3);
+    EXPECT_EQ(info.returnsCounts[1] + info.returnsCounts[2] + info.returnsCounts[3], nCloudPoints);
+    EXPECT_EQ(info.returnsCounts[1], (nCloudPoints + 2)/3);
+
+    ASSERT_EQ(info.classesCounts.size(), 2);
+    EXPECT_EQ(info.classesCounts[2], nCloudPoints/4);
+
+    ASSERT_EQ(info.linesCounts.size(), 2);
+    EXPECT_EQ(info.linesCounts[0], 50000);
+    EXPECT_EQ(info.linesCounts[1], 50000);
+
+    //round trip through the sidecar format.
+    std::stringstream stream;
+    ASSERT_TRUE(info.write(stream));
+
+    std::optional<PointCloudInfo> read = PointCloudInfo::read(stream);
+
+    ASSERT_TRUE(read.has_value());
+    EXPECT_EQ(read->nPoints, info.nPoints);
+    EXPECT_EQ(read->min, info.min);
+    EXPECT_EQ(read->max, info.max);
+    EXPECT_EQ(read->attributes, info.attributes);
+    EXPECT_EQ(read->ranges["intensity"].max, info.ranges["intensity"].max);
+    EXPECT_EQ(read->returnsCounts, info.returnsCounts);
+    EXPECT_EQ(read->classesCounts, info.classesCounts);
+    EXPECT_EQ(read->linesCounts, info.linesCounts);
+
+    //a truncated sidecar is rejected.
+    std::string truncated = stream.str();
+    truncated.resize(truncated.size()/2);
+    std::istringstream truncatedStream(truncated);
+
+    EXPECT_FALSE(PointCloudInfo::read(truncatedStream).has_value());
+}
+
+TEST(PointCloudInfoTest, TestJsonEscape) {
+
+    EXPECT_EQ(PointCloudInfo::jsonEscape("plain/path.las"), "plain/path.las");
+    EXPECT_EQ(PointCloudInfo::jsonEscape("a \"quoted\" name"), "a \\\"quoted\\\" name");
+    EXPECT_EQ(PointCloudInfo::jsonEscape("C:\\data\\tile.las"), "C:\\\\data\\\\tile.las");
+    EXPECT_EQ(PointCloudInfo::jsonEscape("line\nbreak\ttab"), "line\\nbreak\\ttab");
+    EXPECT_EQ(PointCloudInfo::jsonEscape(std::string("bell\x07", 5)), "bell\\u0007");
+    EXPECT_EQ(PointCloudInfo::jsonEscape("éà"), "éà");
+
+    //the attribute names are escaped in the statistics.
+    PointCloudInfo info;
+    info.attributes = {"weird\"name"};
+
+    std::ostringstream json;
+    info.writeJson(json);
+
+    EXPECT_NE(json.str().find("\"weird\\\"name\":{\"count\":0}"), std::string::npos) << json.str();
+
+}
+
+TEST_F(PointCloudTest, TestPointCloudInfoSidecar) {
+
+    std::filesystem::path fileName = "test_point_cloud_info.csv";
+    std::filesystem::path sidecar = PointCloudInfo::sidecarPath(fileName);
+
+    std::filesystem::remove(sidecar);
+
+    StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+    pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(testCloud);
+    pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+    ASSERT_TRUE(AsciiPointCloud::writePointCloudAscii(fileName, pointCloudStack, AsciiPointCloud::Format::Csv));
+
+    bool fromSidecar = true;
+    std::optional<PointCloudInfo> computed = PointCloudInfo::forFile(fileName, &fromSidecar);
+
+    ASSERT_TRUE(computed.has_value());
+    EXPECT_FALSE(fromSidecar);
+    EXPECT_EQ(computed->nPoints, nPoints);
+    EXPECT_TRUE(std::filesystem::exists(sidecar));
+
+    std::optional<PointCloudInfo> cached = PointCloudInfo::forFile(fileName, &fromSidecar);
+
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_TRUE(fromSidecar);
+    EXPECT_EQ(cached->nPoints, nPoints);
+    EXPECT_EQ(cached->min, computed->min);
+    EXPECT_EQ(cached->max, computed->max);
+
+    //modifying the file invalidates the sidecar.
+    {
+        std::ofstream out(fileName, std::ios_base::app);
+        out << "\n";
+    }
+
+    EXPECT_FALSE(PointCloudInfo::fromSidecar(fileName).has_value());
+
+    std::filesystem::remove(sidecar);
+    std::filesystem::remove(fileName);
+}
+
+TEST(CrsApproximationTest, TestInterpolation) {
+
+    //spherical mercator, in meters, from geographic coordinates in degrees, undefined above 80 degrees of latitude.
+    constexpr double radius = 6378137;
+    constexpr double deg2rad = M_PI/180;
+
+    auto mercator = [] (StereoVision::IO::PtGeometry<double> & position) {
+
+        if (std::abs(position.y) > 80) {
+            position.x = HUGE_VAL;
+            position.y = HUGE_VAL;
+            position.z = HUGE_VAL;
+            return;
+        }
+
+        double lon = position.x*deg2rad;
+        double lat = position.y*deg2rad;
+
+        position.x = radius*lon;
+        position.y = radius*std::log(std::tan(M_PI/4 + lat/2));
+    };
+
+    constexpr double tolerance = 1e-3;
+
+    CrsApproximation approximation(mercator, tolerance, 1.0/400, 250);
+
+    std::default_random_engine re(42);
+    std::uniform_real_distribution<double> lonDist(6.5, 6.505);
+    std::uniform_real_distribution<double> latDist(46.5, 46.505);
+    std::uniform_real_distribution<double> heightDist(300, 700);
+
+    constexpr int nTestPoints = 100000;
+
+    double maxError = 0;
+
+    for (int i = 0; i < nTestPoints; i++) {
+
+        StereoVision::IO::PtGeometry<double> exact;
+        exact.x = lonDist(re);
+        exact.y = latDist(re);
+        exact.z = heightDist(re);
+
+        StereoVision::IO::PtGeometry<double> approximated = exact;
+
+        mercator(exact);
+        approximation.apply(approximated);
+
+        maxError = std::max({maxError,
+                             std::abs(exact.x - approximated.x),
+                             std::abs(exact.y - approximated.y),
+                             std::abs(exact.z - approximated.z)});
+    }
+
+    //the error is checked at the nodes of a regular lattice of each cell only, so a small margin is allowed.
+    EXPECT_LT(maxError, 2*tolerance);
+    EXPECT_EQ(approximation.numberOfInterpolatedPoints(), nTestPoints);
+    EXPECT_LT(approximation.numberOfExactSamples(), nTestPoints/10);
+
+    //close to the border of the domain, the cells cannot be interpolated and the points are converted exactly.
+    for (double lat : {79.9999, 80.5}) {
+
+        StereoVision::IO::PtGeometry<double> exact;
+        exact.x = 6.5001;
+        exact.y = lat;
+        exact.z = 500;
+
+        StereoVision::IO::PtGeometry<double> approximated = exact;
+
+        mercator(exact);
+        approximation.apply(approximated);
+
+        EXPECT_EQ(std::isfinite(approximated.y), std::isfinite(exact.y));
+
+        if (std::isfinite(exact.y)) {
+            EXPECT_NEAR(approximated.y, exact.y, tolerance);
+        }
+    }
+
+    EXPECT_EQ(approximation.numberOfExactPoints(), 2);
+}
+
+TEST(NativeCrsPipelineTest, TestAffinePipelines) {
+
+    auto apply = [] (StereoVision::Geometry::AffineTransform<double> const& transform, double x, double y, double z) {
+        return Eigen::Vector3d(transform*Eigen::Vector3d(x, y, z));
+    };
+
+    auto parseAffinePipeline = [] (std::string const& projString) -> std::optional<StereoVision::Geometry::AffineTransform<double>> {
+
+        std::optional<NativeCrsPipeline> pipeline = NativeCrsPipeline::parse(projString);
+
+        if (!pipeline.has_value() or !pipeline->isAffine()) {
+            return std::nullopt;
+        }
+
+        return pipeline->affine();
+    };
+
+    //geographic coordinates in degrees, lat lon order, to radians, lon lat order.
+    auto swapped = parseAffinePipeline("+proj=pipeline +step +proj=axisswap +order=2,1 +step +proj=unitconvert +xy_in=deg +xy_out=rad");
+
+    ASSERT_TRUE(swapped.has_value());
+
+    Eigen::Vector3d transformed = apply(swapped.value(), 46.5, 6.5, 500);
+
+    EXPECT_NEAR(transformed.x(), 6.5*M_PI/180, 1e-12);
+    EXPECT_NEAR(transformed.y(), 46.5*M_PI/180, 1e-12);
+    EXPECT_NEAR(transformed.z(), 500, 1e-12);
+
+    //a rotation of one arc second around z, in the position vector convention, rotates the points counterclockwise.
+    auto helmert = parseAffinePipeline("+proj=helmert +x=1 +y=2 +z=3 +rz=1 +s=1 +convention=position_vector");
+
+    ASSERT_TRUE(helmert.has_value());
+
+    transformed = apply(helmert.value(), 1e6, 0, 0);
+
+    double rz = M_PI/(180*3600);
+
+    EXPECT_NEAR(transformed.x(), 1e6*(1 + 1e-6) + 1, 1e-6);
+    EXPECT_NEAR(transformed.y(), 1e6*(1 + 1e-6)*rz + 2, 1e-6);
+    EXPECT_NEAR(transformed.z(), 3, 1e-6);
+
+    //the coordinate frame convention rotates the frame, i.e. the points clockwise.
+    auto coordinateFrame = parseAffinePipeline("+proj=helmert +rz=1 +convention=coordinate_frame +exact");
+
+    ASSERT_TRUE(coordinateFrame.has_value());
+
+    transformed = apply(coordinateFrame.value(), 1e6, 0, 0);
+
+    EXPECT_NEAR(transformed.y(), -1e6*std::sin(rz), 1e-6);
+
+    //a step followed by its inverse is the identity.
+    auto roundTrip = parseAffinePipeline("+proj=pipeline "
+                                         "+step +proj=helmert +x=-10 +y=20 +z=5 +rx=0.5 +ry=-2 +rz=1 +s=-3 +convention=position_vector "
+                                         "+step +proj=affine +xoff=100 +s11=2 +s12=0.5 +s22=3 +s33=0.5 "
+                                         "+step +inv +proj=affine +xoff=100 +s11=2 +s12=0.5 +s22=3 +s33=0.5 "
+                                         "+step +inv +proj=helmert +x=-10 +y=20 +z=5 +rx=0.5 +ry=-2 +rz=1 +s=-3 +convention=position_vector");
+
+    ASSERT_TRUE(roundTrip.has_value());
+
+    transformed = apply(roundTrip.value(), 4e6, 5e5, 4.5e6);
+
+    EXPECT_NEAR(transformed.x(), 4e6, 1e-6);
+    EXPECT_NEAR(transformed.y(), 5e5, 1e-6);
+    EXPECT_NEAR(transformed.z(), 4.5e6, 1e-6);
+
+    //the heights pushed before a step are restored after it.
+    auto pushPop = parseAffinePipeline("+proj=pipeline +step +proj=push +v_3 +step +proj=affine +xoff=5 +zoff=10 +step +proj=pop +v_3");
+
+    ASSERT_TRUE(pushPop.has_value());
+
+    transformed = apply(pushPop.value(), 1, 2, 3);
+
+    EXPECT_NEAR(transformed.x(), 6, 1e-12);
+    EXPECT_NEAR(transformed.z(), 3, 1e-12);
+
+    //non affine steps and time dependent transforms are not handled.
+    EXPECT_FALSE(parseAffinePipeline("+proj=pipeline +step +proj=cart +ellps=GRS80").has_value());
+    EXPECT_FALSE(parseAffinePipeline("+proj=helmert +x=1 +dx=0.1 +t_epoch=2010").has_value());
+    EXPECT_FALSE(parseAffinePipeline("+proj=helmert +rz=1").has_value());
+    EXPECT_FALSE(parseAffinePipeline("+proj=unitconvert +xy_in=deg +xy_out=parsec").has_value());
+}
+
+TEST(NativeCrsPipelineTest, TestKernels) {
+
+    using Ellipsoid = NativeCrsPipeline::Ellipsoid;
+
+    constexpr Ellipsoid wgs84 = NativeCrsPipeline::WGS84;
+    constexpr double deg2rad = M_PI/180;
+
+    double x;
+    double y;
+    double z;
+
+    NativeCrsPipeline::geodeticToCartesian(wgs84, 0, 0, 0, x, y, z);
+
+    EXPECT_NEAR(x, wgs84.a, 1e-9);
+    EXPECT_NEAR(y, 0, 1e-9);
+    EXPECT_NEAR(z, 0, 1e-9);
+
+    NativeCrsPipeline::geodeticToCartesian(wgs84, 0, M_PI/2, 100, x, y, z);
+
+    EXPECT_NEAR(x, 0, 1e-9);
+    EXPECT_NEAR(z, 6356752.314245 + 100, 1e-6);
+
+    //geocentric round trips, up to the poles and for airborne heights.
+    for (double lat = -90; lat <= 90; lat += 7.5) {
+        for (double lon = -180; lon < 180; lon += 45) {
+            for (double h : {-100.0, 0.0, 500.0, 9000.0}) {
+
+                double lonRad;
+                double latRad;
+                double height;
+
+                NativeCrsPipeline::geodeticToCartesian(wgs84, lon*deg2rad, lat*deg2rad, h, x, y, z);
+                NativeCrsPipeline::cartesianToGeodetic(wgs84, x, y, z, lonRad, latRad, height);
+
+                EXPECT_NEAR(latRad, lat*deg2rad, 1e-11);
+                EXPECT_NEAR(height, h, 1e-4);
+
+                if (std::abs(lat) < 90) {
+                    EXPECT_NEAR(std::remainder(lonRad - lon*deg2rad, 2*M_PI), 0, 1e-12);
+                }
+            }
+        }
+    }
+
+    //on the central meridian, the northing is the length of the meridian arc.
+    NativeCrsPipeline::TransverseMercator tmerc(wgs84, 0, 0, 1, 0, 0);
+
+    tmerc.forward(0, 45*deg2rad, x, y);
+
+    EXPECT_NEAR(x, 0, 1e-9);
+    EXPECT_NEAR(y, 4984944.378, 1e-3);
+
+    tmerc.forward(0, M_PI/2, x, y);
+
+    EXPECT_NEAR(y, 10001965.729, 1e-3);
+
+    //utm from geographic coordinates in degrees, as given by PROJ for EPSG:4326 to EPSG:32632.
+    std::optional<NativeCrsPipeline> utm = NativeCrsPipeline::parse("+proj=pipeline +step +proj=axisswap +order=2,1 "
+                                                                    "+step +proj=unitconvert +xy_in=deg +xy_out=rad "
+                                                                    "+step +proj=utm +zone=32 +ellps=WGS84");
+    std::optional<NativeCrsPipeline> utmInverse = NativeCrsPipeline::parse("+proj=pipeline +step +inv +proj=utm +zone=32 +ellps=WGS84 "
+                                                                           "+step +proj=unitconvert +xy_in=rad +xy_out=deg "
+                                                                           "+step +proj=axisswap +order=2,1");
+
+    ASSERT_TRUE(utm.has_value());
+    ASSERT_TRUE(utmInverse.has_value());
+    EXPECT_FALSE(utm->isAffine());
+
+    StereoVision::IO::PtGeometry<double> position;
+    position.x = 45;
+    position.y = 9;
+    position.z = 500;
+
+    utm->apply(position);
+
+    EXPECT_NEAR(position.x, 500000, 1e-6);
+    EXPECT_NEAR(position.y, 0.9996*4984944.378, 1e-3);
+    EXPECT_EQ(position.z, 500);
+
+    //projection round trips, within and well beyond the zone.
+    for (double lat = -80; lat <= 84; lat += 4) {
+        for (double dlon : {-20.0, -3.0, 0.0, 1.5, 3.0, 12.0}) {
+
+            position.x = lat;
+            position.y = 9 + dlon;
+            position.z = 0;
+
+            utm->apply(position);
+            utmInverse->apply(position);
+
+            EXPECT_NEAR(position.x, lat, 1e-10);
+            EXPECT_NEAR(position.y, 9 + dlon, 1e-10);
+        }
+    }
+
+    //the scale factor on the central meridian and the conformality imply a scale of k0*sec(conformal lat) along the equator.
+    NativeCrsPipeline::TransverseMercator equatorial(Ellipsoid{6378137, 0}, 0, 0, 1, 0, 0);
+
+    equatorial.forward(10*deg2rad, 0, x, y);
+
+    EXPECT_NEAR(x, 6378137*std::atanh(std::sin(10*deg2rad)), 1e-6);
+    EXPECT_NEAR(y, 0, 1e-9);
+
+    //unsupported steps and options are left to PROJ.
+    EXPECT_FALSE(NativeCrsPipeline::parse("+proj=tmerc +approx +lon_0=9").has_value());
+    EXPECT_FALSE(NativeCrsPipeline::parse("+proj=utm +zone=32 +units=us-ft").has_value());
+    EXPECT_FALSE(NativeCrsPipeline::parse("+proj=pipeline +step +inv +proj=somerc +lat_0=46.95 +lon_0=7.43").has_value());
+
+    //a datum shift through geocentric coordinates, the heights being kept.
+    std::optional<NativeCrsPipeline> shift = NativeCrsPipeline::parse("+proj=pipeline +step +proj=push +v_3 "
+                                                                      "+step +proj=cart +ellps=bessel "
+                                                                      "+step +proj=helmert +x=674.374 +y=15.056 +z=405.346 "
+                                                                      "+step +inv +proj=cart +ellps=WGS84 "
+                                                                      "+step +proj=pop +v_3");
+
+    ASSERT_TRUE(shift.has_value());
+
+    position.x = 7.43*deg2rad;
+    position.y = 46.95*deg2rad;
+    position.z = 123;
+
+    shift->apply(position);
+
+    EXPECT_EQ(position.z, 123);
+    EXPECT_NEAR(position.x, 7.43*deg2rad, 1e-4);
+    EXPECT_NEAR(position.y, 46.95*deg2rad, 1e-4);
+}
+
+TEST(NativeCrsPipelineTest, TestAgainstProj) {
+
+    PJ_CONTEXT* context = proj_context_create();
+
+    struct Case {
+        const char* inCrs;
+        const char* outCrs;
+        std::array<double, 3> min;
+        std::array<double, 3> max;
+        std::array<double, 3> tolerance;
+    };
+
+    std::vector<Case> cases = {
+        {"EPSG:4978", "EPSG:4979", {4.2e6, 4e5, 4.6e6}, {4.4e6, 6e5, 4.8e6}, {1e-10, 1e-10, 1e-4}},
+        {"EPSG:4326", "EPSG:32632", {44, 5, 0}, {48, 13, 0}, {1e-6, 1e-6, 0}},
+        {"EPSG:32632", "EPSG:4326", {3e5, 4.9e6, 0}, {7e5, 5.3e6, 0}, {1e-11, 1e-11, 0}}
+    };
+
+    for (Case const& testCase : cases) {
+
+        PJ* transform = proj_create_crs_to_crs(context, testCase.inCrs, testCase.outCrs, nullptr);
+
+        if (transform == nullptr) {
+            proj_context_destroy(context);
+            GTEST_SKIP() << "PROJ database not available";
+        }
+
+        std::optional<NativeCrsPipeline> pipeline = NativeCrsPipeline::fromProjTransform(context, transform);
+
+        ASSERT_TRUE(pipeline.has_value()) << testCase.inCrs << " to " << testCase.outCrs;
+
+        std::default_random_engine re(42);
+
+        for (int i = 0; i < 1000; i++) {
+
+            StereoVision::IO::PtGeometry<double> expected;
+            expected.x = std::uniform_real_distribution<double>(testCase.min[0], testCase.max[0])(re);
+            expected.y = std::uniform_real_distribution<double>(testCase.min[1], testCase.max[1])(re);
+            expected.z = std::uniform_real_distribution<double>(testCase.min[2], testCase.max[2])(re);
+
+            StereoVision::IO::PtGeometry<double> obtained = expected;
+
+            proj_trans_generic(transform, PJ_FWD,
+                               &expected.x, 1, 1,
+                               &expected.y, 1, 1,
+                               &expected.z, 1, 1,
+                               nullptr, 0, 0);
+
+            pipeline->apply(obtained);
+
+            EXPECT_NEAR(obtained.x, expected.x, testCase.tolerance[0]);
+            EXPECT_NEAR(obtained.y, expected.y, testCase.tolerance[1]);
+            EXPECT_NEAR(obtained.z, expected.z, testCase.tolerance[2]);
+        }
+
+        proj_destroy(transform);
+    }
+
+    proj_context_destroy(context);
+}
+
+TEST_F(PointCloudTest, TestRoiFanOut) {
+
+    //overlapping regions on a 5x5 grid, and a rotated one.
+    std::ostringstream regionFile;
+    regionFile << "# name x0,y0,z0,dx,dy,dz,rx,ry,rz\n\n";
+
+    std::vector<std::string> names;
+    std::vector<std::string> definitions;
+
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 5; j++) {
+            names.push_back("clip_" + std::to_string(i) + "_" + std::to_string(j));
+            definitions.push_back(std::to_string(-800 + 400*i) + "," + std::to_string(-800 + 400*j) + ",0,300,300,1000,0,0,0");
+        }
+    }
+
+    names.push_back("rotated");
+    definitions.push_back("100,-50,20,500,200,300,0.3,-0.2,0.7");
+
+    //far from all the points.
+    names.push_back("empty");
+    definitions.push_back("1e6,1e6,0,10,10,10,0,0,0");
+
+    for (size_t i = 0; i < names.size(); i++) {
+        regionFile << names[i] << " " << definitions[i] << "\n";
+    }
+
+    std::istringstream regionReader(regionFile.str());
+    std::optional<RegionOfInterestSet> regions = RegionOfInterestSet::parse(regionReader);
+
+    ASSERT_TRUE(regions.has_value());
+    ASSERT_EQ(regions->size(), names.size());
+
+    //expected number of points in each region, by testing all the regions.
+    std::map<std::string, int> expected;
+
+    for (size_t r = 0; r < names.size(); r++) {
+
+        StereoVision::Geometry::AffineTransform<double> world2rect;
+        std::array<double, 3> extents;
+
+        ASSERT_TRUE(RegionOfInterestSelector::parseDefinition(definitions[r], world2rect, extents));
+
+        for (int i = 0; i < nPoints; i++) {
+
+            StereoVision::IO::PtGeometry<double> point;
+            point.x = testCloud[i].xyz.x;
+            point.y = testCloud[i].xyz.y;
+            point.z = testCloud[i].xyz.z;
+
+            if (RegionOfInterestSelector::isInside(world2rect, extents, point)) {
+                expected[PartitionedWriter::partitionPath("test_rois.pcd", names[r]).filename().string()]++;
+            }
+        }
+    }
+
+    StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+    pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(testCloud);
+    pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(testCloud);
+
+    PartitionedWriter writer("test_rois.pcd", regions->partitionFunction());
+
+    std::map<std::string, int> counts;
+
+    bool ok = writer.write(pointCloudStack, [&counts] (std::filesystem::path const& path,
+                           StereoVision::IO::FullPointCloudAccessInterface & partition) {
+
+        int& count = counts[path.filename().string()];
+
+        do {
+            count++;
+        } while (partition.pointAccess->gotoNext());
+
+        return true;
+    });
+
+    ASSERT_TRUE(ok);
+    EXPECT_EQ(counts, expected);
+
+    EXPECT_EQ(regions->emptyRegions(writer.partitionsSizes()), std::vector<std::string>({"empty"}));
+
+    //invalid region files.
+    for (std::string invalid : {"", "# no region\n", "a 0,0,0,1,1,1,0,0,0\na 1,1,1,1,1,1,0,0,0\n",
+                                "a/b 0,0,0,1,1,1,0,0,0\n", "a\n", "a 0,0,0,1,1,1,0,0,0 extra\n"}) {
+        std::istringstream invalidReader(invalid);
+        EXPECT_FALSE(RegionOfInterestSet::parse(invalidReader).has_value()) << invalid;
+    }
+}
+
+TEST(RegionOfInterestSetTest, TestInputCrs) {
+
+    //regions in geographic coordinates, the points being converted to utm before they are written.
+    const char* inCrs = "EPSG:4326";
+    const char* outCrs = "EPSG:32632";
+
+    std::optional<CrsTransform> inverseConversion = CrsTransform::setup(outCrs, inCrs);
+
+    if (!inverseConversion.has_value()) {
+        GTEST_SKIP() << "PROJ database not available";
+    }
+
+    std::shared_ptr<const CrsTransform> toRegionsCrs = std::make_shared<CrsTransform>(std::move(inverseConversion.value()));
+
+    std::vector<std::string> names = {"north", "south", "rotated"};
+    std::vector<std::string> definitions = {"46.5,8,0,0.4,0.9,100,0,0,0", "45.5,8,0,0.4,0.9,100,0,0,0", "46,8,0,0.3,0.3,100,0,0,0.5"};
+
+    std::ostringstream regionFile;
+
+    for (size_t i = 0; i < names.size(); i++) {
+        regionFile << names[i] << " " << definitions[i] << "\n";
+    }
+
+    std::istringstream regionReader(regionFile.str());
+    std::optional<RegionOfInterestSet> regions = RegionOfInterestSet::parse(regionReader);
+
+    ASSERT_TRUE(regions.has_value());
+
+    //latitude, longitude (in the axis order of EPSG:4326) and height.
+    constexpr int nPoints = 1000;
+    GenericCloud cloud;
+
+    std::default_random_engine re(42);
+    std::uniform_real_distribution<float> latitudes(45, 47);
+    std::uniform_real_distribution<float> longitudes(7, 9);
+    std::uniform_real_distribution<float> heights(0, 50);
+
+    for (int i = 0; i < nPoints; i++) {
+
+        GenericCloud::Point point;
+
+        point.xyz.x = latitudes(re);
+        point.xyz.y = longitudes(re);
+        point.xyz.z = heights(re);
+
+        cloud.addPoint(point);
+    }
+
+    std::map<std::string, int> expected;
+
+    for (size_t r = 0; r < names.size(); r++) {
+
+        StereoVision::Geometry::AffineTransform<double> world2rect;
+        std::array<double, 3> extents;
+
+        ASSERT_TRUE(RegionOfInterestSelector::parseDefinition(definitions[r], world2rect, extents));
+
+        for (int i = 0; i < nPoints; i++) {
+
+            StereoVision::IO::PtGeometry<double> point;
+            point.x = cloud[i].xyz.x;
+            point.y = cloud[i].xyz.y;
+            point.z = cloud[i].xyz.z;
+
+            if (RegionOfInterestSelector::isInside(world2rect, extents, point)) {
+                expected[PartitionedWriter::partitionPath("test_rois_crs.pcd", names[r]).filename().string()]++;
+            }
+        }
+    }
+
+    ASSERT_FALSE(expected.empty());
+
+    for (bool convertBack : {true, false}) {
+
+        StereoVision::IO::FullPointCloudAccessInterface pointCloudStack;
+
+        pointCloudStack.headerAccess = std::make_unique<GenericCloudHeaderInterface>(cloud);
+        pointCloudStack.pointAccess = std::make_unique<GenericCloudInterface>(cloud);
+        pointCloudStack.pointAccess = CrsConversion::setupCrsConversion(pointCloudStack.pointAccess, inCrs, outCrs);
+
+        ASSERT_NE(pointCloudStack.pointAccess, nullptr);
+
+        PartitionedWriter writer("test_rois_crs.pcd", regions->partitionFunction((convertBack) ? toRegionsCrs : nullptr));
+
+        std::map<std::string, int> counts;
+
+        bool ok = writer.write(pointCloudStack, [&counts] (std::filesystem::path const& path,
+                               StereoVision::IO::FullPointCloudAccessInterface & partition) {
+
+            int& count = counts[path.filename().string()];
+
+            do {
+                count++;
+            } while (partition.pointAccess->gotoNext());
+
+            return true;
+        });
+
+        ASSERT_TRUE(ok);
+
+        //without the conversion back, the utm coordinates are tested against the geographic regions, which do not contain any of them.
+        if (convertBack) {
+            EXPECT_EQ(counts, expected);
+        } else {
+            EXPECT_TRUE(counts.empty());
+        }
+    }
+}
+
+TEST_F(PointCloudTest, TestStageProfiler) {
+
+    PipelineProfiler profiler(4);
+
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> chain =
+            std::make_unique<GenericCloudInterface>(testCloud);
+
+    chain = profiler.addStage("reader", std::move(chain));
+
+    StereoVision::IO::PointCloudGenericAttribute val = filter_attribute_options[0];
+    chain = AttributeBasedSelector::setupAttributeBasedSelector(chain,
+                                                                filter_attribute_name,
+                                                                AttributeBasedSelector::Equal,
+                                                                val);
+    ASSERT_NE(chain, nullptr);
+
+    chain = profiler.addStage("selector", std::move(chain));
+
+    while (chain->gotoNext()) {
+    }
+
+    std::stringstream report;
+    profiler.reportJson(report, 1.0);
+
+    std::string json = report.str();
+
+    std::string readerStats = "\"name\":\"reader\",\"points_in\":" + std::to_string(nPoints) + ",\"points_out\":" + std::to_string(nPoints);
+    std::string selectorStats = "\"name\":\"selector\",\"points_in\":" + std::to_string(nPoints) + ",\"points_out\":" + std::to_string(nPoints/2);
+
+    ASSERT_NE(json.find(readerStats), std::string::npos) << json;
+    ASSERT_NE(json.find(selectorStats), std::string::npos) << json;
+
+}
+
+TEST_F(PointCloudTest, TestBlockingStageProfiler) {
+
+    PipelineProfiler profiler(4);
+
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> chain =
+            std::make_unique<GenericCloudInterface>(testCloud);
+
+    chain = profiler.addStage("reader", std::move(chain));
+
+    chain = PointSorter::setupPointSorter(chain, PointSorter::Morton);
+    ASSERT_NE(chain, nullptr);
+
+    //a long setup, so that the time measured by the probes is negligible.
+    constexpr double setupTime = 100;
+    constexpr double totalTime = 150;
+
+    chain = profiler.addBlockingStage("sort", std::move(chain), setupTime);
+
+    while (chain->gotoNext()) {
+    }
+
+    std::stringstream report;
+    profiler.reportJson(report, totalTime);
+
+    std::string json = report.str();
+
+    auto stageTime = [&json] (std::string const& name) {
+
+        std::string key = "\"name\":\"" + name + "\"";
+        size_t pos = json.find(key);
+
+        if (pos == std::string::npos) {
+            return -1.;
+        }
+
+        pos = json.find("\"seconds\":", pos);
+        return std::stod(json.substr(pos + 10));
+    };
+
+    //the setup time is attributed to the sort (minus the time spent reading), not to the writer.
+    EXPECT_NEAR(stageTime("sort"), setupTime, 1) << json;
+    EXPECT_NEAR(stageTime("writer"), totalTime - setupTime, 1) << json;
+    EXPECT_LT(stageTime("reader"), 1) << json;
+
+}
+
+/*!
+ * \brief The PeriodicWorkSource class repeat the first point of its source, and do a slow call to gotoNext
+ * at the end of each period, like the readers decoding a new chunk.
+ */
+class PeriodicWorkSource : public IdentityProcessor
+{
+public:
+    PeriodicWorkSource(std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> && source,
+                       int64_t nCalls,
+                       int period,
+                       std::chrono::microseconds workTime) :
+        IdentityProcessor(std::move(source)),
+        _nCalls(nCalls),
+        _period(period),
+        _workTime(workTime),
+        _call(0)
+    {
+
+    }
+
+    virtual bool gotoNext() override {
+
+        if (_call%_period == _period-1) {
+            auto start = std::chrono::steady_clock::now();
+            while (std::chrono::steady_clock::now() - start < _workTime) {
+            }
+        }
+
+        _call++;
+        return _call < _nCalls;
+    }
+
+protected:
+    int64_t _nCalls;
+    int _period;
+    std::chrono::microseconds _workTime;
+    int64_t _call;
+};
+
+TEST_F(PointCloudTest, TestStageProbeSampling) {
+
+    constexpr int period = 64;
+    constexpr int64_t nPeriods = 4000;
+    constexpr std::chrono::microseconds workTime(50);
+
+    //the slow calls have the same period as the sampling, they would never be sampled at a fixed phase.
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> source =
+            std::make_unique<PeriodicWorkSource>(std::make_unique<GenericCloudInterface>(testCloud), nPeriods*period, period, workTime);
+
+    StageProbe probe(std::move(source), period);
+
+    auto start = std::chrono::steady_clock::now();
+
+    while (probe.gotoNext()) {
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double workTotal = 1e-6*workTime.count()*nPeriods;
+
+    EXPECT_GT(probe.cumulativeTime(), workTotal/2);
+    EXPECT_LT(probe.cumulativeTime(), 2*elapsed);
+}
+
+/*!
+ * \brief readNdjsonEvents read the NDJSON events written to a pipe, once its write end is closed.
+ */
+std::vector<std::string> readNdjsonEvents(int fd) {
+
+    std::vector<std::string> events;
+    std::istringstream lines(readAll(fd));
+    std::string line;
+
+    while (std::getline(lines, line)) {
+        events.push_back(line);
+    }
+
+    return events;
+}
+
+TEST_F(PointCloudTest, TestProgressReporter) {
+
+    for (bool success : {true, false}) {
+
+        std::unique_ptr<ProgressCounter> counter = std::make_unique<ProgressCounter>(std::make_unique<GenericCloudInterface>(testCloud));
+
+        //the current point is already read.
+        EXPECT_EQ(counter->processedPoints(), 1);
+
+        std::array<int, 2> fds;
+        ASSERT_EQ(::pipe(fds.data()), 0);
+
+        //the number of points is unknown in the failing case.
+        ProgressReporter reporter(counter.get(), (success) ? nPoints : -1, -1, false, fds[1]);
+        reporter.start();
+
+        std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> chain = std::move(counter);
+        ProgressCounter const* counterStage = static_cast<ProgressCounter const*>(chain.get());
+
+        int nRead = 1;
+
+        while (chain->gotoNext()) {
+            nRead++;
+        }
+
+        EXPECT_EQ(nRead, nPoints);
+        EXPECT_EQ(counterStage->processedPoints(), nPoints);
+
+        reporter.finish(success);
+        ::close(fds[1]);
+
+        std::vector<std::string> events = readNdjsonEvents(fds[0]);
+        ::close(fds[0]);
+
+        ASSERT_GE(events.size(), 2);
+
+        std::string const& start = events.front();
+        std::string const& end = events.back();
+
+        EXPECT_EQ(start.rfind("{\"event\":\"start\"", 0), 0) << start;
+        EXPECT_EQ(end.rfind("{\"event\":\"end\"", 0), 0) << end;
+        EXPECT_NE(end.find(",\"points\":" + std::to_string(nPoints) + ","), std::string::npos) << end;
+
+        if (success) {
+            EXPECT_NE(end.find(",\"status\":\"ok\""), std::string::npos) << end;
+            EXPECT_NE(end.find(",\"fraction\":1,"), std::string::npos) << end;
+            EXPECT_NE(end.find(",\"total_points\":" + std::to_string(nPoints) + ","), std::string::npos) << end;
+        } else {
+            EXPECT_NE(end.find(",\"status\":\"error\""), std::string::npos) << end;
+            EXPECT_NE(end.find(",\"fraction\":null,"), std::string::npos) << end;
+        }
+
+        for (std::string const& event : events) {
+            EXPECT_EQ(event.front(), '{') << event;
+            EXPECT_EQ(event.back(), '}') << event;
+        }
+    }
+
+    //the large totals are written as exact integers, not rounded to 6 significant digits.
+    constexpr int64_t largeTotalPoints = 123456789;
+    constexpr int64_t largeTotalBytes = 9876543210;
+
+    ProgressCounter counter(std::make_unique<GenericCloudInterface>(testCloud));
+
+    std::array<int, 2> fds;
+    ASSERT_EQ(::pipe(fds.data()), 0);
+
+    ProgressReporter reporter(&counter, largeTotalPoints, largeTotalBytes, false, fds[1]);
+    reporter.start();
+    reporter.finish(true);
+    ::close(fds[1]);
+
+    std::vector<std::string> events = readNdjsonEvents(fds[0]);
+    ::close(fds[0]);
+
+    ASSERT_GE(events.size(), 2);
+
+    for (std::string const& event : events) {
+        EXPECT_NE(event.find(",\"total_points\":" + std::to_string(largeTotalPoints) + ","), std::string::npos) << event;
+        EXPECT_NE(event.find(",\"total_bytes\":" + std::to_string(largeTotalBytes) + ","), std::string::npos) << event;
+    }
+}
+
+TEST(SyntheticDataTest, TestSyntheticPointCloud) {
+
+    SyntheticPointCloud::Parameters parameters;
+    parameters.nPoints = 20000;
+    parameters.lineLength = 100;
+    parameters.pulseRate = 5000;
+    parameters.seed = 42;
+
+    std::unique_ptr<SyntheticPointCloud> cloud = SyntheticPointCloud::setupSyntheticPointCloud(parameters);
+    std::unique_ptr<SyntheticPointCloud> replica = SyntheticPointCloud::setupSyntheticPointCloud(parameters);
+
+    ASSERT_NE(cloud, nullptr);
+    ASSERT_NE(replica, nullptr);
+
+    int count = 0;
+    int maxLine = 0;
+    double previousTime = -1;
+    std::set<int> classes;
+
+    do {
+
+        auto pos = cloud->castedPointGeometry<double>();
+        auto replicaPos = replica->castedPointGeometry<double>();
+
+        ASSERT_EQ(pos.x, replicaPos.x);
+        ASSERT_EQ(pos.y, replicaPos.y);
+        ASSERT_EQ(pos.z, replicaPos.z);
+
+        auto gpsTime = cloud->getAttributeByName("gpsTime");
+        auto returnNumber = cloud->getAttributeByName("returnNumber");
+        auto numberOfReturns = cloud->getAttributeByName("numberOfReturns");
+        auto classification = cloud->getAttributeByName("classification");
+        auto line = cloud->getAttributeByName("lineNumber");
+
+        ASSERT_TRUE(gpsTime.has_value() and returnNumber.has_value() and numberOfReturns.has_value());
+        ASSERT_TRUE(classification.has_value() and line.has_value());
+
+        double time = StereoVision::IO::castedPointCloudAttribute<double>(gpsTime.value());
+        int ret = StereoVision::IO::castedPointCloudAttribute<int>(returnNumber.value());
+        int nRet = StereoVision::IO::castedPointCloudAttribute<int>(numberOfReturns.value());
+
+        ASSERT_GE(time, previousTime); //points are generated in acquisition order
+        ASSERT_GE(ret, 1);
+        ASSERT_LE(ret, nRet);
+        ASSERT_LE(nRet, parameters.maxReturns);
+
+        previousTime = time;
+        maxLine = std::max(maxLine, StereoVision::IO::castedPointCloudAttribute<int>(line.value()));
+        classes.insert(StereoVision::IO::castedPointCloudAttribute<int>(classification.value()));
+
+        count++;
+
+        replica->gotoNext();
+
+    } while (cloud->gotoNext());
+
+    EXPECT_EQ(count, parameters.nPoints);
+    EXPECT_FALSE(cloud->hasData());
+    EXPECT_GT(maxLine, 0);
+    EXPECT_GT(classes.count(2), 0); //ground
+    EXPECT_GT(classes.size(), 1);
+
+}
+
+TEST(SyntheticDataTest, TestStaticPipeline) {
+
+    SyntheticPointCloud::Parameters parameters;
+    parameters.nPoints = 20000;
+    parameters.lineLength = 100;
+    parameters.pulseRate = 5000;
+    parameters.seed = 7;
+
+    std::vector<int> lines = {1};
+    int returnCap = 1;
+
+    //region of interest covering only a part of the first two lines.
+    std::ostringstream roi;
+    roi.precision(12);
+    roi << parameters.x0 + parameters.lineLength/2 << "," << parameters.y0 << ",0,20,500,1000,0,0,0.2";
+
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> dynamicChain = SyntheticPointCloud::setupSyntheticPointCloud(parameters);
+
+    dynamicChain = RegionOfInterestSelector::setupRoiSelection(dynamicChain, roi.str());
+    ASSERT_NE(dynamicChain, nullptr);
+    StereoVision::IO::PointCloudGenericAttribute capVal = returnCap;
+    dynamicChain = AttributeBasedSelector::setupAttributeBasedSelector(dynamicChain, "returnNumber", AttributeBasedSelector::SmallerOrEqual, capVal);
+    ASSERT_NE(dynamicChain, nullptr);
+    dynamicChain = AttributeSetBasedSelector::setupAttributeSetBasedSelector(dynamicChain, "lineNumber", AttributeSetBasedSelector::InSet, lines);
+    ASSERT_NE(dynamicChain, nullptr);
+
+    std::unique_ptr<StereoVision::IO::PointCloudPointAccessInterface> staticChain = SyntheticPointCloud::setupSyntheticPointCloud(parameters);
+
+    StaticPipelineConfig config;
+    config.roi = StaticStages::Roi::fromDefinition(roi.str());
+    config.returnCap = StaticStages::ReturnCap{double(returnCap)};
+    config.lineSet = StaticStages::LineSet::fromIndices(lines);
+
+    ASSERT_TRUE(config.roi.has_value());
+
+    staticChain = setupStaticPipeline(staticChain, std::move(config));
+    ASSERT_NE(staticChain, nullptr);
+
+    int count = 0;
+    bool dynamicHasMore = true;
+    bool staticHasMore = true;
+
+    do {
+
+        auto dynamicPos = dynamicChain->castedPointGeometry<double>();
+        auto staticPos = staticChain->castedPointGeometry<double>();
+
+        ASSERT_EQ(dynamicPos.x, staticPos.x);
+        ASSERT_EQ(dynamicPos.y, staticPos.y);
+        ASSERT_EQ(dynamicPos.z, staticPos.z);
+
+        auto line = staticChain->getAttributeByName("lineNumber");
+        auto ret = staticChain->getAttributeByName("returnNumber");
+
+        ASSERT_TRUE(line.has_value() and ret.has_value());
+        ASSERT_EQ(StereoVision::IO::castedPointCloudAttribute<int>(line.value()), lines[0]);
+        ASSERT_LE(StereoVision::IO::castedPointCloudAttribute<int>(ret.value()), returnCap);
+
+        count++;
+
+        dynamicHasMore = dynamicChain->gotoNext();
+        staticHasMore = staticChain->gotoNext();
+
+        ASSERT_EQ(dynamicHasMore, staticHasMore);
+
+    } while (staticHasMore);
+
+    EXPECT_GT(count, 1);
+
+}
+
 int main(int argc, char **argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();